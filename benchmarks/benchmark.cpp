@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "benchmark.hpp"
+
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace ndn {
+namespace ntorrent {
+namespace benchmarks {
+
+namespace {
+
+struct Benchmark {
+  std::string          name;
+  Function             function;
+  std::vector<int64_t> args;
+};
+
+std::vector<Benchmark>&
+registry()
+{
+  static std::vector<Benchmark> benchmarks;
+  return benchmarks;
+}
+
+enum {
+  // The largest number of iterations of a run
+  MAX_ITERATIONS = 1000000000
+};
+
+// Run 'benchmark' with 'arg' until a run lasts at least 'minTime' and print its results
+void
+run(const Benchmark& benchmark, int64_t arg, bool hasArg, double minTime)
+{
+  uint64_t iterations = 1;
+  while (true) {
+    State state(iterations, arg);
+    benchmark.function(state);
+    double seconds = std::chrono::duration<double>(state.elapsed()).count();
+    if (seconds >= minTime || iterations >= MAX_ITERATIONS) {
+      auto label = benchmark.name + (hasArg ? "/" + std::to_string(arg) : "");
+      std::printf("%-48s %12llu %14.1f ns", label.c_str(),
+                  static_cast<unsigned long long>(iterations), seconds * 1e9 / iterations);
+      if (0 != state.bytesPerIteration()) {
+        std::printf(" %12.1f MB/s", state.bytesPerIteration() * iterations / seconds / 1e6);
+      }
+      std::printf("\n");
+      std::fflush(stdout);
+      return;
+    }
+    // aim a bit beyond the minimum time, growing by at least 2 and at most 10 times
+    double scale = seconds > 0 ? 1.4 * minTime / seconds : 10;
+    scale = std::max(2.0, std::min(10.0, scale));
+    iterations = std::min<uint64_t>(MAX_ITERATIONS, iterations * scale);
+  }
+}
+
+} // namespace
+
+State::State(uint64_t iterations, int64_t arg)
+: m_iterations(iterations)
+, m_remaining(iterations)
+, m_arg(arg)
+, m_bytesPerIteration(0)
+, m_started(false)
+, m_running(false)
+, m_elapsed(Clock::duration::zero())
+{
+}
+
+void
+registerBenchmark(const std::string& name, Function function, std::vector<int64_t> args)
+{
+  registry().push_back(Benchmark{name, function, args});
+}
+
+int
+runBenchmarks(int argc, char** argv)
+{
+  std::string filter;
+  double minTime = 0.5;
+  for (int i = 1; i < argc; ++i) {
+    const char minTimeFlag[] = "--min-time=";
+    if (0 == std::strncmp(argv[i], minTimeFlag, sizeof(minTimeFlag) - 1)) {
+      try {
+        minTime = boost::lexical_cast<double>(argv[i] + sizeof(minTimeFlag) - 1);
+      }
+      catch (const boost::bad_lexical_cast&) {
+        std::cerr << "Invalid minimum time: " << argv[i] << std::endl;
+        return 1;
+      }
+    }
+    else if ('-' == argv[i][0]) {
+      std::cerr << "usage: " << argv[0] << " [--min-time=<seconds>] [<filter>]" << std::endl;
+      return 1;
+    }
+    else {
+      filter = argv[i];
+    }
+  }
+  std::printf("%-48s %12s %17s %17s\n", "Benchmark", "Iterations", "Time/iteration", "Throughput");
+  for (const auto& benchmark : registry()) {
+    if (std::string::npos == benchmark.name.find(filter)) {
+      continue;
+    }
+    if (benchmark.args.empty()) {
+      run(benchmark, 0, false, minTime);
+    }
+    for (auto arg : benchmark.args) {
+      run(benchmark, arg, true, minTime);
+    }
+  }
+  return 0;
+}
+
+} // namespace benchmarks
+} // namespace ntorrent
+} // namespace ndn
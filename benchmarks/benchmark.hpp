@@ -0,0 +1,222 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_BENCHMARKS_BENCHMARK_HPP
+#define INCLUDED_BENCHMARKS_BENCHMARK_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+namespace benchmarks {
+
+class State {
+  /**
+   * \class State
+   *
+   * \brief The timing of one run of a benchmark, over a fixed number of iterations
+   *
+   * A benchmark performs its setup, then calls keepRunning() until it returns 'false', timing only
+   * the iterations of that loop:
+   *
+   *   while (state.keepRunning()) {
+   *     ...
+   *   }
+   */
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  State(uint64_t iterations, int64_t arg);
+
+  /*
+   * @brief Return whether another iteration should be run, starting the timer on the first call
+   */
+  bool
+  keepRunning();
+
+  /*
+   * @brief Stop the timer, e.g. to reset the state changed by an iteration
+   */
+  void
+  pauseTiming();
+
+  /*
+   * @brief Restart the timer stopped by pauseTiming()
+   */
+  void
+  resumeTiming();
+
+  /*
+   * @brief Record that each iteration processes @p bytes bytes, to report the throughput
+   */
+  void
+  setBytesPerIteration(uint64_t bytes);
+
+  /*
+   * @brief Return the argument the benchmark is run with, or 0 if it has none
+   */
+  int64_t
+  arg() const;
+
+  /*
+   * @brief Return the number of iterations of this run
+   */
+  uint64_t
+  iterations() const;
+
+  /*
+   * @brief Return the time spent in the timed iterations
+   */
+  Clock::duration
+  elapsed() const;
+
+  /*
+   * @brief Return the number of bytes processed by each iteration
+   */
+  uint64_t
+  bytesPerIteration() const;
+
+ private:
+  uint64_t          m_iterations;
+  uint64_t          m_remaining;
+  int64_t           m_arg;
+  uint64_t          m_bytesPerIteration;
+  bool              m_started;
+  bool              m_running;
+  Clock::time_point m_start;
+  Clock::duration   m_elapsed;
+};
+
+typedef std::function<void(State&)> Function;
+
+/*
+ * @brief Register the benchmark @p function named @p name, run once with each of @p args (or once
+ *        without argument if empty)
+ */
+void
+registerBenchmark(const std::string& name, Function function, std::vector<int64_t> args);
+
+/*
+ * @brief Run the registered benchmarks whose names contain the filter given on the command line,
+ *        if any, and print their results; return the exit status of the program
+ *
+ * Each benchmark is run with an increasing number of iterations until a run lasts at least the
+ * minimum time (--min-time=<seconds>, 0.5 by default), and the last run is reported.
+ */
+int
+runBenchmarks(int argc, char** argv);
+
+/*
+ * @brief Prevent the compiler from optimizing away the computation of @p value
+ */
+template<typename T>
+inline void
+doNotOptimize(const T& value)
+{
+  asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct Registration {
+  Registration(const std::string& name, Function function, std::vector<int64_t> args = {})
+  {
+    registerBenchmark(name, function, args);
+  }
+};
+
+inline bool
+State::keepRunning()
+{
+  if (!m_started) {
+    m_started = true;
+    resumeTiming();
+  }
+  if (0 == m_remaining) {
+    pauseTiming();
+    return false;
+  }
+  --m_remaining;
+  return true;
+}
+
+inline void
+State::pauseTiming()
+{
+  if (m_running) {
+    m_elapsed += Clock::now() - m_start;
+    m_running = false;
+  }
+}
+
+inline void
+State::resumeTiming()
+{
+  if (!m_running) {
+    m_start = Clock::now();
+    m_running = true;
+  }
+}
+
+inline void
+State::setBytesPerIteration(uint64_t bytes)
+{
+  m_bytesPerIteration = bytes;
+}
+
+inline int64_t
+State::arg() const
+{
+  return m_arg;
+}
+
+inline uint64_t
+State::iterations() const
+{
+  return m_iterations;
+}
+
+inline State::Clock::duration
+State::elapsed() const
+{
+  return m_elapsed;
+}
+
+inline uint64_t
+State::bytesPerIteration() const
+{
+  return m_bytesPerIteration;
+}
+
+} // namespace benchmarks
+} // namespace ntorrent
+} // namespace ndn
+
+// Define the benchmark 'name', run once with each of the optional integer arguments
+#define NTORRENT_BENCHMARK(name, ...)                                                       \
+  static void name(::ndn::ntorrent::benchmarks::State& state);                              \
+  static ::ndn::ntorrent::benchmarks::Registration name##Registration(#name, name,          \
+                                                                      {__VA_ARGS__});       \
+  static void name(::ndn::ntorrent::benchmarks::State& state)
+
+#endif // INCLUDED_BENCHMARKS_BENCHMARK_HPP
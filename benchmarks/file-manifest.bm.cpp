@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "benchmark.hpp"
+#include "temporary-directory.hpp"
+
+#include "file-manifest.hpp"
+#include "util/digest-signer.hpp"
+
+#include <map>
+
+using ndn::ntorrent::benchmarks::TemporaryDirectory;
+using ndn::ntorrent::benchmarks::doNotOptimize;
+
+namespace ndn {
+namespace ntorrent {
+namespace {
+
+enum {
+  // The size of the packets named in the catalogs, which does not change their encoding
+  DATA_PACKET_SIZE = 64
+};
+
+// Return a signed manifest whose catalog has 'catalogSize' names, generated once per size
+const FileManifest&
+manifestWithCatalog(size_t catalogSize)
+{
+  static std::map<size_t, FileManifest> manifests;
+  auto it = manifests.find(catalogSize);
+  if (manifests.end() == it) {
+    TemporaryDirectory directory;
+    auto filePath = directory.createFile("file", catalogSize * DATA_PACKET_SIZE);
+    auto generated = FileManifest::generate(filePath, "/NTORRENT/benchmark/", catalogSize,
+                                            DATA_PACKET_SIZE);
+    it = manifests.emplace(catalogSize, generated.front()).first;
+  }
+  return it->second;
+}
+
+} // namespace
+
+NTORRENT_BENCHMARK(FileManifestWireEncode, 1000, 10000, 100000)
+{
+  const auto& manifest = manifestWithCatalog(state.arg());
+  state.setBytesPerIteration(manifest.wireEncode().size());
+  while (state.keepRunning()) {
+    state.pauseTiming();
+    FileManifest copy(manifest);
+    state.resumeTiming();
+    // encode the catalog into the content again, then the whole packet and its digest
+    copy.finalize();
+    DigestSigner::sign(copy);
+    doNotOptimize(copy.wireEncode());
+  }
+}
+
+NTORRENT_BENCHMARK(FileManifestWireDecode, 1000, 10000, 100000)
+{
+  const auto& wire = manifestWithCatalog(state.arg()).wireEncode();
+  state.setBytesPerIteration(wire.size());
+  while (state.keepRunning()) {
+    FileManifest manifest(wire);
+    doNotOptimize(manifest);
+  }
+}
+
+} // namespace ntorrent
+} // namespace ndn
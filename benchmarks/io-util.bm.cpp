@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "benchmark.hpp"
+#include "temporary-directory.hpp"
+
+#include "file-manifest.hpp"
+#include "util/file-handle-cache.hpp"
+#include "util/file-map-cache.hpp"
+#include "util/io-util.hpp"
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/name.hpp>
+
+using ndn::ntorrent::benchmarks::TemporaryDirectory;
+using ndn::ntorrent::benchmarks::doNotOptimize;
+
+namespace ndn {
+namespace ntorrent {
+namespace {
+
+enum {
+  // The size of the file packetized, written and read by each iteration
+  FILE_SIZE = 4 * 1024 * 1024
+};
+
+// The number of packets of 'dataPacketSize' bytes of a file of FILE_SIZE bytes
+size_t
+numPackets(size_t dataPacketSize)
+{
+  return (FILE_SIZE + dataPacketSize - 1) / dataPacketSize;
+}
+
+} // namespace
+
+NTORRENT_BENCHMARK(PacketizeFile, 1024, 4096, 8192)
+{
+  TemporaryDirectory directory;
+  auto filePath = directory.createFile("file", FILE_SIZE);
+  size_t dataPacketSize = state.arg();
+  Name prefix("/ndn/multicast/NTORRENT/benchmark/file/0");
+  state.setBytesPerIteration(FILE_SIZE);
+  while (state.keepRunning()) {
+    size_t size = 0;
+    IoUtil::packetize_file(filePath, prefix, dataPacketSize, numPackets(dataPacketSize), 0,
+                           [&size] (const Data& packet, const Name&) {
+                             size += packet.getContent().value_size();
+                           });
+    doNotOptimize(size);
+  }
+}
+
+NTORRENT_BENCHMARK(WriteData, 1024, 4096, 8192)
+{
+  TemporaryDirectory directory;
+  auto filePath = directory.createFile("file", FILE_SIZE);
+  size_t dataPacketSize = state.arg();
+  size_t subManifestSize = numPackets(dataPacketSize);
+  auto content = FileManifest::generate(filePath, "/NTORRENT/benchmark/", subManifestSize,
+                                        dataPacketSize, true);
+  const auto& manifest = content.first.front();
+  const auto& packets = content.second;
+  auto outputPath = (directory.path() / "output").string();
+  state.setBytesPerIteration(FILE_SIZE);
+  while (state.keepRunning()) {
+    // the file is written through the page cache, as the writer syncs it once per sub-manifest
+    FileHandleCache handles;
+    bool written = true;
+    for (const auto& packet : packets) {
+      written &= IoUtil::writeData(packet, manifest, subManifestSize, outputPath, handles);
+    }
+    doNotOptimize(written);
+  }
+}
+
+NTORRENT_BENCHMARK(ReadDataPacket, 1024, 4096, 8192)
+{
+  TemporaryDirectory directory;
+  auto filePath = directory.createFile("file", FILE_SIZE);
+  size_t dataPacketSize = state.arg();
+  size_t subManifestSize = numPackets(dataPacketSize);
+  auto content = FileManifest::generate(filePath, "/NTORRENT/benchmark/", subManifestSize,
+                                        dataPacketSize, true);
+  const auto& manifest = content.first.front();
+  std::vector<Name> names;
+  for (const auto& packet : content.second) {
+    names.push_back(packet.getFullName());
+  }
+  FileHandleCache handles;
+  state.setBytesPerIteration(FILE_SIZE);
+  while (state.keepRunning()) {
+    size_t size = 0;
+    for (const auto& name : names) {
+      auto packet = IoUtil::readDataPacket(name, manifest, subManifestSize, filePath, handles);
+      size += nullptr != packet ? packet->getContent().value_size() : 0;
+    }
+    doNotOptimize(size);
+  }
+}
+
+NTORRENT_BENCHMARK(ReadMappedDataPacket, 1024, 4096, 8192)
+{
+  TemporaryDirectory directory;
+  auto filePath = directory.createFile("file", FILE_SIZE);
+  size_t dataPacketSize = state.arg();
+  size_t subManifestSize = numPackets(dataPacketSize);
+  auto content = FileManifest::generate(filePath, "/NTORRENT/benchmark/", subManifestSize,
+                                        dataPacketSize, true);
+  const auto& manifest = content.first.front();
+  std::vector<Name> names;
+  for (const auto& packet : content.second) {
+    names.push_back(packet.getFullName());
+  }
+  FileMapCache mappings;
+  state.setBytesPerIteration(FILE_SIZE);
+  while (state.keepRunning()) {
+    size_t size = 0;
+    for (size_t i = 0; i < names.size(); ++i) {
+      auto packet = IoUtil::readDataPacket(names[i],
+                                           IoUtil::dataOffset(manifest, subManifestSize, i),
+                                           dataPacketSize,
+                                           filePath,
+                                           mappings);
+      size += nullptr != packet ? packet->getContent().value_size() : 0;
+    }
+    doNotOptimize(size);
+  }
+}
+
+} // namespace ntorrent
+} // namespace ndn
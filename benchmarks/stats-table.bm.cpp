@@ -0,0 +1,64 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "benchmark.hpp"
+
+#include "stats-table.hpp"
+
+#include <random>
+
+using ndn::ntorrent::benchmarks::doNotOptimize;
+
+namespace ndn {
+namespace ntorrent {
+
+// Sort a table of the given number of routable prefixes on their scores, as the manager does
+NTORRENT_BENCHMARK(StatsTableSort, 10, 100, 1000)
+{
+  StatsTable table(Name("benchmark"));
+  std::mt19937 random(state.arg());
+  auto now = time::steady_clock::now();
+  for (int64_t i = 0; i < state.arg(); ++i) {
+    table.insert(Name("/isp").appendNumber(i));
+  }
+  for (auto& record : table) {
+    auto sent = 1 + random() % 100;
+    for (size_t i = 0; i < sent; ++i) {
+      record.incrementSentInterests();
+    }
+    for (size_t i = random() % (sent + 1); 0 < i; --i) {
+      record.incrementReceivedData();
+      record.recordReceivedBytes(1024, now + time::milliseconds(i));
+    }
+    record.recordRtt(time::milliseconds(1 + random() % 200));
+  }
+  while (state.keepRunning()) {
+    // sort the records in their original order again
+    state.pauseTiming();
+    StatsTable copy(table);
+    state.resumeTiming();
+    copy.sort(StatsTable::scoreComparator());
+    doNotOptimize(copy);
+  }
+}
+
+} // namespace ntorrent
+} // namespace ndn
@@ -0,0 +1,289 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "simulated-network.hpp"
+#include "temporary-directory.hpp"
+
+#include "metadata-store.hpp"
+#include "rarest-first-data-fetcher.hpp"
+#include "sequential-data-fetcher.hpp"
+#include "torrent-file.hpp"
+#include "torrent-manager.hpp"
+#include "util/io-util.hpp"
+#include "util/logging.hpp"
+#include "util/shared-constants.hpp"
+#include "util/thread-pool.hpp"
+
+#include <boost/asio/io_service.hpp>
+#include <boost/program_options.hpp>
+
+#include <ndn-cxx/util/scheduler.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace po = boost::program_options;
+
+namespace ndn {
+namespace ntorrent {
+
+const char * SharedConstants::commonPrefix = "/ndn/multicast";
+
+namespace benchmarks {
+namespace {
+
+// The name of the torrent, which is also the directory holding its files
+const char* const TORRENT = "swarm";
+
+// The download of a peer that starts without any of the torrent
+struct Leecher {
+  SimulatedNetwork::Id                       id;
+  std::shared_ptr<SequentialDataFetcher>     sequential;
+  std::shared_ptr<RarestFirstDataFetcher>    rarestFirst;
+  // The full names of the distinct data packets received
+  std::unordered_set<Name>                   received;
+  // The time from the start of the swarm to the last data packet, or zero while incomplete
+  std::chrono::steady_clock::duration        completion;
+};
+
+// Store the torrent file segments and file manifests of 'content' in the metadata store at 'path'
+void
+storeMetadata(const std::string& path,
+              const std::pair<std::vector<TorrentFile>,
+                              std::vector<std::pair<std::vector<FileManifest>,
+                                                    std::vector<Data>>>>& content)
+{
+  IoUtil::create_directories(boost::filesystem::path(path).parent_path().string());
+  MetadataStore store;
+  if (!store.open(path)) {
+    throw std::runtime_error("Cannot open the metadata store " + path);
+  }
+  for (const auto& segment : content.first) {
+    store.insert(segment);
+  }
+  for (const auto& file : content.second) {
+    for (const auto& manifest : file.first) {
+      store.insert(manifest);
+    }
+  }
+  store.flush();
+}
+
+double
+seconds(std::chrono::steady_clock::duration duration)
+{
+  return std::chrono::duration<double>(duration).count();
+}
+
+} // namespace
+} // namespace benchmarks
+} // namespace ntorrent
+} // namespace ndn
+
+using namespace ndn;
+using namespace ndn::ntorrent;
+using namespace ndn::ntorrent::benchmarks;
+
+int
+main(int argc, char** argv)
+{
+  po::options_description desc("Simulate a swarm downloading a generated torrent and report its "
+                               "throughput.\nAllowed options");
+  desc.add_options()
+    ("help,h", "produce help message")
+    ("seeders", po::value<size_t>()->default_value(1), "Number of peers with the whole torrent")
+    ("leechers", po::value<size_t>()->default_value(4), "Number of peers downloading the torrent")
+    ("files", po::value<size_t>()->default_value(16), "Number of files of the torrent")
+    ("file-size", po::value<size_t>()->default_value(256 * 1024), "Size of each file in bytes")
+    ("packet-size", po::value<size_t>()->default_value(0),
+     "Size of the data packets in bytes (0 to fit them to the largest NDN packet)")
+    ("delay", po::value<size_t>()->default_value(10), "Delay between any two peers in milliseconds")
+    ("loss", po::value<double>()->default_value(0), "Probability that a packet is lost")
+    ("bandwidth", po::value<uint64_t>()->default_value(0),
+     "Uplink bandwidth of each peer in bytes per second (0 for unlimited)")
+    ("strategy", po::value<std::string>()->default_value("sequential"), "sequential | rarest-first")
+    ("seed", po::value<uint32_t>()->default_value(1), "Seed of the random choices of the network")
+    ("timeout", po::value<size_t>()->default_value(300), "Seconds after which the swarm is stopped")
+  ;
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+  }
+  catch (const po::error& e) {
+    std::cerr << e.what() << std::endl << desc << std::endl;
+    return 2;
+  }
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+  const auto strategy = vm["strategy"].as<std::string>();
+  if ("sequential" != strategy && "rarest-first" != strategy) {
+    std::cerr << "Unsupported strategy: " << strategy << std::endl;
+    return 2;
+  }
+  const auto numFiles = vm["files"].as<size_t>();
+  const auto fileSize = vm["file-size"].as<size_t>();
+  // a packet per line would swamp the throughput being measured
+  LoggingUtil::severity_threshold = boost::log::trivial::warning;
+
+  // all the peers store their data relative to the working directory
+  TemporaryDirectory directory;
+  boost::filesystem::current_path(directory.path());
+  for (size_t i = 0; i < numFiles; ++i) {
+    directory.createFile(std::string(TORRENT) + "/" + std::to_string(i), fileSize);
+  }
+  auto sizes = TorrentFile::fitPacketSizes(TORRENT, TorrentFile::PacketSizes{
+                                             0, 0, vm["packet-size"].as<size_t>()});
+  const auto content = TorrentFile::generate(TORRENT, sizes.namesPerSegment,
+                                             sizes.subManifestSize, sizes.dataPacketSize, false,
+                                             ThreadPool::hardwareConcurrency());
+  const auto torrentFileName = content.first.front().getFullName();
+  size_t numPackets = 0;
+  for (const auto& file : content.second) {
+    for (const auto& manifest : file.first) {
+      numPackets += manifest.catalog().size();
+    }
+  }
+
+  boost::asio::io_service io;
+  auto keyChain = std::make_shared<KeyChain>("pib-memory:", "tpm-memory:");
+  SimulatedNetwork::LinkParameters link{time::milliseconds(vm["delay"].as<size_t>()),
+                                        vm["loss"].as<double>(),
+                                        vm["bandwidth"].as<uint64_t>()};
+  SimulatedNetwork network(io, *keyChain, link, vm["seed"].as<uint32_t>());
+  util::scheduler::Scheduler scheduler(io);
+
+  std::vector<std::shared_ptr<TorrentManager>> seeders;
+  for (size_t i = 0; i < vm["seeders"].as<size_t>(); ++i) {
+    auto name = "seeder" + std::to_string(i);
+    TorrentManager::Resources resources{};
+    resources.face = network.face(network.addPeer(Name("/" + name), true));
+    resources.keyChain = keyChain;
+    resources.appDataPath = name + "/.appdata";
+    storeMetadata(resources.appDataPath + "/" + TORRENT + "/metadata", content);
+    // the files of the torrent are in the working directory
+    seeders.push_back(std::make_shared<TorrentManager>(torrentFileName, "./", true, resources));
+    seeders.back()->Initialize();
+  }
+
+  std::vector<Leecher> leechers(vm["leechers"].as<size_t>());
+  std::unordered_map<SimulatedNetwork::Id, size_t> leecherIndex;
+  for (size_t i = 0; i < leechers.size(); ++i) {
+    auto name = "leecher" + std::to_string(i);
+    auto& leecher = leechers[i];
+    leecher.id = network.addPeer(Name("/" + name), false);
+    leecher.completion = std::chrono::steady_clock::duration::zero();
+    leecherIndex[leecher.id] = i;
+    TorrentManager::Resources resources{};
+    resources.face = network.face(leecher.id);
+    resources.keyChain = keyChain;
+    resources.appDataPath = name + "/.appdata";
+    IoUtil::create_directories(name + "/data");
+    // the leechers keep seeding what they downloaded to the others
+    if ("sequential" == strategy) {
+      leecher.sequential = std::make_shared<SequentialDataFetcher>(torrentFileName, name + "/data/",
+                                                                   true, resources);
+    }
+    else {
+      leecher.rarestFirst = std::make_shared<RarestFirstDataFetcher>(torrentFileName,
+                                                                     name + "/data/", true,
+                                                                     resources);
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  size_t numComplete = 0;
+  network.setOnDataDelivered([&] (SimulatedNetwork::Id id, const Data& data) {
+    auto it = leecherIndex.find(id);
+    if (leecherIndex.end() == it || IoUtil::DATA_PACKET != IoUtil::findType(data.getName())) {
+      return;
+    }
+    auto& leecher = leechers[it->second];
+    if (leecher.received.insert(data.getFullName()).second &&
+        numPackets == leecher.received.size()) {
+      leecher.completion = std::chrono::steady_clock::now() - start;
+      if (leechers.size() == ++numComplete) {
+        io.stop();
+      }
+    }
+  });
+  scheduler.scheduleEvent(time::seconds(vm["timeout"].as<size_t>()), [&io] { io.stop(); });
+  for (auto& leecher : leechers) {
+    if (nullptr != leecher.sequential) {
+      leecher.sequential->launch();
+    }
+    else {
+      leecher.rarestFirst->launch();
+    }
+  }
+  if (leechers.empty()) {
+    io.stop();
+  }
+  io.run();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  const double torrentBytes = static_cast<double>(numFiles) * fileSize;
+  std::cout << "Torrent: " << numFiles << " files, " << numPackets << " data packets of "
+            << sizes.dataPacketSize << " bytes, " << torrentBytes / (1024 * 1024)
+            << " MiB; strategy " << strategy << std::endl;
+  std::cout << std::left << std::setw(12) << "Leecher" << std::right
+            << std::setw(14) << "Complete (s)" << std::setw(14) << "Goodput MB/s"
+            << std::setw(12) << "Packets" << std::setw(12) << "Interests"
+            << std::setw(18) << "Interests/packet" << std::endl;
+  for (size_t i = 0; i < leechers.size(); ++i) {
+    const auto& leecher = leechers[i];
+    const auto& sent = network.sent(leecher.id);
+    bool complete = std::chrono::steady_clock::duration::zero() != leecher.completion;
+    auto duration = seconds(complete ? leecher.completion : elapsed);
+    auto bytes = torrentBytes * leecher.received.size() / std::max<size_t>(numPackets, 1);
+    std::cout << std::left << std::setw(12) << ("leecher" + std::to_string(i)) << std::right
+              << std::fixed << std::setprecision(3)
+              << std::setw(14) << (complete ? std::to_string(duration) : std::string("-"))
+              << std::setw(14) << bytes / duration / 1e6
+              << std::setw(12) << leecher.received.size()
+              << std::setw(12) << sent.interests
+              << std::setw(18) << static_cast<double>(sent.interests) /
+                                  std::max<size_t>(leecher.received.size(), 1)
+              << std::endl;
+  }
+  SimulatedNetwork::Counters total{};
+  for (SimulatedNetwork::Id id = 0; id < network.size(); ++id) {
+    const auto& sent = network.sent(id);
+    total.interests += sent.interests;
+    total.data += sent.data;
+    total.dataBytes += sent.dataBytes;
+    total.nacks += sent.nacks;
+    total.lost += sent.lost;
+  }
+  std::cout << "Network: " << total.interests << " Interests, " << total.data << " Data ("
+            << total.dataBytes << " bytes), " << total.nacks << " Nacks, " << total.lost
+            << " packets lost in " << seconds(elapsed) << " s" << std::endl;
+  return numComplete == leechers.size() ? 0 : 1;
+}
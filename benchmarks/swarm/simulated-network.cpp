@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "simulated-network.hpp"
+
+#include <ndn-cxx/security/signing-helpers.hpp>
+
+#include <algorithm>
+
+namespace ndn {
+namespace ntorrent {
+namespace benchmarks {
+
+namespace {
+
+// The query of a peer for its own routable prefix
+const Name ROUTABLE_PREFIXES("/localhop/nfd/rib/routable-prefixes");
+// The commands a face sends to the local forwarder, which the dummy face answers itself
+const Name LOCALHOST("/localhost");
+
+} // namespace
+
+SimulatedNetwork::SimulatedNetwork(boost::asio::io_service& io,
+                                   KeyChain&                keyChain,
+                                   const LinkParameters&    link,
+                                   uint32_t                 seed)
+: m_io(io)
+, m_keyChain(keyChain)
+, m_scheduler(io)
+, m_link(link)
+, m_random(seed)
+, m_loss(link.lossRate)
+{
+}
+
+SimulatedNetwork::Id
+SimulatedNetwork::addPeer(const Name& routablePrefix, bool seeder)
+{
+  Id id = m_peers.size();
+  std::unique_ptr<Peer> peer(new Peer());
+  peer->face = std::make_shared<util::DummyClientFace>(m_io,
+                                                        util::DummyClientFace::Options{false, true});
+  peer->routablePrefix = routablePrefix;
+  peer->seeder = seeder;
+  peer->uplinkFree = time::steady_clock::now();
+  peer->sent = Counters();
+  peer->face->onSendInterest.connect([this, id] (const Interest& interest) {
+    onSendInterest(id, interest);
+  });
+  peer->face->onSendData.connect([this, id] (const Data& data) {
+    onSendData(id, data);
+  });
+  peer->face->onSendNack.connect([this, id] (const lp::Nack& nack) {
+    onSendNack(id, nack);
+  });
+  m_peers.push_back(std::move(peer));
+  m_prefixes[routablePrefix] = id;
+  if (seeder) {
+    m_seeders.push_back(id);
+  }
+  return id;
+}
+
+SimulatedNetwork::Id
+SimulatedNetwork::route(Id from, const Interest& interest)
+{
+  for (const auto& delegation : interest.getForwardingHint()) {
+    auto it = m_prefixes.find(delegation.name);
+    if (m_prefixes.end() != it && from != it->second) {
+      return it->second;
+    }
+  }
+  // the hint names no peer, e.g. the bootstrap prefixes, so any seeder may answer
+  std::vector<Id> candidates;
+  std::copy_if(m_seeders.begin(), m_seeders.end(), std::back_inserter(candidates),
+               [from] (Id id) { return from != id; });
+  if (candidates.empty()) {
+    return from;
+  }
+  return candidates[std::uniform_int_distribution<size_t>(0, candidates.size() - 1)(m_random)];
+}
+
+void
+SimulatedNetwork::transmit(Id from, size_t size, const std::function<void()>& deliver)
+{
+  auto& peer = *m_peers[from];
+  auto now = time::steady_clock::now();
+  // the packets leave the uplink one at a time, in the order in which they were sent
+  peer.uplinkFree = std::max(peer.uplinkFree, now);
+  if (0 < m_link.bandwidth) {
+    peer.uplinkFree += time::nanoseconds(size * 1000000000 / m_link.bandwidth);
+  }
+  if (m_loss(m_random)) {
+    ++peer.sent.lost;
+    return;
+  }
+  m_scheduler.scheduleEvent(peer.uplinkFree - now + m_link.delay, deliver);
+}
+
+void
+SimulatedNetwork::onSendInterest(Id from, const Interest& interest)
+{
+  if (LOCALHOST.isPrefixOf(interest.getName())) {
+    return;
+  }
+  auto& peer = *m_peers[from];
+  if (ROUTABLE_PREFIXES.isPrefixOf(interest.getName())) {
+    // answered by the local forwarder of the peer, without crossing the network
+    auto data = std::make_shared<Data>(interest.getName());
+    data->setContent(peer.routablePrefix.wireEncode());
+    m_keyChain.sign(*data, signingWithSha256());
+    auto face = peer.face;
+    m_io.post([face, data] { face->receive(*data); });
+    return;
+  }
+  ++peer.sent.interests;
+  Id to = route(from, interest);
+  if (to == from) {
+    return;
+  }
+  transmit(from, interest.wireEncode().size(), [this, from, to, interest] {
+    auto& requesters = m_peers[to]->pending[interest.getName()];
+    if (requesters.end() == std::find(requesters.begin(), requesters.end(), from)) {
+      requesters.push_back(from);
+    }
+    m_peers[to]->face->receive(interest);
+  });
+}
+
+void
+SimulatedNetwork::onSendData(Id from, const Data& data)
+{
+  auto& peer = *m_peers[from];
+  auto it = peer.pending.find(data.getName());
+  if (peer.pending.end() == it) {
+    it = peer.pending.find(data.getFullName());
+  }
+  if (peer.pending.end() == it) {
+    return;
+  }
+  auto requesters = std::move(it->second);
+  peer.pending.erase(it);
+  auto size = data.wireEncode().size();
+  for (auto to : requesters) {
+    ++peer.sent.data;
+    peer.sent.dataBytes += size;
+    transmit(from, size, [this, to, data] {
+      m_peers[to]->face->receive(data);
+      if (m_onDataDelivered) {
+        m_onDataDelivered(to, data);
+      }
+    });
+  }
+}
+
+void
+SimulatedNetwork::onSendNack(Id from, const lp::Nack& nack)
+{
+  auto& peer = *m_peers[from];
+  auto it = peer.pending.find(nack.getInterest().getName());
+  if (peer.pending.end() == it) {
+    return;
+  }
+  auto requesters = std::move(it->second);
+  peer.pending.erase(it);
+  for (auto to : requesters) {
+    ++peer.sent.nacks;
+    transmit(from, nack.getInterest().wireEncode().size(), [this, to, nack] {
+      m_peers[to]->face->receive(nack);
+    });
+  }
+}
+
+} // namespace benchmarks
+} // namespace ntorrent
+} // namespace ndn
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_BENCHMARKS_SWARM_SIMULATED_NETWORK_HPP
+#define INCLUDED_BENCHMARKS_SWARM_SIMULATED_NETWORK_HPP
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/interest.hpp>
+#include <ndn-cxx/lp/nack.hpp>
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/util/dummy-client-face.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+#include <ndn-cxx/util/time.hpp>
+
+#include <boost/asio/io_service.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <functional>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+namespace benchmarks {
+
+class SimulatedNetwork : boost::noncopyable {
+  /**
+   * \class SimulatedNetwork
+   *
+   * \brief An in-process network connecting the faces of a swarm of peers through a forwarder
+   *
+   * Each peer has a face and a routable prefix. The forwarder answers the query for the routable
+   * prefix of a peer. It sends each other Interest to the peer named by its forwarding hint, or to
+   * a random seeder if the hint does not name a peer. The Data and Nacks are returned to the peers
+   * whose Interests they answer.
+   *
+   * Every packet leaves a peer through its uplink, which sends one packet at a time at the uplink
+   * bandwidth. The packet then arrives after the propagation delay, unless it is lost.
+   */
+ public:
+  struct LinkParameters {
+    // The propagation delay between any two peers
+    time::milliseconds delay;
+    // The probability that a packet is lost
+    double             lossRate;
+    // The bandwidth in bytes per second of the uplink of each peer, or 0 if unlimited
+    uint64_t           bandwidth;
+  };
+
+  // The packets sent by a peer
+  struct Counters {
+    uint64_t interests;
+    uint64_t data;
+    uint64_t dataBytes;
+    uint64_t nacks;
+    uint64_t lost;
+  };
+
+  typedef size_t Id;
+  // Called with the peer that received a Data packet and that packet
+  typedef std::function<void(Id, const Data&)> OnDataDelivered;
+
+  /*
+   * @brief Create a network whose events are processed by @p io
+   * @param keyChain The key chain signing the answers to the queries of the routable prefixes
+   * @param seed The seed of the random choices of the seeders and of the lost packets
+   */
+  SimulatedNetwork(boost::asio::io_service& io,
+                   KeyChain&                keyChain,
+                   const LinkParameters&    link,
+                   uint32_t                 seed);
+
+  /*
+   * @brief Add a peer reached through @p routablePrefix and return its id
+   * @param seeder Whether the Interests that are not for a known peer may be sent to this peer
+   */
+  Id
+  addPeer(const Name& routablePrefix, bool seeder);
+
+  /*
+   * @brief Return the face of the peer @p id
+   */
+  std::shared_ptr<util::DummyClientFace>
+  face(Id id) const;
+
+  /*
+   * @brief Call @p onDataDelivered with each Data packet delivered to a peer
+   */
+  void
+  setOnDataDelivered(OnDataDelivered onDataDelivered);
+
+  /*
+   * @brief Return the number of packets sent by the peer @p id
+   */
+  const Counters&
+  sent(Id id) const;
+
+  /*
+   * @brief Return the number of peers
+   */
+  size_t
+  size() const;
+
+ private:
+  struct Peer {
+    std::shared_ptr<util::DummyClientFace>       face;
+    Name                                         routablePrefix;
+    bool                                         seeder;
+    // The time at which the uplink is done sending the packets queued so far
+    time::steady_clock::TimePoint                uplinkFree;
+    // The peers waiting for the Data answering each Interest sent to this peer, by its name
+    std::unordered_map<Name, std::vector<Id>>    pending;
+    Counters                                     sent;
+  };
+
+  void
+  onSendInterest(Id from, const Interest& interest);
+
+  void
+  onSendData(Id from, const Data& data);
+
+  void
+  onSendNack(Id from, const lp::Nack& nack);
+
+  // Return the peer that 'interest' sent by 'from' is forwarded to, or 'from' if it has none
+  Id
+  route(Id from, const Interest& interest);
+
+  // Send a packet of 'size' bytes through the uplink of 'from' and call 'deliver' once it
+  // arrives, unless it is lost
+  void
+  transmit(Id from, size_t size, const std::function<void()>& deliver);
+
+  boost::asio::io_service&                   m_io;
+  KeyChain&                                  m_keyChain;
+  util::scheduler::Scheduler                 m_scheduler;
+  LinkParameters                             m_link;
+  std::mt19937                               m_random;
+  std::bernoulli_distribution                m_loss;
+  std::vector<std::unique_ptr<Peer>>         m_peers;
+  std::unordered_map<Name, Id>               m_prefixes;
+  std::vector<Id>                            m_seeders;
+  OnDataDelivered                            m_onDataDelivered;
+};
+
+inline
+std::shared_ptr<util::DummyClientFace>
+SimulatedNetwork::face(Id id) const
+{
+  return m_peers[id]->face;
+}
+
+inline
+void
+SimulatedNetwork::setOnDataDelivered(OnDataDelivered onDataDelivered)
+{
+  m_onDataDelivered = onDataDelivered;
+}
+
+inline
+const SimulatedNetwork::Counters&
+SimulatedNetwork::sent(Id id) const
+{
+  return m_peers[id]->sent;
+}
+
+inline
+size_t
+SimulatedNetwork::size() const
+{
+  return m_peers.size();
+}
+
+} // namespace benchmarks
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_BENCHMARKS_SWARM_SIMULATED_NETWORK_HPP
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_BENCHMARKS_TEMPORARY_DIRECTORY_HPP
+#define INCLUDED_BENCHMARKS_TEMPORARY_DIRECTORY_HPP
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+namespace benchmarks {
+
+class TemporaryDirectory : boost::noncopyable {
+  /**
+   * \class TemporaryDirectory
+   *
+   * \brief A uniquely named directory holding the files of a benchmark, removed once destroyed
+   */
+ public:
+  TemporaryDirectory();
+
+  ~TemporaryDirectory();
+
+  /*
+   * @brief Create the file @p name of @p size random bytes in this directory and return its path
+   */
+  std::string
+  createFile(const std::string& name, size_t size);
+
+  /*
+   * @brief Return the path of this directory
+   */
+  const boost::filesystem::path&
+  path() const;
+
+ private:
+  boost::filesystem::path m_path;
+};
+
+inline
+TemporaryDirectory::TemporaryDirectory()
+: m_path(boost::filesystem::temp_directory_path() /
+         boost::filesystem::unique_path("ntorrent-benchmark-%%%%-%%%%-%%%%"))
+{
+  boost::filesystem::create_directories(m_path);
+}
+
+inline
+TemporaryDirectory::~TemporaryDirectory()
+{
+  boost::system::error_code ec;
+  boost::filesystem::remove_all(m_path, ec);
+}
+
+inline std::string
+TemporaryDirectory::createFile(const std::string& name, size_t size)
+{
+  auto filePath = m_path / name;
+  boost::filesystem::create_directories(filePath.parent_path());
+  // the same content on every run, so that the runs are comparable
+  std::mt19937 random(static_cast<uint32_t>(std::hash<std::string>()(name) + size));
+  std::vector<char> content(size);
+  for (auto& c : content) {
+    c = static_cast<char>(random());
+  }
+  boost::filesystem::ofstream os(filePath, std::ios::binary);
+  os.write(content.data(), content.size());
+  return filePath.string();
+}
+
+inline const boost::filesystem::path&
+TemporaryDirectory::path() const
+{
+  return m_path;
+}
+
+} // namespace benchmarks
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_BENCHMARKS_TEMPORARY_DIRECTORY_HPP
@@ -0,0 +1,58 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "benchmark.hpp"
+#include "temporary-directory.hpp"
+
+#include "torrent-file.hpp"
+
+using ndn::ntorrent::benchmarks::TemporaryDirectory;
+using ndn::ntorrent::benchmarks::doNotOptimize;
+
+namespace ndn {
+namespace ntorrent {
+namespace {
+
+enum {
+  NUM_FILES = 64,
+  FILE_SIZE = 64 * 1024
+};
+
+} // namespace
+
+// Generate the torrent of NUM_FILES files with the given number of threads
+NTORRENT_BENCHMARK(TorrentFileGenerate, 1, 2, 4)
+{
+  TemporaryDirectory directory;
+  auto torrentPath = directory.path() / "torrent";
+  for (size_t i = 0; i < NUM_FILES; ++i) {
+    directory.createFile("torrent/" + std::to_string(i), FILE_SIZE);
+  }
+  state.setBytesPerIteration(NUM_FILES * FILE_SIZE);
+  while (state.keepRunning()) {
+    auto torrent = TorrentFile::generate(torrentPath.string(), 1024, 1024, 1024, false,
+                                         state.arg());
+    doNotOptimize(torrent);
+  }
+}
+
+} // namespace ntorrent
+} // namespace ndn
@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "benchmark.hpp"
+#include "temporary-directory.hpp"
+
+#include "metadata-store.hpp"
+#include "torrent-file.hpp"
+#include "torrent-manager.hpp"
+#include "util/thread-pool.hpp"
+
+#include <boost/asio/io_service.hpp>
+
+#include <ndn-cxx/util/dummy-client-face.hpp>
+
+#include <memory>
+#include <stdexcept>
+
+using ndn::ntorrent::benchmarks::TemporaryDirectory;
+using ndn::ntorrent::benchmarks::doNotOptimize;
+
+namespace ndn {
+namespace ntorrent {
+namespace {
+
+enum {
+  // The number of files of the torrent, each a single data packet
+  NUM_FILES = 10000,
+  FILE_SIZE = 1024
+};
+
+class ManagerFixture : boost::noncopyable {
+  /**
+   * \class ManagerFixture
+   *
+   * \brief A manager of a torrent of NUM_FILES files, none of which has been downloaded
+   *
+   * The torrent is generated in a temporary directory, which is the working directory of the
+   * process from then on, as the manager stores its metadata relative to it.
+   */
+ public:
+  static ManagerFixture&
+  get();
+
+  TorrentManager&
+  manager();
+
+  // The names of all the data packets of the torrent
+  const std::vector<Name>&
+  packetNames() const;
+
+ private:
+  ManagerFixture();
+
+  TemporaryDirectory                      m_directory;
+  boost::asio::io_service                 m_io;
+  std::shared_ptr<util::DummyClientFace>  m_face;
+  std::unique_ptr<TorrentManager>         m_manager;
+  std::vector<Name>                       m_packetNames;
+};
+
+ManagerFixture::ManagerFixture()
+: m_face(std::make_shared<util::DummyClientFace>(m_io, util::DummyClientFace::Options{true, true}))
+{
+  boost::filesystem::current_path(m_directory.path());
+  for (size_t i = 0; i < NUM_FILES; ++i) {
+    m_directory.createFile("benchmark/" + std::to_string(i), FILE_SIZE);
+  }
+  auto content = TorrentFile::generate("benchmark", 1024, 1024, FILE_SIZE, false,
+                                       ThreadPool::hardwareConcurrency());
+  MetadataStore store;
+  boost::filesystem::create_directories(".appdata/benchmark");
+  if (!store.open(".appdata/benchmark/metadata")) {
+    throw std::runtime_error("Cannot open the metadata store");
+  }
+  for (const auto& segment : content.first) {
+    store.insert(segment);
+  }
+  for (const auto& file : content.second) {
+    for (const auto& manifest : file.first) {
+      store.insert(manifest);
+    }
+  }
+  store.flush();
+  // the data path is empty, so all the packets are missing
+  boost::filesystem::create_directories("empty");
+  m_manager.reset(new TorrentManager(content.first.front().getFullName(), "empty/", false,
+                                     m_face));
+  m_manager->Initialize();
+  m_manager->findAllMissingDataPackets(m_packetNames);
+}
+
+ManagerFixture&
+ManagerFixture::get()
+{
+  static ManagerFixture fixture;
+  return fixture;
+}
+
+TorrentManager&
+ManagerFixture::manager()
+{
+  return *m_manager;
+}
+
+const std::vector<Name>&
+ManagerFixture::packetNames() const
+{
+  return m_packetNames;
+}
+
+} // namespace
+
+NTORRENT_BENCHMARK(TorrentManagerHasDataPacket)
+{
+  auto& fixture = ManagerFixture::get();
+  const auto& names = fixture.packetNames();
+  size_t i = 0;
+  while (state.keepRunning()) {
+    doNotOptimize(fixture.manager().hasDataPacket(names[i]));
+    i = (i + 1) % names.size();
+  }
+}
+
+NTORRENT_BENCHMARK(TorrentManagerFindAllMissingDataPackets)
+{
+  auto& fixture = ManagerFixture::get();
+  while (state.keepRunning()) {
+    std::vector<Name> names;
+    fixture.manager().findAllMissingDataPackets(names);
+    doNotOptimize(names);
+  }
+}
+
+NTORRENT_BENCHMARK(TorrentManagerFindAllMissingDataPacketHandles)
+{
+  auto& fixture = ManagerFixture::get();
+  while (state.keepRunning()) {
+    std::vector<TorrentManager::PacketHandle> packets;
+    fixture.manager().findAllMissingDataPackets(packets);
+    doNotOptimize(packets);
+  }
+}
+
+} // namespace ntorrent
+} // namespace ndn
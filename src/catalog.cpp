@@ -0,0 +1,209 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "catalog.hpp"
+
+#include <ndn-cxx/util/sha256.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/throw_exception.hpp>
+
+namespace ndn {
+namespace ntorrent {
+
+Catalog::Catalog(const Name& prefix, const std::vector<Name>& names)
+: m_prefix(prefix)
+{
+  reserve(names.size());
+  for (const auto& name : names) {
+    push_back(name);
+  }
+}
+
+Name
+Catalog::operator[](size_t position) const
+{
+  auto begin = suffixBegin(position);
+  Name name(m_prefix);
+  name.append(Name(makeBinaryBlock(tlv::Name,
+                                   m_suffixes.data() + begin,
+                                   m_ends[position] - begin)));
+  return name;
+}
+
+size_t
+Catalog::find(const Name& name) const
+{
+  if (name.size() <= m_prefix.size() || !m_prefix.isPrefixOf(name)) {
+    return size();
+  }
+  std::vector<uint8_t> suffix;
+  encodeSuffix(name, suffix);
+  for (size_t i = 0; i < size(); ++i) {
+    auto begin = suffixBegin(i);
+    if (m_ends[i] - begin == suffix.size() &&
+        0 == std::memcmp(m_suffixes.data() + begin, suffix.data(), suffix.size())) {
+      return i;
+    }
+  }
+  return size();
+}
+
+void
+Catalog::push_back(const Name& name)
+{
+  if (!m_prefix.isPrefixOf(name)) {
+    BOOST_THROW_EXCEPTION(Error(name.toUri() + " does not have the prefix " + m_prefix.toUri()));
+  }
+  if (name.size() == m_prefix.size()) {
+    BOOST_THROW_EXCEPTION(Error("Catalog cannot include its prefix"));
+  }
+  encodeSuffix(name, m_suffixes);
+  m_ends.push_back(m_suffixes.size());
+}
+
+void
+Catalog::push_back_suffix(const Block& suffix)
+{
+  if (tlv::Name != suffix.type() || 0 == suffix.value_size()) {
+    BOOST_THROW_EXCEPTION(Error("Catalog cannot include an empty suffix"));
+  }
+  // the components are checked here, so that a malformed suffix is not accepted only to fail
+  // when the name is accessed
+  try {
+    suffix.parse();
+  }
+  catch (const tlv::Error& e) {
+    BOOST_THROW_EXCEPTION(Error(std::string("Catalog cannot include a malformed suffix: ") +
+                                e.what()));
+  }
+  for (const auto& component : suffix.elements()) {
+    if (0 == component.type() || 0xFFFF < component.type() ||
+        (tlv::ImplicitSha256DigestComponent == component.type() &&
+         util::Sha256::DIGEST_SIZE != component.value_size())) {
+      BOOST_THROW_EXCEPTION(Error("Catalog cannot include a suffix with an element of type " +
+                                  std::to_string(component.type()) +
+                                  " that is not a name component"));
+    }
+  }
+  m_suffixes.insert(m_suffixes.end(), suffix.value_begin(), suffix.value_end());
+  m_ends.push_back(m_suffixes.size());
+}
+
+bool
+Catalog::remove(const Name& name)
+{
+  auto position = find(name);
+  if (size() == position) {
+    return false;
+  }
+  auto begin = suffixBegin(position);
+  auto length = m_ends[position] - begin;
+  m_suffixes.erase(m_suffixes.begin() + begin, m_suffixes.begin() + m_ends[position]);
+  m_ends.erase(m_ends.begin() + position);
+  for (auto it = m_ends.begin() + position; it != m_ends.end(); ++it) {
+    *it -= length;
+  }
+  return true;
+}
+
+void
+Catalog::reserve(size_t capacity)
+{
+  m_ends.reserve(capacity);
+}
+
+void
+Catalog::shrink_to_fit()
+{
+  m_suffixes.shrink_to_fit();
+  m_ends.shrink_to_fit();
+}
+
+void
+Catalog::clear()
+{
+  m_suffixes.clear();
+  m_ends.clear();
+}
+
+void
+Catalog::encodeSuffix(const Name& name, std::vector<uint8_t>& suffix) const
+{
+  for (size_t i = m_prefix.size(); i < name.size(); ++i) {
+    const Block& component = name.get(i).wireEncode();
+    suffix.insert(suffix.end(), component.wire(), component.wire() + component.size());
+  }
+}
+
+bool
+operator==(const Catalog& lhs, const Catalog& rhs)
+{
+  if (lhs.m_prefix == rhs.m_prefix) {
+    return lhs.m_ends == rhs.m_ends && lhs.m_suffixes == rhs.m_suffixes;
+  }
+  return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+bool
+operator!=(const Catalog& lhs, const Catalog& rhs)
+{
+  return !(lhs == rhs);
+}
+
+bool
+operator==(const Catalog& catalog, const std::vector<Name>& names)
+{
+  return catalog.size() == names.size() && std::equal(names.begin(), names.end(), catalog.begin());
+}
+
+bool
+operator==(const std::vector<Name>& names, const Catalog& catalog)
+{
+  return catalog == names;
+}
+
+bool
+operator!=(const Catalog& catalog, const std::vector<Name>& names)
+{
+  return !(catalog == names);
+}
+
+bool
+operator!=(const std::vector<Name>& names, const Catalog& catalog)
+{
+  return !(catalog == names);
+}
+
+std::ostream&
+operator<<(std::ostream& os, const Catalog& catalog)
+{
+  os << "[";
+  for (size_t i = 0; i < catalog.size(); ++i) {
+    os << (0 == i ? "" : ", ") << catalog[i];
+  }
+  return os << "]";
+}
+
+} // namespace ntorrent
+} // namespace ndn
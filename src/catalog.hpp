@@ -0,0 +1,326 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_CATALOG_HPP
+#define INCLUDED_CATALOG_HPP
+
+#include <ndn-cxx/encoding/block.hpp>
+#include <ndn-cxx/encoding/encoding-buffer.hpp>
+#include <ndn-cxx/name.hpp>
+
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+
+/**
+ * @brief A compact, ordered collection of names sharing a common prefix
+ *
+ * The prefix is stored once and the components following it are kept back to back in a single
+ * buffer, so each name costs the wire encoding of its suffix plus an offset. Names are only built
+ * when they are accessed, which is why access returns them by value.
+ */
+class Catalog
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  class const_iterator : public boost::iterator_facade<const_iterator,
+                                                       const Name,
+                                                       std::random_access_iterator_tag,
+                                                       Name>
+  {
+  public:
+    const_iterator() = default;
+
+    const_iterator(const Catalog* catalog, size_t position);
+
+  private:
+    friend class boost::iterator_core_access;
+
+    Name
+    dereference() const;
+
+    bool
+    equal(const const_iterator& other) const;
+
+    void
+    increment();
+
+    void
+    decrement();
+
+    void
+    advance(std::ptrdiff_t n);
+
+    std::ptrdiff_t
+    distance_to(const const_iterator& other) const;
+
+    const Catalog* m_catalog = nullptr;
+    size_t         m_position = 0;
+  };
+
+  Catalog() = default;
+
+  /**
+   * @brief Create an empty catalog of names starting with @p prefix
+   */
+  explicit
+  Catalog(const Name& prefix);
+
+  /**
+   * @brief Create a catalog of the specified @p names starting with @p prefix
+   * @throws Error if any of @p names does not have @p prefix or is equal to it
+   */
+  Catalog(const Name& prefix, const std::vector<Name>& names);
+
+  const Name&
+  prefix() const;
+
+  size_t
+  size() const;
+
+  bool
+  empty() const;
+
+  /**
+   * @brief Return the number of bytes allocated for the names, not counting the prefix
+   */
+  size_t
+  bytes() const;
+
+  /**
+   * @brief Return the name at @p position, which must be less than size()
+   */
+  Name
+  operator[](size_t position) const;
+
+  const_iterator
+  begin() const;
+
+  const_iterator
+  end() const;
+
+  /**
+   * @brief Return the position of the first occurrence of @p name, or size() if it is not included
+   */
+  size_t
+  find(const Name& name) const;
+
+  /**
+   * @brief Append @p name to the catalog
+   * @throws Error if @p name does not have the prefix of the catalog or is equal to it
+   */
+  void
+  push_back(const Name& name);
+
+  /**
+   * @brief Append the name made of the prefix of the catalog and the components of @p suffix, the
+   *        wire encoding of a non-empty Name, without building a name from them
+   * @throws Error if @p suffix is not a non-empty Name made of valid name components
+   */
+  void
+  push_back_suffix(const Block& suffix);
+
+  /**
+   * @brief Remove the first occurrence of @p name; return false if it is not included
+   */
+  bool
+  remove(const Name& name);
+
+  /**
+   * @brief Reserve memory for @p capacity names
+   */
+  void
+  reserve(size_t capacity);
+
+  void
+  shrink_to_fit();
+
+  void
+  clear();
+
+  /**
+   * @brief Prepend the suffix of the name at @p position to @p encoder as a Name
+   */
+  template<encoding::Tag TAG>
+  size_t
+  prependSuffix(EncodingImpl<TAG>& encoder, size_t position) const;
+
+private:
+  friend bool
+  operator==(const Catalog& lhs, const Catalog& rhs);
+
+  size_t
+  suffixBegin(size_t position) const;
+
+  // Append the wire encoding of the components of 'name' following the prefix to 'suffix'
+  void
+  encodeSuffix(const Name& name, std::vector<uint8_t>& suffix) const;
+
+  Name                  m_prefix;
+  // The wire encodings of the components of all the suffixes, back to back
+  std::vector<uint8_t>  m_suffixes;
+  // The end of each suffix in 'm_suffixes'
+  std::vector<uint32_t> m_ends;
+};
+
+bool
+operator==(const Catalog& lhs, const Catalog& rhs);
+
+bool
+operator!=(const Catalog& lhs, const Catalog& rhs);
+
+/// Return 'true' if 'catalog' holds the specified 'names' in the same order
+bool
+operator==(const Catalog& catalog, const std::vector<Name>& names);
+
+bool
+operator==(const std::vector<Name>& names, const Catalog& catalog);
+
+bool
+operator!=(const Catalog& catalog, const std::vector<Name>& names);
+
+bool
+operator!=(const std::vector<Name>& names, const Catalog& catalog);
+
+std::ostream&
+operator<<(std::ostream& os, const Catalog& catalog);
+
+inline
+Catalog::const_iterator::const_iterator(const Catalog* catalog, size_t position)
+: m_catalog(catalog)
+, m_position(position)
+{
+}
+
+inline Name
+Catalog::const_iterator::dereference() const
+{
+  return (*m_catalog)[m_position];
+}
+
+inline bool
+Catalog::const_iterator::equal(const const_iterator& other) const
+{
+  return m_catalog == other.m_catalog && m_position == other.m_position;
+}
+
+inline void
+Catalog::const_iterator::increment()
+{
+  ++m_position;
+}
+
+inline void
+Catalog::const_iterator::decrement()
+{
+  --m_position;
+}
+
+inline void
+Catalog::const_iterator::advance(std::ptrdiff_t n)
+{
+  m_position += n;
+}
+
+inline std::ptrdiff_t
+Catalog::const_iterator::distance_to(const const_iterator& other) const
+{
+  return static_cast<std::ptrdiff_t>(other.m_position) - static_cast<std::ptrdiff_t>(m_position);
+}
+
+inline
+Catalog::Catalog(const Name& prefix)
+: m_prefix(prefix)
+{
+}
+
+inline const Name&
+Catalog::prefix() const
+{
+  return m_prefix;
+}
+
+inline size_t
+Catalog::size() const
+{
+  return m_ends.size();
+}
+
+inline bool
+Catalog::empty() const
+{
+  return m_ends.empty();
+}
+
+inline size_t
+Catalog::bytes() const
+{
+  return m_suffixes.capacity() + m_ends.capacity() * sizeof(uint32_t);
+}
+
+inline Catalog::const_iterator
+Catalog::begin() const
+{
+  return const_iterator(this, 0);
+}
+
+inline Catalog::const_iterator
+Catalog::end() const
+{
+  return const_iterator(this, size());
+}
+
+inline size_t
+Catalog::suffixBegin(size_t position) const
+{
+  return 0 == position ? 0 : m_ends[position - 1];
+}
+
+template<encoding::Tag TAG>
+size_t
+Catalog::prependSuffix(EncodingImpl<TAG>& encoder, size_t position) const
+{
+  auto begin = suffixBegin(position);
+  return encoder.prependByteArrayBlock(tlv::Name,
+                                       m_suffixes.data() + begin,
+                                       m_ends[position] - begin);
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_CATALOG_HPP
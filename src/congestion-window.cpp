@@ -0,0 +1,63 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "congestion-window.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+namespace ntorrent {
+
+CongestionWindow::CongestionWindow(double initialWindow)
+: m_window(std::max<double>(initialWindow, MIN_WINDOW))
+, m_threshold(MAX_WINDOW)
+, m_lastDecrease(time::steady_clock::TimePoint::min())
+{
+}
+
+void
+CongestionWindow::increase()
+{
+  if (m_window < m_threshold) {
+    // slow start
+    m_window += 1;
+  }
+  else {
+    // congestion avoidance
+    m_window += 1 / m_window;
+  }
+  m_window = std::min<double>(m_window, MAX_WINDOW);
+}
+
+bool
+CongestionWindow::decrease(const time::steady_clock::TimePoint& now, const time::nanoseconds& rtt)
+{
+  if (m_lastDecrease != time::steady_clock::TimePoint::min() && now < m_lastDecrease + rtt) {
+    return false;
+  }
+  m_lastDecrease = now;
+  m_threshold = std::max<double>(m_window / 2, MIN_WINDOW);
+  m_window = m_threshold;
+  return true;
+}
+
+} // namespace ntorrent
+} // namespace ndn
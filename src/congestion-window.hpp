@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_CONGESTION_WINDOW_HPP
+#define INCLUDED_CONGESTION_WINDOW_HPP
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <cstddef>
+
+namespace ndn {
+namespace ntorrent {
+
+/**
+ * @brief An AIMD congestion window bounding the number of Interests in flight
+ *
+ * The window grows by one Interest per Data packet in slow start, and by one Interest per window
+ * of Data packets in congestion avoidance. A timeout or a congestion Nack halves the window, at
+ * most once per round-trip time, so that the losses of a single congestion event count only once.
+ */
+class CongestionWindow
+{
+public:
+  enum {
+    // Number of Interests that may be in flight before any Data is received
+    INITIAL_WINDOW = 4,
+    // Lower bound on the window
+    MIN_WINDOW = 1,
+    // Upper bound on the window
+    MAX_WINDOW = 1 << 16
+  };
+
+  explicit
+  CongestionWindow(double initialWindow = INITIAL_WINDOW);
+
+  /**
+   * @brief Return the number of Interests that may currently be in flight
+   */
+  size_t
+  size() const;
+
+  /**
+   * @brief Return the exact window
+   */
+  double
+  getWindow() const;
+
+  /**
+   * @brief Return the slow start threshold
+   */
+  double
+  getThreshold() const;
+
+  /**
+   * @brief Grow the window after a Data packet was received
+   */
+  void
+  increase();
+
+  /**
+   * @brief Shrink the window after a timeout or a congestion Nack at time @p now
+   * @param rtt The current estimate of the round-trip time
+   * @return True if the window was shrunk, false if it was already shrunk within the last @p rtt
+   */
+  bool
+  decrease(const time::steady_clock::TimePoint& now, const time::nanoseconds& rtt);
+
+private:
+  double                          m_window;
+  double                          m_threshold;
+  time::steady_clock::TimePoint   m_lastDecrease;
+};
+
+inline size_t
+CongestionWindow::size() const
+{
+  return static_cast<size_t>(m_window);
+}
+
+inline double
+CongestionWindow::getWindow() const
+{
+  return m_window;
+}
+
+inline double
+CongestionWindow::getThreshold() const
+{
+  return m_threshold;
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_CONGESTION_WINDOW_HPP
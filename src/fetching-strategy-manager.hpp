@@ -48,6 +48,13 @@ class FetchingStrategyManager {
     virtual void
     start(const time::milliseconds& timeout = time::milliseconds::zero()) = 0;
 
+    /**
+     * @brief Method called to start the torrent downloading on a face whose events are processed
+     *        by the caller
+     */
+    virtual void
+    launch() = 0;
+
     /**
      * @brief Method called to pause the torrent downloading
      */
@@ -20,19 +20,18 @@
 */
 #include "file-manifest.hpp"
 
+#include "util/digest-signer.hpp"
 #include "util/io-util.hpp"
 #include "util/shared-constants.hpp"
 
+#include <algorithm>
 #include <limits>
 
 #include <boost/assert.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
-#include <boost/range/adaptors.hpp>
 #include <boost/range/irange.hpp>
 #include <boost/throw_exception.hpp>
-#include <ndn-cxx/security/key-chain.hpp>
-#include <ndn-cxx/security/signing-helpers.hpp>
 
 #include <ndn-cxx/encoding/tlv.hpp>
 
@@ -74,12 +73,37 @@ get_name_of_manifest(const std::string& filePath, const Name& manifestPrefix)
 }
 
 // CLASS METHODS
+Name
+FileManifest::manifest_name(const std::string& filePath, const Name& manifestPrefix)
+{
+  return get_name_of_manifest(filePath, manifestPrefix);
+}
+
 std::pair<std::vector<FileManifest>, std::vector<Data>>
 FileManifest::generate(const std::string& filePath,
                        const Name&        manifestPrefix,
                        size_t             subManifestSize,
                        size_t             dataPacketSize,
                        bool               returnData)
+{
+  auto manifests = create_submanifests(filePath, manifestPrefix, subManifestSize, dataPacketSize);
+  std::vector<Data> allPackets;
+  if (returnData) {
+    allPackets.reserve(manifests.size() * subManifestSize);
+  }
+  for (auto& m : manifests) {
+    m.fill_catalog(filePath, subManifestSize, returnData ? &allPackets : nullptr);
+  }
+  allPackets.shrink_to_fit();
+  link_submanifests(manifests);
+  return {manifests, allPackets};
+}
+
+std::vector<FileManifest>
+FileManifest::create_submanifests(const std::string& filePath,
+                                  const Name&        manifestPrefix,
+                                  size_t             subManifestSize,
+                                  size_t             dataPacketSize)
 {
   BOOST_ASSERT(0 < subManifestSize);
   BOOST_ASSERT(0 < dataPacketSize);
@@ -94,45 +118,55 @@ FileManifest::generate(const std::string& filePath,
                               !!(file_length % (subManifestSize * dataPacketSize));
   // Find the prefix for the Catalog
   auto manifestName = get_name_of_manifest(filePath, manifestPrefix);
-  std::vector<Data> allPackets;
-  if (returnData) {
-    allPackets.reserve(numSubManifests * subManifestSize);
-  }
   manifests.reserve(numSubManifests);
   for (auto subManifestNum : irange<size_t>(0, numSubManifests)) {
     auto curr_manifest_name = manifestName;
     // append the packet number
-    curr_manifest_name.appendSequenceNumber(manifests.size());
-    FileManifest curr_manifest(curr_manifest_name, dataPacketSize, manifestPrefix);
-    auto packets = IoUtil::packetize_file(path,
-                                          curr_manifest_name,
-                                          dataPacketSize,
-                                          subManifestSize,
-                                          subManifestNum);
-    if (returnData) {
-      allPackets.insert(allPackets.end(), packets.begin(), packets.end());
-    }
-    curr_manifest.reserve(packets.size());
-    // Collect all the Data packets into the sub-manifests
-    for (const auto& p: packets) {
-      curr_manifest.push_back(p.getFullName());
-    }
-    // append the last manifest
-    manifests.push_back(curr_manifest);
+    curr_manifest_name.appendSequenceNumber(subManifestNum);
+    manifests.emplace_back(curr_manifest_name, dataPacketSize, manifestPrefix);
+  }
+  return manifests;
+}
+
+void
+FileManifest::fill_catalog(const std::string& filePath,
+                           size_t             subManifestSize,
+                           std::vector<Data>* packets)
+{
+  auto subManifestNum = submanifest_number();
+  size_t file_length = Io::file_size(filePath);
+  auto remaining_length = file_length - subManifestNum * subManifestSize * m_dataPacketSize;
+  reserve(std::min(subManifestSize, remaining_length / m_dataPacketSize +
+                                    !!(remaining_length % m_dataPacketSize)));
+  // Collect the names of the Data packets into the sub-manifest, one packet at a time
+  IoUtil::packetize_file(filePath,
+                         name(),
+                         m_dataPacketSize,
+                         subManifestSize,
+                         subManifestNum,
+                         [this, packets](const Data& p, const Name& fullName) {
+                           push_back(fullName);
+                           if (nullptr != packets) {
+                             packets->push_back(p);
+                           }
+                         });
+}
+
+void
+FileManifest::link_submanifests(std::vector<FileManifest>& manifests)
+{
+  if (manifests.empty()) {
+    return;
   }
-  allPackets.shrink_to_fit();
-  manifests.shrink_to_fit();
   // Set all the submanifest_ptrs and sign all the manifests
-  security::KeyChain key_chain;
   manifests.back().finalize();
-  key_chain.sign(manifests.back(), signingWithSha256());
+  DigestSigner::sign(manifests.back());
   for (auto it = manifests.rbegin() + 1; it != manifests.rend(); ++it) {
     auto next = it - 1;
     it->set_submanifest_ptr(std::make_shared<Name>(next->getFullName()));
     it->finalize();
-    key_chain.sign(*it, signingWithSha256());
+    DigestSigner::sign(*it);
   }
-  return {manifests, allPackets};
 }
 
 void
@@ -165,26 +199,12 @@ FileManifest::encodeContent(ndn::EncodingImpl<TAG>& encoder) const {
 
   size_t totalLength = 0;
 
-  // build suffix catalog
-  vector<Name> suffixCatalog;
-  suffixCatalog.reserve(m_catalog.size());
-  for (auto name: m_catalog) {
-    if (!m_catalogPrefix.isPrefixOf(name)) {
-      BOOST_THROW_EXCEPTION(Error(name.toUri() + " does not have the prefix "
-                                               + m_catalogPrefix.toUri()));
-    }
-    name = name.getSubName(m_catalogPrefix.size());
-    if (name.empty()) {
-      BOOST_THROW_EXCEPTION(Error("Manifest cannot include empty string"));
-    }
-    suffixCatalog.push_back(name);
+  // the catalog holds the suffixes already encoded, and only accepts names with its prefix
+  for (size_t i = m_catalog.size(); i > 0; --i) {
+    totalLength += m_catalog.prependSuffix(encoder, i - 1);
   }
 
-  for (const auto& name : suffixCatalog |  boost::adaptors::reversed) {
-    totalLength += name.wireEncode(encoder);
-  }
-
-  totalLength += m_catalogPrefix.wireEncode(encoder);
+  totalLength += m_catalog.prefix().wireEncode(encoder);
 
   totalLength += prependNonNegativeIntegerBlock(encoder, tlv::Content, m_dataPacketSize);
 
@@ -202,19 +222,14 @@ FileManifest::encodeContent(ndn::EncodingImpl<TAG>& encoder) const {
 void
 FileManifest::push_back(const Name& name)
 {
-  BOOST_ASSERT(name != m_catalogPrefix);
-  BOOST_ASSERT(m_catalogPrefix.isPrefixOf(name));
-  m_catalog.push_back(name.toUri());
+  BOOST_ASSERT(name != m_catalog.prefix());
+  BOOST_ASSERT(m_catalog.prefix().isPrefixOf(name));
+  m_catalog.push_back(name);
 }
 
 bool
 FileManifest::remove(const ndn::Name& name) {
-  const auto it = std::find(m_catalog.begin(), m_catalog.end(), name);
-  if (m_catalog.end() == it) {
-    return false;
-  }
-  m_catalog.erase(it);
-  return true;
+  return m_catalog.remove(name);
 }
 
 void
@@ -291,18 +306,21 @@ FileManifest::decodeContent() {
   m_dataPacketSize = readNonNegativeInteger(*element);
   ++element;
   // CatalogPrefix
-  m_catalogPrefix = Name(*element);
+  m_catalog = Catalog(Name(*element));
   ++element;
-  // Catalog
-  m_catalog.clear();
+  // Catalog: the suffixes are kept as encoded, without building a name for each of them
+  m_catalog.reserve(std::distance(element, content.elements_end()));
   for (; element != content.elements_end(); ++element) {
-    element->parse();
-    Name name = m_catalogPrefix;
-    name.append(Name(*element));
-    if (name == m_catalogPrefix) {
+    if (element->type() != tlv::Name || 0 == element->value_size()) {
       BOOST_THROW_EXCEPTION(Error("Empty name included in a FileManifest"));
     }
-    push_back(name);
+    try {
+      m_catalog.push_back_suffix(*element);
+    }
+    catch (const Catalog::Error& e) {
+      BOOST_THROW_EXCEPTION(Error(std::string("Malformed name included in a FileManifest: ") +
+                                  e.what()));
+    }
   }
 }
 
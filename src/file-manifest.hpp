@@ -30,6 +30,7 @@
 #include <ndn-cxx/data.hpp>
 #include <ndn-cxx/name.hpp>
 
+#include "catalog.hpp"
 #include "util/shared-constants.hpp"
 
 namespace ndn {
@@ -73,6 +74,27 @@ class FileManifest : public Data {
   static
   Name
   manifestPrefix(const Name& manifestName);
+
+  static std::vector<FileManifest>
+  create_submanifests(const std::string& filePath,
+                      const ndn::Name&   manifestPrefix,
+                      size_t             subManifestSize,
+                      size_t             dataPacketSize);
+  /// Returns the empty, unsigned sub-manifests of the file at the specified 'filePath', one per
+  /// 'subManifestSize' Data packets of 'dataPacketSize' bytes. Each must be populated with
+  /// 'fill_catalog' and all of them then signed with 'link_submanifests'. Together these perform
+  /// the same steps as 'generate', but let the sub-manifests be populated concurrently.
+
+  static Name
+  manifest_name(const std::string& filePath, const ndn::Name& manifestPrefix);
+  /// Returns the name of the manifests of the file at the specified 'filePath', to which the
+  /// sequence number of each sub-manifest is appended.
+  /// @throws Error if no component of 'filePath' matches the last component of 'manifestPrefix'.
+
+  static void
+  link_submanifests(std::vector<FileManifest>& manifests);
+  /// Sets the 'submanifest_ptr' of each of the specified 'manifests' of a single file to the next
+  /// one and signs them all, starting from the last.
   /**
    * \brief Generates the FileManifest(s) and Data packets for the file at the specified 'filePath'
    *
@@ -159,9 +181,10 @@ class FileManifest : public Data {
   submanifest_ptr() const;
   /// Returns the 'submanifest_ptr' of this FileManifest, or 'nullptr' is none exists
 
-  const std::vector<Name>&
+  const Catalog&
   catalog() const;
-  /// Returns an unmodifiable reference to the 'catalog' of this FileManifest
+  /// Returns an unmodifiable reference to the 'catalog' of this FileManifest, whose names are built
+  /// as they are accessed
 
  private:
   template<encoding::Tag TAG>
@@ -191,6 +214,13 @@ class FileManifest : public Data {
   remove(const Name& name);
   /// If 'name' in catalog, removes first instance and returns 'true', otherwise returns 'false'.
 
+  void
+  fill_catalog(const std::string& filePath,
+               size_t             subManifestSize,
+               std::vector<Data>* packets = nullptr);
+  /// Packetizes the part of the file at 'filePath' covered by this sub-manifest and appends the
+  /// packet names to the catalog (and the packets to 'packets', if specified).
+
   void
   wireDecode(const Block& wire);
   /**
@@ -221,8 +251,7 @@ private:
 // DATA
  private:
   size_t                 m_dataPacketSize;
-  Name                   m_catalogPrefix;
-  std::vector<Name>      m_catalog;
+  Catalog                m_catalog;
   std::shared_ptr<Name>  m_submanifestPtr;
 };
 
@@ -258,8 +287,7 @@ FileManifest::FileManifest(
                std::shared_ptr<Name>    subManifestPtr)
 : Data(name)
 , m_dataPacketSize(dataPacketSize)
-, m_catalogPrefix(catalogPrefix)
-, m_catalog(catalog)
+, m_catalog(catalogPrefix, catalog)
 , m_submanifestPtr(subManifestPtr)
 {
 }
@@ -274,8 +302,7 @@ FileManifest::FileManifest(
                std::shared_ptr<Name> subManifestPtr)
 : Data(name)
 , m_dataPacketSize(dataPacketSize)
-, m_catalogPrefix(catalogPrefix)
-, m_catalog(catalog)
+, m_catalog(catalogPrefix, catalog)
 , m_submanifestPtr(subManifestPtr)
 {
 }
@@ -284,7 +311,6 @@ inline
 FileManifest::FileManifest(const Block& block)
 : Data()
 , m_dataPacketSize(0)
-, m_catalogPrefix("")
 , m_catalog()
 , m_submanifestPtr(nullptr)
 {
@@ -306,10 +332,10 @@ FileManifest::data_packet_size() const
 inline const Name&
 FileManifest::catalog_prefix() const
 {
-  return m_catalogPrefix;
+  return m_catalog.prefix();
 }
 
-inline const std::vector<Name>&
+inline const Catalog&
 FileManifest::catalog() const
 {
   return m_catalog;
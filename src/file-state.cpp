@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "file-state.hpp"
+
+namespace ndn {
+namespace ntorrent {
+
+FileState::FileState(size_t numPackets)
+: m_words((numPackets + WORD_BITS - 1) / WORD_BITS, 0)
+, m_size(numPackets)
+, m_missing(numPackets)
+{
+}
+
+FileState::FileState(const std::vector<bool>& bitmap)
+: FileState(bitmap.size())
+{
+  for (size_t i = 0; i < bitmap.size(); ++i) {
+    if (bitmap[i]) {
+      set(i);
+    }
+  }
+}
+
+bool
+FileState::set(size_t packetNum)
+{
+  auto& word = m_words[packetNum / WORD_BITS];
+  uint64_t mask = uint64_t(1) << (packetNum % WORD_BITS);
+  if (word & mask) {
+    return false;
+  }
+  word |= mask;
+  --m_missing;
+  return true;
+}
+
+void
+FileState::reset(size_t packetNum)
+{
+  auto& word = m_words[packetNum / WORD_BITS];
+  uint64_t mask = uint64_t(1) << (packetNum % WORD_BITS);
+  if (word & mask) {
+    word &= ~mask;
+    ++m_missing;
+  }
+}
+
+size_t
+FileState::findNextMissing(size_t from) const
+{
+  if (from >= m_size) {
+    return m_size;
+  }
+  size_t wordNum = from / WORD_BITS;
+  // ignore the packets before 'from' in the first word
+  uint64_t missing = ~m_words[wordNum] & (~uint64_t(0) << (from % WORD_BITS));
+  while (0 == missing) {
+    if (++wordNum == m_words.size()) {
+      return m_size;
+    }
+    missing = ~m_words[wordNum];
+  }
+  size_t packetNum = wordNum * WORD_BITS + __builtin_ctzll(missing);
+  // the unused bits of the last word are never set
+  return packetNum < m_size ? packetNum : m_size;
+}
+
+std::vector<bool>
+FileState::toBitmap() const
+{
+  std::vector<bool> bitmap(m_size);
+  for (size_t i = 0; i < m_size; ++i) {
+    bitmap[i] = test(i);
+  }
+  return bitmap;
+}
+
+} // namespace ntorrent
+} // namespace ndn
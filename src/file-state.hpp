@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_FILE_STATE_HPP
+#define INCLUDED_FILE_STATE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+
+/**
+ * @brief The set of Data packets of one sub-manifest that have been stored on disk
+ *
+ * The packets are tracked in a bitset packed into 64-bit words together with the number of packets
+ * that are still missing, so completion checks take constant time and the search for missing
+ * packets skips whole words of stored packets at a time.
+ */
+class FileState
+{
+public:
+  /**
+   * @brief Create a state of @p numPackets packets, none of which are stored
+   */
+  explicit
+  FileState(size_t numPackets = 0);
+
+  /**
+   * @brief Create a state from a bitmap, in which stored packets are set
+   */
+  explicit
+  FileState(const std::vector<bool>& bitmap);
+
+  /**
+   * @brief Return the number of packets in the sub-manifest
+   */
+  size_t
+  size() const;
+
+  /**
+   * @brief Return the number of packets that are not stored
+   */
+  size_t
+  missing() const;
+
+  /**
+   * @brief Return true if all packets are stored
+   */
+  bool
+  complete() const;
+
+  /**
+   * @brief Return true if packet @p packetNum is stored; @p packetNum must be less than size()
+   */
+  bool
+  test(size_t packetNum) const;
+
+  /**
+   * @brief Mark packet @p packetNum as stored
+   * @return True if the packet was not stored before, false otherwise.
+   */
+  bool
+  set(size_t packetNum);
+
+  /**
+   * @brief Mark packet @p packetNum as missing
+   */
+  void
+  reset(size_t packetNum);
+
+  /**
+   * @brief Return the number of the first missing packet at or after @p from, or size() if all of
+   *        them are stored
+   */
+  size_t
+  findNextMissing(size_t from = 0) const;
+
+  /**
+   * @brief Return the state as a bitmap, in which stored packets are set
+   */
+  std::vector<bool>
+  toBitmap() const;
+
+  bool
+  operator==(const FileState& other) const;
+
+  bool
+  operator!=(const FileState& other) const;
+
+private:
+  enum { WORD_BITS = 64 };
+
+  std::vector<uint64_t> m_words;
+  size_t                m_size;
+  size_t                m_missing;
+};
+
+inline size_t
+FileState::size() const
+{
+  return m_size;
+}
+
+inline size_t
+FileState::missing() const
+{
+  return m_missing;
+}
+
+inline bool
+FileState::complete() const
+{
+  return 0 == m_missing;
+}
+
+inline bool
+FileState::test(size_t packetNum) const
+{
+  return (m_words[packetNum / WORD_BITS] >> (packetNum % WORD_BITS)) & 1;
+}
+
+inline bool
+FileState::operator==(const FileState& other) const
+{
+  return m_size == other.m_size && m_words == other.m_words;
+}
+
+inline bool
+FileState::operator!=(const FileState& other) const
+{
+  return !(*this == other);
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_FILE_STATE_HPP
@@ -0,0 +1,217 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "generation-cache.hpp"
+
+#include "util/logging.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <sys/stat.h>
+
+namespace ndn {
+namespace ntorrent {
+
+// The cache is a sequence of entries in host byte order, following a 21 byte header:
+//
+//   Header ::= magic:u8[5] subManifestSize:u64 dataPacketSize:u64
+//   Entry  ::= length:u16 path:u8[length] size:u64 mtime:i64 length:u32 manifestName:u8[length]
+//
+// where 'manifestName' is the wire encoding of the full name of the first sub-manifest.
+static const char MAGIC[] = {'N', 'T', 'R', 'G', 1};
+
+static bool
+statFile(const std::string& filePath, uint64_t& size, int64_t& mtime)
+{
+  struct stat st;
+  if (0 != ::stat(filePath.c_str(), &st)) {
+    return false;
+  }
+  size = st.st_size;
+  mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+  return true;
+}
+
+template<typename T>
+static void
+put(std::ostream& os, T value)
+{
+  os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+static bool
+get(const char*& it, const char* end, T& value)
+{
+  if (static_cast<size_t>(end - it) < sizeof(value)) {
+    return false;
+  }
+  std::memcpy(&value, it, sizeof(value));
+  it += sizeof(value);
+  return true;
+}
+
+GenerationCache::GenerationCache()
+: m_subManifestSize(0)
+, m_dataPacketSize(0)
+{
+}
+
+bool
+GenerationCache::open(const std::string& path, size_t subManifestSize, size_t dataPacketSize)
+{
+  m_path = path;
+  m_subManifestSize = subManifestSize;
+  m_dataPacketSize = dataPacketSize;
+  m_entries.clear();
+  std::ifstream is(m_path, std::ifstream::binary);
+  if (!is) {
+    return false;
+  }
+  std::vector<char> bytes((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+  const char* it = bytes.data();
+  const char* end = it + bytes.size();
+  uint64_t recordedSubManifestSize, recordedDataPacketSize;
+  if (bytes.size() < sizeof(MAGIC) || 0 != std::memcmp(it, MAGIC, sizeof(MAGIC))) {
+    LOG_ERROR << "Discarding unrecognized generation cache " << m_path;
+    return false;
+  }
+  it += sizeof(MAGIC);
+  if (!get(it, end, recordedSubManifestSize) || !get(it, end, recordedDataPacketSize)) {
+    LOG_ERROR << "Discarding corrupt generation cache " << m_path;
+    return false;
+  }
+  if (recordedSubManifestSize != m_subManifestSize || recordedDataPacketSize != m_dataPacketSize) {
+    LOG_INFO << "Discarding generation cache " << m_path << " of other packet sizes";
+    return false;
+  }
+  while (it != end) {
+    uint16_t pathLength;
+    uint32_t nameLength;
+    Entry e{0, 0, Name(), false};
+    if (!get(it, end, pathLength) || end - it < pathLength) {
+      break;
+    }
+    std::string filePath(it, pathLength);
+    it += pathLength;
+    if (!get(it, end, e.size) || !get(it, end, e.mtime) || !get(it, end, nameLength) ||
+        static_cast<size_t>(end - it) < nameLength) {
+      break;
+    }
+    try {
+      e.manifestName = Name(Block(reinterpret_cast<const uint8_t*>(it), nameLength));
+    }
+    catch (const tlv::Error&) {
+      break;
+    }
+    it += nameLength;
+    m_entries[filePath] = e;
+  }
+  if (it != end) {
+    LOG_ERROR << "Discarding corrupt tail of generation cache " << m_path;
+  }
+  return true;
+}
+
+void
+GenerationCache::retain(const std::function<bool(const Name&)>& isStored)
+{
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    if (it->second.manifestName.empty() || !isStored(it->second.manifestName)) {
+      it = m_entries.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+}
+
+const Name*
+GenerationCache::lookup(const std::string& filePath)
+{
+  auto& e = m_entries[filePath];
+  uint64_t size;
+  int64_t mtime;
+  if (!statFile(filePath, size, mtime)) {
+    // never trusted again, as no stamp was taken
+    e = Entry{0, 0, Name(), false};
+    return nullptr;
+  }
+  if (size != e.size || mtime != e.mtime || e.manifestName.empty()) {
+    e = Entry{size, mtime, Name(), true};
+    return nullptr;
+  }
+  e.seen = true;
+  return &e.manifestName;
+}
+
+void
+GenerationCache::insert(const std::string& filePath, const Name& manifestName)
+{
+  auto it = m_entries.find(filePath);
+  if (m_entries.end() != it && it->second.seen) {
+    it->second.manifestName = manifestName;
+  }
+}
+
+bool
+GenerationCache::save() const
+{
+  if (m_path.empty()) {
+    return false;
+  }
+  auto tmpPath = m_path + ".tmp";
+  {
+    std::ofstream os(tmpPath, std::ofstream::binary | std::ofstream::trunc);
+    os.write(MAGIC, sizeof(MAGIC));
+    put<uint64_t>(os, m_subManifestSize);
+    put<uint64_t>(os, m_dataPacketSize);
+    for (const auto& kv : m_entries) {
+      const auto& e = kv.second;
+      if (!e.seen || e.manifestName.empty()) {
+        continue;
+      }
+      const auto& wire = e.manifestName.wireEncode();
+      put<uint16_t>(os, kv.first.size());
+      os.write(kv.first.data(), kv.first.size());
+      put<uint64_t>(os, e.size);
+      put<int64_t>(os, e.mtime);
+      put<uint32_t>(os, wire.size());
+      os.write(reinterpret_cast<const char*>(wire.wire()), wire.size());
+    }
+    if (!os.flush()) {
+      LOG_ERROR << "Failed to write generation cache " << tmpPath;
+      return false;
+    }
+  }
+  if (0 != std::rename(tmpPath.c_str(), m_path.c_str())) {
+    LOG_ERROR << "Failed to replace generation cache " << m_path;
+    return false;
+  }
+  return true;
+}
+
+} // namespace ntorrent
+} // namespace ndn
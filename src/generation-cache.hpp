@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_GENERATION_CACHE_HPP
+#define INCLUDED_GENERATION_CACHE_HPP
+
+#include <ndn-cxx/name.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+namespace ndn {
+namespace ntorrent {
+
+/**
+ * @brief A persistent record of the files of a generated torrent, with the size and modification
+ *        time of each file when it was packetized and the full name of its first sub-manifest
+ *
+ * Kept next to the metadata store a torrent was generated into, it lets the next generation of the
+ * same directory with the same packet sizes skip reading the files that did not change: their
+ * sub-manifests are already in the store, and the full name of the first one is all the torrent
+ * file segments need. Only the entries looked up or inserted since the cache was opened are saved,
+ * so the files removed from the directory are forgotten.
+ */
+class GenerationCache : boost::noncopyable
+{
+public:
+  GenerationCache();
+
+  /**
+   * @brief Load the cache at @p path, if any, for the packet sizes of the generation
+   * @return True if the cache was read, false if there was none or it was unreadable.
+   *
+   * The entries recorded for other packet sizes are discarded, as the manifests would differ.
+   */
+  bool
+  open(const std::string& path, size_t subManifestSize, size_t dataPacketSize);
+
+  /**
+   * @brief Return the number of entries
+   */
+  size_t
+  size() const;
+
+  /**
+   * @brief Forget all the entries, so that every file is packetized again
+   */
+  void
+  clear();
+
+  /**
+   * @brief Forget the entries for which @p isStored returns false for the full name of the first
+   *        sub-manifest, e.g. because the metadata store the cache was kept with was removed
+   */
+  void
+  retain(const std::function<bool(const Name&)>& isStored);
+
+  /**
+   * @brief Return the full name of the first sub-manifest of the file at @p filePath if it has the
+   *        recorded size and modification time, or nullptr if it must be packetized again
+   *
+   * The file is stamped with its current size and modification time, which 'insert' records along
+   * with the new manifests. The stamp is taken before the file is read, so that a change made while
+   * it is packetized is seen by the next generation.
+   */
+  const Name*
+  lookup(const std::string& filePath);
+
+  /**
+   * @brief Record @p manifestName as the full name of the first sub-manifest of the file at
+   *        @p filePath, stamped by the last 'lookup' of it
+   */
+  void
+  insert(const std::string& filePath, const Name& manifestName);
+
+  /**
+   * @brief Replace the cache on disk with the entries looked up or inserted since it was opened
+   */
+  bool
+  save() const;
+
+private:
+  struct Entry {
+    uint64_t size;
+    int64_t  mtime;
+    // The full name of the first sub-manifest, empty until one is recorded for the stamp
+    Name     manifestName;
+    // Whether the file was seen by this generation
+    bool     seen;
+  };
+
+  std::string                            m_path;
+  uint64_t                               m_subManifestSize;
+  uint64_t                               m_dataPacketSize;
+  std::unordered_map<std::string, Entry> m_entries;
+};
+
+inline size_t
+GenerationCache::size() const
+{
+  return m_entries.size();
+}
+
+inline void
+GenerationCache::clear()
+{
+  m_entries.clear();
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_GENERATION_CACHE_HPP
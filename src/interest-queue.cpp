@@ -24,19 +24,81 @@
 namespace ndn {
 namespace ntorrent {
 
-void
-InterestQueue::push(shared_ptr<Interest> interest, DataCallback dataReceivedCallback,
-     TimeoutCallback dataFailedCallback)
+InterestQueue::InterestQueue()
+: m_seq(0)
+{
+}
+
+bool
+InterestQueue::push(const Name& name, shared_ptr<const Request> request, Priority priority)
 {
-  m_queue.push(std::make_tuple(interest, dataReceivedCallback, dataFailedCallback));
+  auto it = m_index.find(name);
+  if (m_index.end() == it) {
+    m_index.insert({name, Queued{m_seq, priority, request}});
+    m_levels[priority].push_back(Slot{name, m_seq});
+    ++m_seq;
+    return true;
+  }
+  // collapse the duplicate into the queued name
+  auto& queued = it->second;
+  auto first = queued.request;
+  auto second = request;
+  queued.request = make_shared<const Request>(Request{
+    [first, second] (const Interest& interest, const Data& data) {
+      first->onData(interest, data);
+      second->onData(interest, data);
+    },
+    [first, second] (const Interest& interest) {
+      first->onTimeout(interest);
+      second->onTimeout(interest);
+    },
+    first->exact,
+    first->speculative && second->speculative});
+  if (priority < queued.priority) {
+    // the slot in the lower priority becomes stale
+    queued.seq = m_seq;
+    queued.priority = priority;
+    m_levels[priority].push_back(Slot{name, m_seq});
+    ++m_seq;
+    trim();
+  }
+  return false;
 }
 
-queueTuple
+InterestQueue::Entry
 InterestQueue::pop()
 {
-  queueTuple tup = m_queue.front();
-  m_queue.pop();
-  return tup;
+  Entry entry = front();
+  m_levels[m_index[entry.name].priority].pop_front();
+  m_index.erase(entry.name);
+  trim();
+  return entry;
+}
+
+InterestQueue::Entry
+InterestQueue::front() const
+{
+  for (const auto& level : m_levels) {
+    if (!level.empty()) {
+      const auto& name = level.front().name;
+      return Entry{name, m_index.find(name)->second.request};
+    }
+  }
+  return Entry();
+}
+
+void
+InterestQueue::trim()
+{
+  for (auto& level : m_levels) {
+    while (!level.empty()) {
+      auto it = m_index.find(level.front().name);
+      if (m_index.end() != it && it->second.seq == level.front().seq) {
+        break;
+      }
+      level.pop_front();
+    }
+  }
 }
 
 } // namespace ntorrent
@@ -19,88 +19,147 @@
 * See AUTHORS for complete list of nTorrent authors and contributors.
 */
 
+#ifndef INCLUDED_INTEREST_QUEUE_HPP
+#define INCLUDED_INTEREST_QUEUE_HPP
+
 #include <ndn-cxx/data.hpp>
 #include <ndn-cxx/face.hpp>
 #include <ndn-cxx/interest.hpp>
 
-#include <queue>
-#include <tuple>
-
-typedef std::tuple<std::shared_ptr<ndn::Interest>, ndn::DataCallback, ndn::TimeoutCallback> queueTuple;
+#include <array>
+#include <deque>
+#include <unordered_map>
 
 namespace ndn {
 namespace ntorrent {
 
+/**
+ * @brief A priority queue of the names of Interests yet to be sent, holding each name at most once
+ *
+ * Names of the same priority are sent in the order they were pushed. A queued name costs the name
+ * itself and a pointer to callbacks shared by all the names pushed together; the Interest is only
+ * created when the name is popped.
+ */
 class InterestQueue
 {
 public:
-  InterestQueue() = default;
+  /**
+   * @brief The callbacks for the Interests of a set of names pushed together
+   */
+  struct Request {
+    DataCallback    onData;
+    TimeoutCallback onTimeout;
+    // Whether only Data named exactly as the Interest (plus its implicit digest) may answer it
+    bool            exact;
+    // Whether the name may not exist, so that its timeouts are not taken as losses
+    bool            speculative;
+  };
+
+  struct Entry {
+    Name                      name;
+    shared_ptr<const Request> request;
+  };
+
+  // The priorities of the queued names, from the first to be sent to the last one
+  enum Priority {
+    TORRENT_FILE_RETRY,
+    TORRENT_FILE,
+    FILE_MANIFEST_RETRY,
+    FILE_MANIFEST,
+    DATA_PACKET_RETRY,
+    DATA_PACKET_HIGH,
+    DATA_PACKET,
+    DATA_PACKET_LOW,
+    NUM_PRIORITIES
+  };
+
+  InterestQueue();
 
   ~InterestQueue() = default;
 
   /**
-   * @brief Push a tuple to the Interest Queue
-   * @param interest A shared pointer to an Interest
-   * @param dataReceivedCallback Callback to be called when data is received for the given
-   *                             Interest
-   * @param dataFailedCallback Callback to be called when we fail to retrieve data for the
-   *                           given Interest
+   * @brief Push @p name with the callbacks of @p request and the specified @p priority
+   * @return True if @p name was not queued yet
    *
+   * If @p name is already queued, it is not queued again: the callbacks of both requests are called
+   * for its single Interest, which is sent with the higher of the two priorities.
    */
-  void
-  push(shared_ptr<Interest> interest, DataCallback dataReceivedCallback,
-       TimeoutCallback dataFailedCallback);
+  bool
+  push(const Name& name, shared_ptr<const Request> request, Priority priority = DATA_PACKET);
 
   /**
-   * @brief Pop a tuple from the Interest Queue
-   * @return A tuple of a shared pointer to an Interest, a callaback for successful data
-   *         retrieval and a callback for failed data retrieval
+   * @brief Pop the name with the highest priority from the Interest Queue
+   * @return The name and the callbacks of its Interest
    */
-  queueTuple
+  Entry
   pop();
 
   /**
-   * @brief Return the size of the queue (number of tuples)
-   * @return The number of tuples stored in the queue
+   * @brief Return true if @p name is queued
+   */
+  bool
+  contains(const Name& name) const;
+
+  /**
+   * @brief Return the size of the queue (number of names)
    */
   size_t
   size() const;
 
   /**
    * @brief Check if the queue is empty
-   * @return True if the queue is empty, otherwise false
    */
   bool
   empty() const;
 
   /**
-   * @brief Return the top element of the Interest queue
-   * @return The top tuple element of the Interest queue
+   * @brief Return the name with the highest priority and the callbacks of its Interest
    */
-   queueTuple
-   front() const;
+  Entry
+  front() const;
 
 private:
-  std::queue<queueTuple> m_queue;
+  struct Slot {
+    Name     name;
+    uint64_t seq;
+  };
+
+  struct Queued {
+    uint64_t                  seq;
+    Priority                  priority;
+    shared_ptr<const Request> request;
+  };
+
+  // Drop the slots at the front of each level that were superseded by a promotion
+  void
+  trim();
+
+  // The slots of the names of each priority, in the order they were pushed
+  std::array<std::deque<Slot>, NUM_PRIORITIES> m_levels;
+  // The live slot, priority and callbacks of each queued name
+  std::unordered_map<Name, Queued>             m_index;
+  uint64_t                                     m_seq;
 };
 
 inline size_t
 InterestQueue::size() const
 {
-  return m_queue.size();
+  return m_index.size();
 }
 
 inline bool
 InterestQueue::empty() const
 {
-  return m_queue.empty();
+  return m_index.empty();
 }
 
-inline queueTuple
-InterestQueue::front() const
+inline bool
+InterestQueue::contains(const Name& name) const
 {
-  return m_queue.front();
+  return m_index.end() != m_index.find(name);
 }
 
 } // namespace ntorrent
 } // namespace ndn
+
+#endif // INCLUDED_INTEREST_QUEUE_HPP
@@ -18,16 +18,23 @@
  *
  * See AUTHORS.md for complete list of nTorrent authors and contributors.
  */
+#include "metadata-store.hpp"
+#include "rarest-first-data-fetcher.hpp"
 #include "sequential-data-fetcher.hpp"
+#include "torrent-daemon.hpp"
 #include "torrent-file.hpp"
 #include "util/io-util.hpp"
 #include "util/logging.hpp"
+#include "util/thread-pool.hpp"
 
+#include <fstream>
 #include <iostream>
 #include <iterator>
+#include <sstream>
 #include <stdexcept>
 #include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <boost/program_options.hpp>
 #include <boost/program_options/errors.hpp>
@@ -56,6 +63,26 @@ namespace ntorrent {
 
 const char * SharedConstants::commonPrefix = "/ndn/nTorrent";
 
+// Return the full names of the specified 'torrentSegments' and of the manifests in 'store' that
+// the chains of their files go through
+static std::unordered_set<Name>
+findReachable(const MetadataStore& store, const std::vector<TorrentFile>& torrentSegments)
+{
+  std::unordered_set<Name> reachable;
+  for (const auto& segment : torrentSegments) {
+    reachable.insert(segment.getFullName());
+    for (const auto& initialName : segment.getCatalog()) {
+      Name name = initialName;
+      FileManifest manifest;
+      while (reachable.insert(name).second && store.find(name, manifest) &&
+             nullptr != manifest.submanifest_ptr()) {
+        name = *manifest.submanifest_ptr();
+      }
+    }
+  }
+  return reachable;
+}
+
 } // end ntorrent
 } // end ndn
 
@@ -67,9 +94,18 @@ int main(int argc, char *argv[])
     desc.add_options()
     // TODO(msweatt) Consider  adding  flagged args for other parameters
       ("help,h", "produce help message")
-      ("generate,g" , "-g <data directory> <output-path>? <names-per-segment>? <names-per-manifest-segment>? <data-packet-size>?")
+      ("generate,g" , "-g <data directory> <output-path>? <names-per-segment>? <names-per-manifest-segment>? <data-packet-size>? (sizes omitted or 0 are fitted to the largest NDN packet)")
+      ("jobs,j", po::value<size_t>()->default_value(1), "-j <N> Number of threads used to generate a torrent (0 for one per core)")
+      ("incremental,i", "With -g, only read the files changed since the torrent was last generated into the same output path")
       ("seed,s", "After download completes, continue to seed")
+      ("strategy", po::value<std::string>()->default_value("sequential"), "sequential | rarest-first")
       ("dump,d", "-d <file> Dump the contents of the Data stored at the <file>.")
+      ("daemon", po::value<std::string>(), "--daemon <file> Host in one process the torrents listed in <file>, one '<torrent-file-name> <data-path> <strategy>?' per line")
+      ("seed-threads", po::value<size_t>()->default_value(0), "--seed-threads <N> Number of threads reading the served data packets from disk (0 for one per core)")
+      ("metrics-interval", po::value<size_t>()->default_value(0), "--metrics-interval <S> Log the metrics of each torrent every <S> seconds (0 to never log them)")
+      ("window-budget", po::value<size_t>()->default_value(TorrentDaemon::DEFAULT_WINDOW_BUDGET), "--window-budget <N> Number of Interests outstanding across the torrents of the daemon")
+      ("memory-budget", po::value<size_t>()->default_value(0), "--memory-budget <MB> Megabytes of file manifests each torrent keeps in memory, the complete ones being reloaded from disk when needed (0 to keep them all); the packet cache is not counted")
+      ("max-pending-interests", po::value<size_t>()->default_value(0), "--max-pending-interests <N> Number of Interests each torrent has outstanding at most (0 for no bound but the congestion windows)")
       ("log-level", po::value<std::string>(), "trace | debug | info | warming | error | fatal | console")
       ("args", po::value<std::vector<std::string> >(), "For arguments you want to specify without flags")
     ;
@@ -109,7 +145,37 @@ int main(int argc, char *argv[])
     LoggingUtil::init(log_to_console);
     logging::add_common_attributes();
 
-    if (vm.count("args")) {
+    // daemon mode
+    if (vm.count("daemon")) {
+      auto listPath = vm["daemon"].as<std::string>();
+      std::ifstream list(listPath);
+      if (!list) {
+        throw ndn::Error("Cannot read the torrent list: " + listPath);
+      }
+      auto seedFlag = (vm.count("seed") != 0);
+      TorrentDaemon daemon(vm["window-budget"].as<size_t>(), vm["seed-threads"].as<size_t>());
+      daemon.setMetricsInterval(time::seconds(vm["metrics-interval"].as<size_t>()));
+      daemon.setMemoryBudget(vm["memory-budget"].as<size_t>() * 1024 * 1024);
+      daemon.setMaxPendingInterests(vm["max-pending-interests"].as<size_t>());
+      std::string line;
+      while (std::getline(list, line)) {
+        // <torrent-file-name> <data-path> <strategy>?
+        std::istringstream fields(line);
+        std::string torrentName, dataPath;
+        std::string strategy = vm["strategy"].as<std::string>();
+        if (!(fields >> torrentName) || '#' == torrentName[0]) {
+          continue;
+        }
+        if (!(fields >> dataPath)) {
+          throw ndn::Error("Missing data path for " + torrentName);
+        }
+        fields >> strategy;
+        daemon.add(torrentName, dataPath, seedFlag, strategy);
+      }
+      LOG_INFO << "Hosting " << daemon.size() << " torrents";
+      daemon.run();
+    }
+    else if (vm.count("args")) {
       auto args = vm["args"].as<std::vector<std::string>>();
       // if generate mode
       if (vm.count("generate")) {
@@ -118,36 +184,88 @@ int main(int argc, char *argv[])
         }
         auto dataPath         = args[0];
         auto outputPath       = args.size() >= 2 ? args[1] : ".appdata/";
-        auto namesPerSegment  = args.size() >= 3 ? boost::lexical_cast<size_t>(args[2]) : 1024;
-        auto namesPerManifest = args.size() >= 4 ? boost::lexical_cast<size_t>(args[3]) : 1024;
-        auto dataPacketSize   = args.size() == 5 ? boost::lexical_cast<size_t>(args[4]) : 1024;
+        // the sizes that are omitted or zero are fitted to the largest NDN packet
+        TorrentFile::PacketSizes requested{
+          args.size() >= 3 ? boost::lexical_cast<size_t>(args[2]) : 0,
+          args.size() >= 4 ? boost::lexical_cast<size_t>(args[3]) : 0,
+          args.size() == 5 ? boost::lexical_cast<size_t>(args[4]) : 0
+        };
+        auto sizes = TorrentFile::fitPacketSizes(dataPath, requested);
+        auto largest = TorrentFile::fitPacketSizes(dataPath);
+        if (sizes.namesPerSegment > largest.namesPerSegment ||
+            sizes.subManifestSize > largest.subManifestSize ||
+            sizes.dataPacketSize > largest.dataPacketSize) {
+          LOG_WARNING << "Some packets will exceed " << MAX_NDN_PACKET_SIZE
+                      << " bytes and cannot be forwarded";
+        }
+        LOG_INFO << "Generating " << dataPath << " with " << sizes.namesPerSegment
+                 << " names per segment, " << sizes.subManifestSize
+                 << " names per manifest and " << sizes.dataPacketSize << " bytes per data packet";
 
-        const auto& content = TorrentFile::generate(dataPath,
-                                                    namesPerSegment,
-                                                    namesPerManifest,
-                                                    dataPacketSize);
-        const auto& torrentSegments = content.first;
-        std::vector<FileManifest> manifests;
-        for (const auto& ms : content.second) {
-          manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+        auto jobs             = vm["jobs"].as<size_t>();
+        if (0 == jobs) {
+          jobs = ThreadPool::hardwareConcurrency();
         }
+
         auto torrentPrefix = fs::canonical(dataPath).filename().string();
         outputPath += ("/" + torrentPrefix);
-        auto torrentPath =  outputPath + "/torrent_files/";
-        // write all the torrent segments
+        // write all the torrent segments and manifests to the store read by the torrent manager
+        IoUtil::create_directories(outputPath);
+        MetadataStore store;
+        if (!store.open(outputPath + "/metadata")) {
+          return -1;
+        }
+        // the manifests of the unchanged files are reused only if they are still in the store
+        GenerationCache cache;
+        cache.open(outputPath + "/generation-cache", sizes.subManifestSize, sizes.dataPacketSize);
+        if (vm.count("incremental")) {
+          cache.retain([&store] (const Name& manifestName) { return store.contains(manifestName); });
+        }
+        else {
+          cache.clear();
+        }
+        const auto& content = TorrentFile::generate(dataPath,
+                                                    sizes.namesPerSegment,
+                                                    sizes.subManifestSize,
+                                                    sizes.dataPacketSize,
+                                                    false,
+                                                    jobs,
+                                                    &cache);
+        const auto& torrentSegments = content.first;
+        LOG_INFO << "Read " << content.second.size() << " new or changed files";
         for (const TorrentFile& t : torrentSegments) {
-          if (!IoUtil::writeTorrentSegment(t, torrentPath)) {
-            LOG_ERROR << "Write failed: " << t.getName() << std::endl;
+          if (!store.insert(t) && !store.contains(t.getFullName())) {
+            LOG_ERROR << "Write failed: " << t.getName();
             return -1;
           }
         }
-        auto manifestPath = outputPath + "/manifests/";
-        for (const FileManifest& m : manifests) {
-          if (!IoUtil::writeFileManifest(m, manifestPath)) {
-            LOG_ERROR << "Write failed: " << m.getName() << std::endl;
-            return -1;
+        for (const auto& ms : content.second) {
+          for (const FileManifest& m : ms.first) {
+            if (!store.insert(m) && !store.contains(m.getFullName())) {
+              LOG_ERROR << "Write failed: " << m.getName();
+              return -1;
+            }
           }
         }
+        if (!store.flush()) {
+          LOG_ERROR << "Sync failed: " << outputPath << "/metadata";
+          return -1;
+        }
+        // drop the segments and manifests of the earlier generations, so that they are not
+        // decoded each time the torrent is loaded
+        auto reachable = findReachable(store, torrentSegments);
+        auto numRecords = store.size();
+        if (!store.compact([&reachable] (const Name& fullName) {
+              return 0 != reachable.count(fullName);
+            })) {
+          LOG_WARNING << "Stale records are left in " << outputPath << "/metadata";
+        }
+        else if (store.size() < numRecords) {
+          LOG_INFO << "Dropped " << numRecords - store.size() << " stale records from "
+                   << outputPath << "/metadata";
+        }
+        // only once the manifests it refers to are on disk
+        cache.save();
       }
       // if dump mode
       else if(vm.count("dump")) {
@@ -155,7 +273,7 @@ int main(int argc, char *argv[])
           throw ndn::Error("wrong number of arguments for dump");
         }
         auto filePath = args[0];
-        auto data = io::load<Data>(filePath);
+        auto data = IoUtil::load<Data>(filePath);
         if (nullptr != data) {
           std::cout << data->getFullName() << std::endl;
         }
@@ -172,8 +290,26 @@ int main(int argc, char *argv[])
         auto torrentName = args[0];
         auto dataPath    = args[1];
         auto seedFlag    = (vm.count("seed") != 0);
-        SequentialDataFetcher fetcher(torrentName, dataPath, seedFlag);
-        fetcher.start();
+        auto strategy    = vm["strategy"].as<std::string>();
+        auto seedThreads = vm["seed-threads"].as<size_t>();
+        TorrentManager::Resources resources{};
+        resources.seedWorkers = make_shared<ThreadPool>(0 < seedThreads
+                                                        ? seedThreads
+                                                        : ThreadPool::hardwareConcurrency());
+        resources.metricsInterval = time::seconds(vm["metrics-interval"].as<size_t>());
+        resources.memoryBudget = vm["memory-budget"].as<size_t>() * 1024 * 1024;
+        resources.maxPendingInterests = vm["max-pending-interests"].as<size_t>();
+        if ("sequential" == strategy) {
+          SequentialDataFetcher fetcher(torrentName, dataPath, seedFlag, resources);
+          fetcher.start();
+        }
+        else if ("rarest-first" == strategy) {
+          RarestFirstDataFetcher fetcher(torrentName, dataPath, seedFlag, resources);
+          fetcher.start();
+        }
+        else {
+          throw ndn::Error("Unsupported strategy: " + strategy);
+        }
       }
     }
     else {
@@ -0,0 +1,344 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "metadata-store.hpp"
+
+#include "util/logging.hpp"
+
+#include <ndn-cxx/encoding/tlv.hpp>
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn {
+namespace ntorrent {
+
+// The store is a sequence of records following an 8 byte header:
+//
+//   Record ::= Name Data
+//
+// where Name is the TLV encoding of the full name of the Data packet that follows it.
+static const char MAGIC[] = {'N', 'T', 'R', 'M', 'S', 0, 0, 1};
+
+// A read-only mapping of a whole file
+class Mapping : boost::noncopyable
+{
+public:
+  Mapping(int fd, size_t size)
+  : m_begin(nullptr)
+  , m_size(size)
+  {
+    if (0 < size) {
+      void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (MAP_FAILED != p) {
+        m_begin = static_cast<const uint8_t*>(p);
+        ::madvise(p, size, MADV_SEQUENTIAL);
+      }
+    }
+  }
+
+  ~Mapping()
+  {
+    if (nullptr != m_begin) {
+      ::munmap(const_cast<uint8_t*>(m_begin), m_size);
+    }
+  }
+
+  const uint8_t*
+  begin() const
+  {
+    return m_begin;
+  }
+
+private:
+  const uint8_t* m_begin;
+  size_t         m_size;
+};
+
+// Read a TLV-TYPE or TLV-LENGTH number; return false if it is truncated
+static bool
+readNumber(const uint8_t*& it, const uint8_t* end, uint64_t& number)
+{
+  if (it == end) {
+    return false;
+  }
+  uint8_t first = *it++;
+  size_t length = first < 253 ? 0 : first == 253 ? 2 : first == 254 ? 4 : 8;
+  if (static_cast<size_t>(end - it) < length) {
+    return false;
+  }
+  number = 0 == length ? first : 0;
+  for (size_t i = 0; i < length; ++i) {
+    number = (number << 8) | *it++;
+  }
+  return true;
+}
+
+// Skip the TLV element of the specified 'type' at 'it'; return false if it is truncated or of
+// another type
+static bool
+skipElement(const uint8_t*& it, const uint8_t* end, uint32_t type)
+{
+  uint64_t elementType;
+  uint64_t length;
+  if (!readNumber(it, end, elementType) || type != elementType ||
+      !readNumber(it, end, length) || static_cast<uint64_t>(end - it) < length) {
+    return false;
+  }
+  it += length;
+  return true;
+}
+
+MetadataStore::MetadataStore()
+: m_fd(-1)
+, m_end(0)
+{
+}
+
+MetadataStore::~MetadataStore()
+{
+  close();
+}
+
+bool
+MetadataStore::open(const std::string& path)
+{
+  close();
+  m_path = path;
+  m_fd = ::open(m_path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (m_fd < 0) {
+    LOG_ERROR << "Failed to open " << m_path << ": " << std::strerror(errno);
+    return false;
+  }
+  if (!index(m_end)) {
+    close();
+    return false;
+  }
+  // discard whatever follows the last complete record
+  if (0 != ::ftruncate(m_fd, m_end) ||
+      (0 == m_end && sizeof(MAGIC) != ::pwrite(m_fd, MAGIC, sizeof(MAGIC), 0))) {
+    LOG_ERROR << "Failed to reset " << m_path << ": " << std::strerror(errno);
+    close();
+    return false;
+  }
+  m_end = std::max<uint64_t>(m_end, sizeof(MAGIC));
+  return true;
+}
+
+void
+MetadataStore::close()
+{
+  if (m_fd >= 0) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+  m_end = 0;
+  m_records.clear();
+  m_index.clear();
+}
+
+bool
+MetadataStore::index(uint64_t& storeEnd)
+{
+  storeEnd = 0;
+  struct stat st;
+  if (0 != ::fstat(m_fd, &st)) {
+    LOG_ERROR << "Failed to stat " << m_path << ": " << std::strerror(errno);
+    return false;
+  }
+  // a file shorter than the header holds no record
+  if (static_cast<size_t>(st.st_size) < sizeof(MAGIC)) {
+    return true;
+  }
+  // only a header read and found wrong discards the file, not a failure to read it
+  char magic[sizeof(MAGIC)];
+  auto bytesRead = ::pread(m_fd, magic, sizeof(magic), 0);
+  if (bytesRead < 0) {
+    LOG_ERROR << "Failed to read " << m_path << ": " << std::strerror(errno);
+    return false;
+  }
+  if (sizeof(magic) != static_cast<size_t>(bytesRead) ||
+      0 != std::memcmp(magic, MAGIC, sizeof(MAGIC))) {
+    LOG_ERROR << "Discarding unrecognized metadata store " << m_path;
+    return true;
+  }
+  Mapping mapping(m_fd, st.st_size);
+  const uint8_t* begin = mapping.begin();
+  if (nullptr == begin) {
+    LOG_ERROR << "Failed to map " << m_path << ": " << std::strerror(errno);
+    return false;
+  }
+  const uint8_t* end = begin + st.st_size;
+  const uint8_t* it = begin + sizeof(MAGIC);
+  while (it != end) {
+    const uint8_t* name = it;
+    if (!skipElement(it, end, tlv::Name)) {
+      break;
+    }
+    const uint8_t* data = it;
+    if (!skipElement(it, end, tlv::Data)) {
+      break;
+    }
+    Name fullName(Block(name, data - name));
+    if (m_index.insert({fullName, m_records.size()}).second) {
+      m_records.push_back(Record{fullName, static_cast<uint64_t>(data - begin),
+                                 static_cast<size_t>(it - data)});
+    }
+  }
+  if (it != end) {
+    LOG_ERROR << "Discarding truncated tail of " << m_path;
+  }
+  // the last complete record, which is the header itself if it holds none
+  storeEnd = it - begin;
+  return true;
+}
+
+void
+MetadataStore::onDecodeError(size_t position, const tlv::Error& error) const
+{
+  LOG_ERROR << "Dropping malformed record of " << m_records[position].fullName << " in "
+            << m_path << ": " << error.what();
+}
+
+bool
+MetadataStore::insert(const Data& data)
+{
+  if (!isOpen()) {
+    return false;
+  }
+  const auto& fullName = data.getFullName();
+  if (contains(fullName)) {
+    return false;
+  }
+  const Block& name = fullName.wireEncode();
+  const Block& wire = data.wireEncode();
+  std::vector<uint8_t> record(name.wire(), name.wire() + name.size());
+  record.insert(record.end(), wire.wire(), wire.wire() + wire.size());
+  auto written = ::pwrite(m_fd, record.data(), record.size(), m_end);
+  if (written < 0 || static_cast<size_t>(written) != record.size()) {
+    LOG_ERROR << "Failed to write to " << m_path << ": " << std::strerror(errno);
+    // the partial record is overwritten by the next one
+    return false;
+  }
+  m_index[fullName] = m_records.size();
+  m_records.push_back(Record{fullName, m_end + name.size(), wire.size()});
+  m_end += record.size();
+  return true;
+}
+
+bool
+MetadataStore::flush()
+{
+  return isOpen() && 0 == ::fdatasync(m_fd);
+}
+
+bool
+MetadataStore::compact(const Filter& keep)
+{
+  if (!isOpen()) {
+    return false;
+  }
+  std::vector<size_t> records;
+  for (size_t i = 0; i < m_records.size(); ++i) {
+    if (keep(m_records[i].fullName)) {
+      records.push_back(i);
+    }
+  }
+  if (records.size() == m_records.size()) {
+    return true;
+  }
+  Mapping mapping(m_fd, m_end);
+  if (nullptr == mapping.begin()) {
+    LOG_ERROR << "Failed to map " << m_path << ": " << std::strerror(errno);
+    return false;
+  }
+  std::string compactPath = m_path + ".compact";
+  int fd = ::open(compactPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    LOG_ERROR << "Failed to open " << compactPath << ": " << std::strerror(errno);
+    return false;
+  }
+  auto append = [fd] (const uint8_t* buffer, size_t size) {
+    auto written = ::write(fd, buffer, size);
+    return 0 <= written && static_cast<size_t>(written) == size;
+  };
+  bool isWritten = append(reinterpret_cast<const uint8_t*>(MAGIC), sizeof(MAGIC));
+  for (auto it = records.begin(); isWritten && it != records.end(); ++it) {
+    const auto& record = m_records[*it];
+    const Block& name = record.fullName.wireEncode();
+    isWritten = append(name.wire(), name.size()) &&
+                append(mapping.begin() + record.offset, record.size);
+  }
+  isWritten = isWritten && 0 == ::fdatasync(fd);
+  ::close(fd);
+  if (!isWritten || 0 != ::rename(compactPath.c_str(), m_path.c_str())) {
+    LOG_ERROR << "Failed to compact " << m_path << ": " << std::strerror(errno);
+    ::unlink(compactPath.c_str());
+    return false;
+  }
+  // index the records again, at their new positions
+  return open(m_path);
+}
+
+std::vector<Block>
+MetadataStore::read(const std::vector<size_t>& records) const
+{
+  std::vector<Block> wires;
+  if (records.empty() || !isOpen()) {
+    return wires;
+  }
+  Mapping mapping(m_fd, m_end);
+  if (nullptr == mapping.begin()) {
+    LOG_ERROR << "Failed to map " << m_path << ": " << std::strerror(errno);
+    return wires;
+  }
+  wires.reserve(records.size());
+  for (auto i : records) {
+    const auto& record = m_records[i];
+    wires.emplace_back(mapping.begin() + record.offset, record.size);
+  }
+  return wires;
+}
+
+bool
+MetadataStore::read(size_t position, Block& wire) const
+{
+  if (!isOpen()) {
+    return false;
+  }
+  const auto& record = m_records[position];
+  auto buffer = make_shared<Buffer>(record.size);
+  auto bytesRead = ::pread(m_fd, buffer->data(), buffer->size(), record.offset);
+  if (bytesRead < 0 || static_cast<size_t>(bytesRead) != record.size) {
+    LOG_ERROR << "Failed to read " << m_path << ": " << std::strerror(errno);
+    return false;
+  }
+  wire = Block(buffer);
+  return true;
+}
+
+} // namespace ntorrent
+} // namespace ndn
@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_METADATA_STORE_HPP
+#define INCLUDED_METADATA_STORE_HPP
+
+#include "util/thread-pool.hpp"
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/encoding/block.hpp>
+#include <ndn-cxx/encoding/tlv.hpp>
+#include <ndn-cxx/name.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+
+/**
+ * @brief A single append-only file holding the torrent file segments and file manifests of a
+ *        torrent
+ *
+ * Each record is the full name of a packet followed by its wire encoding. The file is memory mapped
+ * when it is opened to index the records by full name, so a packet is stored at most once without
+ * reading back what is on disk, and mapped again to load the packets.
+ */
+class MetadataStore : boost::noncopyable
+{
+public:
+  typedef std::function<bool(const Name&)> Filter;
+
+  MetadataStore();
+
+  ~MetadataStore();
+
+  /**
+   * @brief Open the store at @p path, creating it if it does not exist, and index its records
+   * @return True if the store could be opened for appending, false otherwise.
+   *
+   * A truncated tail, e.g. left by a crash, is discarded, as is a file that is not a store. A
+   * store that cannot be read or mapped is left as is and not opened.
+   */
+  bool
+  open(const std::string& path);
+
+  /**
+   * @brief Return whether the store is open; when it is not, nothing can be inserted
+   */
+  bool
+  isOpen() const;
+
+  void
+  close();
+
+  /**
+   * @brief Return the number of stored packets
+   */
+  size_t
+  size() const;
+
+  /**
+   * @brief Return true if the packet with the specified @p fullName is stored
+   */
+  bool
+  contains(const Name& fullName) const;
+
+  /**
+   * @brief Append @p data to the store
+   * @return True if it was appended, false if it was already stored or could not be written.
+   */
+  bool
+  insert(const Data& data);
+
+  /**
+   * @brief Sync the appended records to disk
+   */
+  bool
+  flush();
+
+  /**
+   * @brief Rewrite the store with only the records whose full names match @p keep, e.g. to drop
+   *        the packets of the earlier generations of a torrent
+   * @return True if the store holds only the matching records and is still open, false otherwise.
+   *
+   * The records are written to a new file that replaces the store once it is synced, so the store
+   * is left as is if it cannot be rewritten.
+   */
+  bool
+  compact(const Filter& keep);
+
+  /**
+   * @brief Return the stored packets whose full names match @p filter, in the order they were
+   *        appended, decoded as T by @p numThreads threads
+   *
+   * The packets that cannot be decoded as T are logged and left out.
+   */
+  template<typename T>
+  std::vector<T>
+  load(const Filter& filter, size_t numThreads = 1) const;
+
+  /**
+   * @brief Decode the stored packet with the specified @p fullName as T into @p packet
+   * @return True if the packet is stored and could be read and decoded, false otherwise.
+   *
+   * Only the record of the packet is read, so a single packet is cheap to reload.
+   */
+  template<typename T>
+  bool
+  find(const Name& fullName, T& packet) const;
+
+private:
+  struct Record {
+    Name     fullName;
+    // The position and size of the wire encoding of the packet
+    uint64_t offset;
+    size_t   size;
+  };
+
+  // Index the records of the log into 'end', the end of the last complete one (zero if the file
+  // is not a store); return false if the file could not be read
+  bool
+  index(uint64_t& end);
+
+  // Log that the packet of the record at 'position' could not be decoded
+  void
+  onDecodeError(size_t position, const tlv::Error& error) const;
+
+  // Return the wire encodings of the packets of the records at the specified positions
+  std::vector<Block>
+  read(const std::vector<size_t>& records) const;
+
+  // Read the wire encoding of the packet of the record at 'position' into 'wire'
+  bool
+  read(size_t position, Block& wire) const;
+
+  std::string                      m_path;
+  int                              m_fd;
+  uint64_t                         m_end;
+  std::vector<Record>              m_records;
+  // The position of each record in 'm_records' by full name
+  std::unordered_map<Name, size_t> m_index;
+};
+
+inline bool
+MetadataStore::isOpen() const
+{
+  return m_fd >= 0;
+}
+
+inline size_t
+MetadataStore::size() const
+{
+  return m_records.size();
+}
+
+inline bool
+MetadataStore::contains(const Name& fullName) const
+{
+  return m_index.end() != m_index.find(fullName);
+}
+
+template<typename T>
+std::vector<T>
+MetadataStore::load(const Filter& filter, size_t numThreads) const
+{
+  std::vector<size_t> records;
+  for (size_t i = 0; i < m_records.size(); ++i) {
+    if (filter(m_records[i].fullName)) {
+      records.push_back(i);
+    }
+  }
+  auto wires = read(records);
+  std::vector<T> packets(wires.size());
+  // a record whose packet is malformed is dropped rather than failing the whole load
+  std::vector<char> decoded(wires.size(), 0);
+  auto decode = [this, &packets, &wires, &records, &decoded] (size_t i) {
+    try {
+      packets[i].wireDecode(wires[i]);
+      decoded[i] = 1;
+    }
+    catch (const tlv::Error& e) {
+      onDecodeError(records[i], e);
+    }
+  };
+  if (1 < numThreads && 1 < wires.size()) {
+    ThreadPool pool(std::min(numThreads, wires.size()));
+    for (size_t i = 0; i < wires.size(); ++i) {
+      pool.post([&decode, i] { decode(i); });
+    }
+    pool.wait();
+  }
+  else {
+    for (size_t i = 0; i < wires.size(); ++i) {
+      decode(i);
+    }
+  }
+  size_t numDecoded = 0;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    if (decoded[i]) {
+      if (numDecoded != i) {
+        packets[numDecoded] = std::move(packets[i]);
+      }
+      ++numDecoded;
+    }
+  }
+  packets.resize(numDecoded);
+  return packets;
+}
+
+template<typename T>
+bool
+MetadataStore::find(const Name& fullName, T& packet) const
+{
+  auto it = m_index.find(fullName);
+  Block wire;
+  if (m_index.end() == it || !read(it->second, wire)) {
+    return false;
+  }
+  try {
+    packet.wireDecode(wire);
+  }
+  catch (const tlv::Error& e) {
+    onDecodeError(it->second, e);
+    return false;
+  }
+  return true;
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_METADATA_STORE_HPP
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "metrics.hpp"
+
+#include <ostream>
+#include <string>
+
+namespace ndn {
+namespace ntorrent {
+
+Histogram::Histogram()
+: m_count(0)
+, m_sum(0)
+, m_max(0)
+{
+  m_buckets.fill(0);
+}
+
+void
+Histogram::add(uint64_t value)
+{
+  size_t bucket = 0;
+  for (auto v = value; 0 != v; v >>= 1) {
+    ++bucket;
+  }
+  ++m_buckets[bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1];
+  ++m_count;
+  m_sum += value;
+  if (value > m_max) {
+    m_max = value;
+  }
+}
+
+uint64_t
+Histogram::percentile(double fraction) const
+{
+  if (0 == m_count) {
+    return 0;
+  }
+  // the rank of the value, counting from 1
+  auto rank = static_cast<uint64_t>(fraction * m_count);
+  if (rank < 1) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    seen += m_buckets[i];
+    if (seen >= rank) {
+      // the bound of the last bucket would overflow, and no value is beyond the largest one
+      uint64_t bound = 0 == i ? 0 : (i < NUM_BUCKETS - 1 ? (uint64_t(1) << i) - 1 : m_max);
+      return bound < m_max ? bound : m_max;
+    }
+  }
+  return m_max;
+}
+
+Metrics::Metrics()
+{
+  m_counters.fill(0);
+}
+
+void
+Metrics::recordRtt(const Name& prefix, const time::nanoseconds& rtt)
+{
+  m_rtts[prefix].add(time::duration_cast<time::microseconds>(rtt).count());
+}
+
+void
+Metrics::recordWriteLatency(const time::nanoseconds& latency)
+{
+  m_writeLatencies.add(time::duration_cast<time::microseconds>(latency).count());
+}
+
+const char*
+Metrics::counterName(Counter counter)
+{
+  switch (counter) {
+    case INTERESTS_SENT:
+      return "interests_sent";
+    case DATA_RECEIVED:
+      return "data_received";
+    case BYTES_RECEIVED:
+      return "bytes_received";
+    case TIMEOUTS:
+      return "timeouts";
+    case NACKS_RECEIVED:
+      return "nacks_received";
+    case BYTES_WRITTEN:
+      return "bytes_written";
+    case INTERESTS_RECEIVED:
+      return "interests_received";
+    case DATA_SERVED:
+      return "data_served";
+    case BYTES_SERVED:
+      return "bytes_served";
+    case NACKS_SENT:
+      return "nacks_sent";
+    case SERVE_CACHE_HITS:
+      return "serve_cache_hits";
+    case SERVE_CACHE_MISSES:
+      return "serve_cache_misses";
+    case PACKETS_READ_AHEAD:
+      return "packets_read_ahead";
+    default:
+      return "unknown";
+  }
+}
+
+// Write the summary of 'histogram' as '<name>_<statistic><label> <value>' lines
+static void
+dumpHistogram(std::ostream& os, const std::string& name, const std::string& label,
+              const Histogram& histogram)
+{
+  os << name << "_count" << label << " " << histogram.count() << "\n"
+     << name << "_sum_us" << label << " " << histogram.sum() << "\n"
+     << name << "_p50_us" << label << " " << histogram.percentile(0.5) << "\n"
+     << name << "_p99_us" << label << " " << histogram.percentile(0.99) << "\n"
+     << name << "_max_us" << label << " " << histogram.max() << "\n";
+}
+
+void
+Metrics::dump(std::ostream& os) const
+{
+  for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+    os << counterName(static_cast<Counter>(i)) << " " << m_counters[i] << "\n";
+  }
+  dumpHistogram(os, "write_latency", "", m_writeLatencies);
+  for (const auto& kv : m_rtts) {
+    dumpHistogram(os, "rtt", "{" + kv.first.toUri() + "}", kv.second);
+  }
+}
+
+} // namespace ntorrent
+} // namespace ndn
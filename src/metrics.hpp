@@ -0,0 +1,239 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_METRICS_HPP
+#define INCLUDED_METRICS_HPP
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/util/time.hpp>
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <unordered_map>
+
+namespace ndn {
+namespace ntorrent {
+
+class Histogram {
+  /**
+   * \class Histogram
+   *
+   * \brief A histogram of values in buckets of exponentially growing width
+   *
+   * Bucket 0 counts the values 0, and bucket i > 0 the values in [2^(i-1), 2^i); the last bucket
+   * also counts the larger values. Adding a value is a few arithmetic operations, so that it may be
+   * done on the hot path.
+   */
+ public:
+  enum {
+    NUM_BUCKETS = 64
+  };
+
+  Histogram();
+
+  /*
+   * @brief Count one occurrence of @p value
+   */
+  void
+  add(uint64_t value);
+
+  /*
+   * @brief Return the upper bound of the bucket holding the @p fraction-th value, e.g. 0.99 for
+   * the 99th percentile, or 0 if there are no values
+   */
+  uint64_t
+  percentile(double fraction) const;
+
+  /*
+   * @brief Return the number of values added
+   */
+  uint64_t
+  count() const;
+
+  /*
+   * @brief Return the sum of the values added
+   */
+  uint64_t
+  sum() const;
+
+  /*
+   * @brief Return the largest value added
+   */
+  uint64_t
+  max() const;
+
+  /*
+   * @brief Return the number of values in each bucket
+   */
+  const std::array<uint64_t, NUM_BUCKETS>&
+  buckets() const;
+
+ private:
+  std::array<uint64_t, NUM_BUCKETS> m_buckets;
+  uint64_t                          m_count;
+  uint64_t                          m_sum;
+  uint64_t                          m_max;
+};
+
+class Metrics {
+  /**
+   * \class Metrics
+   *
+   * \brief The counters and latency histograms of a torrent
+   *
+   * The metrics are updated from the thread processing the events of the face and are only
+   * formatted when they are dumped, so recording them costs an increment or a histogram update.
+   */
+ public:
+  enum Counter {
+    INTERESTS_SENT,
+    DATA_RECEIVED,
+    BYTES_RECEIVED,
+    TIMEOUTS,
+    NACKS_RECEIVED,
+    BYTES_WRITTEN,
+    INTERESTS_RECEIVED,
+    DATA_SERVED,
+    BYTES_SERVED,
+    NACKS_SENT,
+    SERVE_CACHE_HITS,
+    SERVE_CACHE_MISSES,
+    PACKETS_READ_AHEAD,
+    NUM_COUNTERS
+  };
+
+  Metrics();
+
+  /*
+   * @brief Add @p n to @p counter
+   */
+  void
+  increment(Counter counter, uint64_t n = 1);
+
+  /*
+   * @brief Return the value of @p counter
+   */
+  uint64_t
+  get(Counter counter) const;
+
+  /*
+   * @brief Record the RTT @p rtt of an Interest sent through the routable prefix @p prefix
+   */
+  void
+  recordRtt(const Name& prefix, const time::nanoseconds& rtt);
+
+  /*
+   * @brief Record the time @p latency taken to write a data packet from the moment it was received
+   */
+  void
+  recordWriteLatency(const time::nanoseconds& latency);
+
+  /*
+   * @brief Return the RTTs in microseconds of each routable prefix
+   */
+  const std::unordered_map<Name, Histogram>&
+  rtts() const;
+
+  /*
+   * @brief Return the write latencies in microseconds
+   */
+  const Histogram&
+  writeLatencies() const;
+
+  /*
+   * @brief Write the metrics to @p os as one '<name> <value>' line each
+   */
+  void
+  dump(std::ostream& os) const;
+
+  /*
+   * @brief Return the name under which @p counter is dumped
+   */
+  static const char*
+  counterName(Counter counter);
+
+ private:
+  std::array<uint64_t, NUM_COUNTERS>    m_counters;
+  std::unordered_map<Name, Histogram>   m_rtts;
+  Histogram                             m_writeLatencies;
+};
+
+inline
+uint64_t
+Histogram::count() const
+{
+  return m_count;
+}
+
+inline
+uint64_t
+Histogram::sum() const
+{
+  return m_sum;
+}
+
+inline
+uint64_t
+Histogram::max() const
+{
+  return m_max;
+}
+
+inline
+const std::array<uint64_t, Histogram::NUM_BUCKETS>&
+Histogram::buckets() const
+{
+  return m_buckets;
+}
+
+inline
+void
+Metrics::increment(Counter counter, uint64_t n)
+{
+  m_counters[counter] += n;
+}
+
+inline
+uint64_t
+Metrics::get(Counter counter) const
+{
+  return m_counters[counter];
+}
+
+inline
+const std::unordered_map<Name, Histogram>&
+Metrics::rtts() const
+{
+  return m_rtts;
+}
+
+inline
+const Histogram&
+Metrics::writeLatencies() const
+{
+  return m_writeLatencies;
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_METRICS_HPP
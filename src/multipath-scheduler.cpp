@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "multipath-scheduler.hpp"
+
+namespace ndn {
+namespace ntorrent {
+
+MultipathScheduler::MultipathScheduler()
+: m_pending(0)
+{
+}
+
+MultipathScheduler::Path&
+MultipathScheduler::path(const Name& prefix)
+{
+  auto it = m_paths.find(prefix);
+  if (m_paths.end() == it) {
+    it = m_paths.insert({prefix, Path{CongestionWindow(), 0}}).first;
+  }
+  return it->second;
+}
+
+StatsTable::iterator
+MultipathScheduler::select(StatsTable& table, const Name& exclude, bool requireRoom)
+{
+  auto best = table.end();
+  double bestWeight = -1;
+  for (auto it = table.begin(); it != table.end(); ++it) {
+    const auto& prefix = it->getRecordName();
+    if (prefix == exclude) {
+      continue;
+    }
+    auto& p = path(prefix);
+    double window = p.window.getWindow();
+    if (requireRoom && p.pending >= p.window.size()) {
+      continue;
+    }
+    double room = p.pending < window ? (window - p.pending) / window : 0;
+    double weight = (it->getRecordScore() + MIN_SCORE_MICROS / 1e6) * room;
+    if (weight > bestWeight) {
+      best = it;
+      bestWeight = weight;
+    }
+  }
+  if (table.end() == best && !exclude.empty()) {
+    auto it = table.find(exclude);
+    if (table.end() != it && (!requireRoom || path(exclude).pending < path(exclude).window.size())) {
+      best = it;
+    }
+  }
+  return best;
+}
+
+void
+MultipathScheduler::onSent(const Name& prefix)
+{
+  ++path(prefix).pending;
+  ++m_pending;
+}
+
+void
+MultipathScheduler::onData(const Name& prefix)
+{
+  auto& p = path(prefix);
+  if (p.pending > 0) {
+    --p.pending;
+    --m_pending;
+  }
+  p.window.increase();
+}
+
+void
+MultipathScheduler::onLoss(const Name&                          prefix,
+                           const time::steady_clock::TimePoint& now,
+                           const time::nanoseconds&             rtt,
+                           bool                                 congested)
+{
+  auto& p = path(prefix);
+  if (p.pending > 0) {
+    --p.pending;
+    --m_pending;
+  }
+  if (congested) {
+    p.window.decrease(now, rtt);
+  }
+}
+
+size_t
+MultipathScheduler::pending(const Name& prefix) const
+{
+  auto it = m_paths.find(prefix);
+  return m_paths.end() == it ? 0 : it->second.pending;
+}
+
+size_t
+MultipathScheduler::window() const
+{
+  size_t window = 0;
+  for (const auto& kv : m_paths) {
+    window += kv.second.window.size();
+  }
+  return window;
+}
+
+const CongestionWindow*
+MultipathScheduler::getWindow(const Name& prefix) const
+{
+  auto it = m_paths.find(prefix);
+  return m_paths.end() == it ? nullptr : &it->second.window;
+}
+
+} // namespace ntorrent
+} // namespace ndn
@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_MULTIPATH_SCHEDULER_HPP
+#define INCLUDED_MULTIPATH_SCHEDULER_HPP
+
+#include "congestion-window.hpp"
+#include "stats-table.hpp"
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/util/time.hpp>
+
+#include <unordered_map>
+
+namespace ndn {
+namespace ntorrent {
+
+/**
+ * @brief Spreads Interests over all routable prefixes of a stats table
+ *
+ * Every prefix has its own congestion window. Each Interest goes to the prefix with free room in its
+ * window that has the best score weighted by that free room, so the aggregate window grows with the
+ * number of prefixes that answer, and faster prefixes carry a larger share of the Interests.
+ */
+class MultipathScheduler
+{
+public:
+  enum {
+    // Score given to prefixes without measurements, so they are probed once others are busy
+    // (in millionths)
+    MIN_SCORE_MICROS = 1000
+  };
+
+  MultipathScheduler();
+
+  /**
+   * @brief Select the prefix of @p table through which to send the next Interest
+   * @param exclude A prefix not to select unless it is the only one in @p table
+   * @param requireRoom Whether the window of the selected prefix must have free room
+   * @return The selected record, or table.end() if no prefix can be selected
+   */
+  StatsTable::iterator
+  select(StatsTable& table, const Name& exclude = Name(), bool requireRoom = true);
+
+  /**
+   * @brief Account for an Interest sent through @p prefix
+   */
+  void
+  onSent(const Name& prefix);
+
+  /**
+   * @brief Account for an Interest sent through @p prefix that was answered by Data
+   */
+  void
+  onData(const Name& prefix);
+
+  /**
+   * @brief Account for an Interest sent through @p prefix that timed out or was Nacked at time
+   *        @p now; the window of the prefix shrinks if @p congested is true
+   * @param rtt The current RTT estimate of the prefix
+   */
+  void
+  onLoss(const Name&                          prefix,
+         const time::steady_clock::TimePoint& now,
+         const time::nanoseconds&             rtt,
+         bool                                 congested = true);
+
+  /**
+   * @brief Return the number of Interests pending through all prefixes
+   */
+  size_t
+  pending() const;
+
+  /**
+   * @brief Return the number of Interests pending through @p prefix
+   */
+  size_t
+  pending(const Name& prefix) const;
+
+  /**
+   * @brief Return the sum of the windows of all prefixes
+   */
+  size_t
+  window() const;
+
+  /**
+   * @brief Return the congestion window of @p prefix, or nullptr if no Interest was sent through it
+   */
+  const CongestionWindow*
+  getWindow(const Name& prefix) const;
+
+private:
+  struct Path {
+    CongestionWindow window;
+    size_t           pending;
+  };
+
+  Path&
+  path(const Name& prefix);
+
+  std::unordered_map<Name, Path> m_paths;
+  size_t                         m_pending;
+};
+
+inline size_t
+MultipathScheduler::pending() const
+{
+  return m_pending;
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_MULTIPATH_SCHEDULER_HPP
@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "packet-cache.hpp"
+
+namespace ndn {
+namespace ntorrent {
+
+PacketCache::PacketCache(size_t capacity)
+: m_capacity(capacity)
+, m_bytes(0)
+, m_hits(0)
+, m_misses(0)
+{
+}
+
+void
+PacketCache::insert(const Data& data)
+{
+  const auto& fullName = data.getFullName();
+  auto size = data.wireEncode().size();
+  if (size > m_capacity || m_index.end() != m_index.find(fullName)) {
+    return;
+  }
+  while (m_bytes + size > m_capacity) {
+    evict(std::prev(m_entries.end()));
+  }
+  m_entries.push_front(Entry{fullName, make_shared<const Data>(data), size});
+  m_index[fullName] = m_entries.begin();
+  m_bytes += size;
+}
+
+shared_ptr<const Data>
+PacketCache::find(const Name& fullName)
+{
+  auto it = m_index.find(fullName);
+  if (m_index.end() == it) {
+    ++m_misses;
+    return nullptr;
+  }
+  ++m_hits;
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  return it->second->data;
+}
+
+void
+PacketCache::erase(const Name& fullName)
+{
+  auto it = m_index.find(fullName);
+  if (m_index.end() != it) {
+    evict(it->second);
+  }
+}
+
+void
+PacketCache::clear()
+{
+  m_index.clear();
+  m_entries.clear();
+  m_bytes = 0;
+}
+
+void
+PacketCache::evict(EntryList::iterator it)
+{
+  m_bytes -= it->size;
+  m_index.erase(it->fullName);
+  m_entries.erase(it);
+}
+
+} // namespace ntorrent
+} // namespace ndn
@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_PACKET_CACHE_HPP
+#define INCLUDED_PACKET_CACHE_HPP
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/name.hpp>
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace ndn {
+namespace ntorrent {
+
+/**
+ * @brief An LRU cache of signed Data packets keyed by their full name
+ *
+ * The cache is bounded by the total size of the wire encodings it holds. Cached packets keep their
+ * wire encoding, so answering an Interest from the cache neither re-reads nor re-encodes the packet.
+ */
+class PacketCache : noncopyable
+{
+public:
+  enum {
+    // Default capacity in bytes
+    DEFAULT_CAPACITY = 64 * 1024 * 1024
+  };
+
+  /**
+   * @brief Create an empty cache holding at most @p capacity bytes of wire encodings
+   */
+  explicit
+  PacketCache(size_t capacity = DEFAULT_CAPACITY);
+
+  /**
+   * @brief Insert the signed @p data into the cache, evicting the least recently used packets as
+   *        required. Packets larger than the capacity of the cache are not inserted.
+   */
+  void
+  insert(const Data& data);
+
+  /**
+   * @brief Return the cached packet with the specified @p fullName or nullptr if it is not cached
+   */
+  shared_ptr<const Data>
+  find(const Name& fullName);
+
+  /**
+   * @brief Return true if the packet with the specified @p fullName is cached, without counting a
+   *        lookup or refreshing the packet
+   */
+  bool
+  contains(const Name& fullName) const;
+
+  /**
+   * @brief Remove the packet with the specified @p fullName (if cached)
+   */
+  void
+  erase(const Name& fullName);
+
+  /**
+   * @brief Remove all packets from the cache
+   */
+  void
+  clear();
+
+  /**
+   * @brief Return the number of cached packets
+   */
+  size_t
+  size() const;
+
+  /**
+   * @brief Return the total size in bytes of the cached wire encodings
+   */
+  size_t
+  bytes() const;
+
+  /**
+   * @brief Return the capacity of the cache in bytes
+   */
+  size_t
+  capacity() const;
+
+  /**
+   * @brief Return the number of lookups that found a packet
+   */
+  uint64_t
+  hits() const;
+
+  /**
+   * @brief Return the number of lookups that did not find a packet
+   */
+  uint64_t
+  misses() const;
+
+private:
+  struct Entry {
+    Name                   fullName;
+    shared_ptr<const Data> data;
+    size_t                 size;
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  void
+  evict(EntryList::iterator it);
+
+  // Entries ordered from most to least recently used
+  EntryList                                    m_entries;
+  // Index into 'm_entries' by full name
+  std::unordered_map<Name, EntryList::iterator> m_index;
+  size_t                                       m_capacity;
+  size_t                                       m_bytes;
+  uint64_t                                     m_hits;
+  uint64_t                                     m_misses;
+};
+
+inline bool
+PacketCache::contains(const Name& fullName) const
+{
+  return m_index.end() != m_index.find(fullName);
+}
+
+inline size_t
+PacketCache::size() const
+{
+  return m_entries.size();
+}
+
+inline size_t
+PacketCache::bytes() const
+{
+  return m_bytes;
+}
+
+inline size_t
+PacketCache::capacity() const
+{
+  return m_capacity;
+}
+
+inline uint64_t
+PacketCache::hits() const
+{
+  return m_hits;
+}
+
+inline uint64_t
+PacketCache::misses() const
+{
+  return m_misses;
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_PACKET_CACHE_HPP
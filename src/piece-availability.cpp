@@ -0,0 +1,84 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "piece-availability.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+namespace ntorrent {
+
+PieceAvailability::PieceAvailability()
+: m_peers()
+, m_counts()
+{
+}
+
+void
+PieceAvailability::update(const Name& peer, const std::vector<bool>& pieces)
+{
+  erase(peer);
+  if (m_counts.size() < pieces.size()) {
+    m_counts.resize(pieces.size(), 0);
+  }
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    if (pieces[i]) {
+      ++m_counts[i];
+    }
+  }
+  m_peers[peer] = pieces;
+}
+
+void
+PieceAvailability::erase(const Name& peer)
+{
+  auto it = m_peers.find(peer);
+  if (m_peers.end() == it) {
+    return;
+  }
+  const auto& pieces = it->second;
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    if (pieces[i]) {
+      --m_counts[i];
+    }
+  }
+  m_peers.erase(it);
+}
+
+const std::vector<bool>*
+PieceAvailability::find(const Name& peer) const
+{
+  auto it = m_peers.find(peer);
+  return m_peers.end() == it ? nullptr : &it->second;
+}
+
+void
+PieceAvailability::rarestFirst(std::vector<size_t>& pieces, RandomGenerator& rng) const
+{
+  // shuffling first and then sorting stably breaks the ties at random
+  std::shuffle(pieces.begin(), pieces.end(), rng);
+  std::stable_sort(pieces.begin(), pieces.end(), [this] (size_t lhs, size_t rhs) {
+    return count(lhs) < count(rhs);
+  });
+}
+
+} // namespace ntorrent
+} // namespace ndn
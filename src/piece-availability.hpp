@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_PIECE_AVAILABILITY_HPP
+#define INCLUDED_PIECE_AVAILABILITY_HPP
+
+#include <ndn-cxx/name.hpp>
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+
+/**
+ * @brief Counts how many peers advertised each piece of a torrent
+ *
+ * A piece is a file of the torrent, identified by its position in the catalog of the torrent
+ * file. Each peer is identified by the routable prefix through which we reach it, and advertises
+ * the pieces it has completely in its replies to our ALIVE Interests.
+ */
+class PieceAvailability : noncopyable
+{
+public:
+  typedef std::mt19937 RandomGenerator;
+
+  PieceAvailability();
+
+  /**
+   * @brief Replace the pieces advertised by the peer reachable through @p peer with @p pieces
+   *
+   * The i-th element of @p pieces is true if the peer has the i-th piece.
+   */
+  void
+  update(const Name& peer, const std::vector<bool>& pieces);
+
+  /**
+   * @brief Forget the pieces advertised by the peer reachable through @p peer (if any)
+   */
+  void
+  erase(const Name& peer);
+
+  /**
+   * @brief Return the number of peers that advertised the piece at position @p piece
+   */
+  size_t
+  count(size_t piece) const;
+
+  /**
+   * @brief Return the pieces advertised by the peer reachable through @p peer, or nullptr if it
+   * did not advertise any
+   */
+  const std::vector<bool>*
+  find(const Name& peer) const;
+
+  /**
+   * @brief Return the number of peers that advertised their pieces
+   */
+  size_t
+  peers() const;
+
+  /**
+   * @brief Order @p pieces from the least to the most advertised one, breaking ties at random
+   *        with @p rng so that peers with the same view of the swarm request different pieces
+   */
+  void
+  rarestFirst(std::vector<size_t>& pieces, RandomGenerator& rng) const;
+
+private:
+  // The pieces advertised by each peer
+  std::unordered_map<Name, std::vector<bool>> m_peers;
+  // The number of peers that advertised each piece
+  std::vector<size_t>                         m_counts;
+};
+
+inline size_t
+PieceAvailability::peers() const
+{
+  return m_peers.size();
+}
+
+inline size_t
+PieceAvailability::count(size_t piece) const
+{
+  return piece < m_counts.size() ? m_counts[piece] : 0;
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_PIECE_AVAILABILITY_HPP
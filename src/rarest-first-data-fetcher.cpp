@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "rarest-first-data-fetcher.hpp"
+#include "util/logging.hpp"
+#include "util/io-util.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace ndn {
+namespace ntorrent {
+
+RarestFirstDataFetcher::RarestFirstDataFetcher(const ndn::Name&   torrentFileName,
+                                               const std::string& dataPath,
+                                               bool               seed,
+                                               const TorrentManager::Resources& resources)
+  : m_dataPath(dataPath)
+  , m_torrentFileName(torrentFileName)
+  , m_seedFlag(seed)
+  , m_paused(false)
+  , m_filling(false)
+  , m_packetsScheduled(false)
+  , m_pendingManifests(0)
+  , m_outstanding(0)
+  , m_rng(std::random_device()())
+{
+  m_manager = make_shared<TorrentManager>(m_torrentFileName, m_dataPath, seed, resources);
+}
+
+RarestFirstDataFetcher::~RarestFirstDataFetcher()
+{
+}
+
+void
+RarestFirstDataFetcher::start(const time::milliseconds& timeout)
+{
+  this->launch();
+  m_manager->processEvents(timeout);
+}
+
+void
+RarestFirstDataFetcher::launch()
+{
+  m_manager->Initialize();
+  if (!m_manager->hasAllTorrentSegments()) {
+    this->downloadTorrentFile();
+  }
+  else {
+    LOG_INFO <<  m_torrentFileName << " complete";
+    std::vector<ndn::Name> namesToFetch;
+    m_manager->findFileManifestsToDownload(namesToFetch);
+    this->downloadManifestFiles(namesToFetch);
+    if (0 == m_pendingManifests) {
+      this->schedulePackets();
+    }
+  }
+}
+
+void
+RarestFirstDataFetcher::pause()
+{
+  LOG_INFO << "Pausing " << m_torrentFileName;
+  m_paused = true;
+}
+
+void
+RarestFirstDataFetcher::resume()
+{
+  if (!m_paused) {
+    return;
+  }
+  LOG_INFO << "Resuming " << m_torrentFileName;
+  m_paused = false;
+  std::vector<ndn::Name> deferred;
+  deferred.swap(m_deferred);
+  for (const auto& name : deferred) {
+    this->request(name);
+  }
+  this->fillWindow();
+  this->checkComplete();
+}
+
+void
+RarestFirstDataFetcher::downloadTorrentFile()
+{
+  this->request(m_torrentFileName);
+}
+
+void
+RarestFirstDataFetcher::downloadManifestFiles(const std::vector<ndn::Name>& manifestNames)
+{
+  // count them all first, as the manager reports the manifests we already have at once
+  m_pendingManifests += manifestNames.size();
+  for (const auto& name : manifestNames) {
+    this->request(name);
+  }
+}
+
+void
+RarestFirstDataFetcher::downloadPacket(const ndn::Name& packetName)
+{
+  ++m_outstanding;
+  this->request(packetName);
+}
+
+void
+RarestFirstDataFetcher::request(const ndn::Name& name)
+{
+  if (m_paused) {
+    m_deferred.push_back(name);
+    return;
+  }
+  const auto& appPath = m_manager->appDataPath();
+  switch (IoUtil::findType(name)) {
+    case IoUtil::TORRENT_FILE: {
+      m_manager->downloadTorrentFile(appPath + "/torrent_files/",
+                                     bind(&RarestFirstDataFetcher::onTorrentFileSegmentReceived,
+                                          this, _1),
+                                     bind(&RarestFirstDataFetcher::onDataRetrievalFailure,
+                                          this, _1, _2));
+    } break;
+    case IoUtil::FILE_MANIFEST: {
+      m_manager->download_file_manifest(name,
+                                        appPath + "/manifests/",
+                                        bind(&RarestFirstDataFetcher::onManifestReceived, this, _1),
+                                        bind(&RarestFirstDataFetcher::onDataRetrievalFailure,
+                                             this, _1, _2));
+    } break;
+    case IoUtil::DATA_PACKET: {
+      m_manager->download_data_packet(name,
+                                      bind(&RarestFirstDataFetcher::onDataPacketReceived, this, _1),
+                                      bind(&RarestFirstDataFetcher::onDataRetrievalFailure,
+                                           this, _1, _2));
+    } break;
+    default: {
+      // This should never happen
+      LOG_ERROR << "Unknown Packet Type Requested: " << name;
+    } break;
+  }
+}
+
+void
+RarestFirstDataFetcher::schedulePackets()
+{
+  // The packet handles stay valid, as no more manifests are added once they are all downloaded
+  if (m_packetsScheduled) {
+    return;
+  }
+  m_packetsScheduled = true;
+  LOG_INFO << "All manifests complete";
+
+  std::vector<ndn::Name> manifestNames;
+  m_manager->findAllFileManifests(manifestNames);
+  std::vector<size_t> files(manifestNames.size());
+  std::iota(files.begin(), files.end(), 0);
+  const auto& availability = m_manager->getAvailability();
+  availability.rarestFirst(files, m_rng);
+
+  std::vector<TorrentManager::PacketHandle> packets;
+  for (auto file : files) {
+    packets.clear();
+    m_manager->findDataPacketsToDownload(manifestNames[file], packets);
+    std::shuffle(packets.begin(), packets.end(), m_rng);
+    m_scheduled.insert(m_scheduled.end(), packets.begin(), packets.end());
+  }
+  LOG_INFO << "Scheduled " << m_scheduled.size() << " data packets of " << files.size()
+           << " files advertised by " << availability.peers() << " peers";
+  this->fillWindow();
+  this->checkComplete();
+}
+
+void
+RarestFirstDataFetcher::fillWindow()
+{
+  if (m_filling) {
+    return;
+  }
+  m_filling = true;
+  while (!m_paused && m_outstanding < MAX_OUTSTANDING && !m_scheduled.empty()) {
+    auto packet = m_scheduled.front();
+    m_scheduled.pop_front();
+    this->downloadPacket(m_manager->packetName(packet));
+  }
+  m_filling = false;
+}
+
+void
+RarestFirstDataFetcher::checkComplete()
+{
+  if (m_packetsScheduled && !m_paused && 0 == m_outstanding &&
+      m_scheduled.empty() && m_deferred.empty()) {
+    LOG_INFO << "All data complete";
+    if (!m_seedFlag) {
+      m_manager->shutdown();
+    }
+  }
+}
+
+void
+RarestFirstDataFetcher::onDataPacketReceived(const ndn::Name& name)
+{
+  // Data Packet Received
+  LOG_INFO << "Data Packet Received: " << name;
+  m_retryMap.erase(name);
+  --m_outstanding;
+  this->fillWindow();
+  this->checkComplete();
+}
+
+void
+RarestFirstDataFetcher::onTorrentFileSegmentReceived(const std::vector<Name>& manifestNames)
+{
+  LOG_INFO << "Torrent Segment Received: " << m_torrentFileName;
+  this->downloadManifestFiles(manifestNames);
+  if (0 == m_pendingManifests && m_manager->hasAllTorrentSegments()) {
+    this->schedulePackets();
+  }
+}
+
+void
+RarestFirstDataFetcher::onManifestReceived(const std::vector<Name>& packetNames)
+{
+  if (!packetNames.empty()) {
+    LOG_INFO << "Manifest File Received: "
+             << packetNames[0].getSubName(0, packetNames[0].size()- 3);
+  }
+  --m_pendingManifests;
+  if (0 == m_pendingManifests && m_manager->hasAllTorrentSegments()) {
+    this->schedulePackets();
+  }
+}
+
+void
+RarestFirstDataFetcher::onDataRetrievalFailure(const ndn::Name& name,
+                                               const std::string& errorCode)
+{
+  uint32_t nameType = IoUtil::findType(name);
+  // the retry (if any) is accounted for again
+  if (nameType == IoUtil::FILE_MANIFEST) {
+    --m_pendingManifests;
+  }
+  else if (nameType == IoUtil::DATA_PACKET) {
+    --m_outstanding;
+  }
+
+  if (m_retryMap[name] < MAX_RETRIES) {
+    m_retryMap[name]++;
+    if (nameType == IoUtil::TORRENT_FILE) {
+      LOG_ERROR << "Torrent File Segment Downloading Failed: " << name;
+      this->downloadTorrentFile();
+    }
+    else if (nameType == IoUtil::FILE_MANIFEST) {
+      LOG_ERROR << "Manifest File Segment Downloading Failed: " << name;
+      this->downloadManifestFiles({ name });
+    }
+    else if (nameType == IoUtil::DATA_PACKET) {
+      LOG_ERROR << "Data Packet Downloading Failed: " << name;
+      this->downloadPacket(name);
+    }
+    else {
+      // This should never happen
+      LOG_ERROR << "Unknown Packet Type Downloading Failed: " << name;
+    }
+  }
+  else {
+    m_retryMap.erase(name);
+    LOG_INFO << "Giving up on " << name;
+  }
+
+  if (nameType == IoUtil::FILE_MANIFEST) {
+    if (0 == m_pendingManifests && m_manager->hasAllTorrentSegments()) {
+      this->schedulePackets();
+    }
+  }
+  else if (nameType == IoUtil::DATA_PACKET) {
+    this->fillWindow();
+    this->checkComplete();
+  }
+}
+
+} // namespace ntorrent
+} // namespace ndn
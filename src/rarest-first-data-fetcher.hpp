@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef RAREST_FIRST_DATA_FETCHER_HPP
+#define RAREST_FIRST_DATA_FETCHER_HPP
+
+#include "fetching-strategy-manager.hpp"
+#include "piece-availability.hpp"
+#include "torrent-manager.hpp"
+
+#include <ndn-cxx/name.hpp>
+
+#include <deque>
+#include <unordered_map>
+
+namespace ndn {
+namespace ntorrent {
+
+/**
+ * @brief A fetcher that requests the files of a torrent from the least to the most available one
+ *
+ * Once all the file manifests are downloaded, the files are ordered by the number of peers that
+ * advertised them in their ALIVE replies; files with the same availability and the packets of each
+ * file are ordered at random, so that peers request different packets at the same time. Packets
+ * are handed to the torrent manager a window at a time, which lets the downloading be paused.
+ */
+class RarestFirstDataFetcher : public FetchingStrategyManager {
+  public:
+    class Error : public std::runtime_error
+    {
+    public:
+      explicit
+      Error(const std::string& what)
+        : std::runtime_error(what)
+      {
+      }
+    };
+
+    enum
+    {
+      MAX_RETRIES = 5,
+      // Maximum number of data packets handed to the manager and not yet received
+      MAX_OUTSTANDING = 1024
+    };
+
+    /**
+     * @brief Create a new RarestFirstDataFetcher
+     * @param torrentFileName The name of the torrent file
+     * @param dataPath The path that the manager would look for already stored data packets and
+     *                 will write new data packets
+     * @param resources The resources shared with the other torrents hosted by the process, if any
+     */
+    RarestFirstDataFetcher(const ndn::Name&   torrentFileName,
+                           const std::string& dataPath,
+                           bool               seed =  true,
+                           const TorrentManager::Resources& resources = TorrentManager::Resources());
+
+    ~RarestFirstDataFetcher();
+
+    /**
+     * @brief Start the rarest-first data fetcher
+     */
+    void
+    start(const time::milliseconds& timeout = time::milliseconds::zero());
+
+    /**
+     * @brief Initialize the manager and send the first requests, without processing the events
+     * of the face (which is shared with other torrents)
+     */
+    void
+    launch();
+
+    /**
+     * @brief Stop handing new requests to the manager; the pending ones are still completed
+     */
+    void
+    pause();
+
+    /**
+     * @brief Hand the requests deferred since pause() to the manager and continue the downloading
+     */
+    void
+    resume();
+
+    /**
+     * @brief Return true if the downloading is paused
+     */
+    bool
+    isPaused() const;
+
+  protected:
+    void
+    downloadTorrentFile();
+
+    void
+    downloadManifestFiles(const std::vector<ndn::Name>& manifestNames);
+
+    void
+    downloadPacket(const ndn::Name& packetName);
+
+    // Request 'name' (of any type) now, or once resumed if paused
+    void
+    request(const ndn::Name& name);
+
+    // Order the missing data packets of all the files rarest-first
+    void
+    schedulePackets();
+
+    // Hand scheduled packets to the manager until MAX_OUTSTANDING are outstanding
+    void
+    fillWindow();
+
+    void
+    checkComplete();
+
+    virtual void
+    onDataPacketReceived(const ndn::Name& name);
+
+    virtual void
+    onDataRetrievalFailure(const ndn::Name& name, const std::string& errorCode);
+
+    virtual void
+    onManifestReceived(const std::vector<Name>& packetNames);
+
+    virtual void
+    onTorrentFileSegmentReceived(const std::vector<Name>& manifestNames);
+
+  private:
+    std::unordered_map<Name, int> m_retryMap;
+    std::string m_dataPath;
+    ndn::Name m_torrentFileName;
+    shared_ptr<TorrentManager> m_manager;
+    bool m_seedFlag;
+    bool m_paused;
+    // Whether fillWindow() is running, as the manager reports packets we already have at once
+    bool m_filling;
+    // Whether the data packets were ordered, which happens once all manifests are downloaded
+    bool m_packetsScheduled;
+    // Number of file manifests requested but neither received nor given up on
+    size_t m_pendingManifests;
+    // Number of data packets handed to the manager but neither received nor given up on
+    size_t m_outstanding;
+    // The packets still to hand to the manager, rarest first
+    std::deque<TorrentManager::PacketHandle> m_scheduled;
+    // The requests made while paused
+    std::vector<ndn::Name> m_deferred;
+    PieceAvailability::RandomGenerator m_rng;
+};
+
+inline bool
+RarestFirstDataFetcher::isPaused() const
+{
+  return m_paused;
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // RAREST_FIRST_DATA_FETCHER_HPP
@@ -0,0 +1,360 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "resume-journal.hpp"
+
+#include "util/logging.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+#include <sys/stat.h>
+
+namespace ndn {
+namespace ntorrent {
+
+// The journal is a sequence of records in host byte order, following a 5 byte header:
+//
+//   File       ::= 'F' id:u32 length:u16 name:u8[length]
+//   Bitmap     ::= 'B' id:u32 subManifestNum:u32 numBits:u32 bits:u8[(numBits + 7) / 8]
+//   Packet     ::= 'P' id:u32 subManifestNum:u32 packetNum:u32
+//   Checkpoint ::= 'C' id:u32 size:u64 mtime:i64
+static const char MAGIC[] = {'N', 'T', 'R', 'J', 1};
+
+static bool
+statFile(const std::string& filePath, uint64_t& size, int64_t& mtime)
+{
+  struct stat st;
+  if (0 != ::stat(filePath.c_str(), &st)) {
+    return false;
+  }
+  size = st.st_size;
+  mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+  return true;
+}
+
+template<typename T>
+static void
+put(std::ostream& os, T value)
+{
+  os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+static bool
+get(const char*& it, const char* end, T& value)
+{
+  if (static_cast<size_t>(end - it) < sizeof(value)) {
+    return false;
+  }
+  std::memcpy(&value, it, sizeof(value));
+  it += sizeof(value);
+  return true;
+}
+
+ResumeJournal::ResumeJournal()
+: m_appended(0)
+{
+}
+
+ResumeJournal::~ResumeJournal()
+{
+  flush();
+}
+
+bool
+ResumeJournal::open(const std::string& path)
+{
+  if (m_os.is_open()) {
+    m_os.close();
+  }
+  m_path = path;
+  m_files.clear();
+  m_fileNames.clear();
+  load();
+  return compact();
+}
+
+void
+ResumeJournal::load()
+{
+  std::ifstream is(m_path, std::ifstream::binary);
+  if (!is) {
+    return;
+  }
+  std::vector<char> bytes((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+  const char* it = bytes.data();
+  const char* end = it + bytes.size();
+  if (bytes.size() < sizeof(MAGIC) || 0 != std::memcmp(it, MAGIC, sizeof(MAGIC))) {
+    if (!bytes.empty()) {
+      LOG_ERROR << "Discarding unrecognized resume journal " << m_path;
+    }
+    return;
+  }
+  it += sizeof(MAGIC);
+  while (it != end) {
+    char type = *it++;
+    uint32_t id;
+    if (!get(it, end, id) || (type != 'F' && id >= m_fileNames.size())) {
+      break;
+    }
+    if ('F' == type) {
+      uint16_t length;
+      if (!get(it, end, length) || end - it < length || id != m_fileNames.size()) {
+        break;
+      }
+      std::string fileName(it, length);
+      it += length;
+      m_fileNames.push_back(fileName);
+      m_files[fileName] = FileEntry{id, {}, false, 0, 0, false};
+      continue;
+    }
+    auto& e = m_files[m_fileNames[id]];
+    if ('B' == type) {
+      uint32_t subManifestNum, numBits;
+      if (!get(it, end, subManifestNum) || !get(it, end, numBits) ||
+          static_cast<size_t>(end - it) < (numBits + 7) / 8) {
+        break;
+      }
+      auto& bitmap = e.bitmaps[subManifestNum];
+      bitmap.assign(numBits, false);
+      for (uint32_t i = 0; i < numBits; ++i) {
+        bitmap[i] = (it[i / 8] >> (i % 8)) & 1;
+      }
+      it += (numBits + 7) / 8;
+      e.dirty = true;
+    }
+    else if ('P' == type) {
+      uint32_t subManifestNum, packetNum;
+      if (!get(it, end, subManifestNum) || !get(it, end, packetNum)) {
+        break;
+      }
+      auto& bitmap = e.bitmaps[subManifestNum];
+      if (bitmap.size() <= packetNum) {
+        bitmap.resize(packetNum + 1);
+      }
+      bitmap[packetNum] = true;
+      e.dirty = true;
+    }
+    else if ('C' == type) {
+      if (!get(it, end, e.size) || !get(it, end, e.mtime)) {
+        break;
+      }
+      e.hasCheckpoint = true;
+      e.dirty = false;
+    }
+    else {
+      break;
+    }
+  }
+  if (it != end) {
+    LOG_ERROR << "Discarding corrupt tail of resume journal " << m_path;
+  }
+}
+
+bool
+ResumeJournal::compact()
+{
+  if (m_path.empty()) {
+    return false;
+  }
+  if (m_os.is_open()) {
+    m_os.close();
+  }
+  auto tmpPath = m_path + ".tmp";
+  {
+    std::ofstream os(tmpPath, std::ofstream::binary | std::ofstream::trunc);
+    os.write(MAGIC, sizeof(MAGIC));
+    for (const auto& fileName : m_fileNames) {
+      const auto& e = m_files[fileName];
+      writeFileRecord(os, fileName, e);
+      for (const auto& kv : e.bitmaps) {
+        writeBitmapRecord(os, e.id, kv.first, kv.second);
+      }
+      // a file modified after its checkpoint stays untrusted
+      if (e.hasCheckpoint && !e.dirty) {
+        writeCheckpointRecord(os, e);
+      }
+    }
+    if (!os.flush()) {
+      LOG_ERROR << "Failed to write resume journal " << tmpPath;
+      return false;
+    }
+  }
+  if (0 != std::rename(tmpPath.c_str(), m_path.c_str())) {
+    LOG_ERROR << "Failed to replace resume journal " << m_path;
+    return false;
+  }
+  m_appended = 0;
+  m_os.open(m_path, std::ofstream::binary | std::ofstream::app);
+  return m_os.is_open();
+}
+
+bool
+ResumeJournal::isUnchanged(const std::string& fileName, const std::string& filePath) const
+{
+  auto it = m_files.find(fileName);
+  if (m_files.end() == it || !it->second.hasCheckpoint || it->second.dirty) {
+    return false;
+  }
+  uint64_t size;
+  int64_t mtime;
+  return statFile(filePath, size, mtime) && size == it->second.size && mtime == it->second.mtime;
+}
+
+std::vector<bool>
+ResumeJournal::state(const std::string& fileName, size_t subManifestNum, size_t numPackets) const
+{
+  std::vector<bool> bitmap;
+  auto it = m_files.find(fileName);
+  if (m_files.end() != it) {
+    auto bitmap_it = it->second.bitmaps.find(subManifestNum);
+    if (it->second.bitmaps.end() != bitmap_it) {
+      bitmap = bitmap_it->second;
+    }
+  }
+  bitmap.resize(numPackets);
+  return bitmap;
+}
+
+ResumeJournal::FileEntry&
+ResumeJournal::entry(const std::string& fileName)
+{
+  auto it = m_files.find(fileName);
+  if (m_files.end() != it) {
+    return it->second;
+  }
+  auto& e = m_files[fileName];
+  e = FileEntry{static_cast<uint32_t>(m_fileNames.size()), {}, false, 0, 0, false};
+  m_fileNames.push_back(fileName);
+  if (m_os.is_open()) {
+    writeFileRecord(m_os, fileName, e);
+  }
+  return e;
+}
+
+void
+ResumeJournal::setState(const std::string&       fileName,
+                        size_t                   subManifestNum,
+                        const std::vector<bool>& bitmap)
+{
+  if (!m_os.is_open()) {
+    return;
+  }
+  auto& e = entry(fileName);
+  e.bitmaps[subManifestNum] = bitmap;
+  e.dirty = true;
+  writeBitmapRecord(m_os, e.id, subManifestNum, bitmap);
+  appended();
+}
+
+void
+ResumeJournal::recordPacket(const std::string& fileName, size_t subManifestNum, size_t packetNum)
+{
+  if (!m_os.is_open()) {
+    return;
+  }
+  auto& e = entry(fileName);
+  auto& bitmap = e.bitmaps[subManifestNum];
+  if (bitmap.size() <= packetNum) {
+    bitmap.resize(packetNum + 1);
+  }
+  bitmap[packetNum] = true;
+  e.dirty = true;
+  m_os.put('P');
+  put<uint32_t>(m_os, e.id);
+  put<uint32_t>(m_os, subManifestNum);
+  put<uint32_t>(m_os, packetNum);
+  appended();
+}
+
+void
+ResumeJournal::checkpoint(const std::string& fileName, const std::string& filePath)
+{
+  if (!m_os.is_open()) {
+    return;
+  }
+  auto& e = entry(fileName);
+  if (!statFile(filePath, e.size, e.mtime)) {
+    return;
+  }
+  e.hasCheckpoint = true;
+  e.dirty = false;
+  writeCheckpointRecord(m_os, e);
+  appended();
+}
+
+void
+ResumeJournal::flush()
+{
+  if (m_os.is_open()) {
+    m_os.flush();
+  }
+}
+
+void
+ResumeJournal::writeFileRecord(std::ostream& os, const std::string& fileName, const FileEntry& e)
+{
+  os.put('F');
+  put<uint32_t>(os, e.id);
+  put<uint16_t>(os, fileName.size());
+  os.write(fileName.data(), fileName.size());
+}
+
+void
+ResumeJournal::writeBitmapRecord(std::ostream&            os,
+                                 uint32_t                 id,
+                                 size_t                   subManifestNum,
+                                 const std::vector<bool>& bitmap)
+{
+  os.put('B');
+  put<uint32_t>(os, id);
+  put<uint32_t>(os, subManifestNum);
+  put<uint32_t>(os, bitmap.size());
+  std::vector<char> bytes((bitmap.size() + 7) / 8, 0);
+  for (size_t i = 0; i < bitmap.size(); ++i) {
+    if (bitmap[i]) {
+      bytes[i / 8] |= 1 << (i % 8);
+    }
+  }
+  os.write(bytes.data(), bytes.size());
+}
+
+void
+ResumeJournal::writeCheckpointRecord(std::ostream& os, const FileEntry& e)
+{
+  os.put('C');
+  put<uint32_t>(os, e.id);
+  put<uint64_t>(os, e.size);
+  put<int64_t>(os, e.mtime);
+}
+
+void
+ResumeJournal::appended()
+{
+  if (++m_appended >= COMPACTION_INTERVAL) {
+    compact();
+  }
+}
+
+} // namespace ntorrent
+} // namespace ndn
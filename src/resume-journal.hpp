@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_RESUME_JOURNAL_HPP
+#define INCLUDED_RESUME_JOURNAL_HPP
+
+#include <boost/noncopyable.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+
+/**
+ * @brief A persistent record of which Data packets of a torrent have been written to disk
+ *
+ * The journal is an append-only log, written incrementally as packets are stored. It holds
+ * per-sub-manifest bitmaps and, per file, the size and modification time of the file at the last
+ * checkpoint. On restart the bitmaps of a file can be trusted without re-hashing its contents as
+ * long as nothing was recorded for the file after its last checkpoint and the file on disk still
+ * has the checkpointed size and modification time.
+ *
+ * The log is rewritten in compact form when opened and whenever enough records have accumulated.
+ */
+class ResumeJournal : boost::noncopyable
+{
+public:
+  enum {
+    // Number of appended records after which the journal is compacted
+    COMPACTION_INTERVAL = 1 << 20
+  };
+
+  ResumeJournal();
+
+  /**
+   * @brief Flush any buffered records
+   */
+  ~ResumeJournal();
+
+  /**
+   * @brief Load the journal at @p path (if any) and open it for appending
+   * @return True if the journal could be opened for writing, false otherwise.
+   *
+   * A truncated or corrupt tail, e.g. left by a crash, is discarded.
+   */
+  bool
+  open(const std::string& path);
+
+  /**
+   * @brief Return whether the journal is open; when it is not, all updates are ignored
+   */
+  bool
+  isOpen() const;
+
+  /**
+   * @brief Return true if the recorded state for @p fileName can be trusted, i.e. it was
+   *        checkpointed, not modified since, and the file at @p filePath still matches the
+   *        checkpointed size and modification time
+   */
+  bool
+  isUnchanged(const std::string& fileName, const std::string& filePath) const;
+
+  /**
+   * @brief Return the recorded bitmap of sub-manifest @p subManifestNum of @p fileName, resized to
+   *        @p numPackets entries
+   */
+  std::vector<bool>
+  state(const std::string& fileName, size_t subManifestNum, size_t numPackets) const;
+
+  /**
+   * @brief Replace the recorded bitmap of sub-manifest @p subManifestNum of @p fileName
+   */
+  void
+  setState(const std::string& fileName, size_t subManifestNum, const std::vector<bool>& bitmap);
+
+  /**
+   * @brief Record that packet @p packetNum of sub-manifest @p subManifestNum of @p fileName has
+   *        been written to disk
+   */
+  void
+  recordPacket(const std::string& fileName, size_t subManifestNum, size_t packetNum);
+
+  /**
+   * @brief Record the current size and modification time of the file at @p filePath as the
+   *        checkpoint of @p fileName. Should only be called once all writes to it have been synced.
+   */
+  void
+  checkpoint(const std::string& fileName, const std::string& filePath);
+
+  /**
+   * @brief Write any buffered records to disk
+   */
+  void
+  flush();
+
+  /**
+   * @brief Rewrite the journal holding only the current state of each file
+   */
+  bool
+  compact();
+
+private:
+  struct FileEntry {
+    uint32_t                           id;
+    std::map<size_t, std::vector<bool>> bitmaps;
+    bool                               hasCheckpoint;
+    uint64_t                           size;
+    int64_t                            mtime;
+    // Whether the state changed after the last checkpoint
+    bool                               dirty;
+  };
+
+  FileEntry&
+  entry(const std::string& fileName);
+
+  void
+  load();
+
+  // Append the record introducing 'fileName'
+  void
+  writeFileRecord(std::ostream& os, const std::string& fileName, const FileEntry& e);
+
+  void
+  writeBitmapRecord(std::ostream& os, uint32_t id, size_t subManifestNum,
+                    const std::vector<bool>& bitmap);
+
+  void
+  writeCheckpointRecord(std::ostream& os, const FileEntry& e);
+
+  void
+  appended();
+
+  std::string                                  m_path;
+  std::ofstream                                m_os;
+  std::unordered_map<std::string, FileEntry>   m_files;
+  std::vector<std::string>                     m_fileNames;
+  size_t                                       m_appended;
+};
+
+inline bool
+ResumeJournal::isOpen() const
+{
+  return m_os.is_open();
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_RESUME_JOURNAL_HPP
@@ -0,0 +1,70 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "rtt-estimator.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+namespace ntorrent {
+
+static time::nanoseconds
+clampRto(const time::nanoseconds& rto)
+{
+  return std::min<time::nanoseconds>(std::max<time::nanoseconds>(rto,
+                                                                 time::milliseconds(
+                                                                   RttEstimator::MIN_RTO)),
+                                     time::milliseconds(RttEstimator::MAX_RTO));
+}
+
+RttEstimator::RttEstimator()
+: m_srtt(0)
+, m_rttVar(0)
+, m_rto(time::milliseconds(INITIAL_RTO))
+, m_numMeasurements(0)
+{
+}
+
+void
+RttEstimator::addMeasurement(const time::nanoseconds& rtt)
+{
+  if (0 == m_numMeasurements) {
+    m_srtt = rtt;
+    m_rttVar = rtt / 2;
+  }
+  else {
+    auto delta = m_srtt > rtt ? m_srtt - rtt : rtt - m_srtt;
+    // alpha = 1/8, beta = 1/4
+    m_rttVar = (3 * m_rttVar + delta) / 4;
+    m_srtt = (7 * m_srtt + rtt) / 8;
+  }
+  ++m_numMeasurements;
+  m_rto = clampRto(m_srtt + 4 * m_rttVar);
+}
+
+void
+RttEstimator::backoff()
+{
+  m_rto = clampRto(2 * m_rto);
+}
+
+} // namespace ntorrent
+} // namespace ndn
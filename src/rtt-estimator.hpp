@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_RTT_ESTIMATOR_HPP
+#define INCLUDED_RTT_ESTIMATOR_HPP
+
+#include <ndn-cxx/util/time.hpp>
+
+namespace ndn {
+namespace ntorrent {
+
+/**
+ * @brief Estimates the round-trip time of Interests and the retransmission timeout derived from it
+ *
+ * The smoothed RTT and RTT variation are computed as specified by RFC 6298; the retransmission
+ * timeout is used as the lifetime of the Interests we send.
+ */
+class RttEstimator
+{
+public:
+  enum {
+    // Retransmission timeout in milliseconds used until the first RTT has been measured
+    INITIAL_RTO = 2000,
+    // Lower bound on the retransmission timeout in milliseconds
+    MIN_RTO = 200,
+    // Upper bound on the retransmission timeout in milliseconds
+    MAX_RTO = 60000
+  };
+
+  RttEstimator();
+
+  /**
+   * @brief Update the estimates with the RTT @p rtt of an Interest that was answered
+   *
+   * Measurements must only be taken for Interests that were not retransmitted.
+   */
+  void
+  addMeasurement(const time::nanoseconds& rtt);
+
+  /**
+   * @brief Double the retransmission timeout after an Interest timed out
+   */
+  void
+  backoff();
+
+  /**
+   * @brief Return the current retransmission timeout
+   */
+  time::milliseconds
+  getRto() const;
+
+  /**
+   * @brief Return the smoothed RTT, or the retransmission timeout if no RTT has been measured yet
+   */
+  time::nanoseconds
+  getSrtt() const;
+
+  /**
+   * @brief Return the RTT variation
+   */
+  time::nanoseconds
+  getRttVariation() const;
+
+  /**
+   * @brief Return the number of RTTs measured
+   */
+  uint64_t
+  getNumMeasurements() const;
+
+private:
+  time::nanoseconds m_srtt;
+  time::nanoseconds m_rttVar;
+  time::nanoseconds m_rto;
+  uint64_t          m_numMeasurements;
+};
+
+inline time::milliseconds
+RttEstimator::getRto() const
+{
+  return time::duration_cast<time::milliseconds>(m_rto);
+}
+
+inline time::nanoseconds
+RttEstimator::getSrtt() const
+{
+  return 0 == m_numMeasurements ? m_rto : m_srtt;
+}
+
+inline time::nanoseconds
+RttEstimator::getRttVariation() const
+{
+  return m_rttVar;
+}
+
+inline uint64_t
+RttEstimator::getNumMeasurements() const
+{
+  return m_numMeasurements;
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_RTT_ESTIMATOR_HPP
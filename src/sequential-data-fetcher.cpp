@@ -28,12 +28,13 @@ namespace ntorrent {
 
 SequentialDataFetcher::SequentialDataFetcher(const ndn::Name&   torrentFileName,
                                              const std::string& dataPath,
-                                             bool               seed)
+                                             bool               seed,
+                                             const TorrentManager::Resources& resources)
   : m_dataPath(dataPath)
   , m_torrentFileName(torrentFileName)
   , m_seedFlag(seed)
 {
-  m_manager = make_shared<TorrentManager>(m_torrentFileName, m_dataPath, seed);
+  m_manager = make_shared<TorrentManager>(m_torrentFileName, m_dataPath, seed, resources);
 }
 
 SequentialDataFetcher::~SequentialDataFetcher()
@@ -42,11 +43,17 @@ SequentialDataFetcher::~SequentialDataFetcher()
 
 void
 SequentialDataFetcher::start(const time::milliseconds& timeout)
+{
+  this->launch();
+  m_manager->processEvents(timeout);
+}
+
+void
+SequentialDataFetcher::launch()
 {
   m_manager->Initialize();
   // downloading logic
   this->implementSequentialLogic();
-  m_manager->processEvents(timeout);
 }
 
 void
@@ -68,7 +75,7 @@ SequentialDataFetcher::resume()
 void
 SequentialDataFetcher::downloadTorrentFile()
 {
-  auto torrentPath = ".appdata/" + m_torrentFileName.get(-3).toUri() + "/torrent_files/";
+  auto torrentPath = m_manager->appDataPath() + "/torrent_files/";
   m_manager->downloadTorrentFile(torrentPath,
                                  bind(&SequentialDataFetcher::onTorrentFileSegmentReceived, this, _1),
                                  bind(&SequentialDataFetcher::onDataRetrievalFailure, this, _1, _2));
@@ -77,23 +84,26 @@ SequentialDataFetcher::downloadTorrentFile()
 void
 SequentialDataFetcher::downloadManifestFiles(const std::vector<ndn::Name>& manifestNames)
 {
-  auto manifestPath = ".appdata/" + m_torrentFileName.get(-3).toUri() + "/manifests/";
+  auto manifestPath = m_manager->appDataPath() + "/manifests/";
+  // the data packets of each segment are requested on demand as soon as it arrives
+  m_manager->download_missing_data_packets(
+                              bind(&SequentialDataFetcher::onDataPacketReceived, this, _1),
+                              bind(&SequentialDataFetcher::onDataRetrievalFailure, this, _1, _2));
   for (auto i = manifestNames.begin(); i != manifestNames.end(); i++) {
     m_manager->download_file_manifest(*i,
                               manifestPath,
                               bind(&SequentialDataFetcher::onManifestReceived, this, _1),
-                              bind(&SequentialDataFetcher::onDataRetrievalFailure, this, _1, _2));
+                              bind(&SequentialDataFetcher::onDataRetrievalFailure, this, _1, _2),
+                              bind(&SequentialDataFetcher::onManifestSegmentReceived, this, _1));
   }
 }
 
 void
 SequentialDataFetcher::downloadPackets(const std::vector<ndn::Name>& packetsName)
 {
-  for (auto i = packetsName.begin(); i != packetsName.end(); i++) {
-    m_manager->download_data_packet(*i,
+  m_manager->download_data_packets(packetsName,
                               bind(&SequentialDataFetcher::onDataPacketReceived, this, _1),
                               bind(&SequentialDataFetcher::onDataRetrievalFailure, this, _1, _2));
-  }
 }
 
 void
@@ -102,20 +112,22 @@ SequentialDataFetcher::implementSequentialLogic() {
     this->downloadTorrentFile();
   }
   else {
-    LOG_INFO <<  m_torrentFileName << " complete" <<  std::endl;
+    LOG_INFO <<  m_torrentFileName << " complete";
     std::vector<ndn::Name> namesToFetch;
     m_manager->findFileManifestsToDownload(namesToFetch);
     if (!namesToFetch.empty()) {
       this->downloadManifestFiles(namesToFetch);
     }
     else {
-      LOG_INFO << "All manifests complete" <<  std::endl;
-      m_manager->findAllMissingDataPackets(namesToFetch);
-      if (!namesToFetch.empty()) {
-        this->downloadPackets(namesToFetch);
+      LOG_INFO << "All manifests complete";
+      // the names are produced on demand, as the window of the routable prefixes opens
+      if (0 < m_manager->missingDataPackets()) {
+        m_manager->download_missing_data_packets(
+                              bind(&SequentialDataFetcher::onDataPacketReceived, this, _1),
+                              bind(&SequentialDataFetcher::onDataRetrievalFailure, this, _1, _2));
       }
       else {
-        LOG_INFO << "All data complete" <<  std::endl;
+        LOG_INFO << "All data complete";
         if (!m_seedFlag) {
           m_manager->shutdown();
         }
@@ -136,7 +148,7 @@ void
 SequentialDataFetcher::onTorrentFileSegmentReceived(const std::vector<Name>& manifestNames)
 {
   // TODO(msweatt) Add parameter for torrent file
-  LOG_INFO << "Torrent Segment Received: " << m_torrentFileName << std::endl;
+  LOG_INFO << "Torrent Segment Received: " << m_torrentFileName;
   m_retryMap.clear();
   this->downloadManifestFiles(manifestNames);
 }
@@ -144,10 +156,19 @@ SequentialDataFetcher::onTorrentFileSegmentReceived(const std::vector<Name>& man
 void
 SequentialDataFetcher::onManifestReceived(const std::vector<Name>& packetNames)
 {
-  LOG_INFO << "Manifest File Received: "
-            << packetNames[0].getSubName(0, packetNames[0].size()- 3) << std::endl;
+  // the missing packets of the manifest are produced by the manager
+  if (!packetNames.empty()) {
+    LOG_INFO << "Manifest File Received: "
+              << packetNames[0].getSubName(0, packetNames[0].size()- 3);
+  }
+  m_retryMap.clear();
+}
+
+void
+SequentialDataFetcher::onManifestSegmentReceived(const std::vector<Name>& packetNames)
+{
+  // the packets of the segment are produced by the manager as the windows open
   m_retryMap.clear();
-  this->downloadPackets(packetNames);
 }
 
 void
@@ -32,7 +32,7 @@
 namespace ndn {
 namespace ntorrent {
 
-class SequentialDataFetcher : FetchingStrategyManager {
+class SequentialDataFetcher : public FetchingStrategyManager {
   public:
     class Error : public std::runtime_error
 	  {
@@ -48,10 +48,12 @@ class SequentialDataFetcher : FetchingStrategyManager {
      * @param torrentFileName The name of the torrent file
      * @param dataPath The path that the manager would look for already stored data packets and
      *                 will write new data packets
+     * @param resources The resources shared with the other torrents hosted by the process, if any
      */
     SequentialDataFetcher(const ndn::Name&   torrentFileName,
                           const std::string& dataPath,
-                          bool               seed =  true);
+                          bool               seed =  true,
+                          const TorrentManager::Resources& resources = TorrentManager::Resources());
 
     ~SequentialDataFetcher();
 
@@ -61,6 +63,13 @@ class SequentialDataFetcher : FetchingStrategyManager {
     void
     start(const time::milliseconds& timeout = time::milliseconds::zero());
 
+    /**
+     * @brief Initialize the manager and send the first requests, without processing the events
+     * of the face (which is shared with other torrents)
+     */
+    void
+    launch();
+
     /**
      * @brief Pause the sequential data fetcher
      */
@@ -95,6 +104,9 @@ class SequentialDataFetcher : FetchingStrategyManager {
     virtual void
     onManifestReceived(const std::vector<Name>& packetNames);
 
+    void
+    onManifestSegmentReceived(const std::vector<Name>& packetNames);
+
     virtual void
     onTorrentFileSegmentReceived(const std::vector<Name>& manifestNames);
 
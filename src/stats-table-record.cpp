@@ -31,6 +31,11 @@ StatsTableRecord::StatsTableRecord(const Name& recordName)
   , m_sentInterests(0)
   , m_receivedData(0)
   , m_successRate(0)
+  , m_rtt(0)
+  , m_throughput(0)
+  , m_recentTimeouts(0)
+  , m_intervalBytes(0)
+  , m_intervalStart()
 {
 }
 
@@ -39,6 +44,11 @@ StatsTableRecord::StatsTableRecord(const StatsTableRecord& record)
   , m_sentInterests(record.getRecordSentInterests())
   , m_receivedData(record.getRecordReceivedData())
   , m_successRate(record.getRecordSuccessRate())
+  , m_rtt(record.m_rtt)
+  , m_throughput(record.m_throughput)
+  , m_recentTimeouts(record.m_recentTimeouts)
+  , m_intervalBytes(record.m_intervalBytes)
+  , m_intervalStart(record.m_intervalStart)
 {
 }
 
@@ -59,6 +69,46 @@ StatsTableRecord::incrementReceivedData()
   m_successRate = m_receivedData / float(m_sentInterests);
 }
 
+double
+StatsTableRecord::getRecordScore() const
+{
+  time::nanoseconds rtt = m_rtt > time::nanoseconds::zero() ? m_rtt
+                                                            : time::milliseconds(DEFAULT_RTT);
+  double rttSeconds = rtt.count() / 1e9;
+  return m_successRate / rttSeconds / (1 + m_recentTimeouts);
+}
+
+void
+StatsTableRecord::recordRtt(const time::nanoseconds& rtt)
+{
+  // alpha = 1/8, as for the SRTT of RFC 6298
+  m_rtt = m_rtt > time::nanoseconds::zero() ? (7 * m_rtt + rtt) / 8 : rtt;
+  m_recentTimeouts = m_recentTimeouts * 7 / 8;
+}
+
+void
+StatsTableRecord::recordReceivedBytes(size_t bytes, const time::steady_clock::TimePoint& now)
+{
+  if (time::steady_clock::TimePoint() == m_intervalStart) {
+    m_intervalStart = now;
+  }
+  m_intervalBytes += bytes;
+  time::nanoseconds elapsed = now - m_intervalStart;
+  if (elapsed < time::milliseconds(THROUGHPUT_INTERVAL)) {
+    return;
+  }
+  double sample = m_intervalBytes / (elapsed.count() / 1e9);
+  m_throughput = m_throughput > 0 ? (3 * m_throughput + sample) / 4 : sample;
+  m_intervalBytes = 0;
+  m_intervalStart = now;
+}
+
+void
+StatsTableRecord::incrementTimeouts()
+{
+  m_recentTimeouts += 1;
+}
+
 StatsTableRecord&
 StatsTableRecord::operator=(const StatsTableRecord& other)
 {
@@ -66,6 +116,11 @@ StatsTableRecord::operator=(const StatsTableRecord& other)
   m_sentInterests = other.getRecordSentInterests();
   m_receivedData = other.getRecordReceivedData();
   m_successRate = other.getRecordSuccessRate();
+  m_rtt = other.m_rtt;
+  m_throughput = other.m_throughput;
+  m_recentTimeouts = other.m_recentTimeouts;
+  m_intervalBytes = other.m_intervalBytes;
+  m_intervalStart = other.m_intervalStart;
   return (*this);
 }
 
@@ -19,7 +19,11 @@
 * See AUTHORS for complete list of nTorrent authors and contributors.
 */
 
+#ifndef INCLUDED_STATS_TABLE_RECORD_HPP
+#define INCLUDED_STATS_TABLE_RECORD_HPP
+
 #include <ndn-cxx/name.hpp>
+#include <ndn-cxx/util/time.hpp>
 
 namespace ndn {
 namespace ntorrent {
@@ -29,6 +33,13 @@ namespace ntorrent {
  */
 class StatsTableRecord {
 public:
+  enum {
+    // Length in milliseconds of the intervals over which throughput samples are taken
+    THROUGHPUT_INTERVAL = 1000,
+    // RTT in milliseconds assumed for scoring a record before its RTT has been measured
+    DEFAULT_RTT = 2000
+  };
+
   class Error : public std::runtime_error
   {
   public:
@@ -94,6 +105,55 @@ public:
   void
   incrementReceivedData();
 
+  /**
+   * @brief Get the smoothed RTT of the Interests sent through this prefix, or zero if no RTT has
+   *        been measured yet
+   */
+  time::nanoseconds
+  getRecordRtt() const;
+
+  /**
+   * @brief Get the smoothed rate in bytes per second of the Data received through this prefix
+   */
+  double
+  getRecordThroughput() const;
+
+  /**
+   * @brief Get the number of recent timeouts; each Data packet received decays it by a factor
+   *        of 7/8
+   */
+  double
+  getRecordRecentTimeouts() const;
+
+  /**
+   * @brief Get the score of a record, which estimates the rate of Data packets we can retrieve
+   *        per pending Interest through this prefix
+   *
+   * The score is the success rate divided by the RTT in seconds, discounted by the recent
+   * timeouts.
+   */
+  double
+  getRecordScore() const;
+
+  /**
+   * @brief Update the smoothed RTT with the RTT @p rtt of an Interest answered through this prefix
+   *        and decay the recent timeouts
+   */
+  void
+  recordRtt(const time::nanoseconds& rtt);
+
+  /**
+   * @brief Account for @p bytes of Data received through this prefix at time @p now
+   */
+  void
+  recordReceivedBytes(size_t bytes, const time::steady_clock::TimePoint& now);
+
+  /**
+   * @brief Account for an Interest sent through this prefix that timed out
+   */
+  void
+  incrementTimeouts();
+
   /**
    * @brief Assignment operator
    */
@@ -105,6 +165,12 @@ private:
   uint64_t m_sentInterests;
   uint64_t m_receivedData;
   double m_successRate;
+  time::nanoseconds m_rtt;
+  double m_throughput;
+  double m_recentTimeouts;
+  // The bytes received since the start of the current throughput interval
+  uint64_t m_intervalBytes;
+  time::steady_clock::TimePoint m_intervalStart;
 };
 
 /**
@@ -143,6 +209,26 @@ StatsTableRecord::getRecordSuccessRate() const
   return m_successRate;
 }
 
+inline time::nanoseconds
+StatsTableRecord::getRecordRtt() const
+{
+  return m_rtt;
+}
+
+inline double
+StatsTableRecord::getRecordThroughput() const
+{
+  return m_throughput;
+}
+
+inline double
+StatsTableRecord::getRecordRecentTimeouts() const
+{
+  return m_recentTimeouts;
+}
+
 
 }  // namespace ntorrent
 }  // namespace ndn
+
+#endif // INCLUDED_STATS_TABLE_RECORD_HPP
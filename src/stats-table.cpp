@@ -32,41 +32,49 @@ StatsTable::StatsTable(const Name& torrentName)
 void
 StatsTable::insert(const Name& prefix)
 {
+  m_index.emplace(prefix, m_statsTable.size());
   m_statsTable.push_back(StatsTableRecord(prefix));
 }
 
 StatsTable::const_iterator
 StatsTable::find(const Name& prefix) const
 {
-  for (auto i = m_statsTable.begin(); i != m_statsTable.end(); ++i) {
-    if (i->getRecordName() == prefix) {
-      return i;
-    }
+  auto it = m_index.find(prefix);
+  if (m_index.end() == it) {
+    return StatsTable::end();
   }
-  return StatsTable::end();
+  return m_statsTable.begin() + it->second;
 }
 
 StatsTable::iterator
 StatsTable::find(const Name& prefix)
 {
-  for (auto i = m_statsTable.begin(); i != m_statsTable.end(); ++i) {
-    if (i->getRecordName() == prefix) {
-      return i;
-    }
+  auto it = m_index.find(prefix);
+  if (m_index.end() == it) {
+    return StatsTable::end();
   }
-  return StatsTable::end();
+  return m_statsTable.begin() + it->second;
 }
 
 bool
 StatsTable::erase(const Name& prefix)
 {
-  for (auto i = m_statsTable.begin(); i != m_statsTable.end(); ++i) {
-    if (i->getRecordName() == prefix) {
-        m_statsTable.erase(i);
-        return true;
-    }
+  auto it = m_index.find(prefix);
+  if (m_index.end() == it) {
+    return false;
+  }
+  m_statsTable.erase(m_statsTable.begin() + it->second);
+  reindex();
+  return true;
+}
+
+void
+StatsTable::reindex()
+{
+  m_index.clear();
+  for (size_t i = 0; i < m_statsTable.size(); ++i) {
+    m_index.emplace(m_statsTable[i].getRecordName(), i);
   }
-  return false;
 }
 
 }  // namespace ntorrent
@@ -19,8 +19,12 @@
 * See AUTHORS for complete list of nTorrent authors and contributors.
 */
 
+#ifndef INCLUDED_STATS_TABLE_HPP
+#define INCLUDED_STATS_TABLE_HPP
+
 #include "stats-table-record.hpp"
 
+#include <unordered_map>
 #include <vector>
 
 namespace ndn {
@@ -28,6 +32,10 @@ namespace ntorrent {
 
 /**
  * @brief Represents a stats table
+ *
+ * The records are kept in a vector, in the order they were inserted or sorted, and indexed by
+ * routable prefix so that 'find' does not scan the table. If a prefix is inserted more than once,
+ * 'find' and 'erase' refer to its first record.
  */
 class StatsTable {
 public:
@@ -122,6 +130,20 @@ public:
     {return left.getRecordSuccessRate() >= right.getRecordSuccessRate();}
   };
 
+  /**
+   * @brief Comparator ordering the records on descending score, i.e. on the rate at which they
+   *        are expected to deliver Data, and then on descending throughput
+   */
+  struct scoreComparator {
+    bool operator() (const StatsTableRecord& left, const StatsTableRecord& right) const
+    {
+      if (left.getRecordScore() != right.getRecordScore()) {
+        return left.getRecordScore() > right.getRecordScore();
+      }
+      return left.getRecordThroughput() > right.getRecordThroughput();
+    }
+  };
+
   /**
    * @brief Sort the records of the stats table on desceding success rate
    * @param comp Optional comparator function to be used for sorting.
@@ -133,9 +155,16 @@ public:
   void
   sort(std::function<bool(const StatsTableRecord&, const StatsTableRecord&)> comp = comparator());
 
+private:
+  // Rebuild 'm_index' after the records were moved
+  void
+  reindex();
+
 private:
   // Set of StatsTableRecords
   std::vector<StatsTableRecord> m_statsTable;
+  // The position in 'm_statsTable' of the first record of each prefix
+  std::unordered_map<Name, size_t> m_index;
   Name m_torrentName;
 };
 
@@ -143,6 +172,7 @@ inline void
 StatsTable::clear()
 {
   m_statsTable.clear();
+  m_index.clear();
 }
 
 inline size_t
@@ -179,7 +209,10 @@ inline void
 StatsTable::sort(std::function<bool(const StatsTableRecord&, const StatsTableRecord&)> comp)
 {
   std::sort(m_statsTable.begin(), m_statsTable.end(), comp);
+  reindex();
 }
 
 }  // namespace ntorrent
 }  // namespace ndn
+
+#endif // INCLUDED_STATS_TABLE_HPP
@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "torrent-daemon.hpp"
+
+#include "rarest-first-data-fetcher.hpp"
+#include "sequential-data-fetcher.hpp"
+#include "util/logging.hpp"
+
+namespace ndn {
+namespace ntorrent {
+
+TorrentDaemon::TorrentDaemon(size_t windowBudget, size_t seedThreads, std::shared_ptr<Face> face)
+: m_resources()
+{
+  m_resources.face = nullptr != face ? face : make_shared<Face>();
+  m_resources.keyChain = make_shared<KeyChain>();
+  m_resources.writer = make_shared<AsyncWriter>(m_resources.face->getIoService());
+  m_resources.budget = make_shared<WindowBudget>(windowBudget);
+  m_resources.seedWorkers = make_shared<ThreadPool>(0 < seedThreads
+                                                    ? seedThreads
+                                                    : ThreadPool::hardwareConcurrency());
+  // bounded across the torrents, which would otherwise each map and cache as many
+  m_resources.packetCache = make_shared<PacketCache>();
+  m_resources.fileMappings = make_shared<FileMapCache>();
+}
+
+void
+TorrentDaemon::add(const Name&        torrentFileName,
+                   const std::string& dataPath,
+                   bool               seed,
+                   const std::string& strategy)
+{
+  std::unique_ptr<FetchingStrategyManager> fetcher;
+  if ("sequential" == strategy) {
+    fetcher.reset(new SequentialDataFetcher(torrentFileName, dataPath, seed, m_resources));
+  }
+  else if ("rarest-first" == strategy) {
+    fetcher.reset(new RarestFirstDataFetcher(torrentFileName, dataPath, seed, m_resources));
+  }
+  else {
+    BOOST_THROW_EXCEPTION(Error("Unsupported strategy: " + strategy));
+  }
+  LOG_INFO << "Hosting " << torrentFileName << " at " << dataPath;
+  fetcher->launch();
+  m_fetchers.push_back(std::move(fetcher));
+}
+
+void
+TorrentDaemon::run(const time::milliseconds& timeout)
+{
+  m_resources.face->processEvents(timeout);
+}
+
+} // namespace ntorrent
+} // namespace ndn
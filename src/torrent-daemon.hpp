@@ -0,0 +1,175 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_TORRENT_DAEMON_HPP
+#define INCLUDED_TORRENT_DAEMON_HPP
+
+#include "fetching-strategy-manager.hpp"
+#include "torrent-manager.hpp"
+
+#include <ndn-cxx/face.hpp>
+#include <ndn-cxx/name.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+
+class TorrentDaemon : boost::noncopyable {
+  /**
+   * \class TorrentDaemon
+   *
+   * \brief Hosts many torrents in one process
+   *
+   * All the torrents share a single face, key chain, writer of the received data packets, pool of
+   * threads reading the served ones, cache of packets and of file mappings, and a budget of
+   * outstanding Interests that each torrent with Interests to send gets a fair share of. A torrent that completes and does not seed shuts down
+   * without stopping the others.
+   */
+ public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  enum {
+    // Default number of Interests outstanding across all the torrents
+    DEFAULT_WINDOW_BUDGET = 4096
+  };
+
+  /*
+   * @brief Create a daemon without torrents
+   * @param windowBudget The maximum number of Interests outstanding across all the torrents
+   * @param seedThreads The number of threads reading the served data packets (0 for one per core)
+   * @param face Optional face object shared by the torrents
+   */
+  explicit
+  TorrentDaemon(size_t                windowBudget = DEFAULT_WINDOW_BUDGET,
+                size_t                seedThreads = 0,
+                std::shared_ptr<Face> face = nullptr);
+
+  /*
+   * @brief Host the torrent whose torrent file's initial segment is @p torrentFileName
+   * @param dataPath The path to the location on disk to use for the torrent data
+   * @param seed Whether to continue seeding after the download completes
+   * @param strategy The fetching strategy: "sequential" or "rarest-first"
+   * Start downloading (or seeding) the torrent at once, its events are processed by run(). Throw
+   * Error if @p strategy is not supported.
+   */
+  void
+  add(const Name&        torrentFileName,
+      const std::string& dataPath,
+      bool               seed = true,
+      const std::string& strategy = "sequential");
+
+  /*
+   * @brief Log the metrics of each torrent added from now on every @p interval, or never if zero
+   */
+  void
+  setMetricsInterval(const time::milliseconds& interval);
+
+  /*
+   * @brief Keep at most about @p bytes of file manifests in memory for each torrent added from now
+   *        on, or any number if zero (see TorrentManager::setMemoryBudget())
+   */
+  void
+  setMemoryBudget(size_t bytes);
+
+  /*
+   * @brief Have at most @p maxPendingInterests Interests outstanding for each torrent added from
+   *        now on, or any number if zero
+   */
+  void
+  setMaxPendingInterests(size_t maxPendingInterests);
+
+  /*
+   * @brief Process the events of all the torrents for @p timeout, or until stopped if zero
+   */
+  void
+  run(const time::milliseconds& timeout = time::milliseconds::zero());
+
+  /*
+   * @brief Return the number of hosted torrents
+   */
+  size_t
+  size() const;
+
+  /*
+   * @brief Return the resources shared by the hosted torrents
+   */
+  const TorrentManager::Resources&
+  resources() const;
+
+ private:
+  // Declared first, as the managers of the fetchers leave the budget when destroyed
+  TorrentManager::Resources                              m_resources;
+  std::vector<std::unique_ptr<FetchingStrategyManager>>  m_fetchers;
+};
+
+inline
+size_t
+TorrentDaemon::size() const
+{
+  return m_fetchers.size();
+}
+
+inline
+void
+TorrentDaemon::setMetricsInterval(const time::milliseconds& interval)
+{
+  m_resources.metricsInterval = interval;
+}
+
+inline
+void
+TorrentDaemon::setMemoryBudget(size_t bytes)
+{
+  m_resources.memoryBudget = bytes;
+}
+
+inline
+void
+TorrentDaemon::setMaxPendingInterests(size_t maxPendingInterests)
+{
+  m_resources.maxPendingInterests = maxPendingInterests;
+}
+
+inline
+const TorrentManager::Resources&
+TorrentDaemon::resources() const
+{
+  return m_resources;
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_TORRENT_DAEMON_HPP
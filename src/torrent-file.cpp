@@ -20,13 +20,17 @@
 */
 
 #include "torrent-file.hpp"
+#include "util/digest-signer.hpp"
 #include "util/io-util.hpp"
 #include "util/shared-constants.hpp"
+#include "util/thread-pool.hpp"
 
-#include <ndn-cxx/security/key-chain.hpp>
-#include <ndn-cxx/security/signing-helpers.hpp>
+#include <ndn-cxx/util/sha256.hpp>
 
 #include <algorithm>
+#include <functional>
+#include <limits>
+#include <set>
 
 #include <boost/range/adaptors.hpp>
 #include <boost/filesystem.hpp>
@@ -86,9 +90,10 @@ TorrentFile::getTorrentFilePtr() const
 void
 TorrentFile::constructLongNames()
 {
-  for (auto i = m_suffixCatalog.begin(); i != m_suffixCatalog.end(); ++i) {
-      Name commonPrefix = m_commonPrefix;
-      m_catalog.push_back(commonPrefix.append((*i)));
+  m_catalog.reserve(m_catalog.size() + m_suffixCatalog.size());
+  for (const auto& suffix : m_suffixCatalog) {
+    m_catalog.push_back(m_commonPrefix);
+    m_catalog.back().append(suffix);
   }
 }
 
@@ -230,6 +235,64 @@ TorrentFile::finalize()
   m_suffixCatalog.clear();
 }
 
+// Return the paths of all the files under 'directoryPath', sorted lexicographically
+static std::set<std::string>
+findFileNames(const std::string& directoryPath)
+{
+  std::set<std::string> fileNames;
+  Io::recursive_directory_iterator directoryPtr(fs::system_complete(directoryPath).string());
+  for (auto i = directoryPtr; i != Io::recursive_directory_iterator(); ++i) {
+    fileNames.insert(i->path().string());
+  }
+  return fileNames;
+}
+
+static std::vector<std::pair<std::vector<FileManifest>, std::vector<Data>>>
+generateManifests(const std::set<std::string>& fileNames,
+                  const Name&                  manifestPrefix,
+                  size_t                       subManifestSize,
+                  size_t                       dataPacketSize,
+                  bool                         returnData,
+                  size_t                       jobs)
+{
+  std::vector<std::pair<std::vector<FileManifest>, std::vector<Data>>> manifestPairs;
+  manifestPairs.reserve(fileNames.size());
+  // The Data packets of each sub-manifest of each file, if requested
+  std::vector<std::vector<std::vector<Data>>> packets(fileNames.size());
+  ThreadPool pool(jobs);
+  // Populate every sub-manifest of every file concurrently
+  for (const auto& fileName : fileNames) {
+    auto manifests = FileManifest::create_submanifests(fileName, manifestPrefix,
+                                                       subManifestSize, dataPacketSize);
+    manifestPairs.emplace_back(std::move(manifests), std::vector<Data>());
+    auto& filePackets = packets[manifestPairs.size() - 1];
+    auto& fileManifests = manifestPairs.back().first;
+    filePackets.resize(returnData ? fileManifests.size() : 0);
+    for (size_t i = 0; i < fileManifests.size(); ++i) {
+      auto manifest_ptr = &fileManifests[i];
+      auto packets_ptr = returnData ? &filePackets[i] : nullptr;
+      pool.post([=, &fileName] {
+        manifest_ptr->fill_catalog(fileName, subManifestSize, packets_ptr);
+      });
+    }
+  }
+  pool.wait();
+  // Chain and sign the sub-manifests of each file, starting from the last
+  for (size_t i = 0; i < manifestPairs.size(); ++i) {
+    auto& manifestPair = manifestPairs[i];
+    auto& filePackets = packets[i];
+    pool.post([&manifestPair, &filePackets] {
+      FileManifest::link_submanifests(manifestPair.first);
+      for (auto& p : filePackets) {
+        manifestPair.second.insert(manifestPair.second.end(), p.begin(), p.end());
+        std::vector<Data>().swap(p);
+      }
+    });
+  }
+  pool.wait();
+  return manifestPairs;
+}
+
 std::pair<std::vector<TorrentFile>,
           std::vector<std::pair<std::vector<FileManifest>,
                                 std::vector<Data>>>>
@@ -237,7 +300,9 @@ TorrentFile::generate(const std::string& directoryPath,
                       size_t namesPerSegment,
                       size_t subManifestSize,
                       size_t dataPacketSize,
-                      bool returnData)
+                      bool returnData,
+                      size_t jobs,
+                      GenerationCache* cache)
 {
   //TODO(spyros) Adapt this support subdirectories in 'directoryPath'
   BOOST_ASSERT(0 < namesPerSegment);
@@ -250,7 +315,6 @@ TorrentFile::generate(const std::string& directoryPath,
   }
 
   Name directoryPathName(directoryPath);
-  Io::recursive_directory_iterator directoryPtr(fs::system_complete(directoryPath).string());
 
   std::string prefix = std::string(SharedConstants::commonPrefix) + "/NTORRENT";
   Name commonPrefix(prefix +
@@ -259,44 +323,67 @@ TorrentFile::generate(const std::string& directoryPath,
   Name torrentName(commonPrefix.toUri() + "/torrent-file");
   TorrentFile currentTorrentFile(torrentName, commonPrefix, {});
   std::vector<std::pair<std::vector<FileManifest>, std::vector<Data>>> manifestPairs;
-  // sort all the file names lexicographically
-  std::set<std::string> fileNames;
-  for (auto i = directoryPtr; i != Io::recursive_directory_iterator(); ++i) {
-    fileNames.insert(i->path().string());
+  auto fileNames = findFileNames(directoryPath);
+  Name manifestPrefix(prefix +
+                      directoryPathName.getSubName(directoryPathName.size() - 1).toUri());
+  // The full name of the first sub-manifest of each file, taken from 'cache' for the files that
+  // did not change since they were recorded, which are left out of 'changedFileNames'
+  std::vector<Name> initialNames;
+  initialNames.reserve(fileNames.size());
+  std::set<std::string> changedFileNames;
+  for (const auto& fileName : fileNames) {
+    auto cachedName = nullptr != cache ? cache->lookup(fileName) : nullptr;
+    initialNames.push_back(nullptr != cachedName ? *cachedName : Name());
+    if (nullptr == cachedName) {
+      changedFileNames.insert(fileName);
+    }
+  }
+  if (jobs > 1) {
+    manifestPairs = generateManifests(changedFileNames, manifestPrefix, subManifestSize,
+                                      dataPacketSize, returnData, jobs);
+  }
+  else {
+    for (const auto& fileName : changedFileNames) {
+      manifestPairs.push_back(FileManifest::generate(fileName, manifestPrefix, subManifestSize,
+                                                     dataPacketSize, returnData));
+    }
+  }
+  auto manifestPair = manifestPairs.begin();
+  auto fileName = fileNames.begin();
+  for (auto& initialName : initialNames) {
+    if (initialName.empty()) {
+      initialName = manifestPair->first[0].getFullName();
+      if (nullptr != cache) {
+        cache->insert(*fileName, initialName);
+      }
+      manifestPair->first.shrink_to_fit();
+      manifestPair->second.shrink_to_fit();
+      ++manifestPair;
+    }
+    ++fileName;
   }
   size_t manifestFileCounter = 0u;
-  for (const auto& fileName : fileNames) {
-    Name manifestPrefix(prefix +
-                        directoryPathName.getSubName(directoryPathName.size() - 1).toUri());
-    std::pair<std::vector<FileManifest>, std::vector<Data>> currentManifestPair =
-                                                    FileManifest::generate(fileName,
-                                                    manifestPrefix, subManifestSize,
-                                                    dataPacketSize, returnData);
-
+  for (const auto& initialName : initialNames) {
     if (manifestFileCounter != 0 && 0 == manifestFileCounter % namesPerSegment) {
       torrentSegments.push_back(currentTorrentFile);
       Name currentTorrentName = torrentName;
       currentTorrentName.appendSequenceNumber(static_cast<int>(manifestFileCounter));
       currentTorrentFile = TorrentFile(currentTorrentName, commonPrefix, {});
     }
-    currentTorrentFile.insert(currentManifestPair.first[0].getFullName());
-    currentManifestPair.first.shrink_to_fit();
-    currentManifestPair.second.shrink_to_fit();
-    manifestPairs.push_back(currentManifestPair);
+    currentTorrentFile.insert(initialName);
     ++manifestFileCounter;
   }
 
   // Sign and append the last torrent-file
-  security::KeyChain keyChain;
   currentTorrentFile.finalize();
-  keyChain.sign(currentTorrentFile, signingWithSha256());
+  DigestSigner::sign(currentTorrentFile);
   torrentSegments.push_back(currentTorrentFile);
 
   for (auto it = torrentSegments.rbegin() + 1; it != torrentSegments.rend(); ++it) {
     auto next = it - 1;
     it->setTorrentFilePtr(next->getFullName());
     it->finalize();
-    keyChain.sign(*it, signingWithSha256());
+    DigestSigner::sign(*it);
   }
 
   torrentSegments.shrink_to_fit();
@@ -304,6 +391,99 @@ TorrentFile::generate(const std::string& directoryPath,
   return std::make_pair(torrentSegments, manifestPairs);
 }
 
+// Return the largest number of entries for which 'encodedSize' (which increases with the number
+// of entries) is at most 'maxPacketSize', or 0 if not even one entry fits
+static size_t
+fitEntries(size_t maxPacketSize, const std::function<size_t(size_t)>& encodedSize)
+{
+  auto sizeOfOne = encodedSize(1);
+  if (sizeOfOne > maxPacketSize) {
+    return 0;
+  }
+  // estimate from the size of each entry, then drop the entries that still do not fit, as the
+  // TLV lengths grow with the number of entries
+  auto entrySize = std::max<size_t>(1, encodedSize(2) - sizeOfOne);
+  size_t count = 1 + (maxPacketSize - sizeOfOne) / entrySize;
+  for (auto size = encodedSize(count); size > maxPacketSize; size = encodedSize(count)) {
+    count = std::max<size_t>(1, count - std::max<size_t>(1, (size - maxPacketSize) / entrySize));
+  }
+  return count;
+}
+
+TorrentFile::PacketSizes
+TorrentFile::fitPacketSizes(const std::string& directoryPath,
+                            const PacketSizes& requested,
+                            size_t maxPacketSize)
+{
+  fs::path path(directoryPath);
+  if (!Io::exists(path)) {
+    BOOST_THROW_EXCEPTION(Error(directoryPath + ": no such directory."));
+  }
+  Name directoryPathName(directoryPath);
+  Name commonPrefix(std::string(SharedConstants::commonPrefix) + "/NTORRENT" +
+                    directoryPathName.getSubName(directoryPathName.size() - 1).toUri());
+  // the file with the longest name has the largest packets
+  Name manifestName;
+  for (const auto& fileName : findFileNames(directoryPath)) {
+    auto name = FileManifest::manifest_name(fileName, commonPrefix);
+    if (name.wireEncode().size() > manifestName.wireEncode().size()) {
+      manifestName = name;
+    }
+  }
+  // the largest sequence numbers of the sub-manifests, data packets and torrent-file segments
+  const uint64_t maxSequenceNumber = std::numeric_limits<uint32_t>::max();
+  const std::vector<uint8_t> digest(util::Sha256::DIGEST_SIZE);
+  manifestName.appendSequenceNumber(maxSequenceNumber);
+  auto manifestFullName = Name(manifestName).appendImplicitSha256Digest(digest.data(),
+                                                                        digest.size());
+  auto packetName = Name(manifestName).appendSequenceNumber(maxSequenceNumber);
+
+  PacketSizes sizes = requested;
+  if (0 == sizes.dataPacketSize) {
+    sizes.dataPacketSize = fitEntries(maxPacketSize, [&packetName] (size_t contentSize) {
+      std::vector<uint8_t> content(contentSize);
+      Data packet(packetName);
+      packet.setContent(encoding::makeBinaryBlock(tlv::Content, content.data(), content.size()));
+      DigestSigner::sign(packet);
+      return packet.wireEncode().size();
+    });
+    if (sizes.dataPacketSize >= PACKET_SIZE_ALIGNMENT) {
+      sizes.dataPacketSize -= sizes.dataPacketSize % PACKET_SIZE_ALIGNMENT;
+    }
+  }
+  if (0 == sizes.subManifestSize && 0 < sizes.dataPacketSize) {
+    auto packetFullName = Name(packetName).appendImplicitSha256Digest(digest.data(),
+                                                                      digest.size());
+    auto dataPacketSize = sizes.dataPacketSize;
+    sizes.subManifestSize = fitEntries(maxPacketSize, [&] (size_t numNames) {
+      FileManifest manifest(manifestName, dataPacketSize, commonPrefix,
+                            std::vector<Name>(numNames, packetFullName),
+                            make_shared<Name>(manifestFullName));
+      manifest.finalize();
+      DigestSigner::sign(manifest);
+      return manifest.wireEncode().size();
+    });
+  }
+  if (0 == sizes.namesPerSegment) {
+    auto segmentName = Name(commonPrefix.toUri() + "/torrent-file")
+                         .appendSequenceNumber(maxSequenceNumber);
+    auto segmentFullName = Name(segmentName).appendImplicitSha256Digest(digest.data(),
+                                                                        digest.size());
+    sizes.namesPerSegment = fitEntries(maxPacketSize, [&] (size_t numNames) {
+      TorrentFile segment(segmentName, segmentFullName, commonPrefix,
+                          std::vector<Name>(numNames, manifestFullName));
+      segment.finalize();
+      DigestSigner::sign(segment);
+      return segment.wireEncode().size();
+    });
+  }
+  if (0 == sizes.dataPacketSize || 0 == sizes.subManifestSize || 0 == sizes.namesPerSegment) {
+    BOOST_THROW_EXCEPTION(Error(directoryPath + ": the names are too long for packets of " +
+                                std::to_string(maxPacketSize) + " bytes."));
+  }
+  return sizes;
+}
+
 } // namespace ntorrent
 
 } // namespace ndn
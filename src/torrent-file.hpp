@@ -23,10 +23,12 @@
 #define TORRENT_FILE_HPP
 
 #include "file-manifest.hpp"
+#include "generation-cache.hpp"
 
 #include <ndn-cxx/name.hpp>
 #include <ndn-cxx/encoding/block.hpp>
 #include <ndn-cxx/data.hpp>
+#include <ndn-cxx/encoding/tlv.hpp>
 
 #include <memory>
 
@@ -45,6 +47,24 @@ public:
     {
     }
   };
+  /**
+   * @brief The sizes of the packets of a torrent, as given to 'generate'
+   */
+  struct PacketSizes {
+    // The number of file manifest names in each segment of the torrent-file
+    size_t namesPerSegment;
+    // The number of data packet names in each sub-manifest
+    size_t subManifestSize;
+    // The number of bytes of file content in each data packet
+    size_t dataPacketSize;
+  };
+
+  enum {
+    // The multiple of which the fitted data packet sizes are, so that the data packets start at
+    // aligned offsets of their files
+    PACKET_SIZE_ALIGNMENT = 1024
+  };
+
   static ndn::Name
   torrentFileName(const Name& name);
 
@@ -162,10 +182,17 @@ public:
    *        torrent-file
    * @param returnData Determines whether the data would be returned in memory or it will be
    *        stored on disk without being returned
+   * @param jobs The number of threads used to packetize and hash the files. If greater than 1, the
+   *        sub-manifests of all the files are populated concurrently. The output is identical
+   *        regardless of the number of threads.
+   * @param cache (optional) The files generated before, whose manifests are reused for the files
+   *        that did not change since instead of reading them again. It is updated with the files
+   *        that are read.
    *
    * Generates the torrent-file for the directory at the specified 'directoryPath',
    * splitting the torrent-file into multiple segments, each one of which contains
-   * at most 'namesPerSegment' number of manifest names
+   * at most 'namesPerSegment' number of manifest names. The manifests (and Data) are returned only
+   * for the files that were read, in the order of their names.
    *
    **/
   static std::pair<std::vector<TorrentFile>,
@@ -175,7 +202,28 @@ public:
            size_t namesPerSegment,
            size_t subManifestSize,
            size_t dataPacketSize,
-           bool returnData = false);
+           bool returnData = false,
+           size_t jobs = 1,
+           GenerationCache* cache = nullptr);
+
+  /**
+   * @brief Fit the packet sizes of the torrent of 'directoryPath' to the largest NDN packet
+   *
+   * @param directoryPath The path to the directory for which the torrent-file is to be generated
+   * @param requested The sizes to use, where each size that is zero is to be fitted
+   * @param maxPacketSize The number of bytes that no packet of the torrent may exceed
+   * @throws Error if the directory does not exist, or if its names are too long for any packet to
+   *         fit in 'maxPacketSize' bytes
+   *
+   * The data packet size is fitted first, as the largest multiple of PACKET_SIZE_ALIGNMENT (if
+   * any fits) for which a data packet of the file with the longest name fits. Then each
+   * sub-manifest, and then each segment of the torrent-file, is given as many names as fit in a
+   * single packet. The fit is conservative, as it assumes the largest sequence numbers.
+   */
+  static PacketSizes
+  fitPacketSizes(const std::string& directoryPath,
+                 const PacketSizes& requested = PacketSizes{0, 0, 0},
+                 size_t maxPacketSize = MAX_NDN_PACKET_SIZE);
 
 protected:
   /**
@@ -31,10 +31,13 @@
 
 #include <ndn-cxx/data.hpp>
 #include <ndn-cxx/security/key-chain.hpp>
-#include <ndn-cxx/security/signing-helpers.hpp>
 #include <ndn-cxx/util/io.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <ostream>
 #include <set>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -47,117 +50,189 @@ using std::vector;
 namespace ndn {
 namespace ntorrent {
 
+// Return the packets of type T of the specified 'type' in 'store' or, if it could not be opened,
+// those saved one per file under 'dirPath'
+template<typename T>
+static vector<T>
+loadMetadata(const MetadataStore& store,
+             IoUtil::NAME_TYPE    type,
+             const string&        dirPath,
+             size_t               numThreads)
+{
+  if (!store.isOpen()) {
+    return IoUtil::load_directory<T>(dirPath, io::BASE64, numThreads);
+  }
+  return store.load<T>([type] (const Name& fullName) { return type == IoUtil::findType(fullName); },
+                       numThreads);
+}
+
+// Append to 'store' the torrent file segments and file manifests saved one file each
+static void
+importMetadata(MetadataStore& store,
+               const string&  torrentFilePath,
+               const string&  manifestPath,
+               size_t         numThreads)
+{
+  for (const auto& t : IoUtil::load_directory<TorrentFile>(torrentFilePath, io::BASE64, numThreads)) {
+    store.insert(t);
+  }
+  for (const auto& m : IoUtil::load_directory<FileManifest>(manifestPath, io::BASE64, numThreads)) {
+    store.insert(m);
+  }
+}
+
 static vector<TorrentFile>
-intializeTorrentSegments(const string& torrentFilePath, const Name& initialSegmentName)
-{
-  security::KeyChain key_chain;
-  Name currSegmentFullName = initialSegmentName;
-  vector<TorrentFile> torrentSegments = IoUtil::load_directory<TorrentFile>(torrentFilePath);
-  // Starting with the initial segment name, verify the names, loading next name from torrentSegment
-  for (auto it = torrentSegments.begin(); it != torrentSegments.end(); ++it) {
-    TorrentFile& segment = *it;
-    key_chain.sign(segment, signingWithSha256());
-    if (segment.getFullName() != currSegmentFullName) {
-      vector<TorrentFile> correctSegments(torrentSegments.begin(), it);
-      torrentSegments.swap(correctSegments);
-      break;
-    }
+intializeTorrentSegments(vector<TorrentFile> torrentSegments, const Name& initialSegmentName)
+{
+  // the store also holds the segments of the earlier generations of the torrent, so starting with
+  // the initial segment name, collect the segments of its chain by full name
+  std::unordered_map<Name, size_t> positions;
+  for (size_t i = 0; i < torrentSegments.size(); ++i) {
+    positions.insert({torrentSegments[i].getFullName(), i});
+  }
+  vector<TorrentFile> output;
+  auto it = positions.find(initialSegmentName);
+  while (positions.end() != it) {
+    const auto& segment = torrentSegments[it->second];
+    output.push_back(segment);
+    positions.erase(it);
     // load the next full name
     if (nullptr == segment.getTorrentFilePtr()) {
       break;
     }
-    currSegmentFullName = *segment.getTorrentFilePtr();
+    it = positions.find(*segment.getTorrentFilePtr());
   }
-  return torrentSegments;
+  return output;
 }
 
 static vector<FileManifest>
-intializeFileManifests(const string& manifestPath, const vector<TorrentFile>& torrentSegments)
+intializeFileManifests(vector<FileManifest> manifests, const vector<TorrentFile>& torrentSegments)
 {
-  security::KeyChain key_chain;
-
-  vector<FileManifest> manifests = IoUtil::load_directory<FileManifest>(manifestPath);
   if (manifests.empty()) {
     return manifests;
   }
-
-  // sign the manifests
-  std::for_each(manifests.begin(), manifests.end(),
-                [&key_chain](FileManifest& m){
-                  key_chain.sign(m,signingWithSha256());
-                });
-
-  // put all names of initial manifests from the valid torrent files into a set
-  std::vector<ndn::Name> validInitialManifestNames;
-  for (const auto& segment : torrentSegments) {
-    const auto& catalog = segment.getCatalog();
-    validInitialManifestNames.insert(validInitialManifestNames.end(),
-                                    catalog.begin(),
-                                    catalog.end());
+  std::unordered_map<Name, size_t> positions;
+  for (size_t i = 0; i < manifests.size(); ++i) {
+    positions.insert({manifests[i].getFullName(), i});
   }
-  auto manifest_it =  manifests.begin();
   std::vector<FileManifest> output;
   output.reserve(manifests.size());
-
-  for (auto& initialName : validInitialManifestNames) {
-    // starting from the initial segment
-    auto& validName = initialName;
-    if (manifests.end() == manifest_it) {
-      break;
-    }
-    auto fileName = manifest_it->file_name();
-    // sequential collect all valid segments
-    while (manifest_it != manifests.end() && manifest_it->getFullName() == validName) {
-      output.push_back(*manifest_it);
-      if (manifest_it->submanifest_ptr() != nullptr) {
-        validName = *manifest_it->submanifest_ptr();
-        ++manifest_it;
-      }
-      else {
-        ++manifest_it;
-        break;
+  // starting from the initial segment of each file, collect the segments of its valid chain
+  for (const auto& segment : torrentSegments) {
+    for (const auto& initialName : segment.getCatalog()) {
+      auto it = positions.find(initialName);
+      while (positions.end() != it) {
+        const auto& manifest = manifests[it->second];
+        output.push_back(manifest);
+        positions.erase(it);
+        if (nullptr == manifest.submanifest_ptr()) {
+          break;
+        }
+        it = positions.find(*manifest.submanifest_ptr());
       }
     }
-    // skip the remain segments for this file (all invalid)
-    while (manifests.end() != manifest_it && manifest_it->file_name() == fileName) {
-      ++manifest_it;
-    }
   }
+  // in the order kept by writeFileManifest
+  std::stable_sort(output.begin(), output.end(),
+                   [](const FileManifest& lhs, const FileManifest& rhs) {
+                     return lhs.file_name() < rhs.file_name()
+                         || (lhs.file_name() == rhs.file_name()
+                          && lhs.submanifest_number() < rhs.submanifest_number());
+                   });
   return output;
 }
 
-static vector<Data>
-initializeDataPackets(const string&      filePath,
-                      const FileManifest manifest,
-                      size_t             subManifestSize)
+// Set the state of each data packet of 'manifest' in 'fileState' whose content in the file at
+// 'filePath' matches the catalog, returning the number of packets read from the file
+static size_t
+verifyDataPackets(const string&       filePath,
+                  const FileManifest& manifest,
+                  size_t              subManifestSize,
+                  FileState&          fileState)
 {
-  vector<Data> packets;
-  auto subManifestNum = manifest.submanifest_number();
+  const auto& catalog = manifest.catalog();
+  size_t i = 0;
+  // the packets come in the order of the catalog, along with the full names computed as they
+  // were signed
+  return IoUtil::packetize_file(filePath,
+                                manifest.name(),
+                                manifest.data_packet_size(),
+                                subManifestSize,
+                                manifest.submanifest_number(),
+                                [&catalog, &fileState, &i] (const Data&, const Name& fullName) {
+                                  if (i < catalog.size() && catalog[i] == fullName) {
+                                    fileState.set(i);
+                                  }
+                                  ++i;
+                                });
+}
 
-  packets =  IoUtil::packetize_file(filePath,
-                                    manifest.name(),
-                                    manifest.data_packet_size(),
-                                    subManifestSize,
-                                    subManifestNum);
+// Return the estimated bytes held by the signed 'manifest' in memory
+static size_t
+manifestBytes(const FileManifest& manifest)
+{
+  return sizeof(FileManifest) + manifest.wireEncode().size() + manifest.catalog().bytes();
+}
 
-  auto catalog = manifest.catalog();
-  // Filter out invalid packet names
-  std::remove_if(packets.begin(), packets.end(),
-                [&packets, &catalog](const Data& p) {
-                  return catalog.end() == std::find(catalog.begin(),
-                                                     catalog.end(),
-                                                     p.getFullName());
-                });
-  return packets;
+// Return the estimated bytes held by a file manifest named 'fullName' once evicted
+static size_t
+evictedManifestBytes(const Name& fullName)
+{
+  // the manifest keeps its name, while its full name is kept aside
+  return sizeof(FileManifest) + 2 * fullName.wireEncode().size();
 }
 
-static std::vector<bool>
+static FileState
 initializeFileState(const string&       dataPath,
                     const FileManifest& manifest,
                     size_t              subManifestSize)
 {
   // construct the file name
-  return vector<bool>(manifest.catalog().size());
+  return FileState(manifest.catalog().size());
+}
+
+// Append the handles of the missing packets of the manifest at 'position' to 'packets'
+static void
+findMissingPackets(const FileManifest&                         manifest,
+                   const FileState&                            fileState,
+                   size_t                                      position,
+                   std::vector<TorrentManager::PacketHandle>&  packets)
+{
+  // if we have no packets from this file
+  if (0 == fileState.size()) {
+    for (size_t dataNum = 0; dataNum < manifest.catalog().size(); ++dataNum) {
+      packets.emplace_back(position, dataNum);
+    }
+    return;
+  }
+  // skip the complete sub-manifests without looking at their packets
+  if (fileState.complete()) {
+    return;
+  }
+  for (auto dataNum = fileState.findNextMissing();
+       dataNum < fileState.size();
+       dataNum = fileState.findNextMissing(dataNum + 1)) {
+    packets.emplace_back(position, dataNum);
+  }
+}
+
+// Return the routable prefix in the forwarding hint of 'interest', or the empty name if it has none
+static Name
+hintPrefix(const Interest& interest)
+{
+  const auto& hint = interest.getForwardingHint();
+  return hint.begin() == hint.end() ? Name() : hint.begin()->name;
+}
+
+// Set the forwarding hint of 'interest' to 'prefix'
+static void
+setHintPrefix(Interest& interest, const Name& prefix)
+{
+  Delegation del;
+  del.preference = 1;
+  del.name = prefix;
+  DelegationList list({del});
+  interest.setForwardingHint(list);
 }
 
 //==================================================================================================
@@ -182,21 +257,63 @@ void TorrentManager::Initialize()
                                                make_shared<StatsTable>(m_statsTable), m_face,
                                                std::bind(&TorrentManager::eraseOwnRoutablePrefix,
                                                          this));
+  m_updateHandler->setAvailabilityHandlers(std::bind(&TorrentManager::findCompleteFiles, this),
+                                           [this] (const Name& peer,
+                                                   const std::vector<bool>& pieces) {
+                                             m_availability.update(peer, pieces);
+                                           });
+  m_updateHandler->setMetricsHandler([this] {
+    std::ostringstream os;
+    dumpMetrics(os);
+    return os.str();
+  });
+  setMetricsInterval(m_metricsInterval);
 
   // .../<torrent_name>/torrent-file/<implicit_digest>
-  string dataPath = ".appdata/" + m_torrentFileName.get(-3).toUri();
+  const auto& dataPath = m_appDataPath;
   string manifestPath = dataPath +"/manifests";
   string torrentFilePath = dataPath +"/torrent_files";
 
   // get the torrent file segments and manifests that we have.
-  if (!Io::exists(torrentFilePath)) {
-    return;
+  auto loadStart = std::chrono::steady_clock::now();
+  IoUtil::create_directories(dataPath);
+  if (m_metadata.open(dataPath + "/metadata") && 0 == m_metadata.size()) {
+    // earlier versions saved each segment and manifest to its own file
+    importMetadata(m_metadata, torrentFilePath, manifestPath, m_loadThreads);
   }
-  m_torrentSegments = intializeTorrentSegments(torrentFilePath, m_torrentFileName);
+  m_torrentSegments = intializeTorrentSegments(
+                        loadMetadata<TorrentFile>(m_metadata, IoUtil::TORRENT_FILE,
+                                                  torrentFilePath, m_loadThreads),
+                        m_torrentFileName);
+  m_torrentSegmentIndex.clear();
+  m_fileManifestIndex.clear();
+  m_fileIndex.clear();
+  m_fileManifests.clear();
+  m_fileStates.clear();
+  m_unwritableFiles.clear();
+  indexTorrentSegments();
   if (m_torrentSegments.empty()) {
     return;
   }
-  m_fileManifests   = intializeFileManifests(manifestPath, m_torrentSegments);
+  m_fileManifests   = intializeFileManifests(
+                        loadMetadata<FileManifest>(m_metadata, IoUtil::FILE_MANIFEST,
+                                                   manifestPath, m_loadThreads),
+                        m_torrentSegments);
+  LOG_INFO << "Loaded " << m_torrentSegments.size() << " torrent file segments and "
+           << m_fileManifests.size() << " file manifests in "
+           << std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - loadStart).count()
+           << " ms using " << m_loadThreads << " threads";
+  indexFileManifests();
+  m_fileStates.resize(m_fileManifests.size());
+  m_journal.open(dataPath + "/resume-journal");
+  m_manifestBytes = 0;
+  m_completeManifests.clear();
+  m_completeManifestIndex.clear();
+  m_evictedManifests.clear();
+  for (const auto& m : m_fileManifests) {
+    m_manifestBytes += manifestBytes(m);
+  }
 
   // get the submanifest sizes
   for (const auto& m : m_fileManifests) {
@@ -206,7 +323,8 @@ void TorrentManager::Initialize()
     }
   }
 
-  for (const auto& m : m_fileManifests) {
+  for (size_t j = 0; j < m_fileManifests.size(); ++j) {
+    const auto& m = m_fileManifests[j];
     // construct the file name
     auto fileName = m.file_name();
     fs::path filePath = m_dataPath + fileName;
@@ -217,36 +335,47 @@ void TorrentManager::Initialize()
       }
       continue;
     }
-    auto packets = initializeDataPackets(filePath.string(), m, m_subManifestSizes[m.file_name()]);
-    // If there are any valid packets, add corresponding state to manager
-    if (!packets.empty()) {
-      m_fileStates[m.getFullName()] = initializeFileState(m_dataPath,
-                                                          m,
-                                                          m_subManifestSizes[m.file_name()]);
-      auto& fileBitMap = m_fileStates[m.getFullName()];
-      auto read_it = packets.begin();
-      size_t i = 0;
-      for (auto name : m.catalog()) {
-        if (read_it == packets.end()) {
-          break;
-        }
-        if (name == read_it->getFullName()) {
-          ++read_it;
-          fileBitMap[i] = true;
-        }
-        ++i;
-      }
-      for (const auto& d : packets) {
-        seed(d);
+    // trust the journal if the file has not changed since it was last checkpointed
+    if (m_journal.isUnchanged(fileName, filePath.string())) {
+      FileState fileState(m_journal.state(fileName, m.submanifest_number(), m.catalog().size()));
+      if (fileState.missing() != fileState.size()) {
+        m_fileStates[j] = fileState;
       }
+      continue;
+    }
+    auto fileState = initializeFileState(m_dataPath, m, m_subManifestSizes[m.file_name()]);
+    // If there are any packets in the file, add corresponding state to manager; the prefix of the
+    // data packets is announced with that of their manifest
+    if (0 < verifyDataPackets(filePath.string(), m, m_subManifestSizes[m.file_name()],
+                              fileState)) {
+      m_fileStates[j] = fileState;
+      m_journal.setState(fileName, m.submanifest_number(), fileState.toBitmap());
+    }
+    else {
+      m_journal.setState(fileName, m.submanifest_number(), vector<bool>(m.catalog().size()));
     }
   }
+  m_missingPackets = 0;
+  for (size_t j = 0; j < m_fileManifests.size(); ++j) {
+    const auto& fileState = m_fileStates[j];
+    m_missingPackets += 0 == fileState.size() ? m_fileManifests[j].catalog().size()
+                                              : fileState.missing();
+  }
+  // the verified states now match the files on disk
+  for (const auto& kv : m_subManifestSizes) {
+    m_journal.checkpoint(kv.first, m_dataPath + kv.first);
+  }
+  m_journal.compact();
   for (const auto& t : m_torrentSegments) {
     seed(t);
   }
   for (const auto& m : m_fileManifests) {
    seed(m);
   }
+  for (size_t j = 0; j < m_fileManifests.size(); ++j) {
+    touchFileManifest(j);
+  }
+  enforceMemoryBudget();
 }
 
 shared_ptr<Name>
@@ -263,21 +392,19 @@ TorrentManager::findTorrentFileSegmentToDownload() const
 shared_ptr<Name>
 TorrentManager::findManifestSegmentToDownload(const Name& manifestName) const
 {
-  //sequentially find whether we have downloaded any segments of this manifest file
-  Name manifestPrefix = FileManifest::manifestPrefix(manifestName);
-  auto it = std::find_if(m_fileManifests.rbegin(), m_fileManifests.rend(),
-                      [&manifestPrefix] (const FileManifest& f) {
-                        return manifestPrefix.isPrefixOf(f.getName());
-                      });
+  // find whether we have downloaded any segments of this manifest file
+  auto file_it = m_fileIndex.find(FileManifest::manifestPrefix(manifestName));
 
   // if we do not have any segments of the file manifest
-  if (it == m_fileManifests.rend()) {
+  if (file_it == m_fileIndex.end()) {
     return make_shared<Name>(manifestName);
   }
 
   // if we already have the requested segment of the file manifest
-  if (it->submanifest_number() >= manifestName.get(manifestName.size() - 2).toSequenceNumber()) {
-    return it->submanifest_ptr();
+  const auto& lastSegment = m_fileManifests[file_it->second.second];
+  if (lastSegment.submanifest_number() >=
+      manifestName.get(manifestName.size() - 2).toSequenceNumber()) {
+    return lastSegment.submanifest_ptr();
   }
   // if we do not have the requested segment
   else {
@@ -289,10 +416,7 @@ void
 TorrentManager::findFileManifestsToDownload(std::vector<Name>& manifestNames) const
 {
   std::vector<Name> manifests;
-  // insert the first segment name of all the file manifests to the vector
-  for (auto i = m_torrentSegments.begin(); i != m_torrentSegments.end(); i++) {
-    manifests.insert(manifests.end(), i->getCatalog().begin(), i->getCatalog().end());
-  }
+  findAllFileManifests(manifests);
   // for each file
   for (const auto& manifestName : manifests) {
     // find the first (if any) segment we are missing
@@ -303,76 +427,129 @@ TorrentManager::findFileManifestsToDownload(std::vector<Name>& manifestNames) co
   }
 }
 
+void
+TorrentManager::findAllFileManifests(std::vector<Name>& manifestNames) const
+{
+  // insert the first segment name of all the file manifests to the vector
+  for (auto i = m_torrentSegments.begin(); i != m_torrentSegments.end(); i++) {
+    manifestNames.insert(manifestNames.end(), i->getCatalog().begin(), i->getCatalog().end());
+  }
+}
+
+std::vector<bool>
+TorrentManager::findCompleteFiles() const
+{
+  std::vector<Name> manifests;
+  findAllFileManifests(manifests);
+  std::vector<bool> files(manifests.size(), false);
+  for (size_t i = 0; i < manifests.size(); ++i) {
+    auto file_it = m_fileIndex.find(FileManifest::manifestPrefix(manifests[i]));
+    if (m_fileIndex.end() == file_it ||
+        nullptr != m_fileManifests[file_it->second.second].submanifest_ptr()) {
+      continue;
+    }
+    bool complete = true;
+    for (auto j = file_it->second.first; complete && j <= file_it->second.second; ++j) {
+      // only complete manifests are evicted
+      complete = m_fileStates[j].complete() &&
+                 (m_fileStates[j].size() == m_fileManifests[j].catalog().size() ||
+                  0 != m_evictedManifests.count(m_fileManifests[j].getName()));
+    }
+    files[i] = complete;
+  }
+  return files;
+}
+
 bool
 TorrentManager::hasDataPacket(const Name& dataName) const
 {
-
-  auto manifest_it = std::find_if(m_fileManifests.begin(), m_fileManifests.end(),
-                                 [&dataName](const FileManifest& m) {
-                                   return m.getName().isPrefixOf(dataName);
-                                 });
+  // <manifest name>/<sequence number>/<implicit digest>
+  auto manifest_ptr = findFileManifest(dataName.getSubName(0, dataName.size() - 2));
 
   // if we do not have the file manifest, just return false
-  if (manifest_it == m_fileManifests.end()) {
+  if (nullptr == manifest_ptr) {
     return false;
   }
 
   // that corresponds to the specific submanifest
-  auto fileState_it = m_fileStates.find(manifest_it->getFullName());
-  if (m_fileStates.end() != fileState_it) {
-    const auto& fileState = fileState_it->second;
-    auto dataNum = dataName.get(dataName.size() - 2).toSequenceNumber();
-    // find whether we have the requested packet from the bitmap
-    return fileState[dataNum];
-  }
-  return false;
+  const auto& fileState = m_fileStates[manifest_ptr - m_fileManifests.data()];
+  auto dataNum = dataName.get(dataName.size() - 2).toSequenceNumber();
+  // find whether we have the requested packet from the bitmap
+  return dataNum < fileState.size() && fileState.test(dataNum);
 }
 
 void
 TorrentManager::findDataPacketsToDownload(const Name& manifestName, std::vector<Name>& packetNames) const
 {
-  auto manifest_it = std::find_if(m_fileManifests.begin(), m_fileManifests.end(),
-                                 [&manifestName](const FileManifest& m) {
-                                   return m.name().getSubName(0, m.name().size()
-                                                              - 1).isPrefixOf(manifestName);
-                                 });
-
-  for (auto j = manifest_it; j != m_fileManifests.end(); j++) {
-    auto& fileState = m_fileStates[j->getFullName()];
-    for (size_t dataNum = 0; dataNum < j->catalog().size(); ++dataNum) {
-      if (!fileState[dataNum]) {
-        packetNames.push_back(j->catalog()[dataNum]);
-      }
-    }
+  std::vector<PacketHandle> packets;
+  findDataPacketsToDownload(manifestName, packets);
+  packetNames.reserve(packetNames.size() + packets.size());
+  for (const auto& p : packets) {
+    packetNames.push_back(packetName(p));
+  }
+}
 
-    // check that the next manifest in the vector refers to the next segment of the same file
-    if ((j + 1) != m_fileManifests.end() && (j+1)->file_name() != manifest_it->file_name()) {
-      break;
-    }
+void
+TorrentManager::findDataPacketsToDownload(const Name&                manifestName,
+                                          std::vector<PacketHandle>& packets) const
+{
+  auto file_it = m_fileIndex.find(FileManifest::manifestPrefix(manifestName));
+  if (m_fileIndex.end() == file_it) {
+    return;
+  }
+
+  // all the segments of a file are stored contiguously
+  for (auto i = file_it->second.first; i <= file_it->second.second; ++i) {
+    findMissingPackets(m_fileManifests[i], m_fileStates[i], i, packets);
   }
 }
 
 void
 TorrentManager::findAllMissingDataPackets(std::vector<Name>& packetNames) const
 {
-  for (auto j = m_fileManifests.begin(); j != m_fileManifests.end(); ++j) {
-    auto fileState_it = m_fileStates.find(j->getFullName());
+  std::vector<PacketHandle> packets;
+  findAllMissingDataPackets(packets);
+  packetNames.reserve(packetNames.size() + packets.size());
+  for (const auto& p : packets) {
+    packetNames.push_back(packetName(p));
+  }
+}
+
+void
+TorrentManager::findAllMissingDataPackets(std::vector<PacketHandle>& packets) const
+{
+  for (size_t i = 0; i < m_fileManifests.size(); ++i) {
+    findMissingPackets(m_fileManifests[i], m_fileStates[i], i, packets);
+  }
+}
+
+Name
+TorrentManager::packetName(const PacketHandle& packet) const
+{
+  return m_fileManifests[packet.first].catalog()[packet.second];
+}
+
+bool
+TorrentManager::findNextMissingDataPacket(PacketHandle& packet) const
+{
+  while (packet.first < m_fileManifests.size()) {
+    const auto& fileState = m_fileStates[packet.first];
     // if we have no packets from this file
-    if (m_fileStates.end() == fileState_it) {
-      packetNames.reserve(packetNames.size() + j->catalog().size());
-      packetNames.insert(packetNames.end(), j->catalog().begin(), j->catalog().end());
+    if (0 == fileState.size()) {
+      if (packet.second < m_fileManifests[packet.first].catalog().size()) {
+        return true;
+      }
     }
-    // find the packets that we are missing
-    else {
-      const auto &fileState =  fileState_it->second;
-      for (auto i = j->catalog().begin(); i != j->catalog().end(); i++) {
-        auto dataNum = i->get(i->size() - 2).toSequenceNumber();
-        if (!fileState[dataNum]) {
-          packetNames.push_back(*i);
-        }
+    else if (!fileState.complete()) {
+      packet.second = fileState.findNextMissing(packet.second);
+      if (packet.second < fileState.size()) {
+        return true;
       }
     }
+    ++packet.first;
+    packet.second = 0;
   }
+  return false;
 }
 
 void
@@ -381,13 +558,9 @@ TorrentManager::downloadTorrentFileSegment(const ndn::Name& name,
                                            TorrentFileReceivedCallback onSuccess,
                                            FailedCallback onFailed)
 {
-  shared_ptr<Interest> interest = createInterest(name);
-
   auto dataReceived = [path, onSuccess, onFailed, this]
                                             (const Interest& interest, const Data& data) {
       m_pendingInterests.erase(interest.getName());
-      // Stats Table update here...
-      m_stats_table_iter->incrementReceivedData();
       m_retries = 0;
       std::vector<Name> manifestNames;
       TorrentFile file(data.wireEncode());
@@ -431,8 +604,10 @@ TorrentManager::downloadTorrentFileSegment(const ndn::Name& name,
       shutdown();
     }
   };
-  LOG_DEBUG << "Pushing to the Interest Queue: " << *interest << std::endl;
-  m_interestQueue->push(interest, dataReceived, dataFailed);
+  LOG_DEBUG << "Pushing to the Interest Queue: " << name;
+  auto request = make_shared<const InterestQueue::Request>(
+                   InterestQueue::Request{dataReceived, dataFailed, false, false});
+  m_interestQueue->push(name, request, queuePriority(name, InterestQueue::TORRENT_FILE));
   this->sendInterest();
 }
 
@@ -462,7 +637,8 @@ void
 TorrentManager::download_file_manifest(const Name&              manifestName,
                                        const std::string&       path,
                                        TorrentManager::ManifestReceivedCallback onSuccess,
-                                       TorrentManager::FailedCallback           onFailed)
+                                       TorrentManager::FailedCallback           onFailed,
+                                       TorrentManager::ManifestSegmentReceivedCallback onSegment)
 {
   shared_ptr<Name> searchRes = findManifestSegmentToDownload(manifestName);
   auto packetNames = make_shared<std::vector<Name>>();
@@ -474,7 +650,14 @@ TorrentManager::download_file_manifest(const Name&              manifestName,
     onSuccess(*packetNames);
     return;
   }
-  this->downloadFileManifestSegment(*searchRes, path, packetNames, onSuccess, onFailed);
+  auto download = make_shared<ManifestDownload>();
+  download->path        = path;
+  download->packetNames = packetNames;
+  download->onSuccess   = onSuccess;
+  download->onFailed    = onFailed;
+  download->onSegment   = onSegment;
+  download->expected    = *searchRes;
+  this->downloadFileManifestSegment(*searchRes, download);
 }
 
 void
@@ -482,24 +665,77 @@ TorrentManager::download_data_packet(const Name& packetName,
                                      DataReceivedCallback onSuccess,
                                      FailedCallback onFailed)
 {
-  if (this->hasDataPacket(packetName)) {
-    onSuccess(packetName);
+  download_data_packets({ packetName }, onSuccess, onFailed);
+}
+
+void
+TorrentManager::download_data_packets(const std::vector<Name>& packetNames,
+                                      DataReceivedCallback onSuccess,
+                                      FailedCallback onFailed)
+{
+  std::vector<Name> missingNames;
+  for (const auto& packetName : packetNames) {
+    if (this->hasDataPacket(packetName)) {
+      onSuccess(packetName);
+    }
+    else {
+      missingNames.push_back(packetName);
+    }
+  }
+  if (missingNames.empty()) {
     return;
   }
+  // a resumed download may start close to its end
+  checkEndgame();
 
-  shared_ptr<Interest> interest = this->createInterest(packetName);
+  auto request = makeDataPacketRequest(onSuccess, onFailed);
+  for (const auto& packetName : missingNames) {
+    LOG_DEBUG << "Pushing to the Interest Queue: " << packetName;
+    m_interestQueue->push(packetName, request, dataPacketPriority(packetName));
+  }
+  this->sendInterest();
+}
+
+void
+TorrentManager::download_missing_data_packets(DataReceivedCallback onSuccess,
+                                              FailedCallback onFailed)
+{
+  checkEndgame();
+  m_missingCursor = PacketHandle(0, 0);
+  m_missingRequest = makeDataPacketRequest(onSuccess, onFailed);
+  this->sendInterest();
+}
 
+shared_ptr<const InterestQueue::Request>
+TorrentManager::makeDataPacketRequest(DataReceivedCallback onSuccess, FailedCallback onFailed)
+{
   auto dataReceived = [onSuccess, onFailed, this]
                                           (const Interest& interest, const Data& data) {
     m_pendingInterests.erase(interest.getName());
-    // Write data to disk...
-    if(writeData(data)) {
-      seed(data);
+    // Write data to disk without waiting for it, the callbacks are called once it is written
+    auto written = [onSuccess, onFailed, data, this] (bool result) {
+      if (result) {
+        seed(data);
+        m_packetCache->insert(data);
+        checkEndgame();
+        onSuccess(data.getName());
+      }
+      else {
+        onFailed(data.getName(), "Write failed");
+      }
+      if (!hasPendingInterests() && !m_seedFlag) {
+        shutdown();
+      }
+    };
+    if (!writeDataAsync(data, written)) {
+      if (isWritable(data.getName())) {
+        onSuccess(data.getName());
+      }
+      else {
+        onFailed(data.getName(), "Write failed");
+      }
     }
-    // Stats Table update here...
-    m_stats_table_iter->incrementReceivedData();
     m_retries = 0;
-    onSuccess(data.getName());
     this->sendInterest();
     if (!hasPendingInterests() && !m_seedFlag) {
       shutdown();
@@ -522,9 +758,8 @@ TorrentManager::download_data_packet(const Name& packetName,
       shutdown();
     }
   };
-  LOG_DEBUG << "Pushing to the Interest Queue: " << *interest << std::endl;
-  m_interestQueue->push(interest, dataReceived, dataFailed);
-  this->sendInterest();
+  return make_shared<const InterestQueue::Request>(
+           InterestQueue::Request{dataReceived, dataFailed, false, false});
 }
 
 void TorrentManager::seed(const Data& data) {
@@ -559,53 +794,176 @@ void TorrentManager::seed(const Data& data) {
 void
 TorrentManager::shutdown()
 {
+  m_metricsScheduler.reset();
+  m_writer->flushAll(nullptr);
+  drainWrites();
+  // all writes are synced, so the recorded states of all files can be trusted on restart
+  for (const auto& kv : m_subManifestSizes) {
+    m_journal.checkpoint(kv.first, m_dataPath + kv.first);
+  }
+  m_journal.flush();
+  m_metadata.flush();
+  // the face is shared with the other torrents of the process, which keep running
+  if (nullptr != m_budget) {
+    m_budget->update(m_budgetId, 0, false);
+    return;
+  }
   m_face->getIoService().stop();
 }
 
+void
+TorrentManager::dumpMetrics(std::ostream& os) const
+{
+  m_metrics.dump(os);
+  os << "interest_queue_depth " << m_interestQueue->size() << "\n"
+     << "pending_interests " << m_pendingInterests.size() << "\n"
+     << "window " << m_scheduler.window() << "\n"
+     << "pending_writes " << m_pendingWrites.size() << "\n"
+     << "pending_reads " << *m_pendingReads << "\n"
+     << "missing_packets " << m_missingPackets << "\n"
+     << "evicted_manifests " << m_evictedManifests.size() << "\n"
+     << "memory_bytes " << memoryUsage() << "\n";
+}
+
+size_t
+TorrentManager::memoryUsage() const
+{
+  size_t bytes = m_manifestBytes + (m_sharedPacketCache ? 0 : m_packetCache->bytes());
+  // the wire encoding of each torrent file segment, and its catalog as decoded
+  for (const auto& t : m_torrentSegments) {
+    bytes += sizeof(TorrentFile) + 2 * t.wireEncode().size();
+  }
+  for (const auto& fileState : m_fileStates) {
+    bytes += sizeof(FileState) + fileState.size() / 8;
+  }
+  bytes += (m_pendingInterests.size() + m_interestQueue->size() + m_inFlightReads.size() +
+            m_pendingWrites.size()) * PENDING_PACKET_BYTES;
+  return bytes;
+}
+
+void
+TorrentManager::setMetricsInterval(const time::milliseconds& interval)
+{
+  m_metricsInterval = interval;
+  m_metricsScheduler.reset();
+  if (time::milliseconds::zero() < m_metricsInterval) {
+    m_metricsScheduler.reset(new util::scheduler::Scheduler(m_face->getIoService()));
+    m_metricsScheduler->scheduleEvent(m_metricsInterval, [this] { logMetrics(); });
+  }
+}
+
 // = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
 //                                Protected Helpers
 // = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = = =
 
 bool TorrentManager::writeData(const Data& packet)
+{
+  bool written = false;
+  if (!writeDataAsync(packet, [&written] (bool result) { written = result; })) {
+    return false;
+  }
+  drainWrites();
+  return written;
+}
+
+bool
+TorrentManager::writeDataAsync(const Data& packet, AsyncWriter::Callback done)
 {
   // find correct manifest
   const auto& packetName = packet.getName();
-  auto manifest_it = std::find_if(m_fileManifests.begin(), m_fileManifests.end(),
-                                 [&packetName](const FileManifest& m) {
-                                   return m.getName().isPrefixOf(packetName);
-                                 });
-  if (m_fileManifests.end() == manifest_it) {
+  // <manifest name>/<sequence number>
+  auto manifestName = packetName.getSubName(0, packetName.size() - 1);
+  auto manifest_ptr = findFileManifest(manifestName);
+  if (nullptr == manifest_ptr) {
     return false;
   }
   // get file state out
-  auto fileState_it = m_fileStates.find(manifest_it->getFullName());
+  auto& fileState = m_fileStates[manifest_ptr - m_fileManifests.data()];
+  auto subManifestSize = m_subManifestSizes[manifest_ptr->file_name()];
+  auto fileName = manifest_ptr->file_name();
+  auto filePath = m_dataPath + fileName;
+  if (0 != m_unwritableFiles.count(fileName)) {
+    return false;
+  }
   // if there is no open stream to the file
-  if(fileState_it == m_fileStates.end()) {
-    fs::path filePath = m_dataPath + manifest_it->file_name();
-    if (!Io::exists(filePath)) {
-      IoUtil::create_directories(filePath.parent_path());
+  if (0 == fileState.size()) {
+    fs::path path = filePath;
+    if (!Io::exists(path)) {
+      IoUtil::create_directories(path.parent_path());
     }
-    m_fileStates[manifest_it->getFullName()] =
-                initializeFileState(m_dataPath,
-                                    *manifest_it,
-                                    m_subManifestSizes[manifest_it->file_name()]);
+    fileState = initializeFileState(m_dataPath, *manifest_ptr, subManifestSize);
+    // reserve the space of the whole sub-manifest before its first packet is written
+    m_writer->allocate(filePath,
+                       IoUtil::dataOffset(*manifest_ptr, subManifestSize, 0),
+                       manifest_ptr->catalog().size() *
+                         static_cast<uint64_t>(manifest_ptr->data_packet_size()),
+                       [this, fileName] (bool allocated) {
+                         // e.g. the disk is full, so the rest of the file is not requested
+                         if (!allocated && m_unwritableFiles.insert(fileName).second) {
+                           LOG_ERROR << "Stopped downloading " << fileName
+                                     << ", its space could not be reserved";
+                         }
+                       });
   }
-  auto& fileState = m_fileStates[manifest_it->getFullName()];
   auto packetNum = packetName.get(packetName.size() - 1).toSequenceNumber();
-  // if we already have the packet, do not rewrite it.
-  if (fileState[packetNum]) {
+  // if we already have the packet or are writing it, do not rewrite it.
+  if (packetNum >= fileState.size() || fileState.test(packetNum) ||
+      !m_pendingWrites.insert(packet.getFullName()).second) {
     return false;
   }
-  // write data to disk
-  auto subManifestSize = m_subManifestSizes[manifest_it->file_name()];
-  auto filePath = m_dataPath + manifest_it->file_name();
-  if (IoUtil::writeData(packet, *manifest_it, subManifestSize, filePath)) {;
+  // the content block shares the buffer of the packet, keeping it alive until the write is done
+  auto content = packet.getContent();
+  auto fullName = packet.getFullName();
+  auto submitted = time::steady_clock::now();
+  auto onWritten = [this, content, fullName, manifestName, packetNum, done,
+                    submitted] (bool written) {
+    m_pendingWrites.erase(fullName);
+    // the manifests may have moved while the packet was written
+    auto manifest_ptr = findFileManifest(manifestName);
+    // the allocation of the file completes before the writes of its packets
+    if (!written || nullptr == manifest_ptr ||
+        0 != m_unwritableFiles.count(manifest_ptr->file_name())) {
+      LOG_ERROR << "Write failed: " << fullName;
+      if (nullptr != done) {
+        done(false);
+      }
+      return;
+    }
+    m_metrics.increment(Metrics::BYTES_WRITTEN, content.value_size());
+    m_metrics.recordWriteLatency(time::steady_clock::now() - submitted);
     // update bitmap
-    fileState[packetNum] = true;
-    return true;
-  }
-  LOG_ERROR << "Write failed: " << packet.getFullName() << std::endl;
-  return false;
+    auto& fileState = m_fileStates[manifest_ptr - m_fileManifests.data()];
+    fileState.set(packetNum);
+    --m_missingPackets;
+    m_journal.recordPacket(manifest_ptr->file_name(), manifest_ptr->submanifest_number(), packetNum);
+    // sync the file once per completed sub-manifest rather than once per packet
+    if (fileState.complete()) {
+      auto fileName = manifest_ptr->file_name();
+      auto filePath = m_dataPath + fileName;
+      m_writer->flush(filePath, [this, fileName, filePath] (bool synced) {
+        if (synced) {
+          m_journal.checkpoint(fileName, filePath);
+        }
+      });
+      touchFileManifest(manifest_ptr - m_fileManifests.data());
+      enforceMemoryBudget();
+    }
+    if (nullptr != done) {
+      done(true);
+    }
+  };
+  m_writer->write(filePath,
+                  IoUtil::dataOffset(*manifest_ptr, subManifestSize, packetNum),
+                  content.value(),
+                  content.value_size(),
+                  onWritten);
+  return true;
+}
+
+void
+TorrentManager::drainWrites()
+{
+  m_writer->drain();
 }
 
 bool
@@ -615,15 +973,19 @@ TorrentManager::writeTorrentSegment(const TorrentFile& segment, const std::strin
   auto torrentPrefix = m_torrentFileName.getSubName(0, m_torrentFileName.size() - 1);
   // check if we already have it
   if (torrentPrefix.isPrefixOf(segment.getName()) &&
-      m_torrentSegments.end() == std::find(m_torrentSegments.begin(), m_torrentSegments.end(),
-                                           segment))
+      m_torrentSegmentIndex.end() == m_torrentSegmentIndex.find(segment.getName()))
   {
-    if(IoUtil::writeTorrentSegment(segment, path)) {
+    // a segment already in the store was not loaded, as its predecessors were missing
+    if (m_metadata.isOpen() ? m_metadata.insert(segment) ||
+                              m_metadata.contains(segment.getFullName())
+                            : IoUtil::writeTorrentSegment(segment, path)) {
       auto it = std::find_if(m_torrentSegments.begin(), m_torrentSegments.end(),
                              [&segment](const TorrentFile& t){
                                return segment.getSegmentNumber() < t.getSegmentNumber() ;
                             });
+      auto position = it - m_torrentSegments.begin();
       m_torrentSegments.insert(it, segment);
+      indexTorrentSegments(position);
       return true;
     }
   }
@@ -633,14 +995,15 @@ TorrentManager::writeTorrentSegment(const TorrentFile& segment, const std::strin
 
 bool TorrentManager::writeFileManifest(const FileManifest& manifest, const std::string& path)
 {
-  if (m_fileManifests.end() == std::find(m_fileManifests.begin(), m_fileManifests.end(),
-                                           manifest))
+  if (nullptr == findFileManifest(manifest.getName()))
   {
     // update the state of the manager
     if (0 == manifest.submanifest_number()) {
       m_subManifestSizes[manifest.file_name()] = manifest.catalog().size();
     }
-    if(IoUtil::writeFileManifest(manifest, path)) {
+    if (m_metadata.isOpen() ? m_metadata.insert(manifest) ||
+                              m_metadata.contains(manifest.getFullName())
+                            : IoUtil::writeFileManifest(manifest, path)) {
       // add to collection
       auto it = std::find_if(m_fileManifests.begin(), m_fileManifests.end(),
                              [&manifest](const FileManifest& m){
@@ -648,7 +1011,20 @@ bool TorrentManager::writeFileManifest(const FileManifest& manifest, const std::
                                ||    (m.file_name() == manifest.file_name()
                                   && (m.submanifest_number() > manifest.submanifest_number()));
                             });
+      auto position = it - m_fileManifests.begin();
       m_fileManifests.insert(it, manifest);
+      m_fileStates.insert(m_fileStates.begin() + position, FileState());
+      indexFileManifests(position);
+      // the missing packets are looked for again from the new segment, as the queued ones are
+      // skipped
+      if (nullptr != m_missingRequest && static_cast<size_t>(position) <= m_missingCursor.first) {
+        m_missingCursor = PacketHandle(position, 0);
+      }
+      m_missingPackets += manifest.catalog().size();
+      m_manifestBytes += manifestBytes(manifest);
+      // the manifests after it have moved
+      m_advisedManifests.clear();
+      m_readahead.clear();
       return true;
     }
   }
@@ -657,47 +1033,19 @@ bool TorrentManager::writeFileManifest(const FileManifest& manifest, const std::
 
 void
 TorrentManager::downloadFileManifestSegment(const Name& manifestName,
-                                            const std::string& path,
-                                            std::shared_ptr<std::vector<Name>> packetNames,
-                                            TorrentManager::ManifestReceivedCallback onSuccess,
-                                            TorrentManager::FailedCallback onFailed)
+                                            shared_ptr<ManifestDownload> download)
 {
-  shared_ptr<Interest> interest = this->createInterest(manifestName);
-
-  auto dataReceived = [packetNames, path, onSuccess, onFailed, this]
-                                          (const Interest& interest, const Data& data) {
+  auto dataReceived = [download, this] (const Interest& interest, const Data& data) {
     m_pendingInterests.erase(interest.getName());
-    // Stats Table update here...
-    m_stats_table_iter->incrementReceivedData();
     m_retries = 0;
-
-    FileManifest file(data.wireEncode());
-
-    // Write the file manifest segment to disk...
-    if(writeFileManifest(file, path)) {
-      seed(file);
-    }
-    else {
-      onFailed(interest.getName(), "Write Failed");
-    }
-
-    const std::vector<Name>& packetsCatalog = file.catalog();
-    packetNames->insert(packetNames->end(), packetsCatalog.begin(), packetsCatalog.end());
-    shared_ptr<Name> nextSegmentPtr = file.submanifest_ptr();
-    if (nextSegmentPtr != nullptr) {
-      this->downloadFileManifestSegment(*nextSegmentPtr, path, packetNames, onSuccess, onFailed);
-    }
-    else {
-      onSuccess(*packetNames);
-    }
+    this->onFileManifestSegment(data, download);
     this->sendInterest();
     if (!hasPendingInterests() && !m_seedFlag) {
       shutdown();
     }
   };
 
-  auto dataFailed = [packetNames, path, manifestName, onFailed, this]
-                                                (const Interest& interest) {
+  auto dataFailed = [download, this] (const Interest& interest) {
     m_pendingInterests.erase(interest.getName());
     m_retries++;
     if (m_retries >= MAX_NUM_OF_RETRIES) {
@@ -705,100 +1053,549 @@ TorrentManager::downloadFileManifestSegment(const Name& manifestName,
       if (m_stats_table_iter == m_statsTable.end())
         m_stats_table_iter = m_statsTable.begin();
     }
-    onFailed(interest.getName(), "Unknown failure");
+    download->onFailed(interest.getName(), "Unknown failure");
     this->sendInterest();
   };
-  LOG_DEBUG << "Pushing to the Interest Queue: " << *interest << std::endl;
-  m_interestQueue->push(interest, dataReceived, dataFailed);
+  LOG_DEBUG << "Pushing to the Interest Queue: " << manifestName;
+  auto request = make_shared<const InterestQueue::Request>(
+                   InterestQueue::Request{dataReceived, dataFailed, false, false});
+  m_interestQueue->push(manifestName,
+                        request,
+                        queuePriority(manifestName, InterestQueue::FILE_MANIFEST));
   this->sendInterest();
 }
 
+void
+TorrentManager::prefetchFileManifestSegment(uint64_t submanifestNumber,
+                                            shared_ptr<ManifestDownload> download)
+{
+  // <manifest prefix>/<submanifest number>, answered only by a segment of the manifest
+  Name name = FileManifest::manifestPrefix(download->expected);
+  name.appendSequenceNumber(submanifestNumber);
+  download->speculating.insert(submanifestNumber);
+
+  auto dataReceived = [submanifestNumber, download, this]
+                                          (const Interest& interest, const Data& data) {
+    m_pendingInterests.erase(interest.getName());
+    download->speculating.erase(submanifestNumber);
+    if (!download->expected.empty()) {
+      auto expectedNumber = download->expected.get(-2).toSequenceNumber();
+      if (submanifestNumber == expectedNumber) {
+        if (data.getFullName() == download->expected) {
+          this->onFileManifestSegment(data, download);
+        }
+        else {
+          LOG_DEBUG << "Dropping unexpected manifest segment: " << data.getFullName();
+          this->downloadFileManifestSegment(download->expected, download);
+        }
+      }
+      else if (submanifestNumber > expectedNumber) {
+        // the segments after the last one do not exist, so they are no longer prefetched
+        if (nullptr == FileManifest(data.wireEncode()).submanifest_ptr()) {
+          download->last = std::min(download->last, submanifestNumber);
+        }
+        download->prefetched.insert({submanifestNumber, data});
+      }
+    }
+    this->sendInterest();
+    if (!hasPendingInterests() && !m_seedFlag) {
+      shutdown();
+    }
+  };
+
+  // a segment that could not be prefetched is requested by its full name once it is known
+  auto dataFailed = [submanifestNumber, download, this] (const Interest& interest) {
+    m_pendingInterests.erase(interest.getName());
+    download->speculating.erase(submanifestNumber);
+    if (!download->expected.empty() &&
+        submanifestNumber == download->expected.get(-2).toSequenceNumber()) {
+      this->downloadFileManifestSegment(download->expected, download);
+    }
+    this->sendInterest();
+    if (!hasPendingInterests() && !m_seedFlag) {
+      shutdown();
+    }
+  };
+  LOG_DEBUG << "Prefetching: " << name;
+  auto request = make_shared<const InterestQueue::Request>(
+                   InterestQueue::Request{dataReceived, dataFailed, true, true});
+  m_interestQueue->push(name, request, InterestQueue::FILE_MANIFEST);
+}
+
+void
+TorrentManager::onFileManifestSegment(const Data& data, shared_ptr<ManifestDownload> download)
+{
+  FileManifest file(data.wireEncode());
+
+  // Write the file manifest segment to disk...
+  if(writeFileManifest(file, download->path)) {
+    seed(file);
+  }
+  else {
+    download->onFailed(data.getName(), "Write Failed");
+  }
+
+  // request the next segments before the data packets of this one
+  shared_ptr<Name> nextSegmentPtr = file.submanifest_ptr();
+  shared_ptr<Data> next;
+  if (nextSegmentPtr == nullptr) {
+    download->expected = Name();
+    download->prefetched.clear();
+  }
+  else {
+    download->expected = *nextSegmentPtr;
+    auto nextNumber = nextSegmentPtr->get(-2).toSequenceNumber();
+    auto lastNumber = std::min(nextNumber + m_manifestPrefetch, download->last);
+    auto prefetched_it = download->prefetched.find(nextNumber);
+    if (download->prefetched.end() != prefetched_it) {
+      next = make_shared<Data>(prefetched_it->second);
+      download->prefetched.erase(prefetched_it);
+      if (next->getFullName() != download->expected) {
+        LOG_DEBUG << "Dropping unexpected manifest segment: " << next->getFullName();
+        next = nullptr;
+        this->downloadFileManifestSegment(download->expected, download);
+      }
+    }
+    else if (0 == download->speculating.count(nextNumber)) {
+      this->downloadFileManifestSegment(download->expected, download);
+    }
+    // keep the segments after the next one in flight, as this one is known to have a successor
+    for (auto i = nextNumber + 1; i <= lastNumber; ++i) {
+      if (0 == download->speculating.count(i) && 0 == download->prefetched.count(i)) {
+        this->prefetchFileManifestSegment(i, download);
+      }
+    }
+  }
+
+  std::vector<Name> packetsCatalog(file.catalog().begin(), file.catalog().end());
+  if (download->onSegment) {
+    download->onSegment(packetsCatalog);
+  }
+  else {
+    download->packetNames->insert(download->packetNames->end(),
+                                  packetsCatalog.begin(), packetsCatalog.end());
+  }
+
+  if (nextSegmentPtr == nullptr) {
+    download->onSuccess(*download->packetNames);
+  }
+  else if (nullptr != next) {
+    this->onFileManifestSegment(*next, download);
+  }
+}
+
 void
 TorrentManager::onInterestReceived(const InterestFilter& filter, const Interest& interest)
 {
   // handle if it is a torrent-file
-  LOG_DEBUG << "Interest Received: " << interest << std::endl;
+  LOG_DEBUG << "Interest Received: " << interest;
+  m_metrics.increment(Metrics::INTERESTS_RECEIVED);
   const auto& interestName = interest.getName();
-  std::shared_ptr<Data> data = nullptr;
-  auto cmp = [&interestName](const Data& t){return t.getFullName() == interestName;};
+  std::shared_ptr<const Data> data = nullptr;
   // determine if it is torrent file (that we have)
-  auto torrent_it =  std::find_if(m_torrentSegments.begin(), m_torrentSegments.end(), cmp);
-  if (m_torrentSegments.end() != torrent_it) {
-    data = std::make_shared<Data>(*torrent_it);
+  auto torrent_it = m_torrentSegmentIndex.find(interestName.getSubName(0, interestName.size() - 1));
+  if (m_torrentSegmentIndex.end() != torrent_it &&
+      m_torrentSegments[torrent_it->second].getFullName() == interestName) {
+    data = std::make_shared<Data>(m_torrentSegments[torrent_it->second]);
   }
   else {
-    // determine if it is manifest (that we have)
-    auto manifest_it = std::find_if(m_fileManifests.begin(), m_fileManifests.end(), cmp);
-    if (m_fileManifests.end() != manifest_it) {
-      data = std::make_shared<Data>(*manifest_it) ;
+    // determine if it is manifest (that we have), named in full or only up to its segment number
+    auto manifest_ptr = findFileManifest(interestName.getSubName(0, interestName.size() - 1));
+    if (nullptr == manifest_ptr) {
+      manifest_ptr = findFileManifest(interestName);
+    }
+    if (nullptr != manifest_ptr) {
+      manifest_ptr = loadFileManifest(manifest_ptr - m_fileManifests.data());
+    }
+    if (nullptr != manifest_ptr && (manifest_ptr->getFullName() == interestName ||
+                                    manifest_ptr->getName() == interestName)) {
+      data = std::make_shared<Data>(*manifest_ptr);
     }
     else {
       // determine if it is data packet (that we have)
-      auto manifestName = interestName.getSubName(0, interestName.size() - 2);
-      auto map_it = std::find_if(m_fileStates.begin(), m_fileStates.end(),
-                                       [&manifestName](const std::pair<Name,
-                                                                       std::vector<bool>>& kv){
-                                        return manifestName.isPrefixOf(kv.first
-                                          );
-                                      });
-      if (m_fileStates.end() != map_it) {
+      manifest_ptr = findFileManifest(interestName.getSubName(0, interestName.size() - 2));
+      if (nullptr != manifest_ptr) {
         auto packetName = interestName.getSubName(0, interestName.size() - 1);
         // get out the bitmap to be sure we have the packet
-        auto& fileState = map_it->second;
-        const auto &bitmap = fileState;
+        auto &fileState = m_fileStates[manifest_ptr - m_fileManifests.data()];
         auto packetNum = packetName.get(packetName.size() - 1).toSequenceNumber();
-        if (bitmap[packetNum]) {
-          // get the manifest
-          auto manifest_it = std::find_if(m_fileManifests.begin(), m_fileManifests.end(),
-                                          [&manifestName](const FileManifest& m) {
-                                            return manifestName.isPrefixOf(m.name());
-                                          });
-          auto manifestFileName = manifest_it->file_name();
-          auto filePath = m_dataPath + manifestFileName;
-          data = IoUtil::readDataPacket(interestName,
-                                        *manifest_it,
-                                        m_subManifestSizes[manifestFileName],
-                                        filePath);
+        if (packetNum < fileState.size() && fileState.test(packetNum)) {
+          // answer from the cache if possible, otherwise read the packet and cache it
+          data = m_packetCache->find(interestName);
+          m_metrics.increment(nullptr != data ? Metrics::SERVE_CACHE_HITS
+                                              : Metrics::SERVE_CACHE_MISSES);
+          if (nullptr == data) {
+            auto manifestFileName = manifest_ptr->file_name();
+            adviseManifest(*manifest_ptr, m_dataPath + manifestFileName);
+            serveDataPacket(interest,
+                            IoUtil::dataOffset(*manifest_ptr,
+                                               m_subManifestSizes[manifestFileName],
+                                               packetNum),
+                            manifest_ptr->data_packet_size(),
+                            m_dataPath + manifestFileName);
+          }
+          // queued after the read of the requested packet, if any
+          readAhead(*manifest_ptr, packetNum);
+          if (nullptr == data) {
+            return;
+          }
         }
       }
     }
   }
   if (nullptr != data) {
-    m_face->put(*data);
+    putData(*data);
   }
   else {
     // TODO(msweatt) NACK
-    LOG_ERROR << "NACK: " << interest << std::endl;
+    LOG_ERROR << "NACK: " << interest;
   }
   return;
 }
 
+void
+TorrentManager::adviseManifest(const FileManifest& manifest, const std::string& filePath)
+{
+  size_t position = &manifest - m_fileManifests.data();
+  if (m_advisedManifests.end() != std::find(m_advisedManifests.begin(),
+                                            m_advisedManifests.end(),
+                                            position)) {
+    return;
+  }
+  if (ADVISED_MANIFESTS <= m_advisedManifests.size()) {
+    m_advisedManifests.pop_front();
+  }
+  m_advisedManifests.push_back(position);
+  auto subManifestSize = m_subManifestSizes[manifest.file_name()];
+  // the file state of a served manifest has all its packets, even once the manifest is evicted
+  m_fileMappings->willNeed(filePath,
+                           IoUtil::dataOffset(manifest, subManifestSize, 0),
+                           m_fileStates[position].size() * manifest.data_packet_size());
+}
+
+void
+TorrentManager::serveDataPacket(const Interest&    interest,
+                                uint64_t           offset,
+                                size_t             dataPacketSize,
+                                const std::string& filePath)
+{
+  if (nullptr == m_seedWorkers) {
+    onDataPacketRead(interest,
+                     IoUtil::readDataPacket(interest.getName(),
+                                            offset,
+                                            dataPacketSize,
+                                            filePath,
+                                            *m_fileMappings));
+    return;
+  }
+  // the Interests for a packet already being read are all answered by the Data of that read
+  const auto& interestName = interest.getName();
+  auto it = m_inFlightReads.find(interestName);
+  if (m_inFlightReads.end() != it) {
+    ++it->second;
+    LOG_DEBUG << "Aggregated: " << interest;
+    return;
+  }
+  // shed the load rather than queue reads that would complete after the Interest expires
+  if (*m_pendingReads >= m_maxPendingReads) {
+    LOG_DEBUG << "Overloaded, NACK: " << interest;
+    lp::Nack nack(interest);
+    nack.setReason(lp::NackReason::CONGESTION);
+    m_face->put(nack);
+    m_metrics.increment(Metrics::NACKS_SENT);
+    return;
+  }
+  ++*m_pendingReads;
+  m_inFlightReads.emplace(interestName, 1);
+  // the worker keeps the files mapped until the read is done, even if this manager is gone
+  auto mappings = m_fileMappings;
+  auto face = m_face;
+  std::weak_ptr<size_t> pendingReads = m_pendingReads;
+  m_seedWorkers->post([this, interest, offset, dataPacketSize, filePath, mappings, face,
+                       pendingReads] {
+    auto data = IoUtil::readDataPacket(interest.getName(), offset, dataPacketSize, filePath,
+                                       *mappings);
+    face->getIoService().post([this, interest, data, pendingReads] {
+      auto pending = pendingReads.lock();
+      if (nullptr != pending) {
+        --*pending;
+        auto it = m_inFlightReads.find(interest.getName());
+        if (m_inFlightReads.end() != it) {
+          if (it->second > 1) {
+            LOG_DEBUG << "Answering " << it->second << " Interests for " << interest.getName();
+          }
+          m_inFlightReads.erase(it);
+        }
+        // a single Data satisfies every pending Interest with its name in the forwarder
+        onDataPacketRead(interest, data);
+      }
+    });
+  });
+}
+
+const FileManifest*
+TorrentManager::loadFileManifest(size_t position)
+{
+  auto& manifest = m_fileManifests[position];
+  auto evicted_it = m_evictedManifests.find(manifest.getName());
+  if (m_evictedManifests.end() != evicted_it) {
+    FileManifest loaded;
+    try {
+      if (!m_metadata.find(evicted_it->second, loaded)) {
+        LOG_ERROR << "Cannot reload the file manifest " << evicted_it->second;
+        return nullptr;
+      }
+    }
+    catch (const tlv::Error& e) {
+      LOG_ERROR << "Cannot decode the file manifest " << evicted_it->second << ": " << e.what();
+      return nullptr;
+    }
+    LOG_DEBUG << "Reloaded the file manifest " << evicted_it->second;
+    m_manifestBytes -= evictedManifestBytes(evicted_it->second);
+    m_manifestBytes += manifestBytes(loaded);
+    m_evictedManifests.erase(evicted_it);
+    manifest = std::move(loaded);
+    touchFileManifest(position);
+    enforceMemoryBudget();
+  }
+  else {
+    touchFileManifest(position);
+  }
+  return &manifest;
+}
+
+void
+TorrentManager::touchFileManifest(size_t position)
+{
+  const auto& fileState = m_fileStates[position];
+  if (0 == fileState.size() || !fileState.complete()) {
+    return;
+  }
+  const auto& name = m_fileManifests[position].getName();
+  auto it = m_completeManifestIndex.find(name);
+  if (m_completeManifestIndex.end() != it) {
+    m_completeManifests.splice(m_completeManifests.begin(), m_completeManifests, it->second);
+  }
+  else {
+    m_completeManifests.push_front(name);
+    m_completeManifestIndex.emplace(name, m_completeManifests.begin());
+  }
+}
+
+void
+TorrentManager::enforceMemoryBudget()
+{
+  // an evicted manifest is reloaded from the store
+  if (0 == m_memoryBudget || !m_metadata.isOpen()) {
+    return;
+  }
+  while (m_manifestBytes > m_memoryBudget && 1 < m_completeManifests.size()) {
+    auto name = m_completeManifests.back();
+    m_completeManifests.pop_back();
+    m_completeManifestIndex.erase(name);
+    auto position_it = m_fileManifestIndex.find(name);
+    if (m_fileManifestIndex.end() == position_it) {
+      continue;
+    }
+    auto position = position_it->second;
+    const auto& fileState = m_fileStates[position];
+    auto& manifest = m_fileManifests[position];
+    // a manifest missing packets again is needed to download them
+    auto fullName = manifest.getFullName();
+    if (0 == fileState.size() || !fileState.complete() || !m_metadata.contains(fullName)) {
+      continue;
+    }
+    LOG_DEBUG << "Evicting the file manifest " << fullName;
+    m_manifestBytes -= manifestBytes(manifest);
+    m_manifestBytes += evictedManifestBytes(fullName);
+    // the packets are served knowing only the name, packet size and file state of the manifest
+    manifest = FileManifest(manifest.getName(),
+                            manifest.data_packet_size(),
+                            manifest.catalog_prefix(),
+                            std::vector<Name>(),
+                            manifest.submanifest_ptr());
+    m_evictedManifests.emplace(manifest.getName(), fullName);
+  }
+}
+
+void
+TorrentManager::readAhead(const FileManifest& manifest, uint64_t packetNum)
+{
+  if (nullptr == m_seedWorkers || 0 == m_readaheadPackets) {
+    return;
+  }
+  size_t position = &manifest - m_fileManifests.data();
+  // the file state of a served manifest has all its packets, even once the manifest is evicted
+  const auto& fileState = m_fileStates[position];
+  auto it = m_readahead.find(position);
+  if (m_readahead.end() == it) {
+    m_readahead.emplace(position, ReadaheadState{packetNum, 1, packetNum + 1});
+    return;
+  }
+  auto& state = it->second;
+  if (packetNum == state.last + 1) {
+    ++state.run;
+  }
+  else if (packetNum > state.last) {
+    state.run = 1;
+    state.end = packetNum + 1;
+  }
+  else {
+    // a packet requested again (e.g. by another peer) neither extends nor breaks the run
+    return;
+  }
+  state.last = packetNum;
+  if (packetNum + 1 >= fileState.size()) {
+    // the sub-manifest was requested up to its end
+    m_readahead.erase(it);
+    return;
+  }
+  // refill the window once half of it was requested, leaving room for the reads of the requested
+  // packets
+  auto begin = std::max(state.end, packetNum + 1);
+  if (SEQUENTIAL_RUN > state.run || begin > packetNum + m_readaheadPackets / 2 ||
+      *m_pendingReads >= m_maxPendingReads / 2) {
+    return;
+  }
+  auto end = std::min<uint64_t>(packetNum + 1 + m_readaheadPackets, fileState.size());
+  state.end = std::max(state.end, end);
+  if (begin >= end || nullptr == loadFileManifest(position)) {
+    return;
+  }
+  const auto& catalog = manifest.catalog();
+  auto subManifestSize = m_subManifestSizes[manifest.file_name()];
+  std::vector<std::pair<Name, uint64_t>> reads;
+  for (auto n = begin; n < end; ++n) {
+    const auto& fullName = catalog[n];
+    if (n >= fileState.size() || !fileState.test(n) ||
+        m_packetCache->contains(fullName) || m_inFlightReads.count(fullName) > 0) {
+      continue;
+    }
+    m_inFlightReads.emplace(fullName, 0);
+    reads.emplace_back(fullName, IoUtil::dataOffset(manifest, subManifestSize, n));
+  }
+  if (reads.empty()) {
+    return;
+  }
+  LOG_DEBUG << "Reading ahead " << reads.size() << " packets after " << catalog[packetNum];
+  // the whole window is a single read for the limit on the pending reads
+  ++*m_pendingReads;
+  auto dataPacketSize = manifest.data_packet_size();
+  auto filePath = m_dataPath + manifest.file_name();
+  auto mappings = m_fileMappings;
+  auto face = m_face;
+  std::weak_ptr<size_t> pendingReads = m_pendingReads;
+  m_seedWorkers->post([this, reads, dataPacketSize, filePath, mappings, face, pendingReads] {
+    std::vector<shared_ptr<Data>> packets;
+    for (const auto& read : reads) {
+      packets.push_back(IoUtil::readDataPacket(read.first, read.second, dataPacketSize, filePath,
+                                               *mappings));
+    }
+    face->getIoService().post([this, reads, packets, pendingReads] {
+      auto pending = pendingReads.lock();
+      if (nullptr != pending) {
+        --*pending;
+        for (size_t i = 0; i < reads.size(); ++i) {
+          onPacketReadAhead(reads[i].first, packets[i]);
+        }
+      }
+    });
+  });
+}
+
+void
+TorrentManager::onPacketReadAhead(const Name& fullName, const shared_ptr<Data>& data)
+{
+  size_t waiting = 0;
+  auto it = m_inFlightReads.find(fullName);
+  if (m_inFlightReads.end() != it) {
+    waiting = it->second;
+    m_inFlightReads.erase(it);
+  }
+  if (nullptr != data) {
+    m_metrics.increment(Metrics::PACKETS_READ_AHEAD);
+    m_packetCache->insert(*data);
+    if (waiting > 0) {
+      LOG_DEBUG << "Answering " << waiting << " Interests for " << fullName;
+      putData(*data);
+    }
+  }
+  else if (waiting > 0) {
+    onDataPacketRead(Interest(fullName), data);
+  }
+}
+
+void
+TorrentManager::onDataPacketRead(const Interest& interest, const shared_ptr<Data>& data)
+{
+  const auto& interestName = interest.getName();
+  if (nullptr != data) {
+    m_packetCache->insert(*data);
+    putData(*data);
+    return;
+  }
+  // the packet is no longer on disk, so it has to be downloaded again
+  LOG_ERROR << "Missing packet on disk: " << interestName;
+  auto manifest_ptr = findFileManifest(interestName.getSubName(0, interestName.size() - 2));
+  // the catalog of the manifest is needed again to download the packet
+  if (nullptr != manifest_ptr) {
+    manifest_ptr = loadFileManifest(manifest_ptr - m_fileManifests.data());
+  }
+  if (nullptr != manifest_ptr) {
+    auto& fileState = m_fileStates[manifest_ptr - m_fileManifests.data()];
+    auto packetNum = interestName.get(interestName.size() - 2).toSequenceNumber();
+    if (packetNum < fileState.size() && fileState.test(packetNum)) {
+      fileState.reset(packetNum);
+      ++m_missingPackets;
+      m_journal.setState(manifest_ptr->file_name(),
+                         manifest_ptr->submanifest_number(),
+                         fileState.toBitmap());
+    }
+  }
+  // TODO(msweatt) NACK
+  LOG_ERROR << "NACK: " << interest;
+}
+
+void
+TorrentManager::putData(const Data& data)
+{
+  m_face->put(data);
+  m_metrics.increment(Metrics::DATA_SERVED);
+  m_metrics.increment(Metrics::BYTES_SERVED, data.wireEncode().size());
+}
+
+void
+TorrentManager::logMetrics()
+{
+  std::ostringstream os;
+  dumpMetrics(os);
+  LOG_INFO << "Metrics of " << m_torrentFileName << ":\n" << os.str();
+  m_metricsScheduler->scheduleEvent(m_metricsInterval, [this] { logMetrics(); });
+}
+
 void
 TorrentManager::onRegisterFailed(const Name& prefix, const std::string& reason)
 {
   LOG_ERROR << "ERROR: Failed to register prefix \""
-            << prefix << "\" in local hub's daemon (" << reason << ")"
-            << std::endl;
+            << prefix << "\" in local hub's daemon (" << reason << ")";
   shutdown();
 }
 
 shared_ptr<Interest>
-TorrentManager::createInterest(Name name)
+TorrentManager::createInterest(const Name& name, bool exact)
 {
   shared_ptr<Interest> interest = make_shared<Interest>(name);
-  interest->setInterestLifetime(time::milliseconds(2000));
+  interest->setInterestLifetime(m_rttEstimator.getRto());
   interest->setMustBeFresh(true);
+  if (exact) {
+    interest->setMaxSuffixComponents(1);
+  }
+  return interest;
+}
 
-  // Select routable prefix
-  // Create and set the forwarding hint
-  Delegation del;
-  del.preference = 1;
-  del.name = m_stats_table_iter->getRecordName();
-  DelegationList list({del});
-
-  // Stats Table update here...
-  m_stats_table_iter->incrementSentInterests();
-
+void
+TorrentManager::updateStatsTable()
+{
   m_sortingCounter++;
   if (m_sortingCounter >= SORTING_INTERVAL) {
     // Use the sorting interval to send out "ALIVE" Interests as well
@@ -808,70 +1605,365 @@ TorrentManager::createInterest(Name name)
     }
     // Do the actual sorting related stuff
     m_sortingCounter = 0;
-    m_statsTable.sort();
+    m_statsTable.sort(StatsTable::scoreComparator());
     m_stats_table_iter = m_statsTable.begin();
     m_retries = 0;
   }
+}
 
-  interest->setForwardingHint(list);
+InterestQueue::Priority
+TorrentManager::queuePriority(const Name& name, InterestQueue::Priority priority) const
+{
+  if (m_failedInterests.end() == m_failedInterests.find(name)) {
+    return priority;
+  }
+  switch (priority) {
+    case InterestQueue::TORRENT_FILE:
+      return InterestQueue::TORRENT_FILE_RETRY;
+    case InterestQueue::FILE_MANIFEST:
+      return InterestQueue::FILE_MANIFEST_RETRY;
+    case InterestQueue::DATA_PACKET_HIGH:
+    case InterestQueue::DATA_PACKET:
+    case InterestQueue::DATA_PACKET_LOW:
+      return InterestQueue::DATA_PACKET_RETRY;
+    default:
+      return priority;
+  }
+}
 
-  return interest;
+InterestQueue::Priority
+TorrentManager::dataPacketPriority(const Name& packetName) const
+{
+  // the last few packets are as urgent as the retries
+  if (m_endgame) {
+    return InterestQueue::DATA_PACKET_RETRY;
+  }
+  auto priority = InterestQueue::DATA_PACKET;
+  // <file prefix>/<submanifest number>/<packet number>/<implicit digest>
+  auto it = m_filePriorities.find(packetName.getSubName(0, packetName.size() - 3));
+  if (m_filePriorities.end() != it) {
+    priority = static_cast<InterestQueue::Priority>(InterestQueue::DATA_PACKET_HIGH + it->second);
+  }
+  return queuePriority(packetName, priority);
 }
 
 void
 TorrentManager::nackCallBack(const Interest& i, const lp::Nack& n) {
-  LOG_DEBUG << "Nack received: " << n.getReason() << ": " << i << std::endl;
+  LOG_DEBUG << "Nack received: " << n.getReason() << ": " << i;
+  m_metrics.increment(Metrics::NACKS_RECEIVED);
   auto it = m_pendingInterests.find(i.getName());
-  Name routablePrefix = (i.getForwardingHint().begin())->name;
-  if (m_stats_table_iter->getRecordName() == routablePrefix) {
-    m_stats_table_iter++;
-    if (m_stats_table_iter == m_statsTable.end()) {
-      m_stats_table_iter = m_statsTable.begin();
-    }
+  if (m_pendingInterests.end() == it) {
+    return;
+  }
+  Name routablePrefix = hintPrefix(i);
+  auto record_it = findStatsRecord(i);
+  auto rtt = m_statsTable.end() != record_it && record_it->getRecordRtt() > time::nanoseconds::zero()
+             ? record_it->getRecordRtt() : m_rttEstimator.getSrtt();
+  m_scheduler.onLoss(routablePrefix, time::steady_clock::now(), rtt,
+                     lp::NackReason::CONGESTION == n.getReason());
+
+  // resend through another prefix, even if its window is full, as the Interest is still pending
+  auto next_it = m_scheduler.select(m_statsTable, routablePrefix, false);
+  if (m_statsTable.end() == next_it) {
+    // there is nowhere to resend it, so give up, the Nack being already accounted for
+    auto giveUp = std::get<5>(it->second);
+    giveUp(i);
+    return;
   }
   Interest newInterest(i);
-  m_stats_table_iter->incrementSentInterests();
-
-  // Create and set the forwarding hint
-  Delegation del;
-  del.preference = 1;
-  del.name = m_stats_table_iter->getRecordName();
-  DelegationList list({del});
+  next_it->incrementSentInterests();
+  m_scheduler.onSent(next_it->getRecordName());
 
   if (m_updateHandler->needsUpdate()) {
-    m_updateHandler->sendAliveInterest(m_stats_table_iter);
+    m_updateHandler->sendAliveInterest(next_it);
   }
 
-  newInterest.setForwardingHint(list);
-  LOG_DEBUG << "Resending Interest with LINK: " << m_stats_table_iter->getRecordName()
-            << std::endl;
+  setHintPrefix(newInterest, next_it->getRecordName());
+  newInterest.setInterestLifetime(m_rttEstimator.getRto());
+  LOG_DEBUG << "Resending Interest with LINK: " << next_it->getRecordName();
+  m_metrics.increment(Metrics::INTERESTS_SENT);
 
-  m_face->expressInterest(newInterest, std::get<0>(it->second),
-                          std::bind(&TorrentManager::nackCallBack, this, _1, _2),
-                          std::get<1>(it->second));
+  // the Nack answered the original Interest, so the RTT is measured from the resent one
+  std::get<2>(it->second) = time::steady_clock::now();
+
+  auto id = m_face->expressInterest(newInterest, std::get<0>(it->second),
+                                    std::bind(&TorrentManager::nackCallBack, this, _1, _2),
+                                    std::get<1>(it->second));
+  if (std::get<4>(it->second) == routablePrefix) {
+    std::get<3>(it->second) = id;
+    std::get<4>(it->second) = next_it->getRecordName();
+  }
+  auto copies_it = m_copies.find(i.getName());
+  if (m_copies.end() != copies_it) {
+    for (auto& copy : copies_it->second) {
+      if (copy.first == routablePrefix) {
+        copy = {next_it->getRecordName(), id};
+        break;
+      }
+    }
+  }
  }
 
 void
 TorrentManager::sendInterest()
 {
-  while (m_pendingInterests.size() < WINDOW_SIZE && !m_interestQueue->empty()) {
-    queueTuple tup = m_interestQueue->pop();
-    m_pendingInterests.insert({std::get<0>(tup)->getName(), std::make_tuple(std::get<1>(tup),
-                               std::get<2>(tup))});
-    LOG_DEBUG << "Sending: " <<  *(std::get<0>(tup)) << std::endl;
-    m_face->expressInterest(*std::get<0>(tup), std::get<1>(tup),
-                            std::bind(&TorrentManager::nackCallBack, this, _1, _2),
-                            std::get<2>(tup));
+  // release the share of the budget of the Interests completed since
+  if (nullptr != m_budget) {
+    m_budget->update(m_budgetId, m_pendingInterests.size(), !m_interestQueue->empty());
+  }
+  while (!m_interestQueue->empty() || queueMissingDataPacket()) {
+    if (0 != m_maxPendingInterests && m_pendingInterests.size() >= m_maxPendingInterests) {
+      break;
+    }
+    updateStatsTable();
+    // select the routable prefix with the best score and room in its window
+    auto record_it = m_scheduler.select(m_statsTable);
+    if (m_statsTable.end() == record_it) {
+      break;
+    }
+    // the Interests of the other torrents sharing the budget are sent first if over our share
+    if (nullptr != m_budget && !m_budget->acquire(m_budgetId)) {
+      break;
+    }
+    auto entry = m_interestQueue->pop();
+    // the Interest is created once it is sent, so its lifetime follows the current RTO
+    auto interest = createInterest(entry.name, entry.request->exact);
+    setHintPrefix(*interest, record_it->getRecordName());
+    record_it->incrementSentInterests();
+    m_scheduler.onSent(record_it->getRecordName());
+    auto request = entry.request;
+    DataCallback dataReceived = [this, request] (const Interest& interest, const Data& data) {
+      // ignore the copies answered after the first one
+      if (m_pendingInterests.end() == m_pendingInterests.find(interest.getName())) {
+        return;
+      }
+      m_failedInterests.erase(interest.getName());
+      onInterestSatisfied(interest, data);
+      request->onData(interest, data);
+      cancelCopies(interest.getName(), hintPrefix(interest));
+    };
+    TimeoutCallback giveUp = [this, request] (const Interest& interest) {
+      // the request fails only once all of its copies failed
+      if (!dropCopy(interest.getName(), hintPrefix(interest))) {
+        // a retry is sent ahead of the fresh requests
+        m_failedInterests.insert(interest.getName());
+        request->onTimeout(interest);
+      }
+    };
+    TimeoutCallback dataFailed = [this, request, giveUp] (const Interest& interest) {
+      // nobody may have the name of a speculative request, which says nothing of the path
+      onInterestTimedOut(interest, request->speculative);
+      giveUp(interest);
+    };
+    LOG_DEBUG << "Sending: " << *interest;
+    m_metrics.increment(Metrics::INTERESTS_SENT);
+    auto id = m_face->expressInterest(*interest, dataReceived,
+                                      std::bind(&TorrentManager::nackCallBack, this, _1, _2),
+                                      dataFailed);
+    const auto& name = entry.name;
+    m_pendingInterests[name] = std::make_tuple(dataReceived,
+                                               dataFailed,
+                                               time::steady_clock::now(),
+                                               id,
+                                               record_it->getRecordName(),
+                                               giveUp);
+    if (m_endgame && IoUtil::DATA_PACKET == IoUtil::findType(name)) {
+      duplicateInterest(name);
+    }
+  }
+  if (nullptr != m_budget) {
+    m_budget->update(m_budgetId, m_pendingInterests.size(), !m_interestQueue->empty());
+  }
+}
+
+bool
+TorrentManager::queueMissingDataPacket()
+{
+  if (nullptr == m_missingRequest) {
+    return false;
+  }
+  while (findNextMissingDataPacket(m_missingCursor)) {
+    // the files that cannot be written are skipped whole
+    if (!m_unwritableFiles.empty() &&
+        0 != m_unwritableFiles.count(m_fileManifests[m_missingCursor.first].file_name())) {
+      ++m_missingCursor.first;
+      m_missingCursor.second = 0;
+      continue;
+    }
+    Name name = packetName(m_missingCursor);
+    ++m_missingCursor.second;
+    // skip the packets that were requested explicitly or are being written
+    if (m_pendingInterests.end() != m_pendingInterests.find(name) ||
+        m_interestQueue->contains(name) ||
+        m_pendingWrites.end() != m_pendingWrites.find(name)) {
+      continue;
+    }
+    m_interestQueue->push(name, m_missingRequest, dataPacketPriority(name));
+    return true;
+  }
+  // the request is kept for the segments still to be received
+  return false;
+}
+
+void
+TorrentManager::onInterestSatisfied(const Interest& interest, const Data& data)
+{
+  auto now = time::steady_clock::now();
+  auto record_it = findStatsRecord(interest);
+  auto it = m_pendingInterests.find(interest.getName());
+  if (m_pendingInterests.end() != it) {
+    auto rtt = now - std::get<2>(it->second);
+    m_rttEstimator.addMeasurement(rtt);
+    m_metrics.recordRtt(hintPrefix(interest), rtt);
+    if (m_statsTable.end() != record_it) {
+      record_it->recordRtt(rtt);
+    }
+  }
+  auto size = data.wireEncode().size();
+  m_metrics.increment(Metrics::DATA_RECEIVED);
+  m_metrics.increment(Metrics::BYTES_RECEIVED, size);
+  if (m_statsTable.end() != record_it) {
+    record_it->incrementReceivedData();
+    record_it->recordReceivedBytes(size, now);
+  }
+  m_scheduler.onData(hintPrefix(interest));
+}
+
+void
+TorrentManager::onInterestTimedOut(const Interest& interest, bool speculative)
+{
+  if (speculative) {
+    m_scheduler.onLoss(hintPrefix(interest), time::steady_clock::now(),
+                       m_rttEstimator.getSrtt(), false);
+    return;
+  }
+  auto record_it = findStatsRecord(interest);
+  auto rtt = m_rttEstimator.getSrtt();
+  if (m_statsTable.end() != record_it) {
+    record_it->incrementTimeouts();
+    if (record_it->getRecordRtt() > time::nanoseconds::zero()) {
+      rtt = record_it->getRecordRtt();
+    }
+  }
+  m_metrics.increment(Metrics::TIMEOUTS);
+  m_rttEstimator.backoff();
+  m_scheduler.onLoss(hintPrefix(interest), time::steady_clock::now(), rtt);
+  LOG_DEBUG << "Timeout through " << hintPrefix(interest) << ", window: "
+            << m_scheduler.window() << ", RTO: " << m_rttEstimator.getRto();
+}
+
+StatsTable::iterator
+TorrentManager::findStatsRecord(const Interest& interest)
+{
+  auto prefix = hintPrefix(interest);
+  return prefix.empty() ? m_statsTable.end() : m_statsTable.find(prefix);
+}
+
+void
+TorrentManager::checkEndgame()
+{
+  if (m_endgame || m_missingPackets > ENDGAME_THRESHOLD || !hasAllTorrentSegments()) {
+    return;
+  }
+  std::vector<Name> manifests;
+  findFileManifestsToDownload(manifests);
+  if (!manifests.empty()) {
+    return;
+  }
+  LOG_INFO << "Endgame: " << m_missingPackets << " data packets missing";
+  m_endgame = true;
+  std::vector<Name> names;
+  for (const auto& kv : m_pendingInterests) {
+    if (IoUtil::DATA_PACKET == IoUtil::findType(kv.first)) {
+      names.push_back(kv.first);
+    }
+  }
+  for (const auto& name : names) {
+    duplicateInterest(name);
   }
 }
 
+void
+TorrentManager::duplicateInterest(const Name& name)
+{
+  auto it = m_pendingInterests.find(name);
+  if (m_pendingInterests.end() == it) {
+    return;
+  }
+  auto& copies = m_copies[name];
+  if (copies.empty()) {
+    copies.emplace_back(std::get<4>(it->second), std::get<3>(it->second));
+  }
+  // use the best prefixes that do not carry a copy yet, even if their windows are full
+  for (auto record_it = m_statsTable.begin();
+       record_it != m_statsTable.end() && copies.size() < ENDGAME_COPIES;
+       ++record_it) {
+    const auto& prefix = record_it->getRecordName();
+    if (copies.end() != std::find_if(copies.begin(), copies.end(),
+                                     [&prefix] (const std::pair<Name, const PendingInterestId*>& c) {
+                                       return c.first == prefix;
+                                     })) {
+      continue;
+    }
+    Interest interest(name);
+    interest.setInterestLifetime(m_rttEstimator.getRto());
+    interest.setMustBeFresh(true);
+    setHintPrefix(interest, prefix);
+    record_it->incrementSentInterests();
+    m_scheduler.onSent(prefix);
+    LOG_DEBUG << "Sending endgame copy: " << interest;
+    m_metrics.increment(Metrics::INTERESTS_SENT);
+    auto id = m_face->expressInterest(interest, std::get<0>(it->second),
+                                      std::bind(&TorrentManager::nackCallBack, this, _1, _2),
+                                      std::get<1>(it->second));
+    copies.emplace_back(prefix, id);
+  }
+}
+
+bool
+TorrentManager::dropCopy(const Name& name, const Name& prefix)
+{
+  auto it = m_copies.find(name);
+  if (m_copies.end() == it) {
+    return false;
+  }
+  auto& copies = it->second;
+  copies.erase(std::remove_if(copies.begin(), copies.end(),
+                              [&prefix] (const std::pair<Name, const PendingInterestId*>& c) {
+                                return c.first == prefix;
+                              }),
+               copies.end());
+  if (copies.empty()) {
+    m_copies.erase(it);
+    return false;
+  }
+  return true;
+}
+
+void
+TorrentManager::cancelCopies(const Name& name, const Name& prefix)
+{
+  auto it = m_copies.find(name);
+  if (m_copies.end() == it) {
+    return;
+  }
+  auto now = time::steady_clock::now();
+  for (const auto& copy : it->second) {
+    if (copy.first != prefix) {
+      m_face->removePendingInterest(copy.second);
+      // the copy was neither answered nor lost, so it does not shrink the window
+      m_scheduler.onLoss(copy.first, now, m_rttEstimator.getSrtt(), false);
+    }
+  }
+  m_copies.erase(it);
+}
+
 void
 TorrentManager::eraseOwnRoutablePrefix()
 {
   Name ownRoutablePrefix = m_updateHandler->getOwnRoutablePrefix();
   if (m_statsTable.find(ownRoutablePrefix) != m_statsTable.end()) {
-    LOG_DEBUG << "Erasing own routable prefix from StatsTable: " << ownRoutablePrefix
-              << std::endl;
+    LOG_DEBUG << "Erasing own routable prefix from StatsTable: " << ownRoutablePrefix;
     std::cout << m_statsTable.erase(ownRoutablePrefix) << std::endl;
   }
   m_stats_table_iter = m_statsTable.begin();
@@ -879,5 +1971,60 @@ TorrentManager::eraseOwnRoutablePrefix()
   m_retries = 0;
 }
 
+void
+TorrentManager::indexTorrentSegments(size_t from)
+{
+  for (size_t i = from; i < m_torrentSegments.size(); ++i) {
+    m_torrentSegmentIndex[m_torrentSegments[i].getName()] = i;
+  }
+}
+
+void
+TorrentManager::indexFileManifests(size_t from)
+{
+  Name previousPrefix;
+  for (size_t i = from; i < m_fileManifests.size(); ++i) {
+    const auto& name = m_fileManifests[i].getName();
+    m_fileManifestIndex[name] = i;
+    // <file prefix>/<submanifest number>
+    auto filePrefix = name.getSubName(0, name.size() - 1);
+    auto file_it = m_fileIndex.find(filePrefix);
+    if (m_fileIndex.end() == file_it) {
+      file_it = m_fileIndex.insert({filePrefix, {i, i}}).first;
+    }
+    // manifests of files entirely after 'from' have shifted, so their first position is stale
+    else if ((i == from || filePrefix != previousPrefix) && file_it->second.first >= from) {
+      file_it->second.first = i;
+    }
+    file_it->second.second = i;
+    previousPrefix = filePrefix;
+  }
+}
+
+const FileManifest*
+TorrentManager::findFileManifest(const Name& manifestName) const
+{
+  auto it = m_fileManifestIndex.find(manifestName);
+  return m_fileManifestIndex.end() == it ? nullptr : &m_fileManifests[it->second];
+}
+
+bool
+TorrentManager::isWritable(const Name& packetName) const
+{
+  if (m_unwritableFiles.empty()) {
+    return true;
+  }
+  // <manifest name>/<sequence number>
+  auto manifest_ptr = findFileManifest(packetName.getPrefix(-1));
+  return nullptr == manifest_ptr || 0 == m_unwritableFiles.count(manifest_ptr->file_name());
+}
+
+FileState*
+TorrentManager::findFileState(const Name& manifestName)
+{
+  auto it = m_fileManifestIndex.find(manifestName);
+  return m_fileManifestIndex.end() == it ? nullptr : &m_fileStates[it->second];
+}
+
 }  // end ntorrent
 }  // end ndn
@@ -23,9 +23,21 @@
 #define INCLUDED_TORRENT_FILE_MANAGER_H
 
 #include "file-manifest.hpp"
+#include "file-state.hpp"
 #include "interest-queue.hpp"
+#include "metadata-store.hpp"
+#include "metrics.hpp"
+#include "multipath-scheduler.hpp"
+#include "packet-cache.hpp"
+#include "piece-availability.hpp"
+#include "resume-journal.hpp"
+#include "rtt-estimator.hpp"
 #include "torrent-file.hpp"
 #include "update-handler.hpp"
+#include "util/async-writer.hpp"
+#include "util/file-map-cache.hpp"
+#include "util/thread-pool.hpp"
+#include "window-budget.hpp"
 
 #include <ndn-cxx/data.hpp>
 #include <ndn-cxx/face.hpp>
@@ -33,9 +45,17 @@
 #include <ndn-cxx/link.hpp>
 #include <ndn-cxx/name.hpp>
 #include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
 
+#include <algorithm>
+#include <deque>
 #include <functional>
+#include <iosfwd>
+#include <limits>
+#include <list>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -53,10 +73,54 @@ class TorrentManager : noncopyable {
  public:
    typedef std::function<void(const ndn::Name&)>                     DataReceivedCallback;
    typedef std::function<void(const std::vector<ndn::Name>&)>        ManifestReceivedCallback;
+   typedef std::function<void(const std::vector<ndn::Name>&)>        ManifestSegmentReceivedCallback;
    typedef std::function<void(const std::vector<ndn::Name>&)>        TorrentFileReceivedCallback;
    typedef std::function<void(const ndn::Name&, const std::string&)> FailedCallback;
-   typedef std::tuple<DataCallback, TimeoutCallback>                 PendingInterestQueueEntry;
+   // The callbacks, send time, id on the face and routable prefix of a pending Interest, and the
+   // callback failing its request without accounting for a timeout
+   typedef std::tuple<DataCallback,
+                      TimeoutCallback,
+                      time::steady_clock::TimePoint,
+                      const PendingInterestId*,
+                      Name,
+                      TimeoutCallback>                               PendingInterestQueueEntry;
    typedef std::unordered_map<ndn::Name, PendingInterestQueueEntry>  PendingInterestQueue;
+   // The position of a file manifest in this manager and of a packet in the manifest's catalog
+   typedef std::pair<size_t, size_t>                                 PacketHandle;
+
+   /*
+    * \brief The resources that the managers of the torrents hosted by one process share
+    * Each resource that is null is owned by the manager itself.
+    */
+   struct Resources {
+     // The face used for data retrieval and seeding
+     std::shared_ptr<Face>          face;
+     // The key chain signing our Interests and ALIVE replies
+     std::shared_ptr<KeyChain>      keyChain;
+     // The writer of the received data packets
+     std::shared_ptr<AsyncWriter>   writer;
+     // The bound on the Interests outstanding across the torrents; if set, the events of the face
+     // keep being processed once this manager shuts down
+     std::shared_ptr<WindowBudget>  budget;
+     // The threads reading the served data packets from disk; if null the packets are read on
+     // the thread processing the events of the face
+     std::shared_ptr<ThreadPool>    seedWorkers;
+     // The interval at which the metrics are logged; if zero they are only dumped when requested
+     time::milliseconds             metricsInterval;
+     // The directory under which the metadata of each torrent is stored; '.appdata/' if empty
+     std::string                    appDataPath;
+     // The bytes of file manifests each torrent keeps in memory; if zero they are never evicted.
+     // The packets cached for seeding are bounded by the capacity of their cache instead
+     size_t                         memoryBudget;
+     // The Interests each torrent has outstanding at most, on top of the congestion windows; if
+     // zero only the windows bound them
+     size_t                         maxPendingInterests;
+     // The cache of the most recently downloaded or served data packets; if null each torrent
+     // has its own
+     std::shared_ptr<PacketCache>   packetCache;
+     // The mappings of the files whose data packets are served; if null each torrent has its own
+     std::shared_ptr<FileMapCache>  fileMappings;
+   };
 
    /*
     * \brief Create a new Torrent manager with the specified parameters.
@@ -72,6 +136,22 @@ class TorrentManager : noncopyable {
                   bool                  seed = true,
                   std::shared_ptr<Face> face = nullptr);
 
+   /*
+    * \brief Create a new Torrent manager sharing the specified @p resources with other managers.
+    * @param torrentFileName The full name of the initial segment of the torrent file
+    * @param dataPath The path to the location on disk to use for the torrent data
+    * @param resources The resources shared with the other managers of this process
+    */
+   TorrentManager(const ndn::Name&      torrentFileName,
+                  const std::string&    dataPath,
+                  bool                  seed,
+                  const Resources&      resources);
+
+   /*
+    * \brief Leave the window budget shared with the other managers, if any.
+    */
+   ~TorrentManager();
+
   /*
    * @brief Initialize the state of this object.
    *
@@ -132,6 +212,21 @@ class TorrentManager : noncopyable {
   void
   findFileManifestsToDownload(std::vector<Name>& manifestNames) const;
 
+  /*
+   * \brief Find the initial segments of the manifests of all the files of the torrent
+   * @param manifestNames The names of the initial file manifest segments, in the order of the
+   *                      catalog of the torrent file (used as an output vector of names)
+   */
+  void
+  findAllFileManifests(std::vector<Name>& manifestNames) const;
+
+  /*
+   * \brief Return for each file of the torrent, in the order of the catalog of the torrent file,
+   * whether we have all its manifest segments and data packets
+   */
+  std::vector<bool>
+  findCompleteFiles() const;
+
   /*
    * \brief Find the names of the data packets of a file manifest that we are currently missing
    * @param manifestName The name of the manifest
@@ -145,6 +240,16 @@ class TorrentManager : noncopyable {
   void
   findDataPacketsToDownload(const Name& manifestName, std::vector<Name>& packetNames) const;
 
+  /*
+   * \brief Find the data packets of a file manifest that we are currently missing
+   * @param manifestName The name of the manifest
+   * @param packets The handles of the data packets to be downloaded (used as an output vector)
+   *
+   * The handles remain valid until the next file manifest segment is added to this manager.
+   */
+  void
+  findDataPacketsToDownload(const Name& manifestName, std::vector<PacketHandle>& packets) const;
+
   /*
    * \brief Find all the data packets that we are currently missing
    * @param packetNames The name of the data packets to be downloaded
@@ -154,9 +259,170 @@ class TorrentManager : noncopyable {
   void
   findAllMissingDataPackets(std::vector<Name>& packetNames) const;
 
+  /*
+   * \brief Find all the data packets that we are currently missing
+   * @param packets The handles of the data packets to be downloaded (used as an output vector)
+   *
+   * The handles remain valid until the next file manifest segment is added to this manager.
+   */
+  void
+  findAllMissingDataPackets(std::vector<PacketHandle>& packets) const;
+
+  /*
+   * \brief Advance @p packet to the next data packet that we are missing, starting from the one it
+   *        refers to
+   * @return True if there is such a packet, false if @p packet is past the last manifest
+   */
+  bool
+  findNextMissingDataPacket(PacketHandle& packet) const;
+
+  /*
+   * \brief Return the full name of the data packet referred to by @p packet
+   */
+  Name
+  packetName(const PacketHandle& packet) const;
+
+  /*
+   * \brief Return whether any Interest is pending or queued, or any received data packet is still
+   * being written
+   */
   bool
   hasPendingInterests() const;
 
+  /*
+   * @brief Return the number of names in the Interest Queue, yet to be sent
+   */
+  size_t
+  queuedInterests() const;
+
+  /*
+   * @brief Return the number of data packets of the file manifests we have that we are missing
+   */
+  size_t
+  missingDataPackets() const;
+
+  /*
+   * @brief Return true if we are in the endgame of the download
+   *
+   * Once we have all the file manifests and are missing at most ENDGAME_THRESHOLD data packets,
+   * the Interest for each missing packet is duplicated over up to ENDGAME_COPIES routable prefixes.
+   * The first Data to arrive satisfies the request and the other copies are cancelled.
+   */
+  bool
+  inEndgame() const;
+
+  /*
+   * @brief Set the number of threads reading and decoding the torrent file segments and file
+   *        manifests from disk in Initialize() (by default one per core)
+   */
+  void
+  setLoadThreads(size_t numThreads);
+
+  /*
+   * @brief Set the maximum number of data packets being read by the seed workers, beyond which the
+   *        Interests for packets that are not cached are answered with a congestion Nack
+   */
+  void
+  setMaxPendingReads(size_t maxPendingReads);
+
+  /*
+   * @brief Set the number of data packets read ahead by the seed workers into the packet cache
+   *        once the packets of a sub-manifest are requested in order (zero disables readahead)
+   */
+  void
+  setReadahead(size_t numPackets);
+
+  /*
+   * @brief Keep at most about @p bytes of file manifests in memory (zero for no bound)
+   *
+   * Beyond the budget, the least recently used complete file manifests are evicted and reloaded
+   * from the metadata store once needed, e.g. to answer an Interest for them. Only their name is
+   * kept in memory, as their packets are served from the file states. The incomplete manifests
+   * are always kept, as are the manifests of a torrent without a metadata store.
+   *
+   * Only the file manifests count against the budget: the cached data packets are bounded by the
+   * capacity of the packet cache.
+   */
+  void
+  setMemoryBudget(size_t bytes);
+
+  /*
+   * @brief Send at most @p maxPendingInterests Interests at a time, whatever the congestion windows
+   *        of the routable prefixes (zero for no bound)
+   *
+   * The Interest Queue is not bounded as such: the names pushed explicitly stay queued until they
+   * can be sent. Those of download_missing_data_packets() are produced one at a time, once the
+   * queue is empty.
+   */
+  void
+  setMaxPendingInterests(size_t maxPendingInterests);
+
+  /*
+   * @brief Return an estimate of the bytes of memory held by this torrent: its metadata, file
+   *        states, cached packets and pending Interests
+   *
+   * A packet cache shared with other torrents is not counted.
+   */
+  size_t
+  memoryUsage() const;
+
+  enum {
+    // Number of missing data packets at which the endgame starts
+    ENDGAME_THRESHOLD = 32,
+    // Number of routable prefixes over which each Interest is sent in the endgame
+    ENDGAME_COPIES = 3,
+    // Default maximum number of data packets being read by the seed workers
+    DEFAULT_MAX_PENDING_READS = 1024,
+    // Default number of data packets read ahead of the last one requested in order
+    DEFAULT_READAHEAD = 32
+  };
+
+  /*
+   * @brief Return the scheduler spreading our Interests over the routable prefixes, which holds
+   *        the congestion window of each prefix
+   */
+  const MultipathScheduler&
+  getScheduler() const;
+
+  /*
+   * @brief Return the estimator of the round-trip time, which sets the lifetime of our Interests
+   */
+  const RttEstimator&
+  getRttEstimator() const;
+
+  /*
+   * @brief Return the number of peers that advertised each file of the torrent (in the order of
+   *        the catalog of the torrent file) in their replies to our ALIVE Interests
+   */
+  const PieceAvailability&
+  getAvailability() const;
+
+  /*
+   * @brief Return the directory in which the metadata of this torrent is stored
+   */
+  const std::string&
+  appDataPath() const;
+
+  /*
+   * @brief Return the counters and latency histograms of this manager
+   */
+  const Metrics&
+  metrics() const;
+
+  /*
+   * @brief Write the metrics of this manager, as well as the current depth of the Interest queue,
+   *        congestion window and number of pending operations, to @p os as '<name> <value>' lines
+   * The same text answers the Interests for the 'metrics' under the ALIVE prefix of the torrent.
+   */
+  void
+  dumpMetrics(std::ostream& os) const;
+
+  /*
+   * @brief Log the metrics every @p interval, or never if @p interval is zero
+   */
+  void
+  setMetricsInterval(const time::milliseconds& interval);
+
   /*
    * @brief Stop all network activities of this manager
    */
@@ -190,14 +456,30 @@ class TorrentManager : noncopyable {
    *                 the file manifest. It passes the name of the data packet that failed
    *                 to download and a failure reason
    *
-   * This method provides non-blocking downloading of all the file manifest segments
+   * @param onSegment Optional callback to be called as soon as each segment of the file manifest
+   *                  is downloaded, so that its data packets can be requested before the rest of
+   *                  the segments arrive. It passes the names of the data packets of the segment,
+   *                  which are then not passed to onSuccess again.
+   *
+   * This method provides non-blocking downloading of all the file manifest segments. While a
+   * segment is pending, the next segments are requested speculatively by their sub-manifest number
+   * (see setManifestPrefetch()); each one is accepted only once the previous segment confirms its
+   * implicit digest.
    *
    */
   void
-  download_file_manifest(const Name&              manifestName,
-                         const std::string&       path,
-                         ManifestReceivedCallback onSuccess,
-                         FailedCallback           onFailed);
+  download_file_manifest(const Name&                     manifestName,
+                         const std::string&              path,
+                         ManifestReceivedCallback        onSuccess,
+                         FailedCallback                  onFailed,
+                         ManifestSegmentReceivedCallback onSegment = {});
+
+  /*
+   * @brief Set the number of file manifest segments requested ahead of the segment that the
+   *        downloaded ones point to; 0 disables the speculative requests
+   */
+  void
+  setManifestPrefetch(size_t numSegments);
 
   /*
    * @brief Download a data packet
@@ -215,6 +497,40 @@ class TorrentManager : noncopyable {
                        DataReceivedCallback onSuccess,
                        FailedCallback       onFailed);
 
+  /*
+   * @brief Download the data packets named 'packetNames', calling 'onSuccess' or 'onFailed' once
+   *        for each of them. The queued Interests share a single copy of the callbacks.
+   */
+  void
+  download_data_packets(const std::vector<Name>& packetNames,
+                        DataReceivedCallback     onSuccess,
+                        FailedCallback           onFailed);
+
+  /*
+   * @brief Download all the data packets that we are missing, calling 'onSuccess' or 'onFailed'
+   *        once for each of them
+   *
+   * The names are not enumerated up front: whenever the Interest Queue is empty and a routable
+   * prefix has room in its window, the next missing packet is found from the file states. The
+   * packets of the file manifest segments received later are downloaded as well.
+   */
+  void
+  download_missing_data_packets(DataReceivedCallback onSuccess, FailedCallback onFailed);
+
+  enum FilePriority {
+    FILE_PRIORITY_HIGH,
+    FILE_PRIORITY_NORMAL,
+    FILE_PRIORITY_LOW
+  };
+
+  /*
+   * @brief Set the priority of the queued Interests for the data packets of the file of the
+   *        manifest named 'manifestName'. Interests for the torrent file and the file manifests
+   *        are always sent first, and retries before fresh requests.
+   */
+  void
+  setFilePriority(const Name& manifestName, FilePriority priority);
+
   // Seed the specified 'data' to the network.
   void
   seed(const Data& data);
@@ -237,11 +553,32 @@ class TorrentManager : noncopyable {
   bool
   writeData(const Data& packet);
 
+  /**
+   * \brief Hand @p packet composed of torrent data to the writer of this manager.
+   * @param packet The data packet to be written to the disk
+   * @param done The callback to be called once the packet is written
+   * Return 'false' if the packet is not to be written, as we already have it, it is already being
+   * written, its file manifest is unknown or its file cannot be written. Otherwise return 'true'
+   * and call @p done, on the thread processing the events of the face, with whether the packet was
+   * written once the write is complete and the state of its file is updated. A packet whose file
+   * turned out not to be writable, its space not being reserved, is reported as not written.
+   */
+  bool
+  writeDataAsync(const Data& packet, AsyncWriter::Callback done);
+
+  /**
+   * \brief Block until all the data packets handed to the writer are written, and their files'
+   * states are updated.
+   */
+  void
+  drainWrites();
+
   /*
    * \brief Write the @p segment torrent segment to disk at the specified path.
    * @param segment The torrent file segment to be written to disk
-   * @param path The path at which to write the torrent file segment
-   * Write the segment to disk, return 'true' if data successfully written to disk 'false'
+   * @param path The path at which to write the torrent file segment if the metadata store of this
+   *             manager could not be opened
+   * Append the segment to the metadata store, return 'true' if data successfully written to disk 'false'
    * otherwise. Behavior is undefined unless @segment is a correct segment for the torrent file of
    * this manager and @p path is the directory used for all segments of this torrent file.
    */
@@ -251,8 +588,9 @@ class TorrentManager : noncopyable {
   /*
    * \brief Write the @p manifest file manifest to disk at the specified @p path.
    * @param manifest The file manifest  to be written to disk
-   * @param path The path at which to write the file manifest
-   * Write the file manifest to disk, return 'true' if data successfully written to disk 'false'
+   * @param path The path at which to write the file manifest if the metadata store of this
+   *             manager could not be opened
+   * Append the file manifest to the metadata store, return 'true' if data successfully written to disk 'false'
    * otherwise. Behavior is undefined unless @manifest is a correct file manifest for a file in the
    * torrent file of this manager and @p path is the directory used for all file manifests of this
    * torrent file.
@@ -286,20 +624,67 @@ class TorrentManager : noncopyable {
    * @param onFailed Callback to be called when we fail to download a file manifest segment
    *
    */
+  struct ManifestDownload;
+
   void
   downloadFileManifestSegment(const Name& manifestName,
-                              const std::string& path,
-                              std::shared_ptr<std::vector<Name>> packetNames,
-                              ManifestReceivedCallback onSuccess,
-                              FailedCallback onFailed);
+                              std::shared_ptr<ManifestDownload> download);
+
+  /*
+   * \brief Speculatively request the segment @p submanifestNumber of the file manifest of
+   *        @p download, before the previous segment tells us its implicit digest
+   */
+  void
+  prefetchFileManifestSegment(uint64_t submanifestNumber,
+                              std::shared_ptr<ManifestDownload> download);
+
+  /*
+   * \brief Store the verified file manifest segment @p data of @p download and continue with
+   *        the segment it points to
+   */
+  void
+  onFileManifestSegment(const Data& data, std::shared_ptr<ManifestDownload> download);
+
+  // The state of the download of the remaining segments of one file manifest
+  struct ManifestDownload {
+    std::string                        path;
+    std::shared_ptr<std::vector<Name>> packetNames;
+    ManifestReceivedCallback           onSuccess;
+    FailedCallback                     onFailed;
+    ManifestSegmentReceivedCallback    onSegment;
+    // The full name of the next segment, as pointed to by the last one; empty once all arrived
+    Name                               expected;
+    // The segments received speculatively, by sub-manifest number, until their digest is known
+    std::map<uint64_t, Data>           prefetched;
+    // The sub-manifest numbers of the pending speculative requests
+    std::set<uint64_t>                 speculating;
+    // The sub-manifest number of the last segment, once a prefetched one has no successor
+    uint64_t                           last = std::numeric_limits<uint64_t>::max();
+  };
 
   enum {
+    // Default number of file manifest segments requested speculatively
+    DEFAULT_MANIFEST_PREFETCH = 4,
     // Number of times to retry if a routable prefix fails to retrieve data
     MAX_NUM_OF_RETRIES = 5,
     // Number of Interests to be sent before sorting the stats table
     SORTING_INTERVAL = 100,
-    // Maximum window size used for sending new Interests out
-    WINDOW_SIZE = 50
+    // Number of recently served sub-manifests not advised to the kernel again
+    ADVISED_MANIFESTS = 16,
+    // Number of packets of a sub-manifest requested in order before the next ones are read ahead
+    SEQUENTIAL_RUN = 3,
+    // Estimated bytes held by each pending, queued, read or written packet (name and callbacks)
+    PENDING_PACKET_BYTES = 512
+  };
+
+  // The order in which the data packets of a sub-manifest are requested from us
+  struct ReadaheadState {
+    // The highest packet number requested
+    uint64_t last;
+    // The number of packets requested in order, up to 'last'
+    size_t   run;
+    // The packet number before which the packets were read ahead (or requested)
+    uint64_t end;
   };
 
   void onDataReceived(const Data& data);
@@ -307,29 +692,171 @@ class TorrentManager : noncopyable {
   void
   onInterestReceived(const InterestFilter& filter, const Interest& interest);
 
+  // Answer 'interest' with the data packet of at most 'dataPacketSize' bytes at 'offset' in the file
+  // at 'filePath', read by a seed worker if there are any. An Interest for a packet that is being
+  // read already waits on that read. Otherwise the Interest is Nacked if too many packets are being
+  // read already.
+  void
+  serveDataPacket(const Interest&    interest,
+                  uint64_t           offset,
+                  size_t             dataPacketSize,
+                  const std::string& filePath);
+
+  // Tell the kernel that the data packets of the sub-manifest 'manifest' in the file at 'filePath'
+  // are about to be read sequentially, unless it was among the last ADVISED_MANIFESTS told so
+  void
+  adviseManifest(const FileManifest& manifest, const std::string& filePath);
+
+  // Return the file manifest at 'position', reloaded from the metadata store if it was evicted, or
+  // nullptr if it could not be reloaded; a complete manifest becomes the most recently used
+  const FileManifest*
+  loadFileManifest(size_t position);
+
+  // Mark the file manifest at 'position' as the most recently used, if complete
+  void
+  touchFileManifest(size_t position);
+
+  // Evict the least recently used complete file manifests until those in memory fit in the memory
+  // budget, keeping at least the most recently used one
+  void
+  enforceMemoryBudget();
+
+  // Read the next data packets of the sub-manifest 'manifest' into the packet cache if its
+  // packets up to 'packetNum', just requested, were requested in order
+  void
+  readAhead(const FileManifest& manifest, uint64_t packetNum);
+
+  // Cache 'data' read ahead as the packet named 'fullName' and answer the Interests that waited on
+  // the read, or mark the packet missing if it could not be read and Interests waited on it
+  void
+  onPacketReadAhead(const Name& fullName, const shared_ptr<Data>& data);
+
+  // Answer 'interest' with 'data' read from disk or, if it could not be read, mark its packet as
+  // missing
+  void
+  onDataPacketRead(const Interest& interest, const shared_ptr<Data>& data);
+
+  // Answer the Interests for 'data'
+  void
+  putData(const Data& data);
+
   void
   onRegisterFailed(const Name& prefix, const std::string& reason);
 
   void
   eraseOwnRoutablePrefix();
 
+  /*
+   * \brief Update the index of 'm_torrentSegments' for all segments at or after position @p from
+   * Must be called whenever segments are added to (or reordered in) 'm_torrentSegments'.
+   */
+  void
+  indexTorrentSegments(size_t from = 0);
+
+  /*
+   * \brief Update the indices of 'm_fileManifests' for all manifests at or after position @p from
+   * Must be called whenever manifests are added to (or reordered in) 'm_fileManifests'.
+   */
+  void
+  indexFileManifests(size_t from = 0);
+
+  /*
+   * \brief Return the manifest named @p manifestName (without its implicit digest) or nullptr if
+   * we do not have it.
+   */
+  const FileManifest*
+  findFileManifest(const Name& manifestName) const;
+
+  /*
+   * \brief Return 'false' if the space of the file of the data packet named @p packetName could
+   * not be reserved, in which case it is no longer downloaded.
+   */
+  bool
+  isWritable(const Name& packetName) const;
+
+  /*
+   * \brief Return the state of the manifest named @p manifestName (without its implicit digest)
+   * or nullptr if we do not have the manifest.
+   */
+  FileState*
+  findFileState(const Name& manifestName);
+
 protected:
-  // A map from each fileManifest a bitmap of which Data packets this manager currently has
-  mutable std::unordered_map<Name, std::vector<bool>>                 m_fileStates;
+  // The Data packets this manager currently has of each manifest, in the order of
+  // 'm_fileManifests'. The state of a manifest is empty until we have any of its packets.
+  std::vector<FileState>                                              m_fileStates;
   // A map for each initial manifest to the size for the sub-manifest
   std::unordered_map<std::string, size_t>                             m_subManifestSizes;
   // The segments of the TorrentFile this manager has
   std::vector<TorrentFile>                                            m_torrentSegments;
   // The FileManifests this manager has
   std::vector<FileManifest>                                           m_fileManifests;
+  // A map from the name of each torrent segment to its position in 'm_torrentSegments'
+  std::unordered_map<Name, size_t>                                    m_torrentSegmentIndex;
+  // A map from the name of each file manifest to its position in 'm_fileManifests'
+  std::unordered_map<Name, size_t>                                    m_fileManifestIndex;
+  // A map from the prefix of each file to the positions of its first and last manifest
+  std::unordered_map<Name, std::pair<size_t, size_t>>                 m_fileIndex;
   // The name of the initial segment of the torrent file for this manager
   Name                                                                m_torrentFileName;
   // The path to the location on disk of the Data packet for this manager
   std::string                                                         m_dataPath;
+  // The directory in which the metadata of this torrent is stored
+  std::string                                                         m_appDataPath;
+  // The mappings of the files of this torrent, from which the served data packets are built (and
+  // shared with the seed workers building them and possibly with other torrents)
+  shared_ptr<FileMapCache>                                            m_fileMappings;
+  // The positions in 'm_fileManifests' of the sub-manifests most recently advised to the kernel,
+  // oldest first
+  std::deque<size_t>                                                  m_advisedManifests;
+  // The most recently downloaded or served Data packets, ready to be sent as is
+  shared_ptr<PacketCache>                                             m_packetCache;
+  // Whether the packet cache is shared with other torrents
+  bool                                                                m_sharedPacketCache;
+  // The persisted file states, used to resume without re-hashing the files on disk
+  ResumeJournal                                                       m_journal;
+  // The torrent file segments and file manifests on disk
+  MetadataStore                                                       m_metadata;
+  // The number of file manifest segments requested speculatively
+  size_t                                                              m_manifestPrefetch;
+  // The number of threads loading the torrent file segments and file manifests
+  size_t                                                              m_loadThreads;
+  // The bytes of file manifests kept in memory beyond which the complete ones are evicted, or zero
+  size_t                                                              m_memoryBudget;
+  // The estimated bytes held by the file manifests in memory
+  size_t                                                              m_manifestBytes;
+  // The names of the complete file manifests in memory, most recently used first
+  std::list<Name>                                                     m_completeManifests;
+  // Index into 'm_completeManifests' by name
+  std::unordered_map<Name, std::list<Name>::iterator>                 m_completeManifestIndex;
+  // The full names of the evicted file manifests, by name
+  std::unordered_map<Name, Name>                                      m_evictedManifests;
 
 private:
   shared_ptr<Interest>
-  createInterest(Name name);
+  createInterest(const Name& name, bool exact = false);
+
+  // Sort the stats table and send an "ALIVE" Interest once every SORTING_INTERVAL Interests
+  void
+  updateStatsTable();
+
+  // Return the priority in the Interest Queue of the Interest named 'name', which is 'priority'
+  // unless it failed before
+  InterestQueue::Priority
+  queuePriority(const Name& name, InterestQueue::Priority priority) const;
+
+  // Return the callbacks of the Interests for data packets, which write and seed the Data
+  shared_ptr<const InterestQueue::Request>
+  makeDataPacketRequest(DataReceivedCallback onSuccess, FailedCallback onFailed);
+
+  // Push the name of the next missing data packet to the Interest Queue, if we are downloading
+  // them all; return false if there is none left
+  bool
+  queueMissingDataPacket();
+
+  // Return the priority in the Interest Queue of the Interest for the data packet 'packetName'
+  InterestQueue::Priority
+  dataPacketPriority(const Name& packetName) const;
 
   void
   sendInterest();
@@ -337,6 +864,42 @@ private:
   void
   nackCallBack(const Interest& i, const lp::Nack& n);
 
+  // Update the RTT estimates, the congestion window and the stats of the routable prefix for the
+  // 'data' answering 'interest'
+  void
+  onInterestSatisfied(const Interest& interest, const Data& data);
+
+  // Back off the RTO and shrink the congestion window after 'interest' timed out; if it is
+  // 'speculative' its name may not exist, so it only releases its room in the window
+  void
+  onInterestTimedOut(const Interest& interest, bool speculative = false);
+
+  // Log the metrics and schedule the next dump in 'm_metricsInterval'
+  void
+  logMetrics();
+
+  // Return the record of the routable prefix in the forwarding hint of 'interest', if any
+  StatsTable::iterator
+  findStatsRecord(const Interest& interest);
+
+  // Start the endgame if we have all the manifests and few enough data packets are missing
+  void
+  checkEndgame();
+
+  // Send copies of the pending Interest named 'name' through other routable prefixes, up to
+  // ENDGAME_COPIES in total
+  void
+  duplicateInterest(const Name& name);
+
+  // Forget the copy of the Interest named 'name' sent through 'prefix'; return true if other
+  // copies of it are still pending
+  bool
+  dropCopy(const Name& name, const Name& prefix);
+
+  // Cancel all the copies of the Interest named 'name' except the one sent through 'prefix'
+  void
+  cancelCopies(const Name& name, const Name& prefix);
+
   // A flag to determine if upon completion we should continue seeding
   bool                                                                m_seedFlag;
   // Face used for network communication
@@ -355,6 +918,59 @@ private:
   PendingInterestQueue                                                m_pendingInterests;
   // A queue to hold all interests for requested data that we have yet to send
   shared_ptr<InterestQueue>                                           m_interestQueue;
+  // The names of the Interests that failed and were not satisfied since
+  std::unordered_set<Name>                                            m_failedInterests;
+  // The priority of the data packets of each file, by the prefix of the file
+  std::unordered_map<Name, FilePriority>                              m_filePriorities;
+  // The next packet to look at when downloading all the missing data packets
+  PacketHandle                                                        m_missingCursor;
+  // The callbacks for all the missing data packets, or null if they are not being downloaded
+  shared_ptr<const InterestQueue::Request>                            m_missingRequest;
+  // Selects the routable prefix of each Interest; holds the congestion window of each prefix
+  MultipathScheduler                                                  m_scheduler;
+  // The round-trip time estimate, used as the lifetime of our Interests
+  RttEstimator                                                        m_rttEstimator;
+  // The files of the torrent advertised by our peers
+  PieceAvailability                                                   m_availability;
+  // The number of data packets of the manifests we have that we are missing
+  size_t                                                              m_missingPackets;
+  // Whether the endgame has started
+  bool                                                                m_endgame;
+  // Performs the writes of the data packets off the thread processing the events of the face
+  shared_ptr<AsyncWriter>                                             m_writer;
+  // The bound on the Interests outstanding across the managers of this process, if shared
+  shared_ptr<WindowBudget>                                            m_budget;
+  // The id of this manager in 'm_budget'
+  WindowBudget::Id                                                    m_budgetId;
+  // The threads reading the served data packets, if shared
+  shared_ptr<ThreadPool>                                              m_seedWorkers;
+  // The number of data packets being read by the seed workers, only referenced weakly by their
+  // completions so that they are dropped once this manager is destroyed
+  shared_ptr<size_t>                                                  m_pendingReads;
+  // The number of data packets being read beyond which the Interests for them are Nacked
+  size_t                                                              m_maxPendingReads;
+  // The number of pending Interests beyond which no more are sent, or zero
+  size_t                                                              m_maxPendingInterests;
+  // The number of Interests waiting on the read of each data packet by the seed workers, keyed
+  // by its full name (zero for the packets only read ahead)
+  std::unordered_map<Name, size_t>                                    m_inFlightReads;
+  // The number of data packets read ahead of the last one requested in order
+  size_t                                                              m_readaheadPackets;
+  // The order of the requests for each sub-manifest, by position in 'm_fileManifests'
+  std::unordered_map<size_t, ReadaheadState>                          m_readahead;
+  // The names of the data packets handed to the writer that are not written yet
+  std::unordered_set<Name>                                            m_pendingWrites;
+  // The names of the files whose space could not be reserved, which are not downloaded any further
+  std::unordered_set<std::string>                                     m_unwritableFiles;
+  // The routable prefix and id on the face of each copy of the Interests sent in the endgame
+  std::unordered_map<Name, std::vector<std::pair<Name, const PendingInterestId*>>>
+                                                                      m_copies;
+  // The counters and latency histograms of this manager
+  Metrics                                                             m_metrics;
+  // The interval at which the metrics are logged, or zero if they are not
+  time::milliseconds                                                  m_metricsInterval;
+  // Schedules the periodic dump of the metrics, if any
+  unique_ptr<util::scheduler::Scheduler>                              m_metricsScheduler;
   // TODO(spyros) Fix and reintegrate update handler
   // // Update Handler instance
   shared_ptr<UpdateHandler>                                           m_updateHandler;
@@ -365,22 +981,73 @@ TorrentManager::TorrentManager(const ndn::Name&      torrentFileName,
                                const std::string&    dataPath,
                                bool                  seed,
                                std::shared_ptr<Face> face)
+: TorrentManager(torrentFileName, dataPath, seed, Resources{face, nullptr, nullptr, nullptr, nullptr,
+                                                                    time::milliseconds::zero()})
+{
+}
+
+inline
+TorrentManager::TorrentManager(const ndn::Name&      torrentFileName,
+                               const std::string&    dataPath,
+                               bool                  seed,
+                               const Resources&      resources)
 : m_fileStates()
 , m_torrentSegments()
 , m_fileManifests()
+, m_torrentSegmentIndex()
+, m_fileManifestIndex()
+, m_fileIndex()
 , m_torrentFileName(torrentFileName)
 , m_dataPath(dataPath)
+, m_appDataPath((resources.appDataPath.empty() ? ".appdata/" : resources.appDataPath + "/") +
+                torrentFileName.get(-3).toUri())
+, m_fileMappings(nullptr != resources.fileMappings ? resources.fileMappings
+                                                     : make_shared<FileMapCache>())
+, m_advisedManifests()
+, m_packetCache(nullptr != resources.packetCache ? resources.packetCache
+                                                 : make_shared<PacketCache>())
+, m_sharedPacketCache(nullptr != resources.packetCache)
+, m_journal()
+, m_metadata()
+, m_manifestPrefetch(DEFAULT_MANIFEST_PREFETCH)
+, m_loadThreads(ThreadPool::hardwareConcurrency())
+, m_memoryBudget(resources.memoryBudget)
+, m_manifestBytes(0)
+, m_completeManifests()
+, m_completeManifestIndex()
+, m_evictedManifests()
 , m_seedFlag(seed)
-, m_face(face)
+, m_face(resources.face)
 , m_retries(0)
 , m_sortingCounter(0)
-, m_keyChain(new KeyChain())
+, m_keyChain(resources.keyChain)
+, m_missingPackets(0)
+, m_endgame(false)
+, m_writer(resources.writer)
+, m_budget(resources.budget)
+, m_budgetId(0)
+, m_seedWorkers(resources.seedWorkers)
+, m_pendingReads(make_shared<size_t>(0))
+, m_maxPendingReads(DEFAULT_MAX_PENDING_READS)
+, m_maxPendingInterests(resources.maxPendingInterests)
+, m_readaheadPackets(DEFAULT_READAHEAD)
+, m_readahead()
+, m_metricsInterval(resources.metricsInterval)
 {
   m_interestQueue = make_shared<InterestQueue>();
 
-  if(face == nullptr) {
+  if(m_face == nullptr) {
     m_face = make_shared<Face>();
   }
+  if (m_keyChain == nullptr) {
+    m_keyChain = make_shared<KeyChain>();
+  }
+  if (m_writer == nullptr) {
+    m_writer = make_shared<AsyncWriter>(m_face->getIoService());
+  }
+  if (m_budget != nullptr) {
+    m_budgetId = m_budget->join([this] { sendInterest(); });
+  }
 
   // Hardcoded prefixes for now
   // TODO(Spyros): Think of something more clever to bootstrap...
@@ -389,6 +1056,14 @@ TorrentManager::TorrentManager(const ndn::Name&      torrentFileName,
   m_stats_table_iter = m_statsTable.begin();
 }
 
+inline
+TorrentManager::~TorrentManager()
+{
+  if (m_budget != nullptr) {
+    m_budget->leave(m_budgetId);
+  }
+}
+
 inline
 void
 TorrentManager::processEvents(const time::milliseconds& timeout)
@@ -414,7 +1089,98 @@ inline
 bool
 TorrentManager::hasPendingInterests() const
 {
-  return !m_pendingInterests.empty() || !m_interestQueue->empty();
+  return !m_pendingInterests.empty() || !m_interestQueue->empty() || !m_pendingWrites.empty();
+}
+
+inline size_t
+TorrentManager::queuedInterests() const
+{
+  return m_interestQueue->size();
+}
+
+inline size_t
+TorrentManager::missingDataPackets() const
+{
+  return m_missingPackets;
+}
+
+inline bool
+TorrentManager::inEndgame() const
+{
+  return m_endgame;
+}
+
+inline const MultipathScheduler&
+TorrentManager::getScheduler() const
+{
+  return m_scheduler;
+}
+
+inline const RttEstimator&
+TorrentManager::getRttEstimator() const
+{
+  return m_rttEstimator;
+}
+
+inline void
+TorrentManager::setManifestPrefetch(size_t numSegments)
+{
+  m_manifestPrefetch = numSegments;
+}
+
+inline void
+TorrentManager::setFilePriority(const Name& manifestName, FilePriority priority)
+{
+  m_filePriorities[FileManifest::manifestPrefix(manifestName)] = priority;
+}
+
+inline void
+TorrentManager::setLoadThreads(size_t numThreads)
+{
+  m_loadThreads = std::max<size_t>(1, numThreads);
+}
+
+inline void
+TorrentManager::setMaxPendingReads(size_t maxPendingReads)
+{
+  m_maxPendingReads = maxPendingReads;
+}
+
+inline void
+TorrentManager::setReadahead(size_t numPackets)
+{
+  m_readaheadPackets = numPackets;
+}
+
+inline void
+TorrentManager::setMemoryBudget(size_t bytes)
+{
+  m_memoryBudget = bytes;
+  enforceMemoryBudget();
+}
+
+inline void
+TorrentManager::setMaxPendingInterests(size_t maxPendingInterests)
+{
+  m_maxPendingInterests = maxPendingInterests;
+}
+
+inline const PieceAvailability&
+TorrentManager::getAvailability() const
+{
+  return m_availability;
+}
+
+inline const std::string&
+TorrentManager::appDataPath() const
+{
+  return m_appDataPath;
+}
+
+inline const Metrics&
+TorrentManager::metrics() const
+{
+  return m_metrics;
 }
 
 }  // end ntorrent
@@ -29,6 +29,9 @@
 namespace ndn {
 namespace ntorrent {
 
+const char* const UpdateHandler::METRICS_COMPONENT = "metrics";
+const char* const UpdateHandler::KNOWN_PREFIXES_COMPONENT = "known";
+
 void
 UpdateHandler::sendAliveInterest(StatsTable::iterator iter)
 {
@@ -36,6 +39,16 @@ UpdateHandler::sendAliveInterest(StatsTable::iterator iter)
   Name interestName = Name(prependedComponents.toUri() + "/NTORRENT" + m_torrentName.toUri() +
                           "/ALIVE" + m_ownRoutablePrefix.toUri());
 
+  // Let the peer send only the prefixes we do not know yet
+  BloomFilter knownPrefixes(BloomFilter::fitSize(m_statsTable->size() + 1,
+                                                 MAX_KNOWN_PREFIXES_SIZE));
+  knownPrefixes.insert(m_ownRoutablePrefix);
+  for (const auto& entry : *m_statsTable) {
+    knownPrefixes.insert(entry.getRecordName());
+  }
+  interestName.append(KNOWN_PREFIXES_COMPONENT)
+              .append(knownPrefixes.bytes().data(), knownPrefixes.bytes().size());
+
   shared_ptr<Interest> i = make_shared<Interest>(interestName);
 
   // Create and set the forwarding hint
@@ -47,30 +60,57 @@ UpdateHandler::sendAliveInterest(StatsTable::iterator iter)
   i->setForwardingHint(list);
   i->setMustBeFresh(true);
 
-  LOG_DEBUG << "Sending ALIVE Interest: " << *i << std::endl;
+  LOG_DEBUG << "Sending ALIVE Interest: " << *i;
+
+  // Back off until a reply brings a new prefix
+  m_nextAliveTime = time::steady_clock::now() + m_aliveInterval;
+  m_aliveInterval = std::min(m_aliveInterval * 2, time::milliseconds(MAX_ALIVE_INTERVAL));
 
   m_face->expressInterest(*i, bind(&UpdateHandler::decodeDataPacketContent, this, _1, _2),
-                          bind(&UpdateHandler::tryNextRoutablePrefix, this, _1),
-                          bind(&UpdateHandler::tryNextRoutablePrefix, this, _1));
+                          bind(&UpdateHandler::tryNextRoutablePrefix, this, _1, 1),
+                          bind(&UpdateHandler::tryNextRoutablePrefix, this, _1, 1));
 }
 
 shared_ptr<Data>
 UpdateHandler::createDataPacket(const Name& name)
 {
+  // <common prefix>/NTORRENT/<torrent name>/ALIVE/<routable prefix>[/known/<Bloom filter>]
+  auto prefixPosition = 2 + 2 + m_torrentName.size();
+  auto prefixSize = name.size() - prefixPosition;
+  unique_ptr<BloomFilter> knownPrefixes;
+  if (prefixSize > 2 && name.get(-2) == name::Component(KNOWN_PREFIXES_COMPONENT)) {
+    const auto& filter = name.get(-1);
+    knownPrefixes.reset(new BloomFilter(filter.value(), filter.value_size()));
+    prefixSize -= 2;
+  }
   // Parse the sender's routable prefix contained in the name
-  Name sendersRoutablePrefix = name.getSubName(2 + 2 + m_torrentName.size());
+  Name sendersRoutablePrefix = name.getSubName(prefixPosition, prefixSize);
 
   if (m_statsTable->find(sendersRoutablePrefix) == m_statsTable->end()) {
     m_statsTable->insert(sendersRoutablePrefix);
   }
 
+  // The first entries of the stats table, skipping those the sender knows
+  std::vector<Name> names;
+  for (const auto& entry : *m_statsTable) {
+    if (names.size() >= MAX_NUM_OF_ENCODED_NAMES) {
+      break;
+    }
+    const auto& prefix = entry.getRecordName();
+    if (nullptr != knownPrefixes &&
+        (prefix == sendersRoutablePrefix || knownPrefixes->contains(prefix))) {
+      continue;
+    }
+    names.push_back(prefix);
+  }
+
   shared_ptr<Data> data = make_shared<Data>(name);
 
   EncodingEstimator estimator;
-  size_t estimatedSize = encodeContent(estimator);
+  size_t estimatedSize = encodeContent(estimator, names);
 
   EncodingBuffer buffer(estimatedSize, 0);
-  encodeContent(buffer);
+  encodeContent(buffer, names);
 
   data->setContentType(tlv::ContentType_Blob);
   data->setFreshnessPeriod(time::milliseconds(100));
@@ -81,7 +121,7 @@ UpdateHandler::createDataPacket(const Name& name)
 
 template<encoding::Tag TAG>
 size_t
-UpdateHandler::encodeContent(EncodingImpl<TAG>& encoder) const
+UpdateHandler::encodeContent(EncodingImpl<TAG>& encoder, const std::vector<Name>& names) const
 {
   // Content ::= CONTENT-TYPE TLV-LENGTH
   //             RoutableName+
@@ -89,17 +129,22 @@ UpdateHandler::encodeContent(EncodingImpl<TAG>& encoder) const
   // RoutableName ::= NAME-TYPE TLV-LENGTH
   //                  Name
 
+  // Availability ::= AVAILABILITY-TYPE TLV-LENGTH
+  //                  BYTE* (one bit per piece, most significant bit first)
+
   size_t totalLength = 0;
-  // Encode the names of the first five entries of the stats table
-  uint32_t namesEncoded = 0;
-  for (const auto& entry : *m_statsTable) {
-    if (namesEncoded >= MAX_NUM_OF_ENCODED_NAMES) {
-      break;
+  if (m_getLocalAvailability) {
+    const auto& pieces = m_getLocalAvailability();
+    std::vector<uint8_t> bytes((pieces.size() + 7) / 8, 0);
+    for (size_t i = 0; i < pieces.size(); ++i) {
+      if (pieces[i]) {
+        bytes[i / 8] |= 0x80 >> (i % 8);
+      }
     }
-    size_t nameLength = 0;
-    nameLength += entry.getRecordName().wireEncode(encoder);
-    totalLength += nameLength;
-    ++namesEncoded;
+    totalLength += encoder.prependByteArrayBlock(AVAILABILITY_TYPE, bytes.data(), bytes.size());
+  }
+  for (const auto& name : names) {
+    totalLength += name.wireEncode(encoder);
   }
   totalLength += encoder.prependVarNumber(totalLength);
   totalLength += encoder.prependVarNumber(tlv::Content);
@@ -115,7 +160,10 @@ UpdateHandler::decodeDataPacketContent(const Interest& interest, const Data& dat
   // RoutableName ::= NAME-TYPE TLV-LENGTH
   //                  Name
 
-  LOG_INFO << "ALIVE data packet received: " << data.getName() << std::endl;
+  // Availability ::= AVAILABILITY-TYPE TLV-LENGTH
+  //                  BYTE* (one bit per piece, most significant bit first)
+
+  LOG_INFO << "ALIVE data packet received: " << data.getName();
 
   if (data.getContentType() != tlv::ContentType_Blob) {
       BOOST_THROW_EXCEPTION(Error("Expected Content Type Blob"));
@@ -125,7 +173,22 @@ UpdateHandler::decodeDataPacketContent(const Interest& interest, const Data& dat
   content.parse();
 
   // Decode the names (maintain their ordering)
+  auto tableSize = m_statsTable->size();
   for (auto element = content.elements_end() - 1; element != content.elements_begin() - 1; element--) {
+    if (element->type() == AVAILABILITY_TYPE) {
+      // the peer is the one reached through the forwarding hint of our Interest
+      if (m_onReceivedAvailability && !interest.getForwardingHint().empty()) {
+        std::vector<bool> pieces(element->value_size() * 8);
+        for (size_t i = 0; i < pieces.size(); ++i) {
+          pieces[i] = (element->value()[i / 8] & (0x80 >> (i % 8))) != 0;
+        }
+        m_onReceivedAvailability(interest.getForwardingHint().begin()->name, pieces);
+      }
+      continue;
+    }
+    if (element->type() != tlv::Name) {
+      continue;
+    }
     element->parse();
     Name name(*element);
     if (name.empty()) {
@@ -136,11 +199,18 @@ UpdateHandler::decodeDataPacketContent(const Interest& interest, const Data& dat
       m_statsTable->insert(name);
     }
   }
+  // The exchange is useful again
+  if (m_statsTable->size() > tableSize) {
+    m_aliveInterval = time::milliseconds(MIN_ALIVE_INTERVAL);
+  }
 }
 
 bool
 UpdateHandler::needsUpdate()
 {
+  if (time::steady_clock::now() < m_nextAliveTime) {
+    return false;
+  }
   if (m_statsTable->size() < MIN_NUM_OF_ROUTABLE_NAMES) {
     return true;
   }
@@ -168,7 +238,7 @@ UpdateHandler::learnOwnRoutablePrefix(OnReceivedOwnRoutablePrefix onReceivedOwnR
     element->parse();
     Name ownRoutablePrefix(*element);
     m_ownRoutablePrefix = ownRoutablePrefix;
-    LOG_DEBUG << "Own routable prefix received: " << m_ownRoutablePrefix << std::endl;
+    LOG_DEBUG << "Own routable prefix received: " << m_ownRoutablePrefix;
 
     Name prependedComponents(SharedConstants::commonPrefix);
     m_face->setInterestFilter(Name(prependedComponents.toUri() + "/NTORRENT" + m_torrentName.toUri() +
@@ -182,7 +252,7 @@ UpdateHandler::learnOwnRoutablePrefix(OnReceivedOwnRoutablePrefix onReceivedOwnR
 
   auto prefixRetrievalFailed = [this, onReceivedOwnRoutablePrefix] (const Interest&) {
     ++m_ownRoutablPrefixRetries;
-    LOG_ERROR << "Own Routable Prefix Retrieval Failed. Trying again." << std::endl;
+    LOG_ERROR << "Own Routable Prefix Retrieval Failed. Trying again.";
     // If we fail, we will retry OWN_ROUTABLE_PREFIX_RETRIES times
     if (m_ownRoutablPrefixRetries < OWN_ROUTABLE_PREFIX_RETRIES) {
       this->learnOwnRoutablePrefix(onReceivedOwnRoutablePrefix);
@@ -196,10 +266,29 @@ UpdateHandler::learnOwnRoutablePrefix(OnReceivedOwnRoutablePrefix onReceivedOwnR
   m_face->expressInterest(i, prefixReceived, nullptr, prefixRetrievalFailed);
 }
 
+bool
+UpdateHandler::isMetricsInterest(const Name& name) const
+{
+  // <common prefix>/NTORRENT/<torrent name>/ALIVE/metrics
+  auto metricsPosition = 2 + 2 + m_torrentName.size();
+  return m_getMetrics && name.size() == metricsPosition + 1 &&
+         name.get(metricsPosition) == name::Component(METRICS_COMPONENT);
+}
+
 void
 UpdateHandler::onInterestReceived(const InterestFilter& filter, const Interest& interest)
 {
-  LOG_INFO << "ALIVE Interest Received: " << interest.getName().toUri() << std::endl;
+  LOG_INFO << "ALIVE Interest Received: " << interest.getName().toUri();
+  if (isMetricsInterest(interest.getName())) {
+    const auto& metrics = m_getMetrics();
+    shared_ptr<Data> data = make_shared<Data>(interest.getName());
+    data->setContentType(tlv::ContentType_Blob);
+    data->setFreshnessPeriod(time::milliseconds(100));
+    data->setContent(reinterpret_cast<const uint8_t*>(metrics.data()), metrics.size());
+    m_keyChain->sign(*data, signingWithSha256());
+    m_face->put(*data);
+    return;
+  }
   shared_ptr<Data> data = this->createDataPacket(interest.getName());
   m_keyChain->sign(*data, signingWithSha256());
   m_face->put(*data);
@@ -209,14 +298,17 @@ void
 UpdateHandler::onRegisterFailed(const Name& prefix, const std::string& reason)
 {
  LOG_ERROR << "ERROR: Failed to register prefix \""
-            << prefix << "\" in local hub's daemon (" << reason << ")"
-            << std::endl;
+            << prefix << "\" in local hub's daemon (" << reason << ")";
   m_face->shutdown();
 }
 
 void
-UpdateHandler::tryNextRoutablePrefix(const Interest& interest)
+UpdateHandler::tryNextRoutablePrefix(const Interest& interest, size_t attempts)
 {
+  if (attempts >= m_statsTable->size()) {
+    LOG_DEBUG << "No peer answered the ALIVE Interest: " << interest.getName();
+    return;
+  }
   const Name& name = interest.getForwardingHint().begin()->name;
   auto iter = m_statsTable->find(name);
 
@@ -244,8 +336,8 @@ UpdateHandler::tryNextRoutablePrefix(const Interest& interest)
   newInterest->setForwardingHint(list);
 
   m_face->expressInterest(*newInterest, bind(&UpdateHandler::decodeDataPacketContent, this, _1, _2),
-                          bind(&UpdateHandler::tryNextRoutablePrefix, this, _1),
-                          bind(&UpdateHandler::tryNextRoutablePrefix, this, _1));
+                          bind(&UpdateHandler::tryNextRoutablePrefix, this, _1, attempts + 1),
+                          bind(&UpdateHandler::tryNextRoutablePrefix, this, _1, attempts + 1));
 }
 
 } // namespace ntorrent
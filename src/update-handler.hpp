@@ -23,6 +23,7 @@
 #define UPDATE_HANDLER_H
 
 #include "stats-table.hpp"
+#include "util/bloom-filter.hpp"
 #include "util/shared-constants.hpp"
 
 #include <ndn-cxx/face.hpp>
@@ -35,6 +36,12 @@ namespace ntorrent {
 class UpdateHandler {
 public:
   typedef std::function<void()> OnReceivedOwnRoutablePrefix;
+  // Return the pieces of the torrent we have, in the order of the torrent file catalog
+  typedef std::function<std::vector<bool>()> GetLocalAvailability;
+  // Called with the routable prefix of a peer and the pieces that peer advertised
+  typedef std::function<void(const Name&, const std::vector<bool>&)> OnReceivedAvailability;
+  // Return the metrics of the torrent as text
+  typedef std::function<std::string()> GetMetrics;
 
   class Error : public tlv::Error
   {
@@ -56,6 +63,10 @@ public:
    * @brief Send an ALIVE Interest
    * @param routablePrefix The routable prefix to be included in the LINK object attached
    *        to this Interest
+   *
+   * The Interest carries a Bloom filter of the prefixes we know, so that the peer replies only
+   * with those we lack. If no peer answers, it is resent through each of the other prefixes of the
+   * table once.
    */
   void
   sendAliveInterest(StatsTable::iterator iter);
@@ -66,16 +77,53 @@ public:
    *
    * Returns true if we have less than MIN_NUM_OF_ROUTABLE_NAMES prefixes in the stats table
    * or all the routable prefixes has success rate less than 0.5. Otherwise, it returns false
+   *
+   * It also returns false until the backoff of the last ALIVE Interest has expired. The backoff
+   * starts at MIN_ALIVE_INTERVAL and doubles with each ALIVE Interest, up to MAX_ALIVE_INTERVAL,
+   * until a reply brings a prefix we did not know.
    */
   bool
   needsUpdate();
 
+  /**
+   * @brief Exchange the availability of the pieces of the torrent in the ALIVE packets
+   * @param getLocalAvailability Returns the pieces to advertise in our replies
+   * @param onReceivedAvailability Called with the pieces advertised in the replies of our peers
+   *
+   * Until this is called neither the replies we send nor the ones we receive carry availability.
+   */
+  void
+  setAvailabilityHandlers(GetLocalAvailability   getLocalAvailability,
+                          OnReceivedAvailability onReceivedAvailability);
+
+  /**
+   * @brief Answer the Interests for <prefix>/ALIVE/metrics with the text returned by @p getMetrics
+   *
+   * Until this is called such Interests are answered like any other ALIVE Interest.
+   */
+  void
+  setMetricsHandler(GetMetrics getMetrics);
+
+  // The component following ALIVE in the name of the Interests for the metrics
+  static const char* const METRICS_COMPONENT;
+
+  // The component preceding the Bloom filter of the prefixes known by the sender of an ALIVE
+  // Interest, at the end of its name
+  static const char* const KNOWN_PREFIXES_COMPONENT;
+
   enum {
+    // TLV type of the bitmap of the pieces of the torrent that a peer has
+    AVAILABILITY_TYPE = 201,
     // Maximum number of names to be encoded as a response to an "ALIVE" Interest
     MAX_NUM_OF_ENCODED_NAMES = 5,
     // Minimum number of routable prefixes that the peer would like to have
     MIN_NUM_OF_ROUTABLE_NAMES = 5,
     OWN_ROUTABLE_PREFIX_RETRIES = 5,
+    // Maximum size in bytes of the Bloom filter of the known prefixes in an "ALIVE" Interest
+    MAX_KNOWN_PREFIXES_SIZE = 1024,
+    // Minimum and maximum time in milliseconds between two "ALIVE" Interests sent on 'needsUpdate'
+    MIN_ALIVE_INTERVAL = 1000,
+    MAX_ALIVE_INTERVAL = 64000,
   };
 
   const Name&
@@ -84,7 +132,7 @@ public:
 private:
   template<encoding::Tag TAG>
   size_t
-  encodeContent(EncodingImpl<TAG>& encoder) const;
+  encodeContent(EncodingImpl<TAG>& encoder, const std::vector<Name>& names) const;
 
   void
   onInterestReceived(const InterestFilter& filter, const Interest& interest);
@@ -97,10 +145,19 @@ private:
    * @param name The name of the data packet
    * @return A shared pointer to the created data packet
    *
+   * If the name ends with the Bloom filter of the prefixes known by the sender, only the
+   * prefixes that are not in the filter are encoded.
    */
   shared_ptr<Data>
   createDataPacket(const Name& name);
 
+  /**
+   * @brief Return whether the Interest named @p name asks for the metrics rather than our
+   *        routable prefixes
+   */
+  bool
+  isMetricsInterest(const Name& name) const;
+
   /**
    * @brief Given a received data packet, decode the contained routable name prefixes
    *        and insert them to the table (if not already there)
@@ -118,8 +175,12 @@ private:
   void
   learnOwnRoutablePrefix(OnReceivedOwnRoutablePrefix onReceivedOwnRoutablePrefix);
 
+  /**
+   * @brief Resend the ALIVE @p interest through the prefix following the one it was sent through,
+   *        unless it was already sent @p attempts times, i.e. through each prefix of the table
+   */
   void
-  tryNextRoutablePrefix(const Interest& interest);
+  tryNextRoutablePrefix(const Interest& interest, size_t attempts);
 
 private:
   Name m_torrentName;
@@ -128,6 +189,12 @@ private:
   shared_ptr<Face> m_face;
   Name m_ownRoutablePrefix;
   size_t m_ownRoutablPrefixRetries;
+  GetLocalAvailability m_getLocalAvailability;
+  OnReceivedAvailability m_onReceivedAvailability;
+  GetMetrics m_getMetrics;
+  // The time before which 'needsUpdate' returns false, and the backoff after the next ALIVE
+  time::steady_clock::TimePoint m_nextAliveTime;
+  time::milliseconds m_aliveInterval;
 };
 
 inline
@@ -139,6 +206,7 @@ UpdateHandler::UpdateHandler(Name torrentName, shared_ptr<KeyChain> keyChain,
 , m_statsTable(statsTable)
 , m_face(face)
 , m_ownRoutablPrefixRetries(0)
+, m_aliveInterval(MIN_ALIVE_INTERVAL)
 {
   this->learnOwnRoutablePrefix(onReceivedOwnRoutablePrefix);
 }
@@ -148,6 +216,20 @@ UpdateHandler::~UpdateHandler()
 {
 }
 
+inline void
+UpdateHandler::setAvailabilityHandlers(GetLocalAvailability   getLocalAvailability,
+                                       OnReceivedAvailability onReceivedAvailability)
+{
+  m_getLocalAvailability = getLocalAvailability;
+  m_onReceivedAvailability = onReceivedAvailability;
+}
+
+inline void
+UpdateHandler::setMetricsHandler(GetMetrics getMetrics)
+{
+  m_getMetrics = getMetrics;
+}
+
 inline const Name&
 UpdateHandler::getOwnRoutablePrefix()
 {
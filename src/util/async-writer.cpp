@@ -0,0 +1,242 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "util/async-writer.hpp"
+
+#include <algorithm>
+#include <climits>
+
+namespace ndn {
+namespace ntorrent {
+
+// The maximum number of buffers in a single vectored write
+#ifdef IOV_MAX
+static const size_t MAX_BUFFERS = IOV_MAX;
+#else
+static const size_t MAX_BUFFERS = 1024;
+#endif
+
+AsyncWriter::AsyncWriter(boost::asio::io_service& ioService, size_t capacity)
+: m_ioService(ioService)
+, m_completions(std::make_shared<Completions>())
+, m_capacity(capacity > 0 ? capacity : 1)
+, m_running(0)
+, m_stopped(false)
+{
+  m_completions->posted = false;
+  m_thread = std::thread(&AsyncWriter::run, this);
+}
+
+AsyncWriter::~AsyncWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopped = true;
+  }
+  m_jobAvailable.notify_all();
+  m_thread.join();
+}
+
+void
+AsyncWriter::write(const std::string& path,
+                   uint64_t           offset,
+                   const uint8_t*     buffer,
+                   size_t             length,
+                   Callback           done)
+{
+  push(Job{WRITE, path, offset, buffer, length, done, false});
+}
+
+void
+AsyncWriter::allocate(const std::string& path, uint64_t offset, uint64_t length, Callback done)
+{
+  push(Job{ALLOCATE, path, offset, nullptr, length, done, false});
+}
+
+void
+AsyncWriter::flush(const std::string& path, Callback done)
+{
+  push(Job{FLUSH, path, 0, nullptr, 0, done, false});
+}
+
+void
+AsyncWriter::flushAll(Callback done)
+{
+  push(Job{FLUSH_ALL, std::string(), 0, nullptr, 0, done, false});
+}
+
+void
+AsyncWriter::push(Job job)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_progress.wait(lock, [this] { return m_jobs.size() < m_capacity; });
+    m_jobs.push_back(std::move(job));
+  }
+  m_jobAvailable.notify_one();
+}
+
+void
+AsyncWriter::drain()
+{
+  // the callbacks may queue further jobs
+  while (0 < pending()) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_progress.wait(lock, [this] { return m_jobs.empty() && 0 == m_running; });
+    }
+    deliver(m_completions);
+  }
+}
+
+size_t
+AsyncWriter::pending() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::lock_guard<std::mutex> completionsLock(m_completions->mutex);
+  return m_jobs.size() + m_running + m_completions->jobs.size();
+}
+
+void
+AsyncWriter::run()
+{
+  std::vector<Job> batch;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_jobAvailable.wait(lock, [this] { return m_stopped || !m_jobs.empty(); });
+      if (m_jobs.empty()) {
+        return;
+      }
+      batch.assign(std::make_move_iterator(m_jobs.begin()), std::make_move_iterator(m_jobs.end()));
+      m_jobs.clear();
+      m_running = batch.size();
+    }
+    m_progress.notify_all();
+    perform(batch);
+    bool post = false;
+    {
+      std::lock_guard<std::mutex> lock(m_completions->mutex);
+      for (auto& job : batch) {
+        if (nullptr != job.done) {
+          m_completions->jobs.push_back(std::move(job));
+        }
+      }
+      post = !m_completions->posted && !m_completions->jobs.empty();
+      m_completions->posted = m_completions->posted || post;
+    }
+    batch.clear();
+    if (post) {
+      std::weak_ptr<Completions> completions = m_completions;
+      m_ioService.post([completions] {
+        auto c = completions.lock();
+        if (nullptr != c) {
+          deliver(c);
+        }
+      });
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_running = 0;
+    }
+    m_progress.notify_all();
+  }
+}
+
+void
+AsyncWriter::perform(std::vector<Job>& batch)
+{
+  auto it = batch.begin();
+  while (it != batch.end()) {
+    if (WRITE == it->operation) {
+      auto end = std::find_if(it, batch.end(), [] (const Job& job) {
+                                                 return WRITE != job.operation;
+                                               });
+      performWrites(it, end);
+      it = end;
+      continue;
+    }
+    switch (it->operation) {
+      case ALLOCATE:
+        it->result = m_handles.allocate(it->path, it->offset, it->length);
+        break;
+      case FLUSH:
+        it->result = m_handles.flush(it->path);
+        break;
+      case FLUSH_ALL:
+        it->result = m_handles.flushAll();
+        break;
+      default:
+        break;
+    }
+    ++it;
+  }
+}
+
+void
+AsyncWriter::performWrites(std::vector<Job>::iterator begin, std::vector<Job>::iterator end)
+{
+  // order the writes by file and offset, leaving the jobs (and callbacks) in their queued order
+  std::vector<Job*> writes(std::distance(begin, end));
+  std::transform(begin, end, writes.begin(), [] (Job& job) { return &job; });
+  std::stable_sort(writes.begin(), writes.end(), [] (const Job* lhs, const Job* rhs) {
+                     return lhs->path < rhs->path ||
+                           (lhs->path == rhs->path && lhs->offset < rhs->offset);
+                   });
+  std::vector<struct iovec> buffers;
+  auto first = writes.begin();
+  while (first != writes.end()) {
+    // extend the run while the next write starts where the previous one ends
+    auto last = std::next(first);
+    while (last != writes.end() &&
+           static_cast<size_t>(last - first) < MAX_BUFFERS &&
+           (*last)->path == (*first)->path &&
+           (*last)->offset == (*std::prev(last))->offset + (*std::prev(last))->length) {
+      ++last;
+    }
+    buffers.clear();
+    for (auto w = first; w != last; ++w) {
+      buffers.push_back({const_cast<uint8_t*>((*w)->buffer), static_cast<size_t>((*w)->length)});
+    }
+    bool result = m_handles.write((*first)->path, (*first)->offset, buffers.data(), buffers.size());
+    for (auto w = first; w != last; ++w) {
+      (*w)->result = result;
+    }
+    first = last;
+  }
+}
+
+void
+AsyncWriter::deliver(const std::shared_ptr<Completions>& completions)
+{
+  std::deque<Job> jobs;
+  {
+    std::lock_guard<std::mutex> lock(completions->mutex);
+    jobs.swap(completions->jobs);
+    completions->posted = false;
+  }
+  for (auto& job : jobs) {
+    job.done(job.result);
+  }
+}
+
+} // namespace ntorrent
+} // namespace ndn
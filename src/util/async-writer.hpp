@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_UTIL_ASYNC_WRITER_H
+#define INCLUDED_UTIL_ASYNC_WRITER_H
+
+#include "util/file-handle-cache.hpp"
+
+#include <boost/asio/io_service.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+
+class AsyncWriter : boost::noncopyable {
+  /**
+   * \class AsyncWriter
+   *
+   * \brief A dedicated I/O thread performing the file writes of a torrent
+   *
+   * Writes are handed to a bounded queue and return immediately. The I/O thread takes all the
+   * queued jobs at once and coalesces the writes to adjacent ranges of the same file into a single
+   * vectored write. The completion callbacks are executed on the thread running the provided
+   * io_service, in the order the jobs were queued, so the caller never needs to synchronize with
+   * the I/O thread. Writes are not synced to disk until they are flushed.
+   */
+ public:
+  typedef std::function<void(bool)> Callback;
+
+  enum {
+    // Default maximum number of queued jobs
+    DEFAULT_CAPACITY = 1024
+  };
+
+  /*
+   * @brief Start the I/O thread, delivering the completions on @p ioService
+   * At most @p capacity jobs are queued, once the queue is full the caller blocks until the I/O
+   * thread catches up.
+   */
+  explicit
+  AsyncWriter(boost::asio::io_service& ioService, size_t capacity = DEFAULT_CAPACITY);
+
+  /*
+   * @brief Complete all the queued jobs, then stop the I/O thread
+   * The callbacks of jobs whose completions were not delivered yet are not called.
+   */
+  ~AsyncWriter();
+
+  /*
+   * @brief Write the @p length bytes at @p buffer to @p offset in the file at @p path
+   * The bytes must remain valid until @p done is called, which can be ensured by capturing their
+   * owner (e.g. the Data packet) in @p done. Call @p done with 'true' if all the bytes were
+   * written, 'false' otherwise.
+   */
+  void
+  write(const std::string& path,
+        uint64_t           offset,
+        const uint8_t*     buffer,
+        size_t             length,
+        Callback           done);
+
+  /*
+   * @brief Reserve the disk space of @p length bytes at @p offset in the file at @p path, then
+   * call @p done with 'false' if it could not be reserved (see FileHandleCache::allocate)
+   */
+  void
+  allocate(const std::string& path, uint64_t offset, uint64_t length, Callback done);
+
+  /*
+   * @brief Sync the completed writes to the file at @p path, then call @p done with the result
+   */
+  void
+  flush(const std::string& path, Callback done);
+
+  /*
+   * @brief Sync the completed writes to all the files, then call @p done with the result
+   */
+  void
+  flushAll(Callback done);
+
+  /*
+   * @brief Block until all the queued jobs are completed, then execute their callbacks on the
+   * calling thread
+   */
+  void
+  drain();
+
+  /*
+   * @brief Return the number of jobs whose callbacks have not been executed yet
+   * (including the jobs without a callback)
+   */
+  size_t
+  pending() const;
+
+ private:
+  enum Operation {
+    WRITE,
+    ALLOCATE,
+    FLUSH,
+    FLUSH_ALL
+  };
+
+  struct Job {
+    Operation      operation;
+    std::string    path;
+    uint64_t       offset;
+    const uint8_t* buffer;
+    uint64_t       length;
+    Callback       done;
+    bool           result;
+  };
+
+  // State shared with the completion handlers posted to the io_service, which may outlive this
+  struct Completions {
+    std::mutex       mutex;
+    std::deque<Job>  jobs;
+    // whether a handler delivering 'jobs' is already posted
+    bool             posted;
+  };
+
+  void
+  push(Job job);
+
+  void
+  run();
+
+  // Perform 'batch' in order, coalescing the consecutive writes to adjacent ranges of a file
+  void
+  perform(std::vector<Job>& batch);
+
+  void
+  performWrites(std::vector<Job>::iterator begin, std::vector<Job>::iterator end);
+
+  // Execute the callbacks of the completed jobs in 'completions'
+  static void
+  deliver(const std::shared_ptr<Completions>& completions);
+
+  boost::asio::io_service&        m_ioService;
+  // Only used by the I/O thread
+  FileHandleCache                 m_handles;
+  std::deque<Job>                 m_jobs;
+  mutable std::mutex              m_mutex;
+  // Signalled when a job is queued or the writer is stopped
+  std::condition_variable         m_jobAvailable;
+  // Signalled when the I/O thread takes jobs off the queue or completes them
+  std::condition_variable         m_progress;
+  std::shared_ptr<Completions>    m_completions;
+  size_t                          m_capacity;
+  // Number of jobs taken off the queue but not yet completed
+  size_t                          m_running;
+  bool                            m_stopped;
+  std::thread                     m_thread;
+};
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_UTIL_ASYNC_WRITER_H
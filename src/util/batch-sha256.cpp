@@ -0,0 +1,569 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "util/batch-sha256.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define NTORRENT_HAVE_X86_SHA256 1
+#include <cpuid.h>
+#include <immintrin.h>
+// The rounds of interleaved blocks only overlap once their loop is unrolled
+#if defined(__clang__)
+#define NTORRENT_UNROLL _Pragma("unroll")
+#elif __GNUC__ >= 8
+#define NTORRENT_UNROLL _Pragma("GCC unroll 16")
+#else
+#define NTORRENT_UNROLL
+#endif
+#endif
+
+namespace ndn {
+namespace ntorrent {
+
+namespace {
+
+enum {
+  BLOCK_SIZE = 64
+};
+
+const uint32_t ROUND_CONSTANTS[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+const uint32_t INITIAL_STATE[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+// The end of a message: its last partial block, followed by the padding and its length in bits
+struct Tail {
+  uint8_t blocks[2 * BLOCK_SIZE];
+  size_t  numBlocks;
+};
+
+void
+makeTail(const BatchSha256::Message& message, Tail& tail)
+{
+  size_t numFullBlocks = message.size / BLOCK_SIZE;
+  size_t remainder = message.size % BLOCK_SIZE;
+  std::memset(tail.blocks, 0, sizeof tail.blocks);
+  if (0 < remainder) {
+    std::memcpy(tail.blocks, message.data + numFullBlocks * BLOCK_SIZE, remainder);
+  }
+  tail.blocks[remainder] = 0x80;
+  // the length takes the last 8 bytes, after at least the 0x80 byte
+  tail.numBlocks = remainder + 1 + 8 <= BLOCK_SIZE ? 1 : 2;
+  uint64_t numBits = static_cast<uint64_t>(message.size) * 8;
+  for (size_t i = 0; i < 8; ++i) {
+    tail.blocks[tail.numBlocks * BLOCK_SIZE - 1 - i] = static_cast<uint8_t>(numBits >> (8 * i));
+  }
+}
+
+// The blocks of a message, followed by those of its tail
+class Cursor {
+ public:
+  explicit
+  Cursor(const BatchSha256::Message& message)
+  : m_data(message.data)
+  , m_numFullBlocks(message.size / BLOCK_SIZE)
+  {
+    makeTail(message, m_tail);
+  }
+
+  size_t
+  numBlocks() const
+  {
+    return m_numFullBlocks + m_tail.numBlocks;
+  }
+
+  const uint8_t*
+  block(size_t i) const
+  {
+    return i < m_numFullBlocks ? m_data + i * BLOCK_SIZE
+                               : m_tail.blocks + (i - m_numFullBlocks) * BLOCK_SIZE;
+  }
+
+ private:
+  const uint8_t* m_data;
+  size_t         m_numFullBlocks;
+  Tail           m_tail;
+};
+
+void
+storeDigest(const uint32_t state[8], BatchSha256::Digest& digest)
+{
+  for (size_t i = 0; i < 8; ++i) {
+    digest[4 * i]     = static_cast<uint8_t>(state[i] >> 24);
+    digest[4 * i + 1] = static_cast<uint8_t>(state[i] >> 16);
+    digest[4 * i + 2] = static_cast<uint8_t>(state[i] >> 8);
+    digest[4 * i + 3] = static_cast<uint8_t>(state[i]);
+  }
+}
+
+// Update 'state' with the 'numBlocks' blocks at 'data'
+typedef void (*Compress)(uint32_t state[8], const uint8_t* data, size_t numBlocks);
+
+// Hash each message in turn with 'compress'
+void
+hashEach(const BatchSha256::Message* messages,
+         size_t                      count,
+         BatchSha256::Digest*        digests,
+         Compress                    compress)
+{
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t state[8];
+    std::copy(INITIAL_STATE, INITIAL_STATE + 8, state);
+    compress(state, messages[i].data, messages[i].size / BLOCK_SIZE);
+    Tail tail;
+    makeTail(messages[i], tail);
+    compress(state, tail.blocks, tail.numBlocks);
+    storeDigest(state, digests[i]);
+  }
+}
+
+//==================================================================================================
+//                                         Scalar
+//==================================================================================================
+
+inline uint32_t
+rotr(uint32_t x, int n)
+{
+  return (x >> n) | (x << (32 - n));
+}
+
+void
+compressScalar(uint32_t state[8], const uint8_t* data, size_t numBlocks)
+{
+  for (; 0 < numBlocks; --numBlocks, data += BLOCK_SIZE) {
+    uint32_t w[64];
+    for (size_t t = 0; t < 16; ++t) {
+      w[t] = static_cast<uint32_t>(data[4 * t]) << 24 | static_cast<uint32_t>(data[4 * t + 1]) << 16
+           | static_cast<uint32_t>(data[4 * t + 2]) << 8 | static_cast<uint32_t>(data[4 * t + 3]);
+    }
+    for (size_t t = 16; t < 64; ++t) {
+      uint32_t s0 = rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+      uint32_t s1 = rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+      w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (size_t t = 0; t < 64; ++t) {
+      uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g))
+                  + ROUND_CONSTANTS[t] + w[t];
+      uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+  }
+}
+
+#ifdef NTORRENT_HAVE_X86_SHA256
+
+//==================================================================================================
+//                                         SHA-NI
+//==================================================================================================
+
+// The state of a message in the order taken by the SHA instructions, as the words ABEF and CDGH
+struct ShaNiState {
+  __m128i abef;
+  __m128i cdgh;
+};
+
+__attribute__((target("sha,sse4.1")))
+inline ShaNiState
+loadShaNiState(const uint32_t state[8])
+{
+  __m128i dcba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+  __m128i hgfe = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4));
+  __m128i cdab = _mm_shuffle_epi32(dcba, 0xB1);
+  __m128i efgh = _mm_shuffle_epi32(hgfe, 0x1B);
+  return ShaNiState{_mm_alignr_epi8(cdab, efgh, 8), _mm_blend_epi16(efgh, cdab, 0xF0)};
+}
+
+__attribute__((target("sha,sse4.1")))
+inline void
+storeShaNiState(const ShaNiState& shaNiState, uint32_t state[8])
+{
+  __m128i feba = _mm_shuffle_epi32(shaNiState.abef, 0x1B);
+  __m128i dchg = _mm_shuffle_epi32(shaNiState.cdgh, 0xB1);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+// Update each of the N 'states' with its block in 'blocks'. The rounds of the blocks are
+// interleaved, so that the latency of the instructions of one is hidden by those of the others.
+template<int N>
+__attribute__((target("sha,sse4.1")))
+inline void
+compressShaNi(ShaNiState states[N], const uint8_t* const blocks[N])
+{
+  const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  ShaNiState saved[N];
+  // the message words of the last four groups of four rounds of each block
+  __m128i w[N][4];
+  for (int n = 0; n < N; ++n) {
+    saved[n] = states[n];
+  }
+  NTORRENT_UNROLL
+  for (int k = 0; k < 16; ++k) {
+    const __m128i constants = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ROUND_CONSTANTS +
+                                                                               4 * k));
+    __m128i msg[N];
+    for (int n = 0; n < N; ++n) {
+      if (k < 4) {
+        w[n][k] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(blocks[n] +
+                                                                                    16 * k)),
+                                   byteSwap);
+      }
+      msg[n] = _mm_add_epi32(w[n][k & 3], constants);
+      states[n].cdgh = _mm_sha256rnds2_epu32(states[n].cdgh, states[n].abef, msg[n]);
+    }
+    if (3 <= k && k < 15) {
+      // complete the words of the next group from the partial result of sha256msg1
+      for (int n = 0; n < N; ++n) {
+        __m128i next = _mm_add_epi32(w[n][(k + 1) & 3],
+                                     _mm_alignr_epi8(w[n][k & 3], w[n][(k - 1) & 3], 4));
+        w[n][(k + 1) & 3] = _mm_sha256msg2_epu32(next, w[n][k & 3]);
+      }
+    }
+    for (int n = 0; n < N; ++n) {
+      msg[n] = _mm_shuffle_epi32(msg[n], 0x0E);
+      states[n].abef = _mm_sha256rnds2_epu32(states[n].abef, states[n].cdgh, msg[n]);
+    }
+    if (1 <= k && k < 13) {
+      for (int n = 0; n < N; ++n) {
+        w[n][(k - 1) & 3] = _mm_sha256msg1_epu32(w[n][(k - 1) & 3], w[n][k & 3]);
+      }
+    }
+  }
+  for (int n = 0; n < N; ++n) {
+    states[n].abef = _mm_add_epi32(states[n].abef, saved[n].abef);
+    states[n].cdgh = _mm_add_epi32(states[n].cdgh, saved[n].cdgh);
+  }
+}
+
+__attribute__((target("sha,sse4.1")))
+void
+compressShaNi(uint32_t state[8], const uint8_t* data, size_t numBlocks)
+{
+  ShaNiState shaNiState = loadShaNiState(state);
+  for (; 0 < numBlocks; --numBlocks, data += BLOCK_SIZE) {
+    compressShaNi<1>(&shaNiState, &data);
+  }
+  storeShaNiState(shaNiState, state);
+}
+
+// Hash the messages two at a time, interleaving their rounds while both have blocks left
+__attribute__((target("sha,sse4.1")))
+void
+hashShaNi(const BatchSha256::Message* messages, size_t count, BatchSha256::Digest* digests)
+{
+  size_t first = 0;
+  for (; first + 1 < count; first += 2) {
+    Cursor cursors[2] = {Cursor(messages[first]), Cursor(messages[first + 1])};
+    ShaNiState states[2] = {loadShaNiState(INITIAL_STATE), loadShaNiState(INITIAL_STATE)};
+    size_t numShared = std::min(cursors[0].numBlocks(), cursors[1].numBlocks());
+    for (size_t block = 0; block < numShared; ++block) {
+      const uint8_t* blocks[2] = {cursors[0].block(block), cursors[1].block(block)};
+      compressShaNi<2>(states, blocks);
+    }
+    for (size_t n = 0; n < 2; ++n) {
+      for (size_t block = numShared; block < cursors[n].numBlocks(); ++block) {
+        const uint8_t* data = cursors[n].block(block);
+        compressShaNi<1>(&states[n], &data);
+      }
+      uint32_t state[8];
+      storeShaNiState(states[n], state);
+      storeDigest(state, digests[first + n]);
+    }
+  }
+  if (first < count) {
+    hashEach(messages + first, 1, digests + first, compressShaNi);
+  }
+}
+
+//==================================================================================================
+//                                          AVX2
+//==================================================================================================
+
+// Transpose the 8x8 matrix of 32-bit words whose rows are 'r'
+__attribute__((target("avx2")))
+inline void
+transpose(__m256i r[8])
+{
+  __m256i t[8];
+  __m256i u[8];
+  for (int i = 0; i < 8; i += 2) {
+    t[i]     = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+    t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+  }
+  for (int i = 0; i < 8; i += 4) {
+    u[i]     = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+    u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+    u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+    u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+  }
+  for (int i = 0; i < 4; ++i) {
+    r[i]     = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+    r[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+  }
+}
+
+__attribute__((target("avx2")))
+inline __m256i
+rotr(__m256i x, int n)
+{
+  return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+// Update the states of the lanes in 'active' with a block of each lane
+__attribute__((target("avx2")))
+void
+compressAvx2(__m256i state[8], const uint8_t* const blocks[BatchSha256::NUM_LANES], __m256i active)
+{
+  const __m256i byteSwap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                           12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+  // w[t] holds the word t of the block of each lane
+  __m256i w[16];
+  for (int half = 0; half < 2; ++half) {
+    for (int lane = 0; lane < BatchSha256::NUM_LANES; ++lane) {
+      w[8 * half + lane] = _mm256_shuffle_epi8(_mm256_loadu_si256(
+                             reinterpret_cast<const __m256i*>(blocks[lane] + 32 * half)), byteSwap);
+    }
+    transpose(w + 8 * half);
+  }
+  __m256i a = state[0], b = state[1], c = state[2], d = state[3];
+  __m256i e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int t = 0; t < 64; ++t) {
+    if (16 <= t) {
+      __m256i w15 = w[(t - 15) & 15];
+      __m256i w2 = w[(t - 2) & 15];
+      __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr(w15, 7), rotr(w15, 18)),
+                                    _mm256_srli_epi32(w15, 3));
+      __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr(w2, 17), rotr(w2, 19)),
+                                    _mm256_srli_epi32(w2, 10));
+      w[t & 15] = _mm256_add_epi32(_mm256_add_epi32(w[t & 15], s0),
+                                   _mm256_add_epi32(w[(t - 7) & 15], s1));
+    }
+    __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr(e, 6), rotr(e, 11)), rotr(e, 25));
+    __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+    __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, s1),
+                                  _mm256_add_epi32(_mm256_add_epi32(ch, w[t & 15]),
+                                                   _mm256_set1_epi32(ROUND_CONSTANTS[t])));
+    __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr(a, 2), rotr(a, 13)), rotr(a, 22));
+    __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b),
+                                  _mm256_and_si256(c, _mm256_or_si256(a, b)));
+    __m256i t2 = _mm256_add_epi32(s0, maj);
+    h = g;
+    g = f;
+    f = e;
+    e = _mm256_add_epi32(d, t1);
+    d = c;
+    c = b;
+    b = a;
+    a = _mm256_add_epi32(t1, t2);
+  }
+  const __m256i words[8] = {a, b, c, d, e, f, g, h};
+  for (int i = 0; i < 8; ++i) {
+    state[i] = _mm256_blendv_epi8(state[i], _mm256_add_epi32(state[i], words[i]), active);
+  }
+}
+
+__attribute__((target("avx2")))
+void
+hashAvx2(const BatchSha256::Message* messages, size_t count, BatchSha256::Digest* digests)
+{
+  // the block of the lanes without a message, whose states are discarded
+  static const uint8_t idle[BLOCK_SIZE] = {};
+  const __m256i byteSwap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                           12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+  for (size_t first = 0; first < count; first += BatchSha256::NUM_LANES) {
+    size_t numLanes = std::min<size_t>(BatchSha256::NUM_LANES, count - first);
+    if (1 == numLanes) {
+      // a lone message is hashed faster one word at a time
+      hashEach(messages + first, 1, digests + first, compressScalar);
+      break;
+    }
+    Tail tails[BatchSha256::NUM_LANES];
+    size_t numFullBlocks[BatchSha256::NUM_LANES] = {};
+    size_t numBlocks[BatchSha256::NUM_LANES] = {};
+    size_t maxBlocks = 0;
+    for (size_t lane = 0; lane < numLanes; ++lane) {
+      const auto& message = messages[first + lane];
+      makeTail(message, tails[lane]);
+      numFullBlocks[lane] = message.size / BLOCK_SIZE;
+      numBlocks[lane] = numFullBlocks[lane] + tails[lane].numBlocks;
+      maxBlocks = std::max(maxBlocks, numBlocks[lane]);
+    }
+    __m256i state[8];
+    for (int i = 0; i < 8; ++i) {
+      state[i] = _mm256_set1_epi32(INITIAL_STATE[i]);
+    }
+    for (size_t block = 0; block < maxBlocks; ++block) {
+      const uint8_t* blocks[BatchSha256::NUM_LANES];
+      alignas(32) int32_t active[BatchSha256::NUM_LANES];
+      for (size_t lane = 0; lane < BatchSha256::NUM_LANES; ++lane) {
+        active[lane] = lane < numLanes && block < numBlocks[lane] ? -1 : 0;
+        if (0 == active[lane]) {
+          blocks[lane] = idle;
+        }
+        else if (block < numFullBlocks[lane]) {
+          blocks[lane] = messages[first + lane].data + block * BLOCK_SIZE;
+        }
+        else {
+          blocks[lane] = tails[lane].blocks + (block - numFullBlocks[lane]) * BLOCK_SIZE;
+        }
+      }
+      compressAvx2(state, blocks,
+                   _mm256_load_si256(reinterpret_cast<const __m256i*>(active)));
+    }
+    // state[i] holds the word i of each lane, whose digest is its words in big-endian order
+    transpose(state);
+    for (size_t lane = 0; lane < numLanes; ++lane) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(digests[first + lane].data()),
+                          _mm256_shuffle_epi8(state[lane], byteSwap));
+    }
+  }
+}
+
+#endif // NTORRENT_HAVE_X86_SHA256
+
+BatchSha256::Implementation
+fastestSupported()
+{
+  if (BatchSha256::isSupported(BatchSha256::SHA_NI)) {
+    return BatchSha256::SHA_NI;
+  }
+  if (BatchSha256::isSupported(BatchSha256::AVX2)) {
+    return BatchSha256::AVX2;
+  }
+  return BatchSha256::SCALAR;
+}
+
+std::atomic<int>&
+selected()
+{
+  static std::atomic<int> implementation(fastestSupported());
+  return implementation;
+}
+
+} // namespace
+
+void
+BatchSha256::computeDigests(const Message* messages, size_t count, Digest* digests)
+{
+  switch (implementation()) {
+#ifdef NTORRENT_HAVE_X86_SHA256
+    case SHA_NI:
+      hashShaNi(messages, count, digests);
+      break;
+    case AVX2:
+      hashAvx2(messages, count, digests);
+      break;
+#endif
+    default:
+      hashEach(messages, count, digests, compressScalar);
+      break;
+  }
+}
+
+BatchSha256::Implementation
+BatchSha256::implementation()
+{
+  return static_cast<Implementation>(selected().load(std::memory_order_relaxed));
+}
+
+bool
+BatchSha256::setImplementation(Implementation implementation)
+{
+  if (!isSupported(implementation)) {
+    return false;
+  }
+  selected().store(implementation, std::memory_order_relaxed);
+  return true;
+}
+
+bool
+BatchSha256::isSupported(Implementation implementation)
+{
+  switch (implementation) {
+    case SCALAR:
+      return true;
+#ifdef NTORRENT_HAVE_X86_SHA256
+    case AVX2:
+      return __builtin_cpu_supports("avx2");
+    case SHA_NI: {
+      unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+      if (__get_cpuid_max(0, nullptr) < 7) {
+        return false;
+      }
+      __cpuid(1, eax, ebx, ecx, edx);
+      // SSSE3 and SSE4.1 shuffle and blend the words given to the SHA instructions
+      bool sse = (ecx & bit_SSSE3) && (ecx & bit_SSE4_1);
+      __cpuid_count(7, 0, eax, ebx, ecx, edx);
+      return sse && (ebx & (1u << 29));
+    }
+#endif
+    default:
+      return false;
+  }
+}
+
+const char*
+BatchSha256::name(Implementation implementation)
+{
+  switch (implementation) {
+    case SCALAR:
+      return "scalar";
+    case AVX2:
+      return "avx2";
+    case SHA_NI:
+      return "sha-ni";
+  }
+  return "unknown";
+}
+
+} // namespace ntorrent
+} // namespace ndn
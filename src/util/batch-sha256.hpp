@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_UTIL_BATCH_SHA256_H
+#define INCLUDED_UTIL_BATCH_SHA256_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ndn {
+namespace ntorrent {
+
+class BatchSha256 {
+  /**
+   * \class BatchSha256
+   *
+   * \brief Compute the SHA-256 digests of many messages at once
+   *
+   * The implementation is chosen at runtime among those the CPU supports: the SHA extensions
+   * (SHA-NI), which hash each message in turn with the dedicated instructions; AVX2, which hashes
+   * eight messages at once, one per 32-bit lane; or a portable scalar implementation. The messages
+   * hashed in the same pass by AVX2 are best of equal sizes, as the pass lasts as long as the
+   * longest one. The digests are the same whatever the implementation.
+   */
+ public:
+  enum {
+    DIGEST_SIZE = 32,
+    // The number of messages hashed in the same pass by the AVX2 implementation
+    NUM_LANES = 8
+  };
+
+  enum Implementation {
+    SCALAR,
+    AVX2,
+    SHA_NI
+  };
+
+  // The bytes of a message to hash
+  struct Message {
+    const uint8_t* data;
+    size_t         size;
+  };
+
+  typedef std::array<uint8_t, DIGEST_SIZE> Digest;
+
+  /*
+   * @brief Set @p digests[i] to the SHA-256 digest of @p messages[i], for each of the @p count
+   *        messages
+   */
+  static void
+  computeDigests(const Message* messages, size_t count, Digest* digests);
+
+  /*
+   * @brief Return the SHA-256 digest of the @p size bytes at @p data
+   */
+  static Digest
+  computeDigest(const uint8_t* data, size_t size);
+
+  /*
+   * @brief Return the implementation currently used, by default the fastest one supported
+   */
+  static Implementation
+  implementation();
+
+  /*
+   * @brief Use @p implementation from now on, unless the CPU does not support it
+   * @return True if @p implementation is now used, false if it is not supported
+   */
+  static bool
+  setImplementation(Implementation implementation);
+
+  /*
+   * @brief Return true if the CPU supports @p implementation
+   */
+  static bool
+  isSupported(Implementation implementation);
+
+  /*
+   * @brief Return the name of @p implementation
+   */
+  static const char*
+  name(Implementation implementation);
+};
+
+inline
+BatchSha256::Digest
+BatchSha256::computeDigest(const uint8_t* data, size_t size)
+{
+  Message message{data, size};
+  Digest digest;
+  computeDigests(&message, 1, &digest);
+  return digest;
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_UTIL_BATCH_SHA256_H
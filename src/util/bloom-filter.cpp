@@ -0,0 +1,89 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "util/bloom-filter.hpp"
+#include "util/batch-sha256.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+namespace ntorrent {
+
+// Return the 64-bit big-endian integer at 'bytes', the same on every host
+static uint64_t
+loadUint64(const uint8_t* bytes)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i) {
+    value = (value << 8) | bytes[i];
+  }
+  return value;
+}
+
+size_t
+BloomFilter::fitSize(size_t numEntries, size_t maxSize)
+{
+  return std::min(maxSize, std::max<size_t>(1, (numEntries * BITS_PER_ENTRY + 7) / 8));
+}
+
+std::vector<size_t>
+BloomFilter::positions(const Name& name) const
+{
+  // combine two hashes into the NUM_HASHES ones, as 'h1 + i * h2' (Kirsch and Mitzenmacher)
+  const auto& wire = name.wireEncode();
+  auto digest = BatchSha256::computeDigest(wire.wire(), wire.size());
+  auto h1 = loadUint64(digest.data());
+  auto h2 = loadUint64(digest.data() + 8) | 1;
+  auto numBits = m_bytes.size() * 8;
+  std::vector<size_t> positions(NUM_HASHES);
+  for (size_t i = 0; i < positions.size(); ++i) {
+    positions[i] = (h1 + i * h2) % numBits;
+  }
+  return positions;
+}
+
+void
+BloomFilter::insert(const Name& name)
+{
+  if (m_bytes.empty()) {
+    return;
+  }
+  for (auto position : positions(name)) {
+    m_bytes[position / 8] |= 0x80 >> (position % 8);
+  }
+}
+
+bool
+BloomFilter::contains(const Name& name) const
+{
+  if (m_bytes.empty()) {
+    return false;
+  }
+  for (auto position : positions(name)) {
+    if (0 == (m_bytes[position / 8] & (0x80 >> (position % 8)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace ntorrent
+} // namespace ndn
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_UTIL_BLOOM_FILTER_H
+#define INCLUDED_UTIL_BLOOM_FILTER_H
+
+#include <ndn-cxx/name.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+
+class BloomFilter {
+  /**
+   * \class BloomFilter
+   *
+   * \brief A value semantic type for a Bloom filter of names, exchanged between peers
+   *
+   * The positions of the bits of a name are derived from the SHA-256 digest of its wire encoding,
+   * so that every peer computes the same ones. The filter is sent as its bytes alone: the number of
+   * bits is eight per byte and the number of hash functions is fixed.
+   */
+ public:
+  enum {
+    // The number of bits set per name
+    NUM_HASHES = 7,
+    // The number of bits per name for which about 1% of the other names are false positives
+    BITS_PER_ENTRY = 10
+  };
+
+  // CREATORS
+  explicit
+  BloomFilter(size_t size = 0);
+  /// Create an empty filter of the specified 'size' bytes.
+
+  BloomFilter(const uint8_t* bytes, size_t size);
+  /// Create the filter whose bytes are the specified 'size' bytes at 'bytes'.
+
+  // CLASS METHODS
+  static size_t
+  fitSize(size_t numEntries, size_t maxSize);
+  /// Return the size in bytes of the filter for the specified 'numEntries' names, at most
+  /// 'maxSize' bytes, past which the false positives become more frequent.
+
+  // MANIPULATORS
+  void
+  insert(const Name& name);
+  /// Add the specified 'name' to this filter.
+
+  // ACCESSORS
+  bool
+  contains(const Name& name) const;
+  /// Return true if the specified 'name' was possibly inserted, or false if it surely was not. An
+  /// empty filter contains nothing.
+
+  const std::vector<uint8_t>&
+  bytes() const;
+  /// Return the bytes of this filter.
+
+ private:
+  // Return the position of the bits of 'name'
+  std::vector<size_t>
+  positions(const Name& name) const;
+
+ private:
+  std::vector<uint8_t> m_bytes;
+};
+
+inline
+BloomFilter::BloomFilter(size_t size)
+: m_bytes(size, 0)
+{
+}
+
+inline
+BloomFilter::BloomFilter(const uint8_t* bytes, size_t size)
+: m_bytes(bytes, bytes + size)
+{
+}
+
+inline const std::vector<uint8_t>&
+BloomFilter::bytes() const
+{
+  return m_bytes;
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_UTIL_BLOOM_FILTER_H
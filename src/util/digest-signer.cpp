@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "util/digest-signer.hpp"
+#include "util/batch-sha256.hpp"
+
+#include <ndn-cxx/encoding/block-helpers.hpp>
+#include <ndn-cxx/encoding/encoding-buffer.hpp>
+#include <ndn-cxx/security/digest-sha256.hpp>
+
+#include <cstring>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+
+// Return the size of the TLV-TYPE or TLV-LENGTH 'number'
+static size_t
+sizeOfVarNumber(uint64_t number)
+{
+  return number < 253 ? 1 : number <= 0xFFFF ? 3 : number <= 0xFFFFFFFF ? 5 : 9;
+}
+
+// Write the TLV-TYPE or TLV-LENGTH 'number' at 'it', and return the position following it
+static uint8_t*
+writeVarNumber(uint8_t* it, uint64_t number)
+{
+  auto size = sizeOfVarNumber(number);
+  if (1 == size) {
+    *it++ = static_cast<uint8_t>(number);
+    return it;
+  }
+  *it++ = 3 == size ? 253 : 5 == size ? 254 : 255;
+  for (size_t i = size - 1; i > 0; --i) {
+    *it++ = static_cast<uint8_t>(number >> (8 * (i - 1)));
+  }
+  return it;
+}
+
+// Copy 'block' at 'it', and return the position following it
+static uint8_t*
+writeBlock(uint8_t* it, const Block& block)
+{
+  std::memcpy(it, block.wire(), block.size());
+  return it + block.size();
+}
+
+void
+DigestSigner::sign(Data& data)
+{
+  // Mirror KeyChain::sign for a DigestSha256 signer: encode the unsigned portion, hash it, and
+  // append the digest as the signature value.
+  data.setSignature(DigestSha256());
+  EncodingBuffer encoder;
+  data.wireEncode(encoder, true);
+  auto digest = BatchSha256::computeDigest(encoder.buf(), encoder.size());
+  data.wireEncode(encoder, encoding::makeBinaryBlock(tlv::SignatureValue, digest.data(),
+                                                      digest.size()));
+}
+
+void
+DigestSigner::sign(Data* packets, size_t count, Name* fullNames)
+{
+  std::vector<EncodingBuffer> encoders(count);
+  std::vector<BatchSha256::Message> messages(count);
+  std::vector<BatchSha256::Digest> digests(count);
+  for (size_t i = 0; i < count; ++i) {
+    packets[i].setSignature(DigestSha256());
+    packets[i].wireEncode(encoders[i], true);
+    messages[i] = BatchSha256::Message{encoders[i].buf(), encoders[i].size()};
+  }
+  BatchSha256::computeDigests(messages.data(), count, digests.data());
+  for (size_t i = 0; i < count; ++i) {
+    const auto& wire = packets[i].wireEncode(encoders[i],
+                                             encoding::makeBinaryBlock(tlv::SignatureValue,
+                                                                       digests[i].data(),
+                                                                       digests[i].size()));
+    messages[i] = BatchSha256::Message{wire.wire(), wire.size()};
+  }
+  // the implicit digest of each packet is the digest of its whole encoding
+  BatchSha256::computeDigests(messages.data(), count, digests.data());
+  for (size_t i = 0; i < count; ++i) {
+    fullNames[i] = packets[i].getName();
+    fullNames[i].appendImplicitSha256Digest(digests[i].data(), digests[i].size());
+  }
+}
+
+shared_ptr<Data>
+DigestSigner::makeData(const Name& name, const uint8_t* content, size_t size)
+{
+  // Data ::= DATA-TYPE TLV-LENGTH
+  //            Name
+  //            MetaInfo
+  //            Content
+  //            SignatureInfo
+  //            SignatureValue
+  // laid out as 'Data::wireEncode' does, the MetaInfo being the default one
+  const Block& nameWire = name.wireEncode();
+  const Block& metaInfoWire = MetaInfo().wireEncode();
+  const Block& signatureInfo = DigestSha256().getInfo();
+  const size_t contentLength = sizeOfVarNumber(tlv::Content) + sizeOfVarNumber(size) + size;
+  const size_t signatureValueLength = sizeOfVarNumber(tlv::SignatureValue) +
+                                      sizeOfVarNumber(BatchSha256::DIGEST_SIZE) +
+                                      BatchSha256::DIGEST_SIZE;
+  const size_t unsignedLength = nameWire.size() + metaInfoWire.size() + contentLength +
+                                signatureInfo.size();
+  const size_t valueLength = unsignedLength + signatureValueLength;
+  auto buffer = make_shared<Buffer>(sizeOfVarNumber(tlv::Data) + sizeOfVarNumber(valueLength) +
+                                    valueLength);
+  uint8_t* it = writeVarNumber(buffer->data(), tlv::Data);
+  it = writeVarNumber(it, valueLength);
+  const uint8_t* unsignedPortion = it;
+  it = writeBlock(it, nameWire);
+  it = writeBlock(it, metaInfoWire);
+  it = writeVarNumber(it, tlv::Content);
+  it = writeVarNumber(it, size);
+  if (0 < size) {
+    std::memcpy(it, content, size);
+    it += size;
+  }
+  it = writeBlock(it, signatureInfo);
+  auto digest = BatchSha256::computeDigest(unsignedPortion, unsignedLength);
+  it = writeVarNumber(it, tlv::SignatureValue);
+  it = writeVarNumber(it, digest.size());
+  std::memcpy(it, digest.data(), digest.size());
+  return make_shared<Data>(Block(buffer));
+}
+
+} // namespace ntorrent
+} // namespace ndn
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_UTIL_DIGEST_SIGNER_H
+#define INCLUDED_UTIL_DIGEST_SIGNER_H
+
+#include <ndn-cxx/data.hpp>
+
+namespace ndn {
+namespace ntorrent {
+
+class DigestSigner {
+  /**
+   * \class DigestSigner
+   *
+   * \brief Sign Data packets with a SHA-256 digest signature without a KeyChain
+   *
+   * The resulting packets are identical to those produced by
+   * 'KeyChain::sign(data, signingWithSha256())', but no PIB/TPM is ever opened, so signing costs
+   * only the encoding and the hash. The digests are computed by BatchSha256, batches of packets
+   * at a time if they are signed together.
+   */
+ public:
+  /*
+   * @brief Set a DigestSha256 signature on @p data and encode it
+   */
+  static void
+  sign(Data& data);
+
+  /*
+   * @brief Sign each of the @p count @p packets as 'sign' does, and set each of @p fullNames to
+   *        the full name of the packet at the same position
+   *
+   * Both the signature and the implicit digest of the packets are computed for all the packets at
+   * once, so that they are hashed in parallel, and no further hash is needed for their full names.
+   */
+  static void
+  sign(Data* packets, size_t count, Name* fullNames);
+
+  /*
+   * @brief Return the packet named @p name with the @p size bytes at @p content, signed as 'sign'
+   *        does
+   *
+   * The packet is encoded in a single buffer, into which the content is copied once, and decoded
+   * in place, so that its content refers to that buffer. The encoding is identical to that of a
+   * packet whose content is set with 'setContent' and then signed.
+   */
+  static shared_ptr<Data>
+  makeData(const Name& name, const uint8_t* content, size_t size);
+};
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_UTIL_DIGEST_SIGNER_H
@@ -0,0 +1,279 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "util/file-handle-cache.hpp"
+
+#include "util/logging.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn {
+namespace ntorrent {
+
+FileHandleCache::FileHandleCache(size_t capacity)
+: m_capacity(capacity > 0 ? capacity : 1)
+{
+}
+
+FileHandleCache::~FileHandleCache()
+{
+  clear();
+}
+
+FileHandleCache::Handle::Handle(const std::string& path, int fd, bool writable)
+: path(path)
+, fd(fd)
+, writable(writable)
+, dirty(false)
+{
+}
+
+FileHandleCache::Handle::~Handle()
+{
+  sync(*this);
+  ::close(fd);
+}
+
+std::shared_ptr<FileHandleCache::Handle>
+FileHandleCache::acquire(const std::string& path, bool forWriting)
+{
+  // the released handles are synced and closed once the lock is released
+  std::vector<std::shared_ptr<Handle>> released;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto index_it = m_index.find(path);
+  if (m_index.end() != index_it) {
+    auto it = index_it->second;
+    if (forWriting && !(*it)->writable) {
+      // reopen for writing below
+      released.push_back(release(it));
+    }
+    else {
+      m_handles.splice(m_handles.begin(), m_handles, it);
+      return m_handles.front();
+    }
+  }
+  int fd = forWriting ? ::open(path.c_str(), O_RDWR | O_CREAT, 0644)
+                      : ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG_ERROR << "Failed to open " << path << ": " << std::strerror(errno);
+    return nullptr;
+  }
+  while (m_handles.size() >= m_capacity) {
+    released.push_back(release(std::prev(m_handles.end())));
+  }
+  m_handles.push_front(std::make_shared<Handle>(path, fd, forWriting));
+  m_index[path] = m_handles.begin();
+  return m_handles.front();
+}
+
+bool
+FileHandleCache::sync(Handle& handle)
+{
+  if (!handle.dirty.exchange(false)) {
+    return true;
+  }
+  if (0 != ::fdatasync(handle.fd)) {
+    LOG_ERROR << "Failed to sync " << handle.path << ": " << std::strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+std::shared_ptr<FileHandleCache::Handle>
+FileHandleCache::release(HandleList::iterator it)
+{
+  auto handle = *it;
+  m_index.erase(handle->path);
+  m_handles.erase(it);
+  return handle;
+}
+
+bool
+FileHandleCache::write(const std::string& path,
+                       uint64_t           offset,
+                       const uint8_t*     buffer,
+                       size_t             length)
+{
+  auto handle = acquire(path, true);
+  if (nullptr == handle) {
+    return false;
+  }
+  while (length > 0) {
+    auto written = ::pwrite(handle->fd, buffer, length, offset);
+    if (written < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      LOG_ERROR << "Failed to write " << path << ": " << std::strerror(errno);
+      return false;
+    }
+    buffer += written;
+    offset += written;
+    length -= written;
+  }
+  handle->dirty = true;
+  return true;
+}
+
+bool
+FileHandleCache::write(const std::string& path, uint64_t offset, struct iovec* buffers, int count)
+{
+  auto handle = acquire(path, true);
+  if (nullptr == handle) {
+    return false;
+  }
+  while (count > 0) {
+    auto written = ::pwritev(handle->fd, buffers, count, offset);
+    if (written < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      LOG_ERROR << "Failed to write " << path << ": " << std::strerror(errno);
+      return false;
+    }
+    offset += written;
+    // skip the buffers that were written completely, then the written part of the next one
+    while (count > 0 && static_cast<size_t>(written) >= buffers->iov_len) {
+      written -= buffers->iov_len;
+      ++buffers;
+      --count;
+    }
+    if (count > 0) {
+      buffers->iov_base = static_cast<uint8_t*>(buffers->iov_base) + written;
+      buffers->iov_len -= written;
+    }
+  }
+  handle->dirty = true;
+  return true;
+}
+
+bool
+FileHandleCache::allocate(const std::string& path, uint64_t offset, uint64_t length)
+{
+  auto handle = acquire(path, true);
+  if (nullptr == handle) {
+    return false;
+  }
+  if (0 == length) {
+    return true;
+  }
+#ifdef __linux__
+  int rval;
+  do {
+    rval = ::fallocate(handle->fd, FALLOC_FL_KEEP_SIZE, offset, length);
+  } while (0 != rval && EINTR == errno);
+  if (0 != rval && EOPNOTSUPP != errno && ENOSYS != errno) {
+    LOG_ERROR << "Failed to allocate " << path << ": " << std::strerror(errno);
+    return false;
+  }
+#endif
+  return true;
+}
+
+int64_t
+FileHandleCache::read(const std::string& path, uint64_t offset, uint8_t* buffer, size_t length)
+{
+  auto handle = acquire(path, false);
+  if (nullptr == handle) {
+    return -1;
+  }
+  size_t total = 0;
+  while (total < length) {
+    auto bytes = ::pread(handle->fd, buffer + total, length - total, offset + total);
+    if (bytes < 0) {
+      if (EINTR == errno) {
+        continue;
+      }
+      LOG_ERROR << "Failed to read " << path << ": " << std::strerror(errno);
+      return -1;
+    }
+    if (0 == bytes) {
+      break;
+    }
+    total += bytes;
+  }
+  return total;
+}
+
+bool
+FileHandleCache::flush(const std::string& path)
+{
+  std::shared_ptr<Handle> handle;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto index_it = m_index.find(path);
+    if (m_index.end() == index_it) {
+      return true;
+    }
+    handle = *index_it->second;
+  }
+  return sync(*handle);
+}
+
+bool
+FileHandleCache::flushAll()
+{
+  std::vector<std::shared_ptr<Handle>> handles;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    handles.assign(m_handles.begin(), m_handles.end());
+  }
+  bool rval = true;
+  for (const auto& handle : handles) {
+    rval = sync(*handle) && rval;
+  }
+  return rval;
+}
+
+void
+FileHandleCache::close(const std::string& path)
+{
+  std::shared_ptr<Handle> handle;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto index_it = m_index.find(path);
+    if (m_index.end() == index_it) {
+      return;
+    }
+    // closed once released, outside of the lock
+    handle = release(index_it->second);
+  }
+}
+
+void
+FileHandleCache::clear()
+{
+  HandleList handles;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    handles.swap(m_handles);
+    m_index.clear();
+  }
+}
+
+} // namespace ntorrent
+} // namespace ndn
@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_UTIL_FILE_HANDLE_CACHE_H
+#define INCLUDED_UTIL_FILE_HANDLE_CACHE_H
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <sys/uio.h>
+
+namespace ndn {
+namespace ntorrent {
+
+class FileHandleCache : boost::noncopyable {
+  /**
+   * \class FileHandleCache
+   *
+   * \brief A bounded cache of open file descriptors for the files of a torrent
+   *
+   * Reads and writes are positional (pread/pwrite) so a single descriptor per file can serve any
+   * packet without seeking or reopening. When more than 'capacity' files are open the least
+   * recently used descriptor is closed. Writes are not synced to disk until flush() or flushAll()
+   * is called, allowing callers to batch the syncs (e.g. once per completed sub-manifest).
+   *
+   * The cache may be used from several threads at once. The reads and writes are performed without
+   * holding its lock, a descriptor evicted while in use is closed once the last use completes.
+   */
+ public:
+  enum {
+    // Default maximum number of simultaneously open descriptors
+    DEFAULT_CAPACITY = 64
+  };
+
+  /*
+   * @brief Create an empty cache that holds at most @p capacity open descriptors
+   */
+  explicit
+  FileHandleCache(size_t capacity = DEFAULT_CAPACITY);
+
+  /*
+   * @brief Flush and close all open descriptors
+   */
+  ~FileHandleCache();
+
+  /*
+   * @brief Write @p length bytes from @p buffer at @p offset in the file at @p path
+   * Create the file if it does not already exist. Return 'true' if all the bytes were written,
+   * 'false' otherwise.
+   */
+  bool
+  write(const std::string& path, uint64_t offset, const uint8_t* buffer, size_t length);
+
+  /*
+   * @brief Write the @p count buffers of @p buffers contiguously at @p offset in the file at @p path
+   * Identical to the above, except the buffers are written with a single vectored write (the
+   * contents of @p buffers are modified on partial writes).
+   */
+  bool
+  write(const std::string& path, uint64_t offset, struct iovec* buffers, int count);
+
+  /*
+   * @brief Reserve disk space for @p length bytes at @p offset in the file at @p path
+   * Create the file if it does not already exist. The reported size of the file is left unchanged,
+   * so the space is only reserved for later writes, which may arrive in any order. Where the file
+   * system cannot reserve space the file is left sparse. Return 'false' if the space could not be
+   * reserved (e.g. the disk is full), 'true' otherwise.
+   */
+  bool
+  allocate(const std::string& path, uint64_t offset, uint64_t length);
+
+  /*
+   * @brief Read up to @p length bytes at @p offset in the file at @p path into @p buffer
+   * Return the number of bytes read, which is less than @p length only at the end of the file, or
+   * -1 if the file could not be opened or read.
+   */
+  int64_t
+  read(const std::string& path, uint64_t offset, uint8_t* buffer, size_t length);
+
+  /*
+   * @brief Sync any outstanding writes to the file at @p path to disk
+   * Return 'false' if the sync failed, 'true' otherwise (including when there was nothing to sync).
+   */
+  bool
+  flush(const std::string& path);
+
+  /*
+   * @brief Sync all outstanding writes to disk
+   */
+  bool
+  flushAll();
+
+  /*
+   * @brief Flush and close the descriptor for @p path (if open)
+   */
+  void
+  close(const std::string& path);
+
+  /*
+   * @brief Flush and close all open descriptors
+   */
+  void
+  clear();
+
+  /*
+   * @brief Return the number of currently open descriptors
+   */
+  size_t
+  size() const;
+
+  /*
+   * @brief Return the maximum number of simultaneously open descriptors
+   */
+  size_t
+  capacity() const;
+
+ private:
+  struct Handle : boost::noncopyable {
+    Handle(const std::string& path, int fd, bool writable);
+
+    // Sync any outstanding writes, then close the descriptor
+    ~Handle();
+
+    std::string        path;
+    int                fd;
+    bool               writable;
+    std::atomic<bool>  dirty;
+  };
+
+  typedef std::list<std::shared_ptr<Handle>> HandleList;
+
+  // Return the open handle for 'path', opening (or reopening for writing) it if necessary, and
+  // mark it as most recently used. Return nullptr on failure.
+  std::shared_ptr<Handle>
+  acquire(const std::string& path, bool forWriting);
+
+  static bool
+  sync(Handle& handle);
+
+  // Remove 'it' from the cache and return it, its descriptor is closed once no longer in use
+  std::shared_ptr<Handle>
+  release(HandleList::iterator it);
+
+  // Handles ordered from most to least recently used
+  HandleList                                                m_handles;
+  // Index into 'm_handles' by file path
+  std::unordered_map<std::string, HandleList::iterator>     m_index;
+  // Maximum number of open handles
+  size_t                                                    m_capacity;
+  // Protects 'm_handles' and 'm_index'
+  mutable std::mutex                                        m_mutex;
+};
+
+inline
+size_t
+FileHandleCache::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_handles.size();
+}
+
+inline
+size_t
+FileHandleCache::capacity() const
+{
+  return m_capacity;
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_UTIL_FILE_HANDLE_CACHE_H
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "util/file-map-cache.hpp"
+
+#include "util/logging.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn {
+namespace ntorrent {
+
+FileMapCache::Mapping::~Mapping()
+{
+  if (nullptr != m_data) {
+    ::munmap(const_cast<uint8_t*>(m_data), m_size);
+  }
+}
+
+FileMapCache::FileMapCache(size_t capacity)
+: m_capacity(capacity > 0 ? capacity : 1)
+{
+}
+
+bool
+FileMapCache::mapFile(Entry& entry)
+{
+  const auto& path = entry.path;
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG_ERROR << "Failed to open " << path << ": " << std::strerror(errno);
+    return false;
+  }
+  struct stat st;
+  if (0 != ::fstat(fd, &st)) {
+    LOG_ERROR << "Failed to stat " << path << ": " << std::strerror(errno);
+    ::close(fd);
+    return false;
+  }
+  // an empty file cannot be mapped, but has nothing to read either
+  void* data = nullptr;
+  if (st.st_size > 0) {
+    data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  // the mapping outlives the descriptor
+  ::close(fd);
+  if (MAP_FAILED == data) {
+    LOG_ERROR << "Failed to map " << path << ": " << std::strerror(errno);
+    return false;
+  }
+  entry.mapping = std::make_shared<const Mapping>(static_cast<const uint8_t*>(data), st.st_size);
+  entry.device = st.st_dev;
+  entry.inode = st.st_ino;
+  return true;
+}
+
+std::shared_ptr<const FileMapCache::Mapping>
+FileMapCache::map(const std::string& path)
+{
+  // the released mappings are unmapped once the lock is released
+  std::vector<std::shared_ptr<const Mapping>> released;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto index_it = m_index.find(path);
+  if (m_index.end() != index_it) {
+    auto it = index_it->second;
+    m_entries.splice(m_entries.begin(), m_entries, it);
+    // the mapping is up to date as long as the same file is at the path, with the same size
+    struct stat st;
+    if (0 == ::stat(path.c_str(), &st) &&
+        it->device == static_cast<uint64_t>(st.st_dev) &&
+        it->inode == static_cast<uint64_t>(st.st_ino) &&
+        it->mapping->size() == static_cast<uint64_t>(st.st_size)) {
+      return it->mapping;
+    }
+    released.push_back(it->mapping);
+    if (!mapFile(*it)) {
+      m_entries.erase(it);
+      m_index.erase(index_it);
+      return nullptr;
+    }
+    return it->mapping;
+  }
+  Entry entry{path, nullptr, 0, 0};
+  if (!mapFile(entry)) {
+    return nullptr;
+  }
+  while (m_entries.size() >= m_capacity) {
+    released.push_back(m_entries.back().mapping);
+    m_index.erase(m_entries.back().path);
+    m_entries.pop_back();
+  }
+  m_entries.push_front(entry);
+  m_index[path] = m_entries.begin();
+  return entry.mapping;
+}
+
+bool
+FileMapCache::willNeed(const std::string& path, uint64_t offset, uint64_t length)
+{
+  auto mapping = map(path);
+  if (nullptr == mapping) {
+    return false;
+  }
+  if (offset >= mapping->size()) {
+    return true;
+  }
+  // advise whole pages, the mapping itself starting on a page
+  static const uint64_t pageSize = ::sysconf(_SC_PAGESIZE);
+  auto begin = offset - offset % pageSize;
+  auto end = std::min<uint64_t>(offset + length, mapping->size());
+  auto data = const_cast<uint8_t*>(mapping->data()) + begin;
+  if (0 != ::madvise(data, end - begin, MADV_SEQUENTIAL) ||
+      0 != ::madvise(data, end - begin, MADV_WILLNEED)) {
+    LOG_DEBUG << "Failed to advise " << path << ": " << std::strerror(errno);
+  }
+  return true;
+}
+
+void
+FileMapCache::close(const std::string& path)
+{
+  std::shared_ptr<const Mapping> mapping;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto index_it = m_index.find(path);
+    if (m_index.end() == index_it) {
+      return;
+    }
+    mapping = index_it->second->mapping;
+    m_entries.erase(index_it->second);
+    m_index.erase(index_it);
+  }
+}
+
+void
+FileMapCache::clear()
+{
+  EntryList entries;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    entries.swap(m_entries);
+    m_index.clear();
+  }
+}
+
+} // namespace ntorrent
+} // namespace ndn
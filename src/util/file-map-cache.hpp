@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_UTIL_FILE_MAP_CACHE_H
+#define INCLUDED_UTIL_FILE_MAP_CACHE_H
+
+#include <boost/noncopyable.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ndn {
+namespace ntorrent {
+
+class FileMapCache : boost::noncopyable {
+  /**
+   * \class FileMapCache
+   *
+   * \brief A bounded cache of read-only memory mappings of the files of a torrent
+   *
+   * Each file is mapped whole, so that a served packet is built straight from the pages of the
+   * file without first reading them into a buffer. The file at the path is checked each time its
+   * mapping is requested: one that grew (e.g. while it is still being downloaded), was truncated
+   * or was replaced since it was mapped is mapped again, as reading the pages past the end of a
+   * file raises SIGBUS. When more than 'capacity' files are mapped the least recently used mapping
+   * is released.
+   *
+   * The cache may be used from several threads at once. A mapping released while in use is unmapped
+   * once the last use completes, so a file must still not be truncated while its pages are read.
+   */
+ public:
+  enum {
+    // Default maximum number of simultaneously mapped files
+    DEFAULT_CAPACITY = 64
+  };
+
+  // The read-only mapping of a file, valid as long as it is referenced
+  class Mapping : boost::noncopyable {
+   public:
+    Mapping(const uint8_t* data, size_t size);
+
+    // Unmap the file
+    ~Mapping();
+
+    const uint8_t*
+    data() const;
+
+    size_t
+    size() const;
+
+   private:
+    const uint8_t* m_data;
+    size_t         m_size;
+  };
+
+  /*
+   * @brief Create an empty cache that holds at most @p capacity mappings
+   */
+  explicit
+  FileMapCache(size_t capacity = DEFAULT_CAPACITY);
+
+  /*
+   * @brief Return the mapping of the whole file currently at @p path, or nullptr if it could not
+   *        be opened or mapped
+   */
+  std::shared_ptr<const Mapping>
+  map(const std::string& path);
+
+  /*
+   * @brief Hint that the @p length bytes at @p offset in the file at @p path are about to be read
+   * in order, so that the kernel reads them ahead (MADV_SEQUENTIAL and MADV_WILLNEED). Return
+   * 'false' if the file could not be mapped, 'true' otherwise.
+   */
+  bool
+  willNeed(const std::string& path, uint64_t offset, uint64_t length);
+
+  /*
+   * @brief Release the mapping of the file at @p path (if mapped)
+   */
+  void
+  close(const std::string& path);
+
+  /*
+   * @brief Release all the mappings
+   */
+  void
+  clear();
+
+  /*
+   * @brief Return the number of currently mapped files
+   */
+  size_t
+  size() const;
+
+  /*
+   * @brief Return the maximum number of simultaneously mapped files
+   */
+  size_t
+  capacity() const;
+
+ private:
+  struct Entry {
+    std::string                    path;
+    std::shared_ptr<const Mapping> mapping;
+    // The device and inode of the mapped file, which the path may no longer name
+    uint64_t                       device;
+    uint64_t                       inode;
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  // Map the whole file at the path of 'entry' into it, returning 'false' on failure
+  static bool
+  mapFile(Entry& entry);
+
+  // Mappings ordered from most to least recently used
+  EntryList                                                 m_entries;
+  // Index into 'm_entries' by file path
+  std::unordered_map<std::string, EntryList::iterator>      m_index;
+  // Maximum number of mappings
+  size_t                                                    m_capacity;
+  // Protects 'm_entries' and 'm_index'
+  mutable std::mutex                                        m_mutex;
+};
+
+inline
+FileMapCache::Mapping::Mapping(const uint8_t* data, size_t size)
+: m_data(data)
+, m_size(size)
+{
+}
+
+inline
+const uint8_t*
+FileMapCache::Mapping::data() const
+{
+  return m_data;
+}
+
+inline
+size_t
+FileMapCache::Mapping::size() const
+{
+  return m_size;
+}
+
+inline
+size_t
+FileMapCache::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+inline
+size_t
+FileMapCache::capacity() const
+{
+  return m_capacity;
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_UTIL_FILE_MAP_CACHE_H
@@ -23,13 +23,15 @@
 
 #include "file-manifest.hpp"
 #include "torrent-file.hpp"
+#include "util/digest-signer.hpp"
+#include "util/file-handle-cache.hpp"
+#include "util/file-map-cache.hpp"
 #include "util/logging.hpp"
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 
-#include <ndn-cxx/security/key-chain.hpp>
-#include <ndn-cxx/security/signing-helpers.hpp>
+#include <algorithm>
 
 namespace fs = boost::filesystem;
 
@@ -39,77 +41,76 @@ using std::vector;
 namespace ndn {
 namespace ntorrent {
 
-std::vector<ndn::Data>
+size_t
 IoUtil::packetize_file(const fs::path& filePath,
                        const ndn::Name& commonPrefix,
                        size_t dataPacketSize,
                        size_t subManifestSize,
-                       size_t subManifestNum)
+                       size_t subManifestNum,
+                       const PacketVisitor& visitor)
 {
   BOOST_ASSERT(0 < dataPacketSize);
-  size_t APPROX_BUFFER_SIZE = std::numeric_limits<int>::max(); // 2 * 1024 * 1024 *1024
   auto file_size = fs::file_size(filePath);
   auto start_offset = subManifestNum * subManifestSize * dataPacketSize;
+  if (start_offset >= file_size) {
+    return 0;
+  }
   // determine the number of bytes in this submanifest
-  auto subManifestLength = subManifestSize * dataPacketSize;
-  auto remainingFileLength = file_size - start_offset;
-  subManifestLength = remainingFileLength < subManifestLength
-                    ? remainingFileLength
-                    : subManifestLength;
-  vector<ndn::Data> packets;
-  packets.reserve(subManifestLength/dataPacketSize + 1);
+  auto subManifestLength = std::min<uintmax_t>(subManifestSize * dataPacketSize,
+                                               file_size - start_offset);
   fs::ifstream fs(filePath, fs::ifstream::binary);
   if (!fs) {
     BOOST_THROW_EXCEPTION(Data::Error("IO Error when opening" + filePath.string()));
   }
-  // ensure that buffer is large enough to contain whole packets
-  // buffer size is either the entire file or the smallest number of data packets >= 2 GB
-  auto buffer_size =
-    subManifestLength < APPROX_BUFFER_SIZE   ?
-    subManifestLength                        :
-    APPROX_BUFFER_SIZE % dataPacketSize == 0 ?
-    APPROX_BUFFER_SIZE :
-    APPROX_BUFFER_SIZE + dataPacketSize - (APPROX_BUFFER_SIZE % dataPacketSize);
-  vector<char> file_bytes;
-  file_bytes.reserve(buffer_size);
+  // read a fixed number of whole packets at a time
+  size_t packetsPerRead = std::max<size_t>(1, READ_BUFFER_SIZE / dataPacketSize);
+  vector<char> file_bytes(std::min<uintmax_t>(packetsPerRead * dataPacketSize, subManifestLength));
   size_t bytes_read = 0;
+  size_t numPackets = 0;
   fs.seekg(start_offset);
-  while(fs && bytes_read < subManifestLength && !fs.eof()) {
-    // read the file into the buffer
-    fs.read(&file_bytes.front(), buffer_size);
+  vector<Data> packets;
+  vector<Name> fullNames(packetsPerRead);
+  packets.reserve(packetsPerRead);
+  while (bytes_read < subManifestLength) {
+    auto to_read = std::min<uintmax_t>(file_bytes.size(), subManifestLength - bytes_read);
+    fs.read(file_bytes.data(), to_read);
     auto read_size = fs.gcount();
-    if (fs.bad() || read_size < 0) {
+    if (fs.bad() || read_size <= 0) {
       BOOST_THROW_EXCEPTION(Data::Error("IO Error when reading" + filePath.string()));
     }
     bytes_read += read_size;
-    char *curr_start = &file_bytes.front();
-    for (size_t i = 0u; i < buffer_size; i += dataPacketSize) {
+    packets.clear();
+    for (std::streamsize i = 0; i < read_size; i += dataPacketSize) {
       // Build a packet from the data
       Name packetName = commonPrefix;
-      packetName.appendSequenceNumber(packets.size());
-      Data d(packetName);
-      auto content_length = i + dataPacketSize > buffer_size ? buffer_size - i : dataPacketSize;
-      d.setContent(encoding::makeBinaryBlock(tlv::Content, curr_start, content_length));
-      curr_start += content_length;
-      // append to the collection
-      packets.push_back(d);
+      packetName.appendSequenceNumber(numPackets++);
+      packets.emplace_back(packetName);
+      auto content_length = std::min<std::streamsize>(dataPacketSize, read_size - i);
+      packets.back().setContent(encoding::makeBinaryBlock(tlv::Content, &file_bytes[i],
+                                                          content_length));
+    }
+    // the packets of the buffer are of equal sizes (but the last of the file), so they are hashed
+    // in parallel
+    DigestSigner::sign(packets.data(), packets.size(), fullNames.data());
+    for (size_t i = 0; i < packets.size(); ++i) {
+      visitor(packets[i], fullNames[i]);
     }
-    file_bytes.clear();
-    // recompute the buffer_size
-    buffer_size =
-      subManifestLength - bytes_read < APPROX_BUFFER_SIZE ?
-      subManifestLength - bytes_read                      :
-      APPROX_BUFFER_SIZE % dataPacketSize == 0            ?
-      APPROX_BUFFER_SIZE                                  :
-      APPROX_BUFFER_SIZE + dataPacketSize - (APPROX_BUFFER_SIZE % dataPacketSize);
   }
-  fs.close();
+  return numPackets;
+}
+
+std::vector<ndn::Data>
+IoUtil::packetize_file(const fs::path& filePath,
+                       const ndn::Name& commonPrefix,
+                       size_t dataPacketSize,
+                       size_t subManifestSize,
+                       size_t subManifestNum)
+{
+  vector<ndn::Data> packets;
+  packets.reserve(subManifestSize);
+  packetize_file(filePath, commonPrefix, dataPacketSize, subManifestSize, subManifestNum,
+                 [&packets](const Data& d, const Name&) { packets.push_back(d); });
   packets.shrink_to_fit();
-  ndn::security::KeyChain key_chain;
-  // sign all the packets
-  for (auto& p : packets) {
-    key_chain.sign(p, signingWithSha256());
-  }
   return packets;
 }
 
@@ -124,12 +125,12 @@ bool IoUtil::writeTorrentSegment(const TorrentFile& segment, const std::string&
   auto filename = path + to_string(segmentNum);
   // if there is already a file on disk for this torrent segment, determine if we should override
   if (fs::exists(filename)) {
-    auto segmentOnDisk_ptr = io::load<TorrentFile>(filename);
+    auto segmentOnDisk_ptr = load<TorrentFile>(filename);
     if (nullptr != segmentOnDisk_ptr && *segmentOnDisk_ptr == segment) {
       return false;
     }
   }
-  io::save(segment, filename);
+  save(segment, filename);
   // add to collection
   return true;
 }
@@ -145,12 +146,12 @@ bool IoUtil::writeFileManifest(const FileManifest& manifest, const std::string&
   }
   // if there is already a file on disk for this file manifest, determine if we should override
   if (fs::exists(filename)) {
-    auto submanifestOnDisk_ptr = io::load<FileManifest>(filename.string());
+    auto submanifestOnDisk_ptr = load<FileManifest>(filename.string());
     if (nullptr != submanifestOnDisk_ptr && *submanifestOnDisk_ptr == manifest) {
       return false;
     }
   }
-  io::save(manifest, filename.string());
+  save(manifest, filename.string());
   return true;
 }
 bool
@@ -159,23 +160,43 @@ IoUtil::writeData(const Data&         packet,
                   size_t              subManifestSize,
                   const std::string&  filePath)
 {
-  fs::ofstream os (filePath, fs::ofstream::binary | fs::ofstream::out | fs::ofstream::app);
+  FileHandleCache handles(1);
+  return writeData(packet, manifest, subManifestSize, filePath, handles);
+}
+
+bool
+IoUtil::writeData(const Data&         packet,
+                  const FileManifest& manifest,
+                  size_t              subManifestSize,
+                  const std::string&  filePath,
+                  FileHandleCache&    handles)
+{
   auto packetName = packet.getName();
   auto packetNum = packetName.get(packetName.size() - 1).toSequenceNumber();
-  auto dataPacketSize = manifest.data_packet_size();
+  auto packetOffset = dataOffset(manifest, subManifestSize, packetNum);
+  // write the content directly from the packet's wire encoding
+  const auto& content = packet.getContent();
+  return handles.write(filePath, packetOffset, content.value(), content.value_size());
+}
+
+uint64_t
+IoUtil::dataOffset(const FileManifest& manifest, size_t subManifestSize, size_t packetNum)
+{
+  uint64_t dataPacketSize = manifest.data_packet_size();
   auto initial_offset = manifest.submanifest_number() * subManifestSize * dataPacketSize;
-  auto packetOffset =  initial_offset + packetNum * dataPacketSize;
-  // write data to disk
-  os.seekp(packetOffset);
-  try {
-    auto content = packet.getContent();
-    std::vector<char> data(content.value_begin(), content.value_end());
-    return os.write(&data[0], data.size()).good() && os.flush().good();
-  }
-  catch (io::Error &e) {
-    LOG_ERROR << e.what() << std::endl;
-    return false;
-  }
+  return initial_offset + packetNum * dataPacketSize;
+}
+
+bool
+IoUtil::allocateData(const FileManifest& manifest,
+                     size_t              subManifestSize,
+                     const std::string&  filePath,
+                     FileHandleCache&    handles)
+{
+  uint64_t dataPacketSize = manifest.data_packet_size();
+  return handles.allocate(filePath,
+                          dataOffset(manifest, subManifestSize, 0),
+                          manifest.catalog().size() * dataPacketSize);
 }
 
 std::shared_ptr<Data>
@@ -184,31 +205,68 @@ IoUtil::readDataPacket(const Name&         packetFullName,
                        size_t              subManifestSize,
                        const std::string&  filePath)
 {
-  fs::fstream is (filePath, fs::fstream::in | fs::fstream::binary);
-  auto dataPacketSize = manifest.data_packet_size();
-  auto start_offset = manifest.submanifest_number() * subManifestSize * dataPacketSize;
+  FileHandleCache handles(1);
+  return readDataPacket(packetFullName, manifest, subManifestSize, filePath, handles);
+}
+
+std::shared_ptr<Data>
+IoUtil::readDataPacket(const Name&         packetFullName,
+                       const FileManifest& manifest,
+                       size_t              subManifestSize,
+                       const std::string&  filePath,
+                       FileHandleCache&    handles)
+{
   auto packetNum = packetFullName.get(packetFullName.size() - 2).toSequenceNumber();
-  // seek to packet
-  is.sync();
-  is.seekg(start_offset + packetNum * dataPacketSize);
-  if (is.tellg() < 0) {
-    LOG_ERROR << "bad seek" << std::endl;
+  return readDataPacket(packetFullName,
+                        dataOffset(manifest, subManifestSize, packetNum),
+                        manifest.data_packet_size(),
+                        filePath,
+                        handles);
+}
+
+std::shared_ptr<Data>
+IoUtil::readDataPacket(const Name&         packetFullName,
+                       uint64_t            offset,
+                       size_t              dataPacketSize,
+                       const std::string&  filePath,
+                       FileHandleCache&    handles)
+{
+  // read contents
+  std::vector<uint8_t> bytes(dataPacketSize);
+  auto read_size = handles.read(filePath, offset, bytes.data(), dataPacketSize);
+  if (read_size < 0) {
+    LOG_ERROR << "Bad read";
+    return nullptr;
+  }
+  // construct packet
+  auto packetName = packetFullName.getSubName(0, packetFullName.size() - 1);
+  auto d = make_shared<Data>(packetName);
+  d->setContent(encoding::makeBinaryBlock(tlv::Content, bytes.data(), read_size));
+  DigestSigner::sign(*d);
+  return d->getFullName() == packetFullName ? d : nullptr;
+}
+
+std::shared_ptr<Data>
+IoUtil::readDataPacket(const Name&         packetFullName,
+                       uint64_t            offset,
+                       size_t              dataPacketSize,
+                       const std::string&  filePath,
+                       FileMapCache&       mappings)
+{
+  // the file is checked before its pages are read, so that a truncated or replaced one is
+  // mapped again (or reported missing) rather than raising SIGBUS
+  auto mapping = mappings.map(filePath);
+  if (nullptr == mapping) {
+    LOG_ERROR << "Bad read";
+    return nullptr;
   }
- // read contents
- std::vector<char> bytes(dataPacketSize);
- is.read(&bytes.front(), dataPacketSize);
- auto read_size = is.gcount();
- if (is.bad() || read_size < 0) {
-  LOG_ERROR << "Bad read" << std::endl;
-  return nullptr;
- }
- // construct packet
- auto packetName = packetFullName.getSubName(0, packetFullName.size() - 1);
- auto d = make_shared<Data>(packetName);
- d->setContent(encoding::makeBinaryBlock(tlv::Content, &bytes.front(), read_size));
- ndn::security::KeyChain key_chain;
- key_chain.sign(*d, signingWithSha256());
- return d->getFullName() == packetFullName ? d : nullptr;
+  // the last packet of the file is shorter
+  size_t size = offset < mapping->size() ? std::min<uint64_t>(dataPacketSize,
+                                                              mapping->size() - offset)
+                                         : 0;
+  auto packetName = packetFullName.getSubName(0, packetFullName.size() - 1);
+  auto d = DigestSigner::makeData(packetName, mapping->data() + offset, size);
+  return d->getFullName() == packetFullName ? d : nullptr;
 }
 
 IoUtil::NAME_TYPE
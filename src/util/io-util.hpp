@@ -22,12 +22,19 @@
 #ifndef INCLUDED_UTIL_IO_UTIL_H
 #define INCLUDED_UTIL_IO_UTIL_H
 
+#include "util/thread-pool.hpp"
+
 #include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
 
 #include <ndn-cxx/data.hpp>
+#include <ndn-cxx/encoding/tlv.hpp>
 #include <ndn-cxx/name.hpp>
 #include <ndn-cxx/util/io.hpp>
 
+#include <algorithm>
+#include <functional>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -40,6 +47,8 @@ namespace Io = boost::filesystem;
 
 class TorrentFile;
 class FileManifest;
+class FileHandleCache;
+class FileMapCache;
 
 class IoUtil {
  public:
@@ -54,10 +63,33 @@ class IoUtil {
     UNKNOWN
   };
 
+  /*
+   * @brief Load the packet of type T saved at @p filePath, or return nullptr if it cannot be read
+   * Files holding the binary wire encoding of a Data packet are recognized by their first byte and
+   * decoded as is; other files are decoded with @p encoding.
+   */
+  template<typename T>
+  static std::shared_ptr<T>
+  load(const std::string& filePath,
+       ndn::io::IoEncoding encoding = ndn::io::IoEncoding::BASE64);
+
+  /*
+   * @brief Load all the packets of type T saved under @p dirPath, in the order of their paths
+   * @param numThreads The number of threads reading and decoding the files concurrently
+   * See load() for the supported encodings.
+   */
   template<typename T>
   static std::vector<T>
   load_directory(const std::string& dirPath,
-                 ndn::io::IoEncoding encoding = ndn::io::IoEncoding::BASE64);
+                 ndn::io::IoEncoding encoding = ndn::io::IoEncoding::BASE64,
+                 size_t numThreads = 1);
+
+  /*
+   * @brief Save @p packet to @p filePath as its binary wire encoding
+   */
+  template<typename T>
+  static void
+  save(const T& packet, const std::string& filePath);
 
   /*
    * @brief create all directories for the @p dirPath.
@@ -66,6 +98,42 @@ class IoUtil {
   static bool create_directories(const boost::filesystem::path& dirPath);
 
 
+  /*
+   * A callback invoked with each signed Data packet produced by packetize_file and its full name,
+   * computed along with its signature so that the packet need not be hashed again
+   */
+  typedef std::function<void(const ndn::Data& packet, const ndn::Name& fullName)> PacketVisitor;
+
+  enum {
+    // The number of bytes read from disk at a time when packetizing a file
+    READ_BUFFER_SIZE = 1024 * 1024
+  };
+
+  /*
+   * @brief Packetize the @p subManifestNum sub-manifest of the file at @p filePath.
+   * @param filePath The path to the file to be packetized
+   * @param commonPrefix The name of the sub-manifest, used as the prefix of each packet name
+   * @param dataPacketSize The maximum number of content bytes per Data packet
+   * @param subManifestSize The number of Data packets per sub-manifest
+   * @param subManifestNum The number of the sub-manifest to be packetized
+   * @param visitor The callback invoked, in order, with each signed packet
+   * Read the file through a buffer of at most READ_BUFFER_SIZE bytes so that no more than one
+   * buffer of payload is held in memory at a time, and return the number of packets produced.
+   * The packets of each buffer are signed and hashed together (see DigestSigner).
+   * @throws Data::Error if there is any I/O issue reading the file.
+   */
+  static size_t
+  packetize_file(const boost::filesystem::path& filePath,
+                 const ndn::Name& commonPrefix,
+                 size_t dataPacketSize,
+                 size_t subManifestSize,
+                 size_t subManifestNum,
+                 const PacketVisitor& visitor);
+
+  /*
+   * @brief Return all the signed Data packets of the @p subManifestNum sub-manifest of the file at
+   * @p filePath (see above).
+   */
   static std::vector<ndn::Data>
   packetize_file(const boost::filesystem::path& filePath,
                  const ndn::Name& commonPrefix,
@@ -110,6 +178,39 @@ class IoUtil {
             size_t              subManifestSize,
             const std::string&  filePath);
 
+  /*
+   * @brief Write @p packet composed of torrent date to disk using a descriptor from @p handles.
+   * Identical to the above, except the file is written through the (possibly already open)
+   * descriptor in @p handles and is not synced to disk until the caller flushes @p handles.
+   */
+  static bool
+  writeData(const Data&         packet,
+            const FileManifest& manifest,
+            size_t              subManifestSize,
+            const std::string&  filePath,
+            FileHandleCache&    handles);
+
+  /*
+   * @brief Return the offset in its file of the data packet number @p packetNum of @p manifest
+   * @param subManifestSize The number of Data packets in each catalog for this file
+   */
+  static uint64_t
+  dataOffset(const FileManifest& manifest, size_t subManifestSize, size_t packetNum);
+
+  /*
+   * @brief Reserve the disk space for the Data packets of @p manifest using @p handles
+   * @param manifest The file manifest whose packets are to be written
+   * @param subManifestSize The number of Data packets in each catalog for this file
+   * @param filePath The path to the file on disk that the packets are written to
+   * Reserve the range of the file covered by the catalog of @p manifest, so that its packets can
+   * be written out of order without fragmenting the file. The size of the file is not changed.
+   */
+  static bool
+  allocateData(const FileManifest& manifest,
+               size_t              subManifestSize,
+               const std::string&  filePath,
+               FileHandleCache&    handles);
+
   /*
    * @brief Read a data packet from the provided stream
    * @param packetFullName The fullname of the expected Data packet
@@ -125,6 +226,45 @@ class IoUtil {
                  size_t              subManifestSize,
                  const std::string&  filePath);
 
+  /*
+   * @brief Read a data packet using a descriptor from @p handles
+   * Identical to the above, except the file is read through the (possibly already open)
+   * descriptor in @p handles.
+   */
+  static std::shared_ptr<Data>
+  readDataPacket(const Name&         packetFullName,
+                 const FileManifest& manifest,
+                 size_t              subManifestSize,
+                 const std::string&  filePath,
+                 FileHandleCache&    handles);
+
+  /*
+   * @brief Read the data packet @p packetFullName of at most @p dataPacketSize bytes at @p offset
+   * in the file at @p filePath, using a descriptor from @p handles
+   * Identical to the above, except the position of the packet is already known, so the manifest is
+   * not needed. This may be called from any thread.
+   */
+  static std::shared_ptr<Data>
+  readDataPacket(const Name&         packetFullName,
+                 uint64_t            offset,
+                 size_t              dataPacketSize,
+                 const std::string&  filePath,
+                 FileHandleCache&    handles);
+
+  /*
+   * @brief Read the data packet @p packetFullName of at most @p dataPacketSize bytes at @p offset
+   * in the file at @p filePath, using a mapping from @p mappings
+   * Identical to the above, except the content of the packet is copied once, straight from the
+   * mapped pages of the file into the wire encoding of the packet. This may be called from any
+   * thread.
+   */
+  static std::shared_ptr<Data>
+  readDataPacket(const Name&         packetFullName,
+                 uint64_t            offset,
+                 size_t              dataPacketSize,
+                 const std::string&  filePath,
+                 FileMapCache&       mappings);
+
   /*
    * @brief Return the type of the specified name
    */
@@ -140,10 +280,26 @@ IoUtil::create_directories(const boost::filesystem::path& dirPath) {
   return boost::filesystem::create_directories(dirPath);
 }
 
+template<typename T>
+inline std::shared_ptr<T>
+IoUtil::load(const std::string& filePath, ndn::io::IoEncoding encoding)
+{
+  Io::ifstream is(filePath, std::ios::binary);
+  if (!is) {
+    return nullptr;
+  }
+  // neither base64 nor hex text starts with the type of a Data packet
+  if (tlv::Data == is.peek()) {
+    encoding = ndn::io::IoEncoding::NO_ENCODING;
+  }
+  return ndn::io::load<T>(is, encoding);
+}
+
 template<typename T>
 inline std::vector<T>
 IoUtil::load_directory(const std::string& dirPath,
-                       ndn::io::IoEncoding encoding) {
+                       ndn::io::IoEncoding encoding,
+                       size_t numThreads) {
   std::vector<T> structures;
   std::set<std::string> fileNames;
   if (Io::exists(dirPath)) {
@@ -151,12 +307,30 @@ IoUtil::load_directory(const std::string& dirPath,
       it !=  Io::recursive_directory_iterator();
       ++it)
     {
-      fileNames.insert(it->path().string());
+      if (!Io::is_directory(it->path())) {
+        fileNames.insert(it->path().string());
+      }
+    }
+    std::vector<std::shared_ptr<T>> loaded(fileNames.size());
+    if (1 < numThreads && 1 < fileNames.size()) {
+      ThreadPool pool(std::min(numThreads, fileNames.size()));
+      size_t i = 0;
+      for (const auto& f : fileNames) {
+        auto& data_ptr = loaded[i++];
+        pool.post([&data_ptr, &f, encoding] { data_ptr = load<T>(f, encoding); });
+      }
+      pool.wait();
+    }
+    else {
+      size_t i = 0;
+      for (const auto& f : fileNames) {
+        loaded[i++] = load<T>(f, encoding);
+      }
     }
-    for (const auto& f : fileNames) {
-      auto data_ptr = ndn::io::load<T>(f, encoding);
+    structures.reserve(loaded.size());
+    for (const auto& data_ptr : loaded) {
       if (nullptr != data_ptr) {
-        structures.push_back(*data_ptr);
+        structures.push_back(std::move(*data_ptr));
       }
     }
   }
@@ -164,6 +338,13 @@ IoUtil::load_directory(const std::string& dirPath,
   return structures;
 }
 
+template<typename T>
+inline void
+IoUtil::save(const T& packet, const std::string& filePath)
+{
+  ndn::io::save(packet, filePath, ndn::io::IoEncoding::NO_ENCODING);
+}
+
 } // namespace ntorrent
 } // namespace ndn
 
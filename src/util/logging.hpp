@@ -27,22 +27,41 @@
 
 #include <boost/log/core.hpp>
 #include <boost/log/sources/global_logger_storage.hpp>
+#include <boost/log/sources/record_ostream.hpp>
 #include <boost/log/sources/severity_logger.hpp>
 #include <boost/log/trivial.hpp>
 
 // register a global logger
 BOOST_LOG_INLINE_GLOBAL_LOGGER_DEFAULT(logger, boost::log::sources::severity_logger_mt<boost::log::trivial::severity_level>)
 
+// The lowest severity of the log statements compiled in, from 0 (trace) to 5 (fatal). The
+// statements below it are dead code that the compiler removes, so that release builds pay nothing
+// for the per-packet trace and debug statements.
+#ifndef NTORRENT_LOG_MIN_LEVEL
+#ifdef _DEBUG
+#define NTORRENT_LOG_MIN_LEVEL 0
+#else
+#define NTORRENT_LOG_MIN_LEVEL 2
+#endif
+#endif
+
 // just a helper macro used by the macros below - don't use it in your code
-#define LOG(severity) BOOST_LOG_SEV(logger::get(), boost::log::trivial::severity)
+// The operands of a statement below the compile-time minimum or the runtime threshold are not
+// evaluated at all.
+#define LOG(severity)                                                                       \
+  if (boost::log::trivial::severity < NTORRENT_LOG_MIN_LEVEL ||                             \
+      boost::log::trivial::severity < ::ndn::ntorrent::LoggingUtil::severity_threshold) {   \
+  }                                                                                         \
+  else                                                                                      \
+    BOOST_LOG_SEV(logger::get(), boost::log::trivial::severity)
 
 // ===== log macros =====
-#define LOG_TRACE   std::cerr
-#define LOG_DEBUG   std::cerr
-#define LOG_INFO    std::cerr
-#define LOG_WARNING std::cerr
-#define LOG_ERROR   std::cerr
-#define LOG_FATAL   std::cerr
+#define LOG_TRACE   LOG(trace)
+#define LOG_DEBUG   LOG(debug)
+#define LOG_INFO    LOG(info)
+#define LOG_WARNING LOG(warning)
+#define LOG_ERROR   LOG(error)
+#define LOG_FATAL   LOG(fatal)
 
 namespace ndn {
 namespace ntorrent {
@@ -50,11 +69,13 @@ namespace ntorrent {
 namespace log = boost::log::trivial;
 
 struct LoggingUtil {
+  // The lowest severity logged; the statements below it are skipped before formatting anything
   static log::severity_level severity_threshold;
 
-  static void init(bool log_to_console = false);
+  static void init(bool log_to_console = false, bool log_to_file = true);
   // Initialize the log for the application. THis method must be called in the main function in
-  // the application before any logging may be performed.
+  // the application before any logging may be performed. The file sink writes 'sample_%N.log'
+  // files in the working directory.
 };
 
 } // end ntorrent
@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "util/thread-pool.hpp"
+
+namespace ndn {
+namespace ntorrent {
+
+ThreadPool::ThreadPool(size_t numThreads)
+: m_outstanding(0)
+, m_stopped(false)
+{
+  numThreads = numThreads > 0 ? numThreads : 1;
+  m_threads.reserve(numThreads);
+  for (size_t i = 0; i < numThreads; ++i) {
+    m_threads.emplace_back(&ThreadPool::run, this);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_allDone.wait(lock, [this] { return 0 == m_outstanding; });
+    m_stopped = true;
+  }
+  m_taskAvailable.notify_all();
+  for (auto& t : m_threads) {
+    t.join();
+  }
+}
+
+void
+ThreadPool::post(Task task)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push(std::move(task));
+    ++m_outstanding;
+  }
+  m_taskAvailable.notify_one();
+}
+
+void
+ThreadPool::wait()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_allDone.wait(lock, [this] { return 0 == m_outstanding; });
+  if (m_error) {
+    auto error = m_error;
+    m_error = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+size_t
+ThreadPool::hardwareConcurrency()
+{
+  auto n = std::thread::hardware_concurrency();
+  return 0 == n ? 1 : n;
+}
+
+void
+ThreadPool::run()
+{
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_taskAvailable.wait(lock, [this] { return m_stopped || !m_tasks.empty(); });
+      if (m_tasks.empty()) {
+        return;
+      }
+      task = std::move(m_tasks.front());
+      m_tasks.pop();
+    }
+    std::exception_ptr error;
+    try {
+      task();
+    }
+    catch (...) {
+      error = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (error && !m_error) {
+      m_error = error;
+    }
+    if (0 == --m_outstanding) {
+      m_allDone.notify_all();
+    }
+  }
+}
+
+} // namespace ntorrent
+} // namespace ndn
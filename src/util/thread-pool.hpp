@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_UTIL_THREAD_POOL_H
+#define INCLUDED_UTIL_THREAD_POOL_H
+
+#include <boost/noncopyable.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+
+class ThreadPool : boost::noncopyable {
+  /**
+   * \class ThreadPool
+   *
+   * \brief A fixed set of worker threads executing posted tasks in FIFO order
+   */
+ public:
+  typedef std::function<void()> Task;
+
+  /*
+   * @brief Create a pool of @p numThreads worker threads (at least one)
+   */
+  explicit
+  ThreadPool(size_t numThreads);
+
+  /*
+   * @brief Wait for all posted tasks to complete, then stop the worker threads
+   */
+  ~ThreadPool();
+
+  /*
+   * @brief Schedule @p task to be executed by one of the worker threads
+   */
+  void
+  post(Task task);
+
+  /*
+   * @brief Block until all posted tasks have completed
+   * If any task threw an exception since the last call, rethrow the first one.
+   */
+  void
+  wait();
+
+  /*
+   * @brief Return the number of worker threads
+   */
+  size_t
+  size() const;
+
+  /*
+   * @brief Return the number of hardware threads, or 1 if it cannot be determined
+   */
+  static size_t
+  hardwareConcurrency();
+
+ private:
+  void
+  run();
+
+  std::vector<std::thread>   m_threads;
+  std::queue<Task>           m_tasks;
+  std::mutex                 m_mutex;
+  // Signalled when a task is posted or the pool is stopped
+  std::condition_variable    m_taskAvailable;
+  // Signalled when the last outstanding task completes
+  std::condition_variable    m_allDone;
+  // Number of tasks posted but not yet completed
+  size_t                     m_outstanding;
+  std::exception_ptr         m_error;
+  bool                       m_stopped;
+};
+
+inline
+size_t
+ThreadPool::size() const
+{
+  return m_threads.size();
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_UTIL_THREAD_POOL_H
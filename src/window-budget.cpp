@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "window-budget.hpp"
+
+namespace ndn {
+namespace ntorrent {
+
+WindowBudget::WindowBudget(size_t capacity)
+: m_capacity(capacity > 0 ? capacity : 1)
+, m_outstanding(0)
+, m_waiting(0)
+, m_nextId(0)
+, m_waking(false)
+{
+}
+
+WindowBudget::Id
+WindowBudget::join(WakeUp onWakeUp)
+{
+  auto id = m_nextId++;
+  m_members[id] = Member{onWakeUp, 0, false, false};
+  return id;
+}
+
+void
+WindowBudget::leave(Id id)
+{
+  auto it = m_members.find(id);
+  if (m_members.end() == it) {
+    return;
+  }
+  m_outstanding -= it->second.outstanding;
+  m_waiting -= it->second.waiting ? 1 : 0;
+  m_members.erase(it);
+  // its turn in 'm_blocked' is skipped when it comes
+  wakeUp(id);
+}
+
+void
+WindowBudget::update(Id id, size_t outstanding, bool waiting)
+{
+  auto it = m_members.find(id);
+  if (m_members.end() == it) {
+    return;
+  }
+  auto& member = it->second;
+  m_outstanding = m_outstanding - member.outstanding + outstanding;
+  m_waiting = m_waiting - (member.waiting ? 1 : 0) + (waiting ? 1 : 0);
+  member.outstanding = outstanding;
+  member.waiting = waiting;
+  // the torrent updating the budget is about to send its own Interests
+  wakeUp(id);
+}
+
+bool
+WindowBudget::acquire(Id id)
+{
+  auto it = m_members.find(id);
+  if (m_members.end() == it) {
+    return false;
+  }
+  auto& member = it->second;
+  if (!member.waiting) {
+    member.waiting = true;
+    ++m_waiting;
+  }
+  if (!allows(member)) {
+    if (!member.blocked) {
+      member.blocked = true;
+      m_blocked.push_back(id);
+    }
+    return false;
+  }
+  // its turn in 'm_blocked' is skipped when it comes
+  member.blocked = false;
+  ++member.outstanding;
+  ++m_outstanding;
+  return true;
+}
+
+bool
+WindowBudget::allows(const Member& member) const
+{
+  return m_outstanding < m_capacity && member.outstanding < fairShare();
+}
+
+void
+WindowBudget::wakeUp(Id except)
+{
+  // the woken up torrents send their Interests, which updates the budget again
+  if (m_waking) {
+    return;
+  }
+  m_waking = true;
+  auto numBlocked = m_blocked.size();
+  while (0 < numBlocked-- && m_outstanding < m_capacity) {
+    auto id = m_blocked.front();
+    m_blocked.pop_front();
+    auto it = m_members.find(id);
+    if (m_members.end() == it || !it->second.blocked) {
+      continue;
+    }
+    auto& member = it->second;
+    if (except == id || !allows(member)) {
+      // try again on the next update
+      m_blocked.push_back(id);
+      continue;
+    }
+    member.blocked = false;
+    if (nullptr != member.wakeUp) {
+      // copied, as the torrent may leave the budget
+      auto onWakeUp = member.wakeUp;
+      onWakeUp();
+    }
+  }
+  m_waking = false;
+}
+
+} // namespace ntorrent
+} // namespace ndn
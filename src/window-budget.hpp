@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#ifndef INCLUDED_WINDOW_BUDGET_HPP
+#define INCLUDED_WINDOW_BUDGET_HPP
+
+#include <boost/noncopyable.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+
+namespace ndn {
+namespace ntorrent {
+
+class WindowBudget : boost::noncopyable {
+  /**
+   * \class WindowBudget
+   *
+   * \brief A bound on the number of Interests outstanding across the torrents hosted by a process
+   *
+   * Each torrent joins the budget and reports the number of Interests it has outstanding. A torrent
+   * may send another Interest only while the budget is not exhausted and it has fewer outstanding
+   * than its fair share, i.e. the capacity divided by the number of torrents with Interests waiting
+   * to be sent. The torrents denied an Interest are woken up in turn, once Interests of any torrent
+   * complete.
+   */
+ public:
+  typedef size_t                 Id;
+  typedef std::function<void()>  WakeUp;
+
+  /*
+   * @brief Create a budget of @p capacity outstanding Interests (at least one)
+   */
+  explicit
+  WindowBudget(size_t capacity);
+
+  /*
+   * @brief Add a torrent to the budget, returning its id
+   * @param onWakeUp Called once the budget has room again after acquire() failed for this torrent
+   */
+  Id
+  join(WakeUp onWakeUp);
+
+  /*
+   * @brief Remove the torrent @p id, releasing its outstanding Interests
+   */
+  void
+  leave(Id id);
+
+  /*
+   * @brief Record that the torrent @p id has @p outstanding Interests outstanding and whether it
+   * has more Interests @p waiting to be sent
+   * Each torrent denied an Interest is woken up if this released enough of the budget.
+   */
+  void
+  update(Id id, size_t outstanding, bool waiting);
+
+  /*
+   * @brief Count one more outstanding Interest for the torrent @p id, if it may send it
+   * Return 'false' if the Interest may not be sent, in which case the torrent is woken up once it
+   * may.
+   */
+  bool
+  acquire(Id id);
+
+  /*
+   * @brief Return the maximum number of outstanding Interests
+   */
+  size_t
+  capacity() const;
+
+  /*
+   * @brief Return the number of Interests outstanding for all the torrents
+   */
+  size_t
+  outstanding() const;
+
+  /*
+   * @brief Return the number of Interests that each torrent waiting to send more may have
+   * outstanding
+   */
+  size_t
+  fairShare() const;
+
+  /*
+   * @brief Return the number of torrents in the budget
+   */
+  size_t
+  size() const;
+
+ private:
+  struct Member {
+    WakeUp wakeUp;
+    size_t outstanding;
+    bool   waiting;
+    bool   blocked;
+  };
+
+  // Return whether 'member' may send another Interest
+  bool
+  allows(const Member& member) const;
+
+  // Wake up the blocked torrents other than 'except' in turn, as long as the budget has room
+  void
+  wakeUp(Id except);
+
+  std::unordered_map<Id, Member>   m_members;
+  // The blocked torrents, in the order they were denied an Interest
+  std::deque<Id>                   m_blocked;
+  size_t                           m_capacity;
+  size_t                           m_outstanding;
+  // Number of members waiting to send more Interests
+  size_t                           m_waiting;
+  Id                               m_nextId;
+  // Whether blocked torrents are being woken up
+  bool                             m_waking;
+};
+
+inline
+size_t
+WindowBudget::capacity() const
+{
+  return m_capacity;
+}
+
+inline
+size_t
+WindowBudget::outstanding() const
+{
+  return m_outstanding;
+}
+
+inline
+size_t
+WindowBudget::fairShare() const
+{
+  auto share = m_capacity / (0 < m_waiting ? m_waiting : 1);
+  return 0 < share ? share : 1;
+}
+
+inline
+size_t
+WindowBudget::size() const
+{
+  return m_members.size();
+}
+
+} // namespace ntorrent
+} // namespace ndn
+
+#endif // INCLUDED_WINDOW_BUDGET_HPP
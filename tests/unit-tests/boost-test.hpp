@@ -36,7 +36,8 @@
 
 struct NtorrentGlobalConfig {
   NtorrentGlobalConfig() {
-    ndn::ntorrent::LoggingUtil::init();
+    // the tests log to stderr, leaving no log file behind
+    ndn::ntorrent::LoggingUtil::init(true, false);
     boost::log::add_common_attributes();
   }
 
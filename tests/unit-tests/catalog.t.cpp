@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "boost-test.hpp"
+#include "catalog.hpp"
+
+#include <vector>
+
+BOOST_TEST_DONT_PRINT_LOG_VALUE(std::vector<ndn::Name>)
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestCatalog)
+
+BOOST_AUTO_TEST_CASE(TestAccessAndRemove)
+{
+  Catalog catalog("/foo");
+  BOOST_CHECK(catalog.empty());
+  catalog.push_back("/foo/0/ABC123");
+  catalog.push_back("/foo/1/DEADBEEF");
+  catalog.push_back("/foo/2/bar/CAFEBABE");
+  BOOST_CHECK_EQUAL(catalog.size(), 3);
+  BOOST_CHECK(catalog.bytes() >= 3 * sizeof(uint32_t));
+  BOOST_CHECK_EQUAL(catalog.prefix(), Name("/foo"));
+  BOOST_CHECK_EQUAL(catalog[1], Name("/foo/1/DEADBEEF"));
+  BOOST_CHECK_EQUAL(catalog[2], Name("/foo/2/bar/CAFEBABE"));
+
+  BOOST_CHECK_EQUAL(catalog.find("/foo/2/bar/CAFEBABE"), 2);
+  BOOST_CHECK_EQUAL(catalog.find("/foo/2/bar"), catalog.size());
+  BOOST_CHECK_EQUAL(catalog.find("/bar/0/ABC123"), catalog.size());
+
+  BOOST_CHECK(catalog.remove("/foo/0/ABC123"));
+  BOOST_CHECK(!catalog.remove("/foo/0/ABC123"));
+  BOOST_CHECK(catalog == std::vector<Name>({"/foo/1/DEADBEEF", "/foo/2/bar/CAFEBABE"}));
+  BOOST_CHECK_EQUAL(catalog[0], Name("/foo/1/DEADBEEF"));
+
+  std::vector<Name> names(catalog.begin(), catalog.end());
+  BOOST_CHECK_EQUAL(names, std::vector<Name>({"/foo/1/DEADBEEF", "/foo/2/bar/CAFEBABE"}));
+
+  BOOST_CHECK_THROW(catalog.push_back("/bar/0"), Catalog::Error);
+  BOOST_CHECK_THROW(catalog.push_back("/foo"), Catalog::Error);
+
+  catalog.clear();
+  catalog.shrink_to_fit();
+  BOOST_CHECK_EQUAL(catalog.bytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestSuffixesAndEquality)
+{
+  Catalog catalog("/foo", {"/foo/0/ABC123", "/foo/1/DEADBEEF"});
+
+  // the encoded suffixes are appended as they are
+  Catalog copy("/foo");
+  for (size_t i = 0; i < catalog.size(); ++i) {
+    EncodingBuffer encoder;
+    catalog.prependSuffix(encoder, i);
+    copy.push_back_suffix(encoder.block());
+  }
+  BOOST_CHECK_EQUAL(catalog, copy);
+  BOOST_CHECK_THROW(copy.push_back_suffix(Name().wireEncode()), Catalog::Error);
+  // a suffix whose components are malformed or are not name components is rejected
+  const uint8_t truncated[] = {tlv::NameComponent, 4, 'A', 'B'};
+  BOOST_CHECK_THROW(copy.push_back_suffix(makeBinaryBlock(tlv::Name, truncated, sizeof(truncated))),
+                    Catalog::Error);
+  const uint8_t untyped[] = {0, 2, 'A', 'B'};
+  BOOST_CHECK_THROW(copy.push_back_suffix(makeBinaryBlock(tlv::Name, untyped, sizeof(untyped))),
+                    Catalog::Error);
+  const uint8_t shortDigest[] = {tlv::ImplicitSha256DigestComponent, 2, 'A', 'B'};
+  BOOST_CHECK_THROW(copy.push_back_suffix(makeBinaryBlock(tlv::Name,
+                                                          shortDigest, sizeof(shortDigest))),
+                    Catalog::Error);
+  BOOST_CHECK_EQUAL(catalog, copy);
+
+  // catalogs holding the same names are equal, whatever their prefixes
+  Catalog other("/", {"/foo/0/ABC123", "/foo/1/DEADBEEF"});
+  BOOST_CHECK_EQUAL(catalog, other);
+  other.remove("/foo/1/DEADBEEF");
+  BOOST_CHECK_NE(catalog, other);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn
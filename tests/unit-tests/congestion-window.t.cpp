@@ -0,0 +1,79 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "boost-test.hpp"
+#include "congestion-window.hpp"
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestCongestionWindow)
+
+BOOST_AUTO_TEST_CASE(TestAimd)
+{
+  CongestionWindow window;
+  BOOST_CHECK_EQUAL(window.size(), CongestionWindow::INITIAL_WINDOW);
+
+  // slow start
+  for (int i = 0; i < 12; ++i) {
+    window.increase();
+  }
+  BOOST_CHECK_EQUAL(window.size(), 16);
+
+  time::steady_clock::TimePoint now;
+  auto rtt = time::milliseconds(100);
+  BOOST_CHECK(window.decrease(now, rtt));
+  BOOST_CHECK_EQUAL(window.size(), 8);
+  BOOST_CHECK_EQUAL(window.getThreshold(), 8);
+
+  // further losses within the same RTT are part of the same congestion event
+  BOOST_CHECK(!window.decrease(now + time::milliseconds(50), rtt));
+  BOOST_CHECK_EQUAL(window.size(), 8);
+
+  // congestion avoidance grows the window by one per window of Data
+  for (int i = 0; i < 8; ++i) {
+    window.increase();
+  }
+  BOOST_CHECK_EQUAL(window.size(), 8);
+  window.increase();
+  BOOST_CHECK_EQUAL(window.size(), 9);
+
+  BOOST_CHECK(window.decrease(now + rtt, rtt));
+  BOOST_CHECK_CLOSE(window.getWindow(), window.getThreshold(), 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(TestMinimum)
+{
+  CongestionWindow window(1);
+  time::steady_clock::TimePoint now;
+  auto rtt = time::milliseconds(100);
+  for (int i = 0; i < 3; ++i) {
+    window.decrease(now + i * rtt, rtt);
+  }
+  BOOST_CHECK_EQUAL(window.size(), CongestionWindow::MIN_WINDOW);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn
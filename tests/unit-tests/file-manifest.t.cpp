@@ -320,6 +320,23 @@ BOOST_AUTO_TEST_CASE(CheckEncodeDecode)
     keyChain.sign(m1);
     BOOST_CHECK_EQUAL(m1, FileManifest(m1.wireEncode()));
   }
+  // a manifest whose catalog includes a malformed name is rejected when it is decoded
+  {
+    EncodingBuffer encoder;
+    const uint8_t truncated[] = {tlv::NameComponent, 4, 'A', 'B'};
+    size_t length = encoder.prependByteArrayBlock(tlv::Name, truncated, sizeof(truncated));
+    length += Name("/foo/").wireEncode(encoder);
+    length += prependNonNegativeIntegerBlock(encoder, tlv::Content, 256);
+    encoder.prependVarNumber(length);
+    encoder.prependVarNumber(tlv::Content);
+
+    Data data("/file0/1A2B3C4D");
+    data.setContentType(tlv::ContentType_Blob);
+    data.setContent(encoder.block());
+    KeyChain keyChain;
+    keyChain.sign(data);
+    BOOST_CHECK_THROW(FileManifest(data.wireEncode()), FileManifest::Error);
+  }
 }
 
 BOOST_AUTO_TEST_CASE(CheckGenerateFileManifest)
@@ -429,7 +446,7 @@ BOOST_AUTO_TEST_CASE(CheckGenerateFileManifest)
         size_t total_manifest_length = 0;
         for (auto& m : manifests) {
           total_manifest_length += m.wireEncode().value_size();
-          for (auto& data_name : m.catalog()) {
+          for (const auto& data_name : m.catalog()) {
             BOOST_CHECK_EQUAL(data_name, data_it->getFullName());
             ++data_it;
           }
@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "boost-test.hpp"
+#include "file-state.hpp"
+
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestFileState)
+
+BOOST_AUTO_TEST_CASE(TestSetAndReset)
+{
+  FileState state(130);
+  BOOST_CHECK_EQUAL(state.size(), 130);
+  BOOST_CHECK_EQUAL(state.missing(), 130);
+  BOOST_CHECK(!state.complete());
+
+  BOOST_CHECK(state.set(0));
+  BOOST_CHECK(!state.set(0));
+  BOOST_CHECK(state.set(129));
+  BOOST_CHECK(state.test(0));
+  BOOST_CHECK(!state.test(1));
+  BOOST_CHECK(state.test(129));
+  BOOST_CHECK_EQUAL(state.missing(), 128);
+
+  state.reset(0);
+  state.reset(0);
+  BOOST_CHECK(!state.test(0));
+  BOOST_CHECK_EQUAL(state.missing(), 129);
+
+  for (size_t i = 0; i < state.size(); ++i) {
+    state.set(i);
+  }
+  BOOST_CHECK(state.complete());
+
+  // an empty state is trivially complete
+  BOOST_CHECK(FileState().complete());
+}
+
+BOOST_AUTO_TEST_CASE(TestFindNextMissing)
+{
+  std::vector<bool> bitmap(200, true);
+  bitmap[3] = false;
+  bitmap[64] = false;
+  bitmap[190] = false;
+  FileState state(bitmap);
+  BOOST_CHECK_EQUAL(state.missing(), 3);
+  BOOST_CHECK(state.toBitmap() == bitmap);
+
+  std::vector<size_t> missing;
+  for (auto i = state.findNextMissing(); i < state.size(); i = state.findNextMissing(i + 1)) {
+    missing.push_back(i);
+  }
+  std::vector<size_t> expected = {3, 64, 190};
+  BOOST_CHECK(missing == expected);
+
+  state.set(190);
+  // the unused bits of the last word are not reported as missing
+  BOOST_CHECK_EQUAL(state.findNextMissing(65), state.size());
+  BOOST_CHECK_EQUAL(state.findNextMissing(500), state.size());
+  BOOST_CHECK_EQUAL(FileState(5).findNextMissing(2), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn
@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "boost-test.hpp"
+#include "generation-cache.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <string>
+
+namespace fs = boost::filesystem;
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestGenerationCache)
+
+BOOST_AUTO_TEST_CASE(TestLookupInsert)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  auto cachePath = dirPath + "generation-cache";
+  auto filePath = dirPath + "file";
+  auto removedPath = dirPath + "removed";
+  std::ofstream(filePath) << "some data";
+  std::ofstream(removedPath) << "other data";
+  Name manifestName("/ndn/multicast/NTORRENT/temp/file/%00%00");
+  Name removedName("/ndn/multicast/NTORRENT/temp/removed/%00%00");
+  {
+    GenerationCache cache;
+    BOOST_CHECK(!cache.open(cachePath, 4, 128));
+    BOOST_CHECK(nullptr == cache.lookup(filePath));
+    BOOST_CHECK(nullptr == cache.lookup(removedPath));
+    cache.insert(filePath, manifestName);
+    cache.insert(removedPath, removedName);
+    // nothing is recorded for a file that was not looked up
+    cache.insert(dirPath + "missing", manifestName);
+    BOOST_REQUIRE(cache.save());
+  }
+  {
+    GenerationCache cache;
+    BOOST_REQUIRE(cache.open(cachePath, 4, 128));
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+    auto name = cache.lookup(filePath);
+    BOOST_REQUIRE(nullptr != name);
+    BOOST_CHECK_EQUAL(*name, manifestName);
+    // the files not seen by a generation are forgotten
+    BOOST_REQUIRE(cache.save());
+  }
+  {
+    GenerationCache cache;
+    BOOST_REQUIRE(cache.open(cachePath, 4, 128));
+    BOOST_CHECK_EQUAL(cache.size(), 1);
+    BOOST_CHECK(nullptr == cache.lookup(removedPath));
+    // a modified file is packetized again
+    std::ofstream(filePath, std::ofstream::app) << "more data";
+    BOOST_CHECK(nullptr == cache.lookup(filePath));
+    cache.insert(filePath, removedName);
+    BOOST_REQUIRE(cache.save());
+  }
+  {
+    GenerationCache cache;
+    BOOST_REQUIRE(cache.open(cachePath, 4, 128));
+    auto name = cache.lookup(filePath);
+    BOOST_REQUIRE(nullptr != name);
+    BOOST_CHECK_EQUAL(*name, removedName);
+    // the manifests that are not stored anymore are not reused
+    cache.retain([&manifestName] (const Name& name) { return manifestName == name; });
+    BOOST_CHECK_EQUAL(cache.size(), 0);
+    BOOST_CHECK(nullptr == cache.lookup(filePath));
+  }
+  {
+    // nor are those generated with other packet sizes
+    GenerationCache cache;
+    BOOST_CHECK(!cache.open(cachePath, 4, 256));
+    BOOST_CHECK_EQUAL(cache.size(), 0);
+    BOOST_CHECK(nullptr == cache.lookup(filePath));
+  }
+  // a corrupt tail is discarded
+  std::ofstream(cachePath, std::ofstream::app) << "garbage";
+  {
+    GenerationCache cache;
+    BOOST_REQUIRE(cache.open(cachePath, 4, 128));
+    BOOST_CHECK_EQUAL(cache.size(), 1);
+  }
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ntorrent
+} // namespace ndn
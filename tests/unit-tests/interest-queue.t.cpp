@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "boost-test.hpp"
+#include "interest-queue.hpp"
+
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+static shared_ptr<const InterestQueue::Request>
+makeRequest(std::vector<Name>& received, std::vector<Name>& timedOut)
+{
+  return make_shared<const InterestQueue::Request>(InterestQueue::Request{
+    [&received] (const Interest& interest, const Data&) { received.push_back(interest.getName()); },
+    [&timedOut] (const Interest& interest) { timedOut.push_back(interest.getName()); },
+    false,
+    false});
+}
+
+BOOST_AUTO_TEST_SUITE(TestInterestQueue)
+
+BOOST_AUTO_TEST_CASE(TestPriorityOrder)
+{
+  std::vector<Name> received, timedOut;
+  auto request = makeRequest(received, timedOut);
+  InterestQueue queue;
+  BOOST_CHECK(queue.empty());
+  BOOST_CHECK(queue.push("/data/0", request, InterestQueue::DATA_PACKET));
+  BOOST_CHECK(queue.push("/data/1", request, InterestQueue::DATA_PACKET));
+  BOOST_CHECK(queue.push("/low/0", request, InterestQueue::DATA_PACKET_LOW));
+  BOOST_CHECK(queue.push("/manifest/0", request, InterestQueue::FILE_MANIFEST));
+  BOOST_CHECK(queue.push("/retry/0", request, InterestQueue::DATA_PACKET_RETRY));
+  BOOST_CHECK(queue.push("/torrent/0", request, InterestQueue::TORRENT_FILE));
+  BOOST_CHECK_EQUAL(queue.size(), 6);
+
+  std::vector<Name> expected = { "/torrent/0", "/manifest/0", "/retry/0",
+                                 "/data/0", "/data/1", "/low/0" };
+  for (const auto& name : expected) {
+    BOOST_CHECK_EQUAL(queue.front().name, name);
+    BOOST_CHECK_EQUAL(queue.pop().name, name);
+  }
+  BOOST_CHECK(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestDeduplication)
+{
+  std::vector<Name> received, timedOut;
+  InterestQueue queue;
+  BOOST_CHECK(queue.push("/data/0", makeRequest(received, timedOut), InterestQueue::DATA_PACKET));
+  BOOST_CHECK(queue.push("/data/1", makeRequest(received, timedOut), InterestQueue::DATA_PACKET));
+  // the duplicate is merged into the queued name
+  BOOST_CHECK(!queue.push("/data/1", makeRequest(received, timedOut), InterestQueue::DATA_PACKET));
+  BOOST_CHECK_EQUAL(queue.size(), 2);
+  BOOST_CHECK(queue.contains("/data/1"));
+
+  // a duplicate with a higher priority promotes the queued name
+  BOOST_CHECK(!queue.push("/data/1",
+                          makeRequest(received, timedOut),
+                          InterestQueue::DATA_PACKET_RETRY));
+  BOOST_CHECK_EQUAL(queue.size(), 2);
+
+  auto entry = queue.pop();
+  BOOST_CHECK_EQUAL(entry.name, Name("/data/1"));
+  // the callbacks of all three requests are called
+  entry.request->onTimeout(Interest(entry.name));
+  BOOST_CHECK_EQUAL(timedOut.size(), 3);
+  BOOST_CHECK(!queue.contains("/data/1"));
+
+  // the stale slot of the promoted name is skipped
+  BOOST_CHECK_EQUAL(queue.size(), 1);
+  BOOST_CHECK_EQUAL(queue.pop().name, Name("/data/0"));
+  BOOST_CHECK(queue.empty());
+
+  // once popped, a name may be queued again
+  BOOST_CHECK(queue.push("/data/1", makeRequest(received, timedOut)));
+  BOOST_CHECK_EQUAL(queue.size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn
@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "boost-test.hpp"
+#include "metadata-store.hpp"
+
+#include "file-manifest.hpp"
+#include "torrent-file.hpp"
+#include "util/io-util.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestMetadataStore)
+
+BOOST_AUTO_TEST_CASE(TestInsertAndLoad)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  auto storePath = dirPath + "metadata";
+  auto content = TorrentFile::generate("tests/testdata/foo", 1, 1, 1024, false);
+  const auto& torrentSegments = content.first;
+  std::vector<FileManifest> manifests;
+  for (const auto& ms : content.second) {
+    manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+  }
+  auto isManifest = [] (const Name& name) {
+    return IoUtil::FILE_MANIFEST == IoUtil::findType(name);
+  };
+  {
+    MetadataStore store;
+    BOOST_REQUIRE(store.open(storePath));
+    for (const auto& t : torrentSegments) {
+      BOOST_CHECK(store.insert(t));
+    }
+    for (const auto& m : manifests) {
+      BOOST_CHECK(store.insert(m));
+    }
+    // packets are stored once
+    BOOST_CHECK(!store.insert(manifests[0]));
+    BOOST_CHECK_EQUAL(store.size(), torrentSegments.size() + manifests.size());
+    BOOST_CHECK(store.contains(manifests[0].getFullName()));
+    BOOST_CHECK(!store.contains(manifests[0].getName()));
+    BOOST_CHECK(store.flush());
+    BOOST_CHECK(store.load<FileManifest>(isManifest) == manifests);
+  }
+  // the records are indexed when the store is opened again
+  MetadataStore store;
+  BOOST_REQUIRE(store.open(storePath));
+  BOOST_CHECK_EQUAL(store.size(), torrentSegments.size() + manifests.size());
+  BOOST_CHECK(!store.insert(torrentSegments[0]));
+  BOOST_CHECK(store.load<FileManifest>(isManifest, 4) == manifests);
+  auto segments = store.load<TorrentFile>([] (const Name& name) {
+                                            return IoUtil::TORRENT_FILE == IoUtil::findType(name);
+                                          });
+  BOOST_CHECK(segments == torrentSegments);
+  // a single packet is read without loading the others
+  FileManifest manifest;
+  BOOST_CHECK(store.find(manifests.back().getFullName(), manifest));
+  BOOST_CHECK(manifest == manifests.back());
+  BOOST_CHECK(!store.find(manifests.back().getName(), manifest));
+  store.close();
+  BOOST_CHECK(!store.find(manifests.back().getFullName(), manifest));
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_CASE(TestTruncatedTail)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  auto storePath = dirPath + "metadata";
+  auto manifests = FileManifest::generate("tests/testdata/foo/bar1.txt", "/NTORRENT/foo/", 8, 1024);
+  BOOST_REQUIRE(1 < manifests.size());
+  {
+    MetadataStore store;
+    BOOST_REQUIRE(store.open(storePath));
+    for (const auto& m : manifests) {
+      BOOST_CHECK(store.insert(m));
+    }
+  }
+  // cut the last record short, as a crash while appending would
+  fs::resize_file(storePath, fs::file_size(storePath) - 1);
+  {
+    MetadataStore store;
+    BOOST_REQUIRE(store.open(storePath));
+    BOOST_CHECK_EQUAL(store.size(), manifests.size() - 1);
+    BOOST_CHECK(!store.contains(manifests.back().getFullName()));
+    // the discarded record can be appended again
+    BOOST_CHECK(store.insert(manifests.back()));
+  }
+  MetadataStore store;
+  BOOST_REQUIRE(store.open(storePath));
+  BOOST_CHECK_EQUAL(store.size(), manifests.size());
+
+  // a file that is not a store is replaced by an empty one
+  std::ofstream(dirPath + "other") << "not a metadata store";
+  BOOST_REQUIRE(store.open(dirPath + "other"));
+  BOOST_CHECK_EQUAL(store.size(), 0);
+  store.close();
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_CASE(TestMalformedRecord)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  auto storePath = dirPath + "metadata";
+  auto manifests = FileManifest::generate("tests/testdata/foo/bar1.txt", "/NTORRENT/foo/", 8, 1024);
+  BOOST_REQUIRE(1 < manifests.size());
+  {
+    MetadataStore store;
+    BOOST_REQUIRE(store.open(storePath));
+    BOOST_CHECK(store.insert(manifests[0]));
+  }
+  // append a record whose framing is intact but whose Data has no name
+  {
+    Name name("/NTORRENT/foo/bar1.txt/malformed");
+    const Block& nameWire = name.wireEncode();
+    const uint8_t data[] = {tlv::Data, 2, tlv::Content, 0};
+    std::ofstream os(storePath, std::ios::binary | std::ios::app);
+    os.write(reinterpret_cast<const char*>(nameWire.wire()), nameWire.size());
+    os.write(reinterpret_cast<const char*>(data), sizeof(data));
+  }
+  MetadataStore store;
+  BOOST_REQUIRE(store.open(storePath));
+  BOOST_CHECK_EQUAL(store.size(), 2);
+  for (size_t i = 1; i < manifests.size(); ++i) {
+    BOOST_CHECK(store.insert(manifests[i]));
+  }
+  // the malformed record is left out, whatever the number of threads decoding the records
+  auto all = [] (const Name&) { return true; };
+  BOOST_CHECK(store.load<FileManifest>(all) == manifests);
+  BOOST_CHECK(store.load<FileManifest>(all, 4) == manifests);
+  store.close();
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_CASE(TestCompact)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  auto storePath = dirPath + "metadata";
+  auto manifests = FileManifest::generate("tests/testdata/foo/bar1.txt", "/NTORRENT/foo/", 8, 1024);
+  BOOST_REQUIRE(2 < manifests.size());
+  MetadataStore store;
+  BOOST_REQUIRE(store.open(storePath));
+  for (const auto& m : manifests) {
+    BOOST_CHECK(store.insert(m));
+  }
+  auto size = fs::file_size(storePath);
+
+  // keeping every record leaves the store as is
+  auto all = [] (const Name&) { return true; };
+  BOOST_CHECK(store.compact(all));
+  BOOST_CHECK_EQUAL(store.size(), manifests.size());
+  BOOST_CHECK_EQUAL(fs::file_size(storePath), size);
+
+  // only the kept records remain, in the order they were appended
+  const auto& dropped = manifests[1].getFullName();
+  BOOST_CHECK(store.compact([&dropped] (const Name& fullName) { return dropped != fullName; }));
+  auto kept = manifests;
+  kept.erase(kept.begin() + 1);
+  BOOST_CHECK_EQUAL(store.size(), kept.size());
+  BOOST_CHECK(!store.contains(dropped));
+  BOOST_CHECK(store.load<FileManifest>(all) == kept);
+  BOOST_CHECK_LT(fs::file_size(storePath), size);
+  BOOST_CHECK(!fs::exists(storePath + ".compact"));
+
+  // the store is still open for appending, and is read the same way once reopened
+  BOOST_CHECK(store.insert(manifests[1]));
+  kept.push_back(manifests[1]);
+  BOOST_CHECK(store.load<FileManifest>(all) == kept);
+  store.close();
+  BOOST_REQUIRE(store.open(storePath));
+  BOOST_CHECK(store.load<FileManifest>(all) == kept);
+  FileManifest manifest;
+  BOOST_CHECK(store.find(kept[0].getFullName(), manifest));
+  BOOST_CHECK_EQUAL(manifest, kept[0]);
+  store.close();
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn
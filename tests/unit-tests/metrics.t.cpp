@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "boost-test.hpp"
+#include "metrics.hpp"
+
+#include <sstream>
+#include <string>
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestMetrics)
+
+BOOST_AUTO_TEST_CASE(TestHistogram)
+{
+  Histogram histogram;
+  BOOST_CHECK_EQUAL(histogram.count(), 0);
+  BOOST_CHECK_EQUAL(histogram.percentile(0.5), 0);
+
+  // 0 | 1 | 2 3 | 4 .. 7 | ...
+  histogram.add(0);
+  histogram.add(1);
+  histogram.add(3);
+  histogram.add(5);
+  histogram.add(6);
+  BOOST_CHECK_EQUAL(histogram.count(), 5);
+  BOOST_CHECK_EQUAL(histogram.sum(), 15);
+  BOOST_CHECK_EQUAL(histogram.max(), 6);
+  BOOST_CHECK_EQUAL(histogram.buckets()[0], 1);
+  BOOST_CHECK_EQUAL(histogram.buckets()[1], 1);
+  BOOST_CHECK_EQUAL(histogram.buckets()[2], 1);
+  BOOST_CHECK_EQUAL(histogram.buckets()[3], 2);
+
+  // the percentiles are the upper bounds of the buckets, but never beyond the largest value
+  BOOST_CHECK_EQUAL(histogram.percentile(0.2), 0);
+  BOOST_CHECK_EQUAL(histogram.percentile(0.4), 1);
+  BOOST_CHECK_EQUAL(histogram.percentile(0.6), 3);
+  BOOST_CHECK_EQUAL(histogram.percentile(0.99), 6);
+  BOOST_CHECK_EQUAL(histogram.percentile(1), 6);
+
+  histogram.add(UINT64_MAX);
+  BOOST_CHECK_EQUAL(histogram.buckets()[Histogram::NUM_BUCKETS - 1], 1);
+  BOOST_CHECK_EQUAL(histogram.percentile(1), UINT64_MAX);
+}
+
+BOOST_AUTO_TEST_CASE(TestCounters)
+{
+  Metrics metrics;
+  for (size_t i = 0; i < Metrics::NUM_COUNTERS; ++i) {
+    BOOST_CHECK_EQUAL(metrics.get(static_cast<Metrics::Counter>(i)), 0);
+  }
+  metrics.increment(Metrics::INTERESTS_SENT);
+  metrics.increment(Metrics::INTERESTS_SENT);
+  metrics.increment(Metrics::BYTES_SERVED, 1024);
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::INTERESTS_SENT), 2);
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::BYTES_SERVED), 1024);
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::DATA_SERVED), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestLatencies)
+{
+  Metrics metrics;
+  metrics.recordRtt(Name("ucla"), time::milliseconds(10));
+  metrics.recordRtt(Name("ucla"), time::milliseconds(30));
+  metrics.recordRtt(Name("arizona"), time::microseconds(5));
+  metrics.recordWriteLatency(time::microseconds(100));
+
+  BOOST_REQUIRE_EQUAL(metrics.rtts().size(), 2);
+  const auto& ucla = metrics.rtts().at(Name("ucla"));
+  BOOST_CHECK_EQUAL(ucla.count(), 2);
+  BOOST_CHECK_EQUAL(ucla.sum(), 40000);
+  BOOST_CHECK_EQUAL(ucla.max(), 30000);
+  BOOST_CHECK_EQUAL(metrics.rtts().at(Name("arizona")).sum(), 5);
+  BOOST_CHECK_EQUAL(metrics.writeLatencies().count(), 1);
+  BOOST_CHECK_EQUAL(metrics.writeLatencies().max(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(TestDump)
+{
+  Metrics metrics;
+  metrics.increment(Metrics::TIMEOUTS, 7);
+  metrics.recordRtt(Name("ucla"), time::microseconds(12));
+
+  std::ostringstream os;
+  metrics.dump(os);
+  const auto& text = os.str();
+  BOOST_CHECK(std::string::npos != text.find("timeouts 7\n"));
+  BOOST_CHECK(std::string::npos != text.find("interests_sent 0\n"));
+  BOOST_CHECK(std::string::npos != text.find("write_latency_count 0\n"));
+  BOOST_CHECK(std::string::npos != text.find("rtt_max_us{/ucla} 12\n"));
+  BOOST_CHECK(std::string::npos != text.find("rtt_p50_us{/ucla} 12\n"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ntorrent
+} // namespace ndn
@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "boost-test.hpp"
+#include "multipath-scheduler.hpp"
+
+#include <ndn-cxx/name.hpp>
+
+#include <map>
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestMultipathScheduler)
+
+BOOST_AUTO_TEST_CASE(TestWindowsPerPrefix)
+{
+  StatsTable table;
+  table.insert(Name("isp1"));
+  table.insert(Name("isp2"));
+  MultipathScheduler scheduler;
+
+  // both prefixes are used until their windows are full
+  std::map<Name, size_t> sent;
+  for (auto it = scheduler.select(table); it != table.end(); it = scheduler.select(table)) {
+    scheduler.onSent(it->getRecordName());
+    ++sent[it->getRecordName()];
+  }
+  BOOST_CHECK_EQUAL(sent[Name("isp1")], CongestionWindow::INITIAL_WINDOW);
+  BOOST_CHECK_EQUAL(sent[Name("isp2")], CongestionWindow::INITIAL_WINDOW);
+  BOOST_CHECK_EQUAL(scheduler.pending(), 2 * CongestionWindow::INITIAL_WINDOW);
+  BOOST_CHECK_EQUAL(scheduler.window(), 2 * CongestionWindow::INITIAL_WINDOW);
+
+  // Data grows the window of its prefix only
+  scheduler.onData(Name("isp1"));
+  BOOST_CHECK_EQUAL(scheduler.pending(Name("isp1")), CongestionWindow::INITIAL_WINDOW - 1);
+  BOOST_CHECK_EQUAL(scheduler.getWindow(Name("isp1"))->size(), CongestionWindow::INITIAL_WINDOW + 1);
+  BOOST_CHECK_EQUAL(scheduler.getWindow(Name("isp2"))->size(), CongestionWindow::INITIAL_WINDOW);
+  auto it = scheduler.select(table);
+  BOOST_REQUIRE(it != table.end());
+  BOOST_CHECK_EQUAL(it->getRecordName(), Name("isp1"));
+
+  // losses shrink the window of their prefix only
+  time::steady_clock::TimePoint now;
+  scheduler.onLoss(Name("isp2"), now, time::milliseconds(100));
+  BOOST_CHECK_EQUAL(scheduler.getWindow(Name("isp2"))->size(), CongestionWindow::INITIAL_WINDOW / 2);
+  BOOST_CHECK_EQUAL(scheduler.getWindow(Name("isp1"))->size(), CongestionWindow::INITIAL_WINDOW + 1);
+  BOOST_CHECK(nullptr == scheduler.getWindow(Name("isp3")));
+}
+
+BOOST_AUTO_TEST_CASE(TestWeighting)
+{
+  StatsTable table;
+  table.insert(Name("slow"));
+  table.insert(Name("fast"));
+  auto slow = table.find(Name("slow"));
+  slow->incrementSentInterests();
+  slow->incrementReceivedData();
+  slow->recordRtt(time::milliseconds(800));
+  auto fast = table.find(Name("fast"));
+  fast->incrementSentInterests();
+  fast->incrementReceivedData();
+  fast->recordRtt(time::milliseconds(20));
+
+  MultipathScheduler scheduler;
+  auto it = scheduler.select(table);
+  BOOST_REQUIRE(it != table.end());
+  BOOST_CHECK_EQUAL(it->getRecordName(), Name("fast"));
+
+  // an excluded prefix is only selected when it is the only one
+  it = scheduler.select(table, Name("fast"));
+  BOOST_REQUIRE(it != table.end());
+  BOOST_CHECK_EQUAL(it->getRecordName(), Name("slow"));
+  table.erase(Name("slow"));
+  it = scheduler.select(table, Name("fast"));
+  BOOST_REQUIRE(it != table.end());
+  BOOST_CHECK_EQUAL(it->getRecordName(), Name("fast"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn
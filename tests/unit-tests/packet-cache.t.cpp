@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "boost-test.hpp"
+#include "packet-cache.hpp"
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+static std::vector<Data>
+makePackets(size_t count, size_t contentSize)
+{
+  KeyChain keyChain;
+  std::vector<Data> packets;
+  std::vector<uint8_t> content(contentSize, 0xAB);
+  for (size_t i = 0; i < count; ++i) {
+    Name name("/ndn/multicast/NTORRENT/foo/bar.txt");
+    name.appendSequenceNumber(0);
+    name.appendSequenceNumber(i);
+    Data d(name);
+    d.setContent(content.data(), content.size());
+    keyChain.sign(d, signingWithSha256());
+    packets.push_back(d);
+  }
+  return packets;
+}
+
+BOOST_AUTO_TEST_SUITE(TestPacketCache)
+
+BOOST_AUTO_TEST_CASE(TestFindAndCounters)
+{
+  auto packets = makePackets(3, 100);
+  PacketCache cache;
+  for (const auto& p : packets) {
+    cache.insert(p);
+  }
+  BOOST_CHECK_EQUAL(cache.size(), 3);
+
+  auto d = cache.find(packets[1].getFullName());
+  BOOST_REQUIRE(nullptr != d);
+  BOOST_CHECK(*d == packets[1]);
+  BOOST_CHECK_EQUAL(cache.hits(), 1);
+  BOOST_CHECK_EQUAL(cache.misses(), 0);
+
+  BOOST_CHECK(nullptr == cache.find(packets[1].getName()));
+  BOOST_CHECK_EQUAL(cache.misses(), 1);
+
+  // checking for a packet is not a lookup
+  BOOST_CHECK(cache.contains(packets[2].getFullName()));
+  BOOST_CHECK(!cache.contains(packets[2].getName()));
+  BOOST_CHECK_EQUAL(cache.hits(), 1);
+  BOOST_CHECK_EQUAL(cache.misses(), 1);
+
+  cache.erase(packets[1].getFullName());
+  BOOST_CHECK(nullptr == cache.find(packets[1].getFullName()));
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+
+  cache.clear();
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+  BOOST_CHECK_EQUAL(cache.bytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TestEviction)
+{
+  auto packets = makePackets(4, 100);
+  auto packetSize = packets[0].wireEncode().size();
+  // room for exactly two packets
+  PacketCache cache(2 * packetSize);
+  cache.insert(packets[0]);
+  cache.insert(packets[1]);
+  BOOST_CHECK_EQUAL(cache.bytes(), 2 * packetSize);
+
+  // touch the first packet, so the second is evicted next
+  BOOST_CHECK(nullptr != cache.find(packets[0].getFullName()));
+  cache.insert(packets[2]);
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  BOOST_CHECK(nullptr != cache.find(packets[0].getFullName()));
+  BOOST_CHECK(nullptr == cache.find(packets[1].getFullName()));
+  BOOST_CHECK(nullptr != cache.find(packets[2].getFullName()));
+
+  // packets larger than the cache are never inserted
+  PacketCache tiny(packetSize - 1);
+  tiny.insert(packets[3]);
+  BOOST_CHECK_EQUAL(tiny.size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn
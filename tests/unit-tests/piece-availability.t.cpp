@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "boost-test.hpp"
+#include "piece-availability.hpp"
+
+#include <ndn-cxx/name.hpp>
+
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestPieceAvailability)
+
+BOOST_AUTO_TEST_CASE(TestCounts)
+{
+  PieceAvailability availability;
+  BOOST_CHECK_EQUAL(availability.peers(), 0);
+  BOOST_CHECK_EQUAL(availability.count(0), 0);
+
+  availability.update(Name("isp1"), {true, true, false});
+  availability.update(Name("isp2"), {true, false, false, true});
+  BOOST_CHECK_EQUAL(availability.peers(), 2);
+  BOOST_CHECK_EQUAL(availability.count(0), 2);
+  BOOST_CHECK_EQUAL(availability.count(1), 1);
+  BOOST_CHECK_EQUAL(availability.count(2), 0);
+  BOOST_CHECK_EQUAL(availability.count(3), 1);
+  BOOST_CHECK_EQUAL(availability.count(4), 0);
+
+  // a new advertisement replaces the previous one of the peer
+  availability.update(Name("isp1"), {false, false, true});
+  BOOST_CHECK_EQUAL(availability.peers(), 2);
+  BOOST_CHECK_EQUAL(availability.count(0), 1);
+  BOOST_CHECK_EQUAL(availability.count(1), 0);
+  BOOST_CHECK_EQUAL(availability.count(2), 1);
+  BOOST_REQUIRE(nullptr != availability.find(Name("isp1")));
+  BOOST_CHECK(*availability.find(Name("isp1")) == std::vector<bool>({false, false, true}));
+
+  availability.erase(Name("isp2"));
+  BOOST_CHECK_EQUAL(availability.peers(), 1);
+  BOOST_CHECK_EQUAL(availability.count(0), 0);
+  BOOST_CHECK_EQUAL(availability.count(3), 0);
+  BOOST_CHECK(nullptr == availability.find(Name("isp2")));
+}
+
+BOOST_AUTO_TEST_CASE(TestRarestFirst)
+{
+  PieceAvailability availability;
+  availability.update(Name("isp1"), {true, true, true, false, false});
+  availability.update(Name("isp2"), {true, true, false, false, false});
+  availability.update(Name("isp3"), {true, false, false, false, false});
+
+  PieceAvailability::RandomGenerator rng(42);
+  bool firstOrder[2] = {false, false};
+  for (int i = 0; i < 64; ++i) {
+    std::vector<size_t> pieces = {0, 1, 2, 3, 4};
+    availability.rarestFirst(pieces, rng);
+    // the pieces nobody advertised come first in any order, then the rarest ones
+    BOOST_CHECK((pieces[0] == 3 && pieces[1] == 4) || (pieces[0] == 4 && pieces[1] == 3));
+    BOOST_CHECK_EQUAL(pieces[2], 2);
+    BOOST_CHECK_EQUAL(pieces[3], 1);
+    BOOST_CHECK_EQUAL(pieces[4], 0);
+    firstOrder[pieces[0] - 3] = true;
+  }
+  // ties are broken at random
+  BOOST_CHECK(firstOrder[0] && firstOrder[1]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ntorrent
+} // namespace ndn
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "boost-test.hpp"
+#include "resume-journal.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestResumeJournal)
+
+BOOST_AUTO_TEST_CASE(TestResume)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  auto journalPath = dirPath + "journal";
+  auto filePath = dirPath + "file";
+  std::ofstream(filePath) << "some data";
+  std::vector<bool> bitmap = {true, false, true};
+  {
+    ResumeJournal journal;
+    BOOST_REQUIRE(journal.open(journalPath));
+    journal.setState("file", 0, bitmap);
+    journal.recordPacket("file", 1, 4);
+    // nothing is trusted before a checkpoint
+    BOOST_CHECK(!journal.isUnchanged("file", filePath));
+    journal.checkpoint("file", filePath);
+    BOOST_CHECK(journal.isUnchanged("file", filePath));
+  }
+  {
+    ResumeJournal journal;
+    BOOST_REQUIRE(journal.open(journalPath));
+    BOOST_CHECK(journal.isUnchanged("file", filePath));
+    BOOST_CHECK(journal.state("file", 0, 3) == bitmap);
+    std::vector<bool> expected = {false, false, false, false, true, false};
+    BOOST_CHECK(journal.state("file", 1, 6) == expected);
+    BOOST_CHECK(journal.state("missing", 0, 2) == std::vector<bool>(2));
+    // recording a packet leaves the file untrusted until the next checkpoint
+    journal.recordPacket("file", 0, 1);
+    BOOST_CHECK(!journal.isUnchanged("file", filePath));
+  }
+  {
+    ResumeJournal journal;
+    BOOST_REQUIRE(journal.open(journalPath));
+    BOOST_CHECK(!journal.isUnchanged("file", filePath));
+    BOOST_CHECK(journal.state("file", 0, 3) == std::vector<bool>(3, true));
+    journal.checkpoint("file", filePath);
+    // a modified file is not trusted
+    std::ofstream(filePath, std::ofstream::app) << "more data";
+    BOOST_CHECK(!journal.isUnchanged("file", filePath));
+  }
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_CASE(TestTruncatedJournal)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  auto journalPath = dirPath + "journal";
+  {
+    ResumeJournal journal;
+    BOOST_REQUIRE(journal.open(journalPath));
+    journal.recordPacket("file", 0, 0);
+    journal.recordPacket("file", 0, 1);
+  }
+  // cut the last record in half, as a crash while appending would
+  fs::resize_file(journalPath, fs::file_size(journalPath) - 6);
+  ResumeJournal journal;
+  BOOST_REQUIRE(journal.open(journalPath));
+  std::vector<bool> expected = {true, false};
+  BOOST_CHECK(journal.state("file", 0, 2) == expected);
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "boost-test.hpp"
+#include "rtt-estimator.hpp"
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestRttEstimator)
+
+BOOST_AUTO_TEST_CASE(TestMeasurements)
+{
+  RttEstimator estimator;
+  BOOST_CHECK_EQUAL(estimator.getNumMeasurements(), 0);
+  BOOST_CHECK(estimator.getRto() == time::milliseconds(RttEstimator::INITIAL_RTO));
+
+  // SRTT = R, RTTVAR = R / 2, RTO = SRTT + 4 * RTTVAR
+  estimator.addMeasurement(time::milliseconds(100));
+  BOOST_CHECK(estimator.getSrtt() == time::milliseconds(100));
+  BOOST_CHECK(estimator.getRttVariation() == time::milliseconds(50));
+  BOOST_CHECK(estimator.getRto() == time::milliseconds(300));
+
+  // RTTVAR = 3/4 * 50 + 1/4 * 100, SRTT = 7/8 * 100 + 1/8 * 200
+  estimator.addMeasurement(time::milliseconds(200));
+  BOOST_CHECK(estimator.getRttVariation() == time::microseconds(62500));
+  BOOST_CHECK(estimator.getSrtt() == time::microseconds(112500));
+  BOOST_CHECK(estimator.getRto() == time::milliseconds(362));
+  BOOST_CHECK_EQUAL(estimator.getNumMeasurements(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(TestBounds)
+{
+  RttEstimator estimator;
+  estimator.addMeasurement(time::milliseconds(1));
+  BOOST_CHECK(estimator.getRto() == time::milliseconds(RttEstimator::MIN_RTO));
+
+  estimator.backoff();
+  BOOST_CHECK(estimator.getRto() == time::milliseconds(2 * RttEstimator::MIN_RTO));
+  for (int i = 0; i < 20; ++i) {
+    estimator.backoff();
+  }
+  BOOST_CHECK(estimator.getRto() == time::milliseconds(RttEstimator::MAX_RTO));
+
+  // a new measurement replaces the backed off timeout
+  estimator.addMeasurement(time::milliseconds(1));
+  BOOST_CHECK(estimator.getRto() == time::milliseconds(RttEstimator::MIN_RTO));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn
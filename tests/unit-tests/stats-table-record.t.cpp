@@ -119,6 +119,58 @@ BOOST_AUTO_TEST_CASE(TestCopyConstructor)
   BOOST_CHECK(record1 == record2);
 }
 
+BOOST_AUTO_TEST_CASE(TestRttAndThroughput)
+{
+  StatsTableRecord record(Name("isp1"));
+  BOOST_CHECK(record.getRecordRtt() == time::nanoseconds::zero());
+  BOOST_CHECK_EQUAL(record.getRecordThroughput(), 0);
+
+  record.recordRtt(time::milliseconds(80));
+  BOOST_CHECK(record.getRecordRtt() == time::milliseconds(80));
+  record.recordRtt(time::milliseconds(160));
+  BOOST_CHECK(record.getRecordRtt() == time::milliseconds(90));
+
+  // a sample is taken once a full interval has elapsed
+  time::steady_clock::TimePoint start = time::steady_clock::TimePoint() + time::seconds(10);
+  record.recordReceivedBytes(1000, start);
+  record.recordReceivedBytes(1000, start + time::milliseconds(500));
+  BOOST_CHECK_EQUAL(record.getRecordThroughput(), 0);
+  record.recordReceivedBytes(2000, start + time::seconds(2));
+  BOOST_CHECK_CLOSE(record.getRecordThroughput(), 2000, 0.001);
+
+  // the copy keeps the measurements
+  StatsTableRecord copy(record);
+  BOOST_CHECK(copy.getRecordRtt() == record.getRecordRtt());
+  BOOST_CHECK_EQUAL(copy.getRecordThroughput(), record.getRecordThroughput());
+}
+
+BOOST_AUTO_TEST_CASE(TestScore)
+{
+  // a fast prefix that sometimes fails beats a slow one that always answers
+  StatsTableRecord slow(Name("isp1"));
+  slow.incrementSentInterests();
+  slow.incrementReceivedData();
+  slow.recordRtt(time::milliseconds(800));
+
+  StatsTableRecord fast(Name("isp2"));
+  for (int i = 0; i < 50; ++i) {
+    fast.incrementSentInterests();
+  }
+  for (int i = 0; i < 49; ++i) {
+    fast.incrementReceivedData();
+  }
+  fast.recordRtt(time::milliseconds(20));
+  BOOST_CHECK_GT(fast.getRecordScore(), slow.getRecordScore());
+
+  // timeouts discount the score until Data arrives again
+  auto score = fast.getRecordScore();
+  fast.incrementTimeouts();
+  BOOST_CHECK_EQUAL(fast.getRecordRecentTimeouts(), 1);
+  BOOST_CHECK_LT(fast.getRecordScore(), score);
+  fast.recordRtt(time::milliseconds(20));
+  BOOST_CHECK_CLOSE(fast.getRecordRecentTimeouts(), 0.875, 0.001);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
@@ -223,6 +223,82 @@ BOOST_AUTO_TEST_CASE(TestTableSort)
   BOOST_CHECK_EQUAL(i->getRecordSuccessRate(), 0.25);
 }
 
+BOOST_AUTO_TEST_CASE(TestScoreSorting)
+{
+  StatsTable table(Name("linux15.01"));
+  table.insert(Name("isp1"));
+  table.insert(Name("isp2"));
+  table.insert(Name("isp3"));
+
+  // isp1 answers every Interest in 800 ms, isp2 answers half of them in 20 ms
+  auto entry = table.find(Name("isp1"));
+  entry->incrementSentInterests();
+  entry->incrementReceivedData();
+  entry->recordRtt(time::milliseconds(800));
+
+  entry = table.find(Name("isp2"));
+  entry->incrementSentInterests();
+  entry->incrementSentInterests();
+  entry->incrementReceivedData();
+  entry->recordRtt(time::milliseconds(20));
+
+  table.sort(StatsTable::scoreComparator());
+  auto i = table.begin();
+  BOOST_CHECK_EQUAL(i->getRecordName().toUri(), "/isp2");
+  ++i;
+  BOOST_CHECK_EQUAL(i->getRecordName().toUri(), "/isp1");
+  ++i;
+  BOOST_CHECK_EQUAL(i->getRecordName().toUri(), "/isp3");
+
+  // repeated timeouts demote isp2
+  entry = table.find(Name("isp2"));
+  for (int j = 0; j < 40; ++j) {
+    entry->incrementTimeouts();
+  }
+  table.sort(StatsTable::scoreComparator());
+  BOOST_CHECK_EQUAL(table.begin()->getRecordName().toUri(), "/isp1");
+}
+
+BOOST_AUTO_TEST_CASE(TestFindAfterReordering)
+{
+  StatsTable table(Name("linux15.01"));
+  for (int i = 0; i < 100; ++i) {
+    table.insert(Name("isp").appendNumber(i));
+  }
+  // make the later prefixes the better ones
+  for (int i = 0; i < 100; ++i) {
+    auto entry = table.find(Name("isp").appendNumber(i));
+    BOOST_REQUIRE(entry != table.end());
+    for (int j = 0; j <= i; ++j) {
+      entry->incrementSentInterests();
+      entry->incrementReceivedData();
+    }
+    entry->recordRtt(time::milliseconds(200 - i));
+  }
+  table.sort(StatsTable::scoreComparator());
+  BOOST_CHECK_EQUAL(table.begin()->getRecordName(), Name("isp").appendNumber(99));
+
+  // the prefixes are still found where they were moved
+  BOOST_CHECK(table.erase(Name("isp").appendNumber(50)));
+  BOOST_CHECK(!table.erase(Name("isp").appendNumber(50)));
+  BOOST_CHECK_EQUAL(table.size(), 99);
+  for (int i = 0; i < 100; ++i) {
+    auto entry = table.find(Name("isp").appendNumber(i));
+    if (50 == i) {
+      BOOST_CHECK(entry == table.end());
+      continue;
+    }
+    BOOST_REQUIRE(entry != table.end());
+    BOOST_CHECK_EQUAL(entry->getRecordName(), Name("isp").appendNumber(i));
+  }
+
+  // the first record of a prefix inserted twice is the one found
+  table.insert(Name("isp").appendNumber(0));
+  BOOST_CHECK(table.find(Name("isp").appendNumber(0)) != table.end() - 1);
+  table.clear();
+  BOOST_CHECK(table.find(Name("isp").appendNumber(0)) == table.end());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
@@ -458,6 +458,142 @@ BOOST_AUTO_TEST_CASE(TestTorrentFileGenerator)
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestTorrentFileGeneratorParallel)
+{
+  const struct {
+    size_t d_namesPerSegment;
+    size_t d_subManifestSize;
+    size_t d_dataPacketSize;
+  } DATA [] = {
+    {1024, 1024, 1024},
+    {2,    4,    128},
+    {1,    1,    1024},
+  };
+  enum { NUM_DATA = sizeof DATA / sizeof *DATA };
+  for (int i = 0; i < NUM_DATA; ++i) {
+    auto serial   = TorrentFile::generate("tests/testdata/foo",
+                                          DATA[i].d_namesPerSegment,
+                                          DATA[i].d_subManifestSize,
+                                          DATA[i].d_dataPacketSize,
+                                          true,
+                                          1);
+    auto parallel = TorrentFile::generate("tests/testdata/foo",
+                                          DATA[i].d_namesPerSegment,
+                                          DATA[i].d_subManifestSize,
+                                          DATA[i].d_dataPacketSize,
+                                          true,
+                                          4);
+    BOOST_CHECK(serial.first == parallel.first);
+    BOOST_REQUIRE_EQUAL(serial.second.size(), parallel.second.size());
+    for (size_t j = 0; j < serial.second.size(); ++j) {
+      BOOST_CHECK(serial.second[j].first == parallel.second[j].first);
+      BOOST_CHECK(serial.second[j].second == parallel.second[j].second);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestTorrentFileGeneratorIncremental)
+{
+  std::string dirPath = "tests/testdata/temp/foo";
+  fs::create_directories(dirPath);
+  for (auto fileName : {"bar.txt", "bar1.txt", "bar2.txt"}) {
+    fs::copy_file(fs::path("tests/testdata/foo") / fileName, fs::path(dirPath) / fileName,
+                  fs::copy_option::overwrite_if_exists);
+  }
+  auto cachePath = "tests/testdata/temp/generation-cache";
+  const size_t jobs[] = {1, 4};
+  for (auto j : jobs) {
+    fs::remove(cachePath);
+    auto expected = TorrentFile::generate(dirPath, 2, 4, 128, false, j);
+    {
+      GenerationCache cache;
+      BOOST_CHECK(!cache.open(cachePath, 4, 128));
+      auto content = TorrentFile::generate(dirPath, 2, 4, 128, false, j, &cache);
+      BOOST_CHECK(content.first == expected.first);
+      BOOST_CHECK_EQUAL(content.second.size(), 3);
+      BOOST_REQUIRE(cache.save());
+    }
+    {
+      // nothing is read again
+      GenerationCache cache;
+      BOOST_REQUIRE(cache.open(cachePath, 4, 128));
+      auto content = TorrentFile::generate(dirPath, 2, 4, 128, false, j, &cache);
+      BOOST_CHECK(content.first == expected.first);
+      BOOST_CHECK_EQUAL(content.second.size(), 0);
+      BOOST_REQUIRE(cache.save());
+    }
+    {
+      // only the changed file is read again
+      fs::ofstream(fs::path(dirPath) / "bar1.txt", std::ios::app) << "appended " << j;
+      expected = TorrentFile::generate(dirPath, 2, 4, 128, false, j);
+      GenerationCache cache;
+      BOOST_REQUIRE(cache.open(cachePath, 4, 128));
+      auto content = TorrentFile::generate(dirPath, 2, 4, 128, false, j, &cache);
+      BOOST_CHECK(content.first == expected.first);
+      BOOST_REQUIRE_EQUAL(content.second.size(), 1);
+      BOOST_CHECK(content.second[0].first == expected.second[1].first);
+    }
+  }
+  fs::remove_all("tests/testdata/temp");
+}
+
+BOOST_AUTO_TEST_CASE(TestFitPacketSizes)
+{
+  const struct {
+    size_t d_maxPacketSize;
+    size_t d_dataPacketSize;
+  } DATA [] = {
+    {MAX_NDN_PACKET_SIZE, 8192},
+    {4000,                3072},
+    {2000,                1024},
+    {1000,                 0  },
+  };
+  enum { NUM_DATA = sizeof DATA / sizeof *DATA };
+  for (int i = 0; i < NUM_DATA; ++i) {
+    auto sizes = TorrentFile::fitPacketSizes("tests/testdata/foo",
+                                             TorrentFile::PacketSizes{0, 0, 0},
+                                             DATA[i].d_maxPacketSize);
+    if (0 < DATA[i].d_dataPacketSize) {
+      BOOST_CHECK_EQUAL(sizes.dataPacketSize, DATA[i].d_dataPacketSize);
+    }
+    else {
+      // too small for an aligned size, so the largest size that fits is used
+      BOOST_CHECK_GT(sizes.dataPacketSize, 0);
+      BOOST_CHECK_LT(sizes.dataPacketSize, TorrentFile::PACKET_SIZE_ALIGNMENT);
+    }
+    BOOST_CHECK_GT(sizes.subManifestSize, 1);
+    BOOST_CHECK_GT(sizes.namesPerSegment, 1);
+    // every packet of the torrent generated with the fitted sizes fits
+    auto content = TorrentFile::generate("tests/testdata/foo",
+                                         sizes.namesPerSegment,
+                                         sizes.subManifestSize,
+                                         sizes.dataPacketSize,
+                                         true);
+    for (const auto& segment : content.first) {
+      BOOST_CHECK_LE(segment.wireEncode().size(), DATA[i].d_maxPacketSize);
+    }
+    for (const auto& file : content.second) {
+      for (const auto& manifest : file.first) {
+        BOOST_CHECK_LE(manifest.wireEncode().size(), DATA[i].d_maxPacketSize);
+      }
+      for (const auto& packet : file.second) {
+        BOOST_CHECK_LE(packet.wireEncode().size(), DATA[i].d_maxPacketSize);
+      }
+    }
+  }
+  // the requested sizes are kept
+  auto sizes = TorrentFile::fitPacketSizes("tests/testdata/foo",
+                                           TorrentFile::PacketSizes{2, 0, 128});
+  BOOST_CHECK_EQUAL(sizes.namesPerSegment, 2);
+  BOOST_CHECK_EQUAL(sizes.dataPacketSize, 128);
+  BOOST_CHECK_GT(sizes.subManifestSize, 1);
+
+  BOOST_CHECK_THROW(TorrentFile::fitPacketSizes("tests/testdata/foo-fake"), TorrentFile::Error);
+  BOOST_CHECK_THROW(TorrentFile::fitPacketSizes("tests/testdata/foo",
+                                                TorrentFile::PacketSizes{0, 0, 0}, 64),
+                    TorrentFile::Error);
+}
+
 } // namespace tests
 
 } // namespace ntorrent
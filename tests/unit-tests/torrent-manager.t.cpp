@@ -28,7 +28,11 @@
 #include "unit-test-time-fixture.hpp"
 #include "util/io-util.hpp"
 
+#include <algorithm>
+#include <future>
 #include <set>
+#include <sstream>
+#include <unordered_map>
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
@@ -51,13 +55,26 @@ class TestTorrentManager : public TorrentManager {
 public:
   TestTorrentManager(const ndn::Name&                 torrentFileName,
                      const std::string&               filePath,
-                     std::shared_ptr<DummyClientFace> face)
-  : TorrentManager(torrentFileName, filePath, false, face)
+                     std::shared_ptr<DummyClientFace> face,
+                     std::shared_ptr<ThreadPool>      seedWorkers = nullptr,
+                     const std::string&               appDataPath = "")
+  : TorrentManager(torrentFileName, filePath, false,
+                   Resources{face, nullptr, nullptr, nullptr, seedWorkers,
+                             time::milliseconds::zero(), appDataPath})
   , m_face(face)
   {
     m_keyChain = make_shared<KeyChain>();
   }
 
+  TestTorrentManager(const ndn::Name&   torrentFileName,
+                     const std::string& filePath,
+                     const Resources&   resources)
+  : TorrentManager(torrentFileName, filePath, false, resources)
+  , m_face(std::dynamic_pointer_cast<DummyClientFace>(resources.face))
+  {
+    m_keyChain = make_shared<KeyChain>();
+  }
+
   std::vector<TorrentFile> torrentSegments() const {
     return m_torrentSegments;
   }
@@ -66,12 +83,19 @@ public:
     return m_fileManifests;
   }
 
+  size_t evictedFileManifests() const {
+    return m_evictedManifests.size();
+  }
+
   void pushTorrentSegment(const TorrentFile& t) {
     m_torrentSegments.push_back(t);
+    indexTorrentSegments(m_torrentSegments.size() - 1);
   }
 
   void pushFileManifestSegment(const FileManifest& m) {
     m_fileManifests.push_back(m);
+    m_fileStates.emplace_back();
+    indexFileManifests(m_fileManifests.size() - 1);
   }
 
   shared_ptr<Name> findTorrentFileSegmentToDownload() {
@@ -83,19 +107,24 @@ public:
   }
 
   std::vector<bool> fileState(const ndn::Name& manifestName) {
-    return m_fileStates[manifestName];
+    auto fileState = findFileState(manifestName.getPrefix(-1));
+    return nullptr == fileState ? std::vector<bool>() : fileState->toBitmap();
   }
 
   void setFileState(const ndn::Name manifestName,
                     const std::vector<bool>& stateVec) {
 
-    m_fileStates[manifestName] = stateVec;
+    *findFileState(manifestName.getPrefix(-1)) = FileState(stateVec);
   }
 
   bool writeData(const Data& data) {
     return TorrentManager::writeData(data);
   }
 
+  void drainWrites() {
+    TorrentManager::drainWrites();
+  }
+
   bool writeTorrentSegment(const TorrentFile& segment, const std::string& path) {
     return TorrentManager::writeTorrentSegment(segment, path);
   }
@@ -522,6 +551,232 @@ BOOST_AUTO_TEST_CASE(TestDownloadingFileManifests)
   fs::remove_all(".appdata");
 }
 
+BOOST_AUTO_TEST_CASE(TestPipelinedFileManifests)
+{
+  vector<FileManifest> manifests;
+  std::string filePath = ".appdata/foo/";
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo", 1, 10, 10, false);
+    auto temp1      = temp.second;
+    temp1.pop_back(); // remove the manifests for the last file
+    for (const auto& ms : temp1) {
+      for (const auto& m : ms.first) {
+        manifests.push_back(m);
+      }
+    }
+  }
+
+  TestTorrentManager manager("/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=521110d7a60e317e1f36029a414f0d98318f26553720ed50a26479fe4bf982b7",
+                             filePath, face);
+
+  manager.Initialize();
+  manager.setManifestPrefetch(2);
+
+  advanceClocks(time::milliseconds(1), 10);
+  manager.sendRoutablePrefixResponse();
+
+  // the second file has many segments, the first of which is manifests[1]
+  std::vector<Name> packetNames;
+  manager.download_file_manifest(manifests[1].getFullName(), filePath + "manifests",
+                                 [](const std::vector<ndn::Name>& vec) {
+                                   BOOST_FAIL("Unexpected completion");
+                                 },
+                                 [](const ndn::Name& name, const std::string& reason) {
+                                   BOOST_FAIL("Unexpected failure");
+                                 },
+                                 [&packetNames] (const std::vector<ndn::Name>& vec) {
+                                   packetNames.insert(packetNames.end(), vec.begin(), vec.end());
+                                 });
+
+  advanceClocks(time::milliseconds(1), 40);
+  face->receive(dynamic_cast<Data&>(manifests[1]));
+  advanceClocks(time::milliseconds(1), 10);
+
+  // the next segment is requested by its full name, the following ones by their number
+  auto isSent = [this] (const Name& name) {
+    return std::any_of(face->sentInterests.begin(), face->sentInterests.end(),
+                       [&name] (const Interest& i) { return i.getName() == name; });
+  };
+  auto prefix = FileManifest::manifestPrefix(manifests[1].getFullName());
+  BOOST_CHECK(isSent(manifests[2].getFullName()));
+  BOOST_CHECK(isSent(Name(prefix).appendSequenceNumber(2)));
+  BOOST_CHECK(isSent(Name(prefix).appendSequenceNumber(3)));
+  BOOST_CHECK(!isSent(Name(prefix).appendSequenceNumber(4)));
+  BOOST_CHECK_EQUAL(packetNames.size(), manifests[1].catalog().size());
+
+  // segments received ahead of the chain are held until their digest is confirmed
+  face->receive(dynamic_cast<Data&>(manifests[4]));
+  face->receive(dynamic_cast<Data&>(manifests[3]));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK_EQUAL(packetNames.size(), manifests[1].catalog().size());
+
+  face->receive(dynamic_cast<Data&>(manifests[2]));
+  advanceClocks(time::milliseconds(1), 10);
+  std::vector<Name> expected;
+  for (size_t i = 1; i <= 4; ++i) {
+    expected.insert(expected.end(), manifests[i].catalog().begin(), manifests[i].catalog().end());
+  }
+  BOOST_CHECK(packetNames == expected);
+  BOOST_REQUIRE(manager.findManifestSegmentToDownload(manifests[1].getFullName()) != nullptr);
+  BOOST_CHECK_EQUAL(*manager.findManifestSegmentToDownload(manifests[1].getFullName()),
+                    manifests[5].getFullName());
+  BOOST_CHECK(isSent(Name(prefix).appendSequenceNumber(6)));
+
+  fs::remove_all(filePath);
+  fs::remove_all(".appdata");
+}
+
+BOOST_AUTO_TEST_CASE(TestPrefetchedFileManifestsFromSeed)
+{
+  vector<FileManifest> manifests;
+  vector<TorrentFile>  torrentSegments;
+  std::string dirPath = ".appdata/foo/";
+  Name initialSegmentName = "/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=24ea5e5e3af6a548cc54c0d5b3573ecb18e247f1567a0d586c1d7c131b75181d";
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo", 1, 128, 128, false);
+    torrentSegments = temp.first;
+    for (const auto& ms : temp.second) {
+      manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+    }
+  }
+  // the seed has the whole torrent on disk
+  auto torrentPath = dirPath + "torrent_files/";
+  boost::filesystem::create_directories(torrentPath);
+  auto fileNum = 0;
+  for (const auto& t : torrentSegments) {
+    fileNum++;
+    io::save(t, torrentPath + to_string(fileNum));
+  }
+  auto manifestPath = dirPath + "manifests/";
+  boost::filesystem::create_directory(manifestPath);
+  for (const auto& m : manifests) {
+    fs::path filename = manifestPath + m.file_name() + to_string(m.submanifest_number());
+    boost::filesystem::create_directory(filename.parent_path());
+    io::save(m, filename.string());
+  }
+  TestTorrentManager seed(initialSegmentName, "tests/testdata/", face);
+  seed.Initialize();
+
+  // the first segment of a file made of three of them
+  auto first_it = std::find_if(manifests.begin(), manifests.end(),
+                               [](const FileManifest& m) { return nullptr != m.submanifest_ptr(); });
+  BOOST_REQUIRE(manifests.end() - first_it >= 3);
+  BOOST_REQUIRE(nullptr == (first_it + 2)->submanifest_ptr());
+  auto prefix = FileManifest::manifestPrefix(first_it->getFullName());
+
+  auto leecherFace = make_shared<DummyClientFace>(io, DummyClientFace::Options{ true, true });
+  TestTorrentManager leecher(initialSegmentName, ".leecher/data/", leecherFace, nullptr,
+                             ".leecher");
+  leecher.Initialize();
+  leecher.setManifestPrefetch(4);
+  advanceClocks(time::milliseconds(1), 10);
+  leecher.sendRoutablePrefixResponse();
+
+  std::vector<Name> packetNames;
+  bool complete = false;
+  leecher.download_file_manifest(first_it->getFullName(), ".leecher/foo/manifests",
+                                 [&] (const std::vector<ndn::Name>& vec) {
+                                   packetNames = vec;
+                                   complete = true;
+                                 },
+                                 [](const ndn::Name& name, const std::string& reason) {
+                                   BOOST_FAIL("Unexpected failure");
+                                 });
+
+  // relay the Interests for the manifest to the seed and its answers back
+  size_t nInterests = 0, nData = 0;
+  for (int i = 0; i < 10; ++i) {
+    advanceClocks(time::milliseconds(1), 10);
+    for (; nInterests < leecherFace->sentInterests.size(); ++nInterests) {
+      Interest interest = leecherFace->sentInterests[nInterests];
+      if (prefix.isPrefixOf(interest.getName())) {
+        face->receive(interest);
+      }
+    }
+    advanceClocks(time::milliseconds(1), 10);
+    for (; nData < face->sentData.size(); ++nData) {
+      Data data = face->sentData[nData];
+      leecherFace->receive(data);
+    }
+  }
+  BOOST_REQUIRE(complete);
+  std::vector<Name> expected;
+  for (auto it = first_it; it != first_it + 3; ++it) {
+    expected.insert(expected.end(), it->catalog().begin(), it->catalog().end());
+  }
+  BOOST_CHECK(packetNames == expected);
+
+  // the third segment was answered to its speculative Interest
+  auto isSent = [&leecherFace] (const Name& name) {
+    return std::any_of(leecherFace->sentInterests.begin(), leecherFace->sentInterests.end(),
+                       [&name] (const Interest& i) { return i.getName() == name; });
+  };
+  BOOST_CHECK(isSent(Name(prefix).appendSequenceNumber(2)));
+  BOOST_CHECK(!isSent((first_it + 2)->getFullName()));
+  BOOST_CHECK(std::any_of(face->sentData.begin(), face->sentData.end(),
+                          [&] (const Data& d) {
+                            return d.getFullName() == (first_it + 2)->getFullName();
+                          }));
+
+  // the segments past the last one are not taken as losses once they time out
+  BOOST_CHECK(isSent(Name(prefix).appendSequenceNumber(3)));
+  advanceClocks(time::milliseconds(100), 100);
+  BOOST_CHECK_EQUAL(leecher.metrics().get(Metrics::TIMEOUTS), 0);
+
+  fs::remove_all(".leecher");
+  fs::remove_all(".appdata");
+}
+
+BOOST_AUTO_TEST_CASE(TestTimedOutPrefetchesReleaseWindow)
+{
+  vector<FileManifest> manifests;
+  std::string filePath = ".appdata/foo/";
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo", 1, 10, 10, false);
+    for (const auto& ms : temp.second) {
+      manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+    }
+  }
+
+  TestTorrentManager manager("/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=521110d7a60e317e1f36029a414f0d98318f26553720ed50a26479fe4bf982b7",
+                             filePath, face);
+  manager.Initialize();
+  manager.setManifestPrefetch(64);
+  advanceClocks(time::milliseconds(1), 10);
+  manager.sendRoutablePrefixResponse();
+
+  size_t numFailed = 0;
+  manager.download_file_manifest(manifests[1].getFullName(), filePath + "manifests",
+                                 [](const std::vector<ndn::Name>& vec) {
+                                   BOOST_FAIL("Unexpected completion");
+                                 },
+                                 [&numFailed] (const ndn::Name& name, const std::string& reason) {
+                                   ++numFailed;
+                                 },
+                                 [] (const std::vector<ndn::Name>& vec) {});
+  advanceClocks(time::milliseconds(1), 10);
+  face->receive(dynamic_cast<Data&>(manifests[1]));
+
+  // none of the next segments is answered, so all the prefetched ones time out
+  advanceClocks(time::milliseconds(100), 1200);
+  BOOST_CHECK_EQUAL(numFailed, 1);
+  BOOST_CHECK(face->sentInterests.size() > 64);
+  BOOST_CHECK_EQUAL(manager.getScheduler().pending(), 0);
+
+  // the windows still have room for the next Interests
+  auto packetName = manifests[1].catalog()[0];
+  manager.download_data_packet(packetName,
+                               [](const ndn::Name& name) {},
+                               [](const ndn::Name& name, const std::string& reason) {});
+  auto numSent = face->sentInterests.size();
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK(std::any_of(face->sentInterests.begin() + numSent, face->sentInterests.end(),
+                          [&packetName] (const Interest& i) { return i.getName() == packetName; }));
+
+  fs::remove_all(filePath);
+  fs::remove_all(".appdata");
+}
+
 BOOST_AUTO_TEST_CASE(TestDownloadingDataPackets)
 {
   std::string filePath = ".appdata/foo/";
@@ -886,106 +1141,675 @@ BOOST_AUTO_TEST_CASE(TestDataAlreadyDownloaded)
   BOOST_CHECK(manager.hasDataPacket(p2));
 }
 
-BOOST_AUTO_TEST_CASE(CheckSeedComplete)
+BOOST_AUTO_TEST_CASE(TestEndgame)
 {
-   const struct {
-       const char    *d_directoryPath;
-       const char    *d_initialSegmentName;
-       size_t         d_namesPerSegment;
-       size_t         d_subManifestSize;
-       size_t         d_dataPacketSize;
-   } DATA [] = {
-      {"tests/testdata/foo", "/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=9e0410fa477309b40a4ef9cb2bebe70ed2e9fa2defcb584979d768b3f6ced981", 1024, 1024, 1024},
-      // {"tests/testdata/foo", "/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=5351d424c7893158da35707258635d885725be0aa34321cf2e557afc2b785a76", 128,  128, 128},
-      // {"tests/testdata/foo", "/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=24ea5e5e3af6a548cc54c0d5b3573ecb18e247f1567a0d586c1d7c131b75181d",   1,  128, 128},
-   };
-   enum { NUM_DATA = sizeof DATA / sizeof *DATA };
-   for (int i = 0; i < NUM_DATA; ++i) {
-     auto directoryPath      = DATA[i].d_directoryPath;
-     Name initialSegmentName = DATA[i].d_initialSegmentName;
-     auto namesPerSegment    = DATA[i].d_namesPerSegment;
-     auto dataPacketSize     = DATA[i].d_dataPacketSize;
-     auto subManifestSize    = DATA[i].d_subManifestSize;
+  vector<FileManifest> manifests;
+  vector<TorrentFile>  torrentSegments;
+  // for each file, the data packets
+  std::vector<vector<Data>> fileData;
+  std::string filePath = "tests/testdata/temp";
+  // get torrent files and manifests
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo",
+                                      1024,
+                                      2048,
+                                      8192,
+                                      true);
+    torrentSegments = temp.first;
+    auto temp1      = temp.second;
+    for (const auto& ms : temp1) {
+      manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+      fileData.push_back(ms.second);
+    }
+  }
+  // write the torrent segments and manifests to disk
+  std::string dirPath = ".appdata/foo/";
+  boost::filesystem::create_directories(dirPath);
+  std::string torrentPath = dirPath + "torrent_files/";
+  boost::filesystem::create_directories(torrentPath);
+  auto fileNum = 0;
+  for (const auto& t : torrentSegments) {
+    fileNum++;
+    auto filename = torrentPath + to_string(fileNum);
+    io::save(t, filename);
+  }
 
-     vector<FileManifest> manifests;
-     vector<TorrentFile> torrentSegments;
-     std::string filePath = "tests/testdata/";
-     std::vector<vector<Data>> fileData;
-     // get torrent files and manifests
-     {
-      auto temp = TorrentFile::generate(directoryPath,
-                                        namesPerSegment,
-                                        subManifestSize,
-                                        dataPacketSize,
-                                        true);
-      torrentSegments = temp.first;
-      auto temp1      = temp.second;
-      for (const auto& ms : temp1) {
-        manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
-        fileData.push_back(ms.second);
-      }
-     }
-     // write the torrent segments  and manifests to disk
-     std::string dirPath = ".appdata/foo/";
-     boost::filesystem::create_directories(dirPath);
-     std::string torrentPath = dirPath + "torrent_files/";
-     boost::filesystem::create_directory(torrentPath);
-     auto fileNum = 0;
-     for (const auto& t : torrentSegments) {
-      fileNum++;
-      auto filename = torrentPath + to_string(fileNum);
-      io::save(t, filename);
-     }
-     auto manifestPath = dirPath + "manifests/";
-     boost::filesystem::create_directory(manifestPath);
-     for (const auto& m : manifests) {
-      fs::path filename = manifestPath + m.file_name() + "/" + to_string(m.submanifest_number());
-      boost::filesystem::create_directories(filename.parent_path());
-      io::save(m, filename.string());
-     }
-     // Initialize and verify
-     TestTorrentManager manager(initialSegmentName,
-                                filePath,
-                                face);
+  auto manifestPath = dirPath + "manifests/";
+  boost::filesystem::create_directory(manifestPath);
+  size_t numPackets = 0;
+  for (const auto& m : manifests) {
+    fs::path filename = manifestPath + m.file_name() + to_string(m.submanifest_number());
+    boost::filesystem::create_directory(filename.parent_path());
+    io::save(m, filename.string());
+    numPackets += m.catalog().size();
+  }
+  TestTorrentManager manager("/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=6114e56874fc01bf8f9c40fa652741a895eb922372f1baf039ccea64dacd2152",
+                             filePath,
+                             face);
 
-     manager.Initialize();
+  manager.Initialize();
+  BOOST_CHECK_EQUAL(manager.missingDataPackets(), numPackets);
+  BOOST_CHECK(!manager.inEndgame());
 
-     advanceClocks(time::milliseconds(1), 10);
-     manager.sendRoutablePrefixResponse();
+  advanceClocks(time::milliseconds(1), 10);
+  manager.sendRoutablePrefixResponse();
 
-     size_t nData = 0;
-     BOOST_CHECK_EQUAL(0, face->sentData.size());
-     // request all the torrent segments
-     for (const auto& t : torrentSegments) {
-      Interest interest(t.getFullName(), time::milliseconds(50));
-      face->expressInterest(interest,
-                            [&t](const Interest& i, const Data& d) {
-                              TorrentFile t1(d.wireEncode());
-                              BOOST_CHECK(t  == d);
-                              BOOST_CHECK(t1 == t);
-                            },
-                            bind([] {
-                              BOOST_FAIL("Unexpected Nack");
-                            }),
-                            bind([] {
-                              BOOST_FAIL("Unexpected timeout");
-                            }));
-      advanceClocks(time::milliseconds(1), 40);
-      face->receive(interest);
-      manager.processEvents(time::milliseconds(-1));
-      // check that one piece of data is sent, and it is what was expected
-      BOOST_CHECK_EQUAL(++nData, face->sentData.size());
-      face->receive(face->sentData[nData - 1]);
-     }
-     // request all the file manifests
-     for (const auto& m : manifests) {
-       Interest interest(m.getFullName(), time::milliseconds(50));
-       face->expressInterest(interest,
-                             [&m](const Interest& i, const Data& d) {
-                               FileManifest m1(d.wireEncode());
-                               BOOST_CHECK(m == d);
-                               BOOST_CHECK(m1 == m);
-                             },
+  // we have all the manifests and few packets are missing
+  BOOST_REQUIRE(numPackets <= TestTorrentManager::ENDGAME_THRESHOLD);
+  int received = 0;
+  const auto& packet = fileData[0][0];
+  manager.download_data_packet(packet.getFullName(),
+                               [&received, &packet] (const Name& name) {
+                                 BOOST_CHECK_EQUAL(name, packet.getName());
+                                 ++received;
+                               },
+                               [](const Name& name, const std::string& reason) {
+                                 BOOST_FAIL("Unexpected failure");
+                               });
+  BOOST_CHECK(manager.inEndgame());
+
+  advanceClocks(time::milliseconds(1), 40);
+  face->receive(packet);
+  advanceClocks(time::milliseconds(1), 10);
+  manager.drainWrites();
+  BOOST_CHECK_EQUAL(received, 1);
+  BOOST_CHECK_EQUAL(manager.missingDataPackets(), numPackets - 1);
+
+  // the request is satisfied by the first Data only
+  face->receive(packet);
+  advanceClocks(time::milliseconds(1), 10);
+  manager.drainWrites();
+  BOOST_CHECK_EQUAL(received, 1);
+
+  fs::remove_all(filePath);
+  fs::remove_all(".appdata");
+}
+
+BOOST_AUTO_TEST_CASE(TestDownloadMissingDataPackets)
+{
+  vector<FileManifest> manifests;
+  vector<TorrentFile>  torrentSegments;
+  // the data packets by full name
+  std::unordered_map<Name, Data> packets;
+  std::string filePath = "tests/testdata/temp";
+  // get torrent files and manifests
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo",
+                                      1024,
+                                      2048,
+                                      8192,
+                                      true);
+    torrentSegments = temp.first;
+    for (const auto& ms : temp.second) {
+      manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+      for (const auto& d : ms.second) {
+        packets.insert({d.getFullName(), d});
+      }
+    }
+  }
+  // write the torrent segments and manifests to disk
+  std::string dirPath = ".appdata/foo/";
+  boost::filesystem::create_directories(dirPath);
+  std::string torrentPath = dirPath + "torrent_files/";
+  boost::filesystem::create_directories(torrentPath);
+  auto fileNum = 0;
+  for (const auto& t : torrentSegments) {
+    fileNum++;
+    auto filename = torrentPath + to_string(fileNum);
+    io::save(t, filename);
+  }
+
+  auto manifestPath = dirPath + "manifests/";
+  boost::filesystem::create_directory(manifestPath);
+  for (const auto& m : manifests) {
+    fs::path filename = manifestPath + m.file_name() + to_string(m.submanifest_number());
+    boost::filesystem::create_directory(filename.parent_path());
+    io::save(m, filename.string());
+  }
+  TestTorrentManager manager("/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=6114e56874fc01bf8f9c40fa652741a895eb922372f1baf039ccea64dacd2152",
+                             filePath,
+                             face);
+
+  manager.Initialize();
+  BOOST_REQUIRE_EQUAL(manager.missingDataPackets(), packets.size());
+
+  // the cursor visits every missing packet once
+  size_t numMissing = 0;
+  for (TorrentManager::PacketHandle p(0, 0);
+       manager.findNextMissingDataPacket(p);
+       ++p.second) {
+    BOOST_CHECK(packets.end() != packets.find(manager.packetName(p)));
+    ++numMissing;
+  }
+  BOOST_CHECK_EQUAL(numMissing, packets.size());
+
+  advanceClocks(time::milliseconds(1), 10);
+  manager.sendRoutablePrefixResponse();
+
+  std::set<Name> received;
+  manager.download_missing_data_packets([&received] (const Name& name) {
+                                          received.insert(name);
+                                        },
+                                        [](const Name& name, const std::string& reason) {
+                                          BOOST_FAIL("Unexpected failure");
+                                        });
+  // answer the Interests as they are sent, which the window allows a few at a time
+  size_t numSent = 0;
+  for (int i = 0; i < 100 && received.size() < packets.size(); ++i) {
+    advanceClocks(time::milliseconds(1), 10);
+    auto sent = face->sentInterests;
+    for (; numSent < sent.size(); ++numSent) {
+      auto it = packets.find(sent[numSent].getName());
+      if (packets.end() != it) {
+        face->receive(it->second);
+      }
+    }
+    // the packets are reported once they are written
+    manager.drainWrites();
+  }
+  BOOST_CHECK_EQUAL(received.size(), packets.size());
+  BOOST_CHECK_EQUAL(manager.missingDataPackets(), 0);
+
+  fs::remove_all(filePath);
+  fs::remove_all(".appdata");
+}
+
+BOOST_AUTO_TEST_CASE(TestDownloadMissingDataPacketsFromScratch)
+{
+  vector<FileManifest> manifests;
+  vector<TorrentFile>  torrentSegments;
+  // the manifest segments by name and by full name, and the data packets by full name
+  std::unordered_map<Name, Data> segments;
+  std::unordered_map<Name, Data> packets;
+  std::string filePath = "tests/testdata/temp";
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo", 1024, 128, 128, true);
+    torrentSegments = temp.first;
+    for (const auto& ms : temp.second) {
+      manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+      for (const auto& d : ms.second) {
+        packets.insert({d.getFullName(), d});
+      }
+    }
+  }
+  for (const auto& m : manifests) {
+    segments.insert({m.getName(), m});
+    segments.insert({m.getFullName(), m});
+  }
+  BOOST_REQUIRE_GT(manifests.size(), 3);
+
+  // only the torrent file is on disk
+  std::string torrentPath = ".appdata/foo/torrent_files/";
+  boost::filesystem::create_directories(torrentPath);
+  auto fileNum = 0;
+  for (const auto& t : torrentSegments) {
+    fileNum++;
+    io::save(t, torrentPath + to_string(fileNum));
+  }
+  TestTorrentManager manager(torrentSegments[0].getFullName(), filePath, face);
+  manager.Initialize();
+  BOOST_REQUIRE_EQUAL(manager.missingDataPackets(), 0);
+
+  advanceClocks(time::milliseconds(1), 10);
+  manager.sendRoutablePrefixResponse();
+
+  // the packets of the segments are produced as the segments arrive
+  std::set<Name> received;
+  manager.download_missing_data_packets([&received] (const Name& name) {
+                                          received.insert(name);
+                                        },
+                                        [](const Name& name, const std::string& reason) {
+                                          BOOST_FAIL("Unexpected failure");
+                                        });
+  std::vector<Name> manifestNames;
+  manager.findFileManifestsToDownload(manifestNames);
+  for (const auto& manifestName : manifestNames) {
+    manager.download_file_manifest(manifestName, ".appdata/foo/manifests",
+                                   [](const std::vector<ndn::Name>& vec) {},
+                                   [](const ndn::Name& name, const std::string& reason) {
+                                     BOOST_FAIL("Unexpected failure");
+                                   },
+                                   [](const std::vector<ndn::Name>& vec) {});
+  }
+
+  size_t numSent = 0;
+  for (int i = 0; i < 500 && received.size() < packets.size(); ++i) {
+    advanceClocks(time::milliseconds(1), 10);
+    auto sent = face->sentInterests;
+    for (; numSent < sent.size(); ++numSent) {
+      auto segment_it = segments.find(sent[numSent].getName());
+      auto packet_it = packets.find(sent[numSent].getName());
+      if (segments.end() != segment_it) {
+        face->receive(segment_it->second);
+      }
+      else if (packets.end() != packet_it) {
+        face->receive(packet_it->second);
+      }
+    }
+    manager.drainWrites();
+  }
+  BOOST_CHECK_EQUAL(manager.fileManifests().size(), manifests.size());
+  BOOST_CHECK_EQUAL(received.size(), packets.size());
+  BOOST_CHECK_EQUAL(manager.missingDataPackets(), 0);
+
+  fs::remove_all(filePath);
+  fs::remove_all(".appdata");
+}
+
+BOOST_AUTO_TEST_CASE(TestUnwritableFile)
+{
+  vector<FileManifest> manifests;
+  vector<TorrentFile>  torrentSegments;
+  // the data packets by full name
+  std::unordered_map<Name, Data> packets;
+  std::string filePath = "tests/testdata/temp";
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo", 1024, 2048, 1024, true);
+    torrentSegments = temp.first;
+    for (const auto& ms : temp.second) {
+      manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+      for (const auto& d : ms.second) {
+        packets.insert({d.getFullName(), d});
+      }
+    }
+  }
+  std::string dirPath = ".appdata/foo/";
+  std::string torrentPath = dirPath + "torrent_files/";
+  boost::filesystem::create_directories(torrentPath);
+  auto fileNum = 0;
+  for (const auto& t : torrentSegments) {
+    fileNum++;
+    io::save(t, torrentPath + to_string(fileNum));
+  }
+  auto manifestPath = dirPath + "manifests/";
+  boost::filesystem::create_directory(manifestPath);
+  // the packets of bar1.txt are named after its manifests
+  std::set<Name> unwritableManifests;
+  for (const auto& m : manifests) {
+    fs::path filename = manifestPath + m.file_name() + to_string(m.submanifest_number());
+    boost::filesystem::create_directory(filename.parent_path());
+    io::save(m, filename.string());
+    if ("/foo/bar1.txt" == m.file_name()) {
+      unwritableManifests.insert(m.getName());
+    }
+  }
+  BOOST_REQUIRE(!unwritableManifests.empty());
+  size_t numUnwritable = 0;
+  for (const auto& p : packets) {
+    numUnwritable += unwritableManifests.count(p.second.getName().getPrefix(-1));
+  }
+  BOOST_REQUIRE_LT(numUnwritable, packets.size());
+
+  TestTorrentManager manager(torrentSegments[0].getFullName(), filePath, face);
+  manager.Initialize();
+  BOOST_REQUIRE_EQUAL(manager.missingDataPackets(), packets.size());
+  // no space can be reserved in a directory standing where the file should be
+  fs::create_directories(filePath + "/foo/bar1.txt");
+
+  advanceClocks(time::milliseconds(1), 10);
+  manager.sendRoutablePrefixResponse();
+
+  std::set<Name> received;
+  std::set<Name> failed;
+  manager.download_missing_data_packets([&received] (const Name& name) {
+                                          received.insert(name);
+                                        },
+                                        [&failed] (const Name& name, const std::string& reason) {
+                                          failed.insert(name);
+                                        });
+  size_t numSent = 0;
+  size_t numUnwritableSent = 0;
+  for (int i = 0; i < 100 && received.size() < packets.size() - numUnwritable; ++i) {
+    advanceClocks(time::milliseconds(1), 10);
+    auto sent = face->sentInterests;
+    for (; numSent < sent.size(); ++numSent) {
+      auto it = packets.find(sent[numSent].getName());
+      if (packets.end() != it) {
+        numUnwritableSent += unwritableManifests.count(it->second.getName().getPrefix(-1));
+        face->receive(it->second);
+      }
+    }
+    manager.drainWrites();
+  }
+  advanceClocks(time::milliseconds(1), 10);
+  manager.drainWrites();
+
+  // the other files are downloaded, while the packets of bar1.txt fail and stop being requested
+  BOOST_CHECK_EQUAL(received.size(), packets.size() - numUnwritable);
+  BOOST_CHECK(!failed.empty());
+  for (const auto& name : failed) {
+    BOOST_CHECK_EQUAL(unwritableManifests.count(name.getPrefix(-1)), 1);
+  }
+  for (const auto& name : received) {
+    BOOST_CHECK_EQUAL(unwritableManifests.count(name.getPrefix(-1)), 0);
+  }
+  BOOST_CHECK_LT(numUnwritableSent, numUnwritable);
+  BOOST_CHECK_EQUAL(manager.missingDataPackets(), numUnwritable);
+
+  fs::remove_all(filePath);
+  fs::remove_all(".appdata");
+}
+
+BOOST_AUTO_TEST_CASE(TestNackAccounting)
+{
+  vector<FileManifest> manifests;
+  std::string filePath = ".appdata/foo/";
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo", 1, 10, 10, false);
+    for (const auto& ms : temp.second) {
+      manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+    }
+  }
+
+  TestTorrentManager manager("/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=521110d7a60e317e1f36029a414f0d98318f26553720ed50a26479fe4bf982b7",
+                             filePath, face);
+  manager.Initialize();
+  advanceClocks(time::milliseconds(1), 10);
+  manager.sendRoutablePrefixResponse();
+
+  // two Interests are sent through the only routable prefix
+  std::vector<Name> failed;
+  const auto& catalog = manifests[1].catalog();
+  manager.download_data_packets({ catalog[0], catalog[1] },
+                                [](const ndn::Name& name) {
+                                  BOOST_FAIL("Unexpected data");
+                                },
+                                [&failed] (const ndn::Name& name, const std::string& reason) {
+                                  failed.push_back(name);
+                                });
+  advanceClocks(time::milliseconds(1), 10);
+  auto sent_it = std::find_if(face->sentInterests.begin(), face->sentInterests.end(),
+                              [&catalog] (const Interest& i) { return i.getName() == catalog[0]; });
+  BOOST_REQUIRE(face->sentInterests.end() != sent_it);
+  BOOST_REQUIRE_EQUAL(manager.getScheduler().pending(), 2);
+
+  // the Nacked Interest is resent through the same prefix, holding a single slot of its window,
+  // and is not taken as a timeout
+  auto numSent = face->sentInterests.size();
+  lp::Nack nack(*sent_it);
+  nack.setReason(lp::NackReason::NO_ROUTE);
+  face->receive(nack);
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK(failed.empty());
+  BOOST_CHECK(std::any_of(face->sentInterests.begin() + numSent, face->sentInterests.end(),
+                          [&catalog] (const Interest& i) { return i.getName() == catalog[0]; }));
+  BOOST_CHECK_EQUAL(manager.getScheduler().pending(), 2);
+  BOOST_CHECK_EQUAL(manager.metrics().get(Metrics::NACKS_RECEIVED), 1);
+  BOOST_CHECK_EQUAL(manager.metrics().get(Metrics::TIMEOUTS), 0);
+
+  fs::remove_all(filePath);
+  fs::remove_all(".appdata");
+}
+
+BOOST_AUTO_TEST_CASE(TestMaxPendingInterests)
+{
+  vector<FileManifest> manifests;
+  vector<TorrentFile>  torrentSegments;
+  // the data packets by full name
+  std::unordered_map<Name, Data> packets;
+  std::string filePath = "tests/testdata/temp";
+  // get torrent files and manifests
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo",
+                                      1024,
+                                      2048,
+                                      8192,
+                                      true);
+    torrentSegments = temp.first;
+    for (const auto& ms : temp.second) {
+      manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+      for (const auto& d : ms.second) {
+        packets.insert({d.getFullName(), d});
+      }
+    }
+  }
+  // write the torrent segments and manifests to disk
+  std::string dirPath = ".appdata/foo/";
+  boost::filesystem::create_directories(dirPath);
+  std::string torrentPath = dirPath + "torrent_files/";
+  boost::filesystem::create_directories(torrentPath);
+  auto fileNum = 0;
+  for (const auto& t : torrentSegments) {
+    fileNum++;
+    auto filename = torrentPath + to_string(fileNum);
+    io::save(t, filename);
+  }
+
+  auto manifestPath = dirPath + "manifests/";
+  boost::filesystem::create_directory(manifestPath);
+  for (const auto& m : manifests) {
+    fs::path filename = manifestPath + m.file_name() + to_string(m.submanifest_number());
+    boost::filesystem::create_directory(filename.parent_path());
+    io::save(m, filename.string());
+  }
+  TestTorrentManager manager("/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=6114e56874fc01bf8f9c40fa652741a895eb922372f1baf039ccea64dacd2152",
+                             filePath,
+                             face);
+
+  manager.Initialize();
+  // fewer than the initial congestion window
+  manager.setMaxPendingInterests(2);
+  advanceClocks(time::milliseconds(1), 10);
+  manager.sendRoutablePrefixResponse();
+
+  std::set<Name> received;
+  manager.download_missing_data_packets([&received] (const Name& name) {
+                                          received.insert(name);
+                                        },
+                                        [](const Name& name, const std::string& reason) {
+                                          BOOST_FAIL("Unexpected failure");
+                                        });
+  size_t numSent = 0;
+  size_t maxPending = 0;
+  for (int i = 0; i < 100 && received.size() < packets.size(); ++i) {
+    advanceClocks(time::milliseconds(1), 10);
+    auto sent = face->sentInterests;
+    // the Interests sent since the previous ones were answered
+    size_t pending = 0;
+    for (; numSent < sent.size(); ++numSent) {
+      auto it = packets.find(sent[numSent].getName());
+      if (packets.end() != it) {
+        ++pending;
+        face->receive(it->second);
+      }
+    }
+    maxPending = std::max(maxPending, pending);
+    manager.drainWrites();
+  }
+  BOOST_CHECK_EQUAL(maxPending, 2);
+  BOOST_CHECK_EQUAL(received.size(), packets.size());
+  BOOST_CHECK_EQUAL(manager.missingDataPackets(), 0);
+
+  fs::remove_all(filePath);
+  fs::remove_all(".appdata");
+}
+
+BOOST_AUTO_TEST_CASE(TestMaxPendingInterestsFromScratch)
+{
+  vector<FileManifest> manifests;
+  vector<TorrentFile>  torrentSegments;
+  // the manifest segments by name and by full name, and the data packets by full name
+  std::unordered_map<Name, Data> segments;
+  std::unordered_map<Name, Data> packets;
+  std::string filePath = "tests/testdata/temp";
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo", 1024, 128, 128, true);
+    torrentSegments = temp.first;
+    for (const auto& ms : temp.second) {
+      manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+      for (const auto& d : ms.second) {
+        packets.insert({d.getFullName(), d});
+      }
+    }
+  }
+  for (const auto& m : manifests) {
+    segments.insert({m.getName(), m});
+    segments.insert({m.getFullName(), m});
+  }
+
+  // only the torrent file is on disk
+  std::string torrentPath = ".appdata/foo/torrent_files/";
+  boost::filesystem::create_directories(torrentPath);
+  auto fileNum = 0;
+  for (const auto& t : torrentSegments) {
+    fileNum++;
+    io::save(t, torrentPath + to_string(fileNum));
+  }
+  TestTorrentManager manager(torrentSegments[0].getFullName(), filePath, face);
+  manager.Initialize();
+  manager.setMaxPendingInterests(4);
+  manager.setManifestPrefetch(2);
+
+  advanceClocks(time::milliseconds(1), 10);
+  manager.sendRoutablePrefixResponse();
+
+  std::set<Name> received;
+  manager.download_missing_data_packets([&received] (const Name& name) {
+                                          received.insert(name);
+                                        },
+                                        [](const Name& name, const std::string& reason) {
+                                          BOOST_FAIL("Unexpected failure");
+                                        });
+  std::vector<Name> manifestNames;
+  manager.findFileManifestsToDownload(manifestNames);
+  for (const auto& manifestName : manifestNames) {
+    manager.download_file_manifest(manifestName, ".appdata/foo/manifests",
+                                   [](const std::vector<ndn::Name>& vec) {},
+                                   [](const ndn::Name& name, const std::string& reason) {
+                                     BOOST_FAIL("Unexpected failure");
+                                   },
+                                   [](const std::vector<ndn::Name>& vec) {});
+  }
+
+  // the queue holds the manifest segments of each file and the next missing packet, never the
+  // packets of the segments received
+  size_t numSent = 0;
+  size_t maxQueued = 0;
+  for (int i = 0; i < 1000 && received.size() < packets.size(); ++i) {
+    advanceClocks(time::milliseconds(1), 10);
+    maxQueued = std::max(maxQueued, manager.queuedInterests());
+    auto sent = face->sentInterests;
+    for (; numSent < sent.size(); ++numSent) {
+      auto segment_it = segments.find(sent[numSent].getName());
+      auto packet_it = packets.find(sent[numSent].getName());
+      if (segments.end() != segment_it) {
+        face->receive(segment_it->second);
+      }
+      else if (packets.end() != packet_it) {
+        face->receive(packet_it->second);
+      }
+    }
+    manager.drainWrites();
+    maxQueued = std::max(maxQueued, manager.queuedInterests());
+  }
+  BOOST_CHECK_LE(maxQueued, manifestNames.size() * 3 + 1);
+  BOOST_CHECK_EQUAL(received.size(), packets.size());
+  BOOST_CHECK_EQUAL(manager.missingDataPackets(), 0);
+
+  fs::remove_all(filePath);
+  fs::remove_all(".appdata");
+}
+
+BOOST_AUTO_TEST_CASE(CheckSeedComplete)
+{
+   const struct {
+       const char    *d_directoryPath;
+       const char    *d_initialSegmentName;
+       size_t         d_namesPerSegment;
+       size_t         d_subManifestSize;
+       size_t         d_dataPacketSize;
+   } DATA [] = {
+      {"tests/testdata/foo", "/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=9e0410fa477309b40a4ef9cb2bebe70ed2e9fa2defcb584979d768b3f6ced981", 1024, 1024, 1024},
+      // {"tests/testdata/foo", "/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=5351d424c7893158da35707258635d885725be0aa34321cf2e557afc2b785a76", 128,  128, 128},
+      // {"tests/testdata/foo", "/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=24ea5e5e3af6a548cc54c0d5b3573ecb18e247f1567a0d586c1d7c131b75181d",   1,  128, 128},
+   };
+   enum { NUM_DATA = sizeof DATA / sizeof *DATA };
+   for (int i = 0; i < NUM_DATA; ++i) {
+     auto directoryPath      = DATA[i].d_directoryPath;
+     Name initialSegmentName = DATA[i].d_initialSegmentName;
+     auto namesPerSegment    = DATA[i].d_namesPerSegment;
+     auto dataPacketSize     = DATA[i].d_dataPacketSize;
+     auto subManifestSize    = DATA[i].d_subManifestSize;
+
+     vector<FileManifest> manifests;
+     vector<TorrentFile> torrentSegments;
+     std::string filePath = "tests/testdata/";
+     std::vector<vector<Data>> fileData;
+     // get torrent files and manifests
+     {
+      auto temp = TorrentFile::generate(directoryPath,
+                                        namesPerSegment,
+                                        subManifestSize,
+                                        dataPacketSize,
+                                        true);
+      torrentSegments = temp.first;
+      auto temp1      = temp.second;
+      for (const auto& ms : temp1) {
+        manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+        fileData.push_back(ms.second);
+      }
+     }
+     // write the torrent segments  and manifests to disk
+     std::string dirPath = ".appdata/foo/";
+     boost::filesystem::create_directories(dirPath);
+     std::string torrentPath = dirPath + "torrent_files/";
+     boost::filesystem::create_directory(torrentPath);
+     auto fileNum = 0;
+     for (const auto& t : torrentSegments) {
+      fileNum++;
+      auto filename = torrentPath + to_string(fileNum);
+      io::save(t, filename);
+     }
+     auto manifestPath = dirPath + "manifests/";
+     boost::filesystem::create_directory(manifestPath);
+     for (const auto& m : manifests) {
+      fs::path filename = manifestPath + m.file_name() + "/" + to_string(m.submanifest_number());
+      boost::filesystem::create_directories(filename.parent_path());
+      io::save(m, filename.string());
+     }
+     // Initialize and verify
+     TestTorrentManager manager(initialSegmentName,
+                                filePath,
+                                face);
+
+     manager.Initialize();
+
+     advanceClocks(time::milliseconds(1), 10);
+     manager.sendRoutablePrefixResponse();
+
+     size_t nData = 0;
+     BOOST_CHECK_EQUAL(0, face->sentData.size());
+     // request all the torrent segments
+     for (const auto& t : torrentSegments) {
+      Interest interest(t.getFullName(), time::milliseconds(50));
+      face->expressInterest(interest,
+                            [&t](const Interest& i, const Data& d) {
+                              TorrentFile t1(d.wireEncode());
+                              BOOST_CHECK(t  == d);
+                              BOOST_CHECK(t1 == t);
+                            },
+                            bind([] {
+                              BOOST_FAIL("Unexpected Nack");
+                            }),
+                            bind([] {
+                              BOOST_FAIL("Unexpected timeout");
+                            }));
+      advanceClocks(time::milliseconds(1), 40);
+      face->receive(interest);
+      manager.processEvents(time::milliseconds(-1));
+      // check that one piece of data is sent, and it is what was expected
+      BOOST_CHECK_EQUAL(++nData, face->sentData.size());
+      face->receive(face->sentData[nData - 1]);
+     }
+     // request all the file manifests
+     for (const auto& m : manifests) {
+       Interest interest(m.getFullName(), time::milliseconds(50));
+       face->expressInterest(interest,
+                             [&m](const Interest& i, const Data& d) {
+                               FileManifest m1(d.wireEncode());
+                               BOOST_CHECK(m == d);
+                               BOOST_CHECK(m1 == m);
+                             },
                               bind([] {
                                 BOOST_FAIL("Unexpected Nack");
                               }),
@@ -1107,6 +1931,351 @@ BOOST_AUTO_TEST_CASE(CheckSeedRandom)
   fs::remove_all(".appdata");
 }
 
+BOOST_AUTO_TEST_CASE(CheckSeedWorkers)
+{
+  vector<FileManifest> manifests;
+  vector<TorrentFile>  torrentSegments;
+  std::vector<Data> data;
+  std::string filePath = "tests/testdata/";
+  std::string dirPath = ".appdata/foo/";
+  Name initialSegmentName = "/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=9e0410fa477309b40a4ef9cb2bebe70ed2e9fa2defcb584979d768b3f6ced981";
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo",
+                                      1024,
+                                      1024,
+                                      1024,
+                                      true);
+    torrentSegments = temp.first;
+    for (const auto& ms : temp.second) {
+      manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+      data.insert(data.end(), ms.second.begin(), ms.second.end());
+    }
+  }
+  // write the torrent segments and manifests to disk
+  auto torrentPath = dirPath + "torrent_files/";
+  boost::filesystem::create_directories(torrentPath);
+  auto fileNum = 0;
+  for (const auto& t : torrentSegments) {
+    fileNum++;
+    io::save(t, torrentPath + to_string(fileNum));
+  }
+  auto manifestPath = dirPath + "manifests/";
+  boost::filesystem::create_directory(manifestPath);
+  for (const auto& m : manifests) {
+    fs::path filename = manifestPath + m.file_name() + to_string(m.submanifest_number());
+    boost::filesystem::create_directory(filename.parent_path());
+    io::save(m, filename.string());
+  }
+
+  auto seedWorkers = make_shared<ThreadPool>(2);
+  TestTorrentManager manager(initialSegmentName, filePath, face, seedWorkers);
+  manager.Initialize();
+  // every packet is read on demand
+  manager.setReadahead(0);
+
+  advanceClocks(time::milliseconds(1), 10);
+  manager.sendRoutablePrefixResponse();
+
+  // when too many packets are being read, the Interests for the others are Nacked
+  manager.setMaxPendingReads(0);
+  face->receive(Interest(data[0].getFullName(), time::milliseconds(50)));
+  manager.processEvents(time::milliseconds(-1));
+  BOOST_CHECK_EQUAL(face->sentNacks.size(), 1);
+  BOOST_CHECK_EQUAL(face->sentData.size(), 0);
+  manager.setMaxPendingReads(TestTorrentManager::DEFAULT_MAX_PENDING_READS);
+
+  // the Interests received for a packet while it is being read share that read
+  {
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    for (size_t i = 0; i < 2; ++i) {
+      seedWorkers->post([released] { released.wait(); });
+    }
+    for (size_t i = 0; i < 3; ++i) {
+      face->receive(Interest(data[0].getFullName(), time::milliseconds(50)));
+    }
+    manager.processEvents(time::milliseconds(-1));
+    BOOST_CHECK_EQUAL(face->sentData.size(), 0);
+    release.set_value();
+    seedWorkers->wait();
+    manager.processEvents(time::milliseconds(-1));
+    BOOST_REQUIRE_EQUAL(face->sentData.size(), 1);
+    BOOST_CHECK(data[0] == face->sentData.back());
+    BOOST_CHECK_EQUAL(face->sentNacks.size(), 1);
+    face->sentData.clear();
+  }
+
+  // the packets are read by the workers and sent from the thread processing the events
+  size_t nData = 0;
+  for (const auto& d : data) {
+    face->receive(Interest(d.getFullName(), time::milliseconds(50)));
+    manager.processEvents(time::milliseconds(-1));
+    seedWorkers->wait();
+    manager.processEvents(time::milliseconds(-1));
+    BOOST_REQUIRE_EQUAL(++nData, face->sentData.size());
+    BOOST_CHECK(d == face->sentData.back());
+  }
+  // only the first packet was served from the cache, on its second round
+  const auto& metrics = manager.metrics();
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::SERVE_CACHE_HITS), 1);
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::SERVE_CACHE_MISSES), data.size() + 3);
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::DATA_SERVED), data.size() + 1);
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::NACKS_SENT), 1);
+  fs::remove_all(".appdata");
+}
+
+BOOST_AUTO_TEST_CASE(CheckSeedReadahead)
+{
+  vector<FileManifest> manifests;
+  vector<TorrentFile>  torrentSegments;
+  std::string filePath = "tests/testdata/";
+  std::string dirPath = ".appdata/foo/";
+  Name initialSegmentName = "/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=9e0410fa477309b40a4ef9cb2bebe70ed2e9fa2defcb584979d768b3f6ced981";
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo",
+                                      1024,
+                                      1024,
+                                      1024,
+                                      false);
+    torrentSegments = temp.first;
+    for (const auto& ms : temp.second) {
+      manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+    }
+  }
+  // write the torrent segments and manifests to disk
+  auto torrentPath = dirPath + "torrent_files/";
+  boost::filesystem::create_directories(torrentPath);
+  auto fileNum = 0;
+  for (const auto& t : torrentSegments) {
+    fileNum++;
+    io::save(t, torrentPath + to_string(fileNum));
+  }
+  auto manifestPath = dirPath + "manifests/";
+  boost::filesystem::create_directory(manifestPath);
+  for (const auto& m : manifests) {
+    fs::path filename = manifestPath + m.file_name() + to_string(m.submanifest_number());
+    boost::filesystem::create_directory(filename.parent_path());
+    io::save(m, filename.string());
+  }
+  auto manifest_it = std::find_if(manifests.begin(), manifests.end(),
+                                  [](const FileManifest& m) { return m.catalog().size() > 40; });
+  BOOST_REQUIRE(manifests.end() != manifest_it);
+  const auto& catalog = manifest_it->catalog();
+
+  auto seedWorkers = make_shared<ThreadPool>(2);
+  TestTorrentManager manager(initialSegmentName, filePath, face, seedWorkers);
+  manager.Initialize();
+  manager.setReadahead(8);
+
+  advanceClocks(time::milliseconds(1), 10);
+  manager.sendRoutablePrefixResponse();
+  const auto& metrics = manager.metrics();
+
+  size_t nData = 0;
+  auto request = [&] (size_t packetNum) {
+    face->receive(Interest(catalog[packetNum], time::milliseconds(50)));
+    manager.processEvents(time::milliseconds(-1));
+  };
+  auto complete = [&] {
+    seedWorkers->wait();
+    manager.processEvents(time::milliseconds(-1));
+  };
+
+  // the first three packets requested in order are read on demand, then the next ones are read
+  // ahead
+  size_t run = 3;
+  for (size_t i = 0; i < run; ++i) {
+    request(i);
+    complete();
+    BOOST_REQUIRE_EQUAL(++nData, face->sentData.size());
+    BOOST_CHECK_EQUAL(face->sentData.back().getFullName(), catalog[i]);
+  }
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::PACKETS_READ_AHEAD), 8);
+
+  // the packets read ahead are answered from the cache, and the window is refilled once half of
+  // it was requested
+  for (size_t i = run; i < 16; ++i) {
+    request(i);
+    BOOST_REQUIRE_EQUAL(++nData, face->sentData.size());
+    BOOST_CHECK_EQUAL(face->sentData.back().getFullName(), catalog[i]);
+    complete();
+  }
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::SERVE_CACHE_HITS), 16 - run);
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::SERVE_CACHE_MISSES), run);
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::PACKETS_READ_AHEAD), 18);
+
+  // a jump forward starts a new run
+  for (size_t i = 30; i < 32; ++i) {
+    request(i);
+    complete();
+    BOOST_REQUIRE_EQUAL(++nData, face->sentData.size());
+  }
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::PACKETS_READ_AHEAD), 18);
+
+  // the Interest for a packet being read ahead waits on that read
+  {
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    for (size_t i = 0; i < 2; ++i) {
+      seedWorkers->post([released] { released.wait(); });
+    }
+    request(32);
+    request(33);
+    BOOST_CHECK_EQUAL(nData, face->sentData.size());
+    release.set_value();
+    complete();
+    nData += 2;
+    BOOST_REQUIRE_EQUAL(nData, face->sentData.size());
+    // the two reads complete in any order
+    std::set<Name> sent = { face->sentData[nData - 2].getFullName(),
+                            face->sentData[nData - 1].getFullName() };
+    BOOST_CHECK(sent == std::set<Name>({ catalog[32], catalog[33] }));
+  }
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::PACKETS_READ_AHEAD), 26);
+  BOOST_CHECK_EQUAL(metrics.get(Metrics::NACKS_SENT), 0);
+  fs::remove_all(".appdata");
+}
+
+BOOST_AUTO_TEST_CASE(CheckSharedPacketCache)
+{
+  vector<FileManifest> manifests;
+  vector<TorrentFile>  torrentSegments;
+  std::string filePath = "tests/testdata/";
+  std::string dirPath = ".appdata/foo/";
+  Name initialSegmentName = "/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=9e0410fa477309b40a4ef9cb2bebe70ed2e9fa2defcb584979d768b3f6ced981";
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo",
+                                      1024,
+                                      1024,
+                                      1024,
+                                      false);
+    torrentSegments = temp.first;
+    for (const auto& ms : temp.second) {
+      manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+    }
+  }
+  // write the torrent segments and manifests to disk
+  auto torrentPath = dirPath + "torrent_files/";
+  boost::filesystem::create_directories(torrentPath);
+  auto fileNum = 0;
+  for (const auto& t : torrentSegments) {
+    fileNum++;
+    io::save(t, torrentPath + to_string(fileNum));
+  }
+  auto manifestPath = dirPath + "manifests/";
+  boost::filesystem::create_directory(manifestPath);
+  for (const auto& m : manifests) {
+    fs::path filename = manifestPath + m.file_name() + to_string(m.submanifest_number());
+    boost::filesystem::create_directory(filename.parent_path());
+    io::save(m, filename.string());
+  }
+  auto manifest_it = std::find_if(manifests.begin(), manifests.end(),
+                                  [](const FileManifest& m) { return m.catalog().size() > 1; });
+  BOOST_REQUIRE(manifests.end() != manifest_it);
+  const auto& catalog = manifest_it->catalog();
+
+  TorrentManager::Resources resources{};
+  resources.face = face;
+  resources.packetCache = make_shared<PacketCache>();
+  resources.fileMappings = make_shared<FileMapCache>();
+  TestTorrentManager manager(initialSegmentName, filePath, resources);
+  manager.Initialize();
+  manager.setReadahead(0);
+  advanceClocks(time::milliseconds(1), 10);
+  const auto usage = manager.memoryUsage();
+
+  // the packets served are cached and the files mapped in the shared caches
+  face->receive(Interest(catalog[0], time::milliseconds(50)));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(face->sentData.size(), 1);
+  BOOST_CHECK(resources.packetCache->contains(catalog[0]));
+  BOOST_CHECK_EQUAL(resources.fileMappings->size(), 1);
+
+  // the shared cache is left out of the memory of the torrent
+  BOOST_CHECK_EQUAL(manager.memoryUsage(), usage);
+
+  face->receive(Interest(catalog[0], time::milliseconds(50)));
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(face->sentData.size(), 2);
+  BOOST_CHECK_EQUAL(manager.metrics().get(Metrics::SERVE_CACHE_HITS), 1);
+  fs::remove_all(".appdata");
+}
+
+BOOST_AUTO_TEST_CASE(CheckMemoryBudget)
+{
+  vector<FileManifest> manifests;
+  vector<TorrentFile>  torrentSegments;
+  std::vector<Data> data;
+  std::string filePath = "tests/testdata/";
+  std::string dirPath = ".appdata/foo/";
+  Name initialSegmentName = "/ndn/multicast/NTORRENT/foo/torrent-file/sha256digest=9e0410fa477309b40a4ef9cb2bebe70ed2e9fa2defcb584979d768b3f6ced981";
+  {
+    auto temp = TorrentFile::generate("tests/testdata/foo",
+                                      1024,
+                                      1024,
+                                      1024,
+                                      true);
+    torrentSegments = temp.first;
+    for (const auto& ms : temp.second) {
+      manifests.insert(manifests.end(), ms.first.begin(), ms.first.end());
+      data.insert(data.end(), ms.second.begin(), ms.second.end());
+    }
+  }
+  // write the torrent segments and manifests to disk
+  auto torrentPath = dirPath + "torrent_files/";
+  boost::filesystem::create_directories(torrentPath);
+  auto fileNum = 0;
+  for (const auto& t : torrentSegments) {
+    fileNum++;
+    io::save(t, torrentPath + to_string(fileNum));
+  }
+  auto manifestPath = dirPath + "manifests/";
+  boost::filesystem::create_directory(manifestPath);
+  for (const auto& m : manifests) {
+    fs::path filename = manifestPath + m.file_name() + to_string(m.submanifest_number());
+    boost::filesystem::create_directory(filename.parent_path());
+    io::save(m, filename.string());
+  }
+  BOOST_REQUIRE(manifests.size() > 1);
+
+  TestTorrentManager manager(initialSegmentName, filePath, face);
+  manager.Initialize();
+  advanceClocks(time::milliseconds(1), 10);
+  manager.sendRoutablePrefixResponse();
+  auto completeFiles = manager.findCompleteFiles();
+  auto memoryUsage = manager.memoryUsage();
+  BOOST_CHECK_EQUAL(manager.evictedFileManifests(), 0);
+
+  // all the complete manifests but the most recently used one are evicted
+  manager.setMemoryBudget(1);
+  BOOST_CHECK_EQUAL(manager.evictedFileManifests(), manifests.size() - 1);
+  BOOST_CHECK(manager.memoryUsage() < memoryUsage);
+  BOOST_CHECK(manager.findCompleteFiles() == completeFiles);
+
+  // the evicted manifests are reloaded to answer the Interests for them, evicting others
+  size_t nData = 0;
+  for (const auto& m : manifests) {
+    face->receive(Interest(m.getFullName(), time::milliseconds(50)));
+    manager.processEvents(time::milliseconds(-1));
+    BOOST_REQUIRE_EQUAL(++nData, face->sentData.size());
+    BOOST_CHECK_EQUAL(face->sentData.back().getFullName(), m.getFullName());
+    BOOST_CHECK_EQUAL(manager.evictedFileManifests(), manifests.size() - 1);
+  }
+  // the packets of the evicted manifests are served without reloading them
+  for (const auto& d : data) {
+    face->receive(Interest(d.getFullName(), time::milliseconds(50)));
+    manager.processEvents(time::milliseconds(-1));
+    BOOST_REQUIRE_EQUAL(++nData, face->sentData.size());
+    BOOST_CHECK(d == face->sentData.back());
+  }
+  BOOST_CHECK_EQUAL(manager.evictedFileManifests(), manifests.size() - 1);
+  std::ostringstream os;
+  manager.dumpMetrics(os);
+  BOOST_CHECK(std::string::npos !=
+              os.str().find("evicted_manifests " + to_string(manifests.size() - 1) + "\n"));
+  fs::remove_all(".appdata");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_FIXTURE_TEST_SUITE(CheckTorrentManagerUtilities, FaceFixture)
@@ -28,6 +28,8 @@
 #include <ndn-cxx/util/dummy-client-face.hpp>
 #include <ndn-cxx/util/io.hpp>
 
+#include <algorithm>
+
 namespace ndn {
 namespace ntorrent {
 namespace tests {
@@ -152,7 +154,12 @@ BOOST_AUTO_TEST_CASE(TestAliveInterestExchange)
 
   BOOST_CHECK_EQUAL((table1->end() - 1)->getRecordName().toUri(), "/test");
 
-  d = DummyParser::createDataPacket(Name("ndn/multicast/NTORRENT/linux15.01/ALIVE/arizona"),
+  // the ALIVE Interest ends with the Bloom filter of the prefixes handler2 knows
+  auto aliveName = face2->sentInterests.back().getName();
+  BOOST_CHECK_EQUAL(aliveName.getPrefix(-2),
+                    Name("ndn/multicast/NTORRENT/linux15.01/ALIVE/arizona"));
+  BOOST_CHECK_EQUAL(aliveName.get(-2), name::Component(UpdateHandler::KNOWN_PREFIXES_COMPONENT));
+  d = DummyParser::createDataPacket(aliveName,
                                      { Name("isp1"), Name("isp2"), Name("isp3") });
   keyChain->sign(*d);
 
@@ -180,7 +187,7 @@ BOOST_AUTO_TEST_CASE(TestAliveInterestExchange)
   handler2.sendAliveInterest(table2->begin());
 
   advanceClocks(time::milliseconds(1), 40);
-  Interest interest2(Name("ndn/multicast/NTORRENT/linux15.01/ALIVE/arizona"));
+  Interest interest2 = face2->sentInterests.back();
   face1->receive(interest2);
 
   advanceClocks(time::milliseconds(1), 10);
@@ -188,6 +195,12 @@ BOOST_AUTO_TEST_CASE(TestAliveInterestExchange)
   dataVec = face1->sentData;
   BOOST_CHECK_EQUAL(dataVec.size(), 2);
 
+  // only the prefixes handler2 does not know are sent, so 'isp3' and its own are skipped
+  nameVec = DummyParser::decodeContent(dataVec[1].getContent());
+  BOOST_CHECK_EQUAL(nameVec->size(), UpdateHandler::MAX_NUM_OF_ENCODED_NAMES);
+  BOOST_CHECK(std::find(nameVec->begin(), nameVec->end(), Name("isp3")) == nameVec->end());
+  BOOST_CHECK(std::find(nameVec->begin(), nameVec->end(), Name("arizona")) == nameVec->end());
+
   auto iter = dataVec.begin() + 1;
   advanceClocks(time::milliseconds(1), 30);
   face2->receive(*iter);
@@ -241,9 +254,97 @@ BOOST_AUTO_TEST_CASE(TestAliveInterestExchange)
   BOOST_CHECK_EQUAL(i->getRecordReceivedData(), 0);
   ++i;
 
+  BOOST_CHECK_EQUAL(i->getRecordName().toUri(), "/isp7");
+  BOOST_CHECK_EQUAL(i->getRecordSuccessRate(), 0);
+  BOOST_CHECK_EQUAL(i->getRecordSentInterests(), 0);
+  BOOST_CHECK_EQUAL(i->getRecordReceivedData(), 0);
+  ++i;
+
   BOOST_CHECK(i == table2->end());
 }
 
+BOOST_AUTO_TEST_CASE(TestAvailabilityExchange)
+{
+  shared_ptr<StatsTable> table1 = make_shared<StatsTable>(Name("linux15.01"));
+  table1->insert(Name("isp1"));
+
+  shared_ptr<KeyChain> keyChain = make_shared<KeyChain>();
+
+  TestUpdateHandler handler1(Name("linux15.01"), keyChain, table1, face1);
+  handler1.setAvailabilityHandlers([] { return std::vector<bool>{true, false, true}; }, {});
+  advanceClocks(time::milliseconds(1), 10);
+  shared_ptr<Data> d = DummyParser::createDataPacket(Name("/localhop/nfd/rib/routable-prefixes"),
+                                                      { Name("ucla") });
+  keyChain->sign(*d);
+  face1->receive(*d);
+
+  shared_ptr<StatsTable> table2 = make_shared<StatsTable>(Name("linux15.01"));
+  table2->insert(Name("ucla"));
+  TestUpdateHandler handler2(Name("linux15.01"), keyChain, table2, face2);
+  Name peer;
+  std::vector<bool> pieces;
+  handler2.setAvailabilityHandlers({}, [&] (const Name& p, const std::vector<bool>& v) {
+    peer = p;
+    pieces = v;
+  });
+  advanceClocks(time::milliseconds(1), 10);
+  d = DummyParser::createDataPacket(Name("/localhop/nfd/rib/routable-prefixes"),
+                                     { Name("arizona") });
+  keyChain->sign(*d);
+  face2->receive(*d);
+
+  handler2.sendAliveInterest(table2->begin());
+
+  advanceClocks(time::milliseconds(1), 40);
+  Interest interest(Name("ndn/multicast/NTORRENT/linux15.01/ALIVE/arizona"));
+  face1->receive(interest);
+
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(face1->sentData.size(), 1);
+
+  // the names are still decoded alongside the availability
+  advanceClocks(time::milliseconds(1), 30);
+  face2->receive(face1->sentData.back());
+  BOOST_CHECK(table2->find(Name("isp1")) != table2->end());
+
+  // the bitmap is padded to whole bytes
+  BOOST_CHECK_EQUAL(peer, Name("ucla"));
+  BOOST_REQUIRE_EQUAL(pieces.size(), 8);
+  BOOST_CHECK(pieces[0]);
+  BOOST_CHECK(!pieces[1]);
+  BOOST_CHECK(pieces[2]);
+  BOOST_CHECK(std::none_of(pieces.begin() + 3, pieces.end(), [] (bool b) { return b; }));
+}
+
+BOOST_AUTO_TEST_CASE(TestMetricsInterest)
+{
+  shared_ptr<StatsTable> table1 = make_shared<StatsTable>(Name("linux15.01"));
+  table1->insert(Name("isp1"));
+
+  shared_ptr<KeyChain> keyChain = make_shared<KeyChain>();
+
+  TestUpdateHandler handler1(Name("linux15.01"), keyChain, table1, face1);
+  handler1.setMetricsHandler([] { return std::string("interests_sent 3\n"); });
+  advanceClocks(time::milliseconds(1), 10);
+  shared_ptr<Data> d = DummyParser::createDataPacket(Name("/localhop/nfd/rib/routable-prefixes"),
+                                                      { Name("ucla") });
+  keyChain->sign(*d);
+  face1->receive(*d);
+
+  advanceClocks(time::milliseconds(1), 40);
+  Interest interest(Name("ndn/multicast/NTORRENT/linux15.01/ALIVE/metrics"));
+  face1->receive(interest);
+
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_REQUIRE_EQUAL(face1->sentData.size(), 1);
+  const auto& content = face1->sentData.back().getContent();
+  BOOST_CHECK_EQUAL(std::string(reinterpret_cast<const char*>(content.value()),
+                                content.value_size()),
+                    "interests_sent 3\n");
+  // the metrics component is not taken for the routable prefix of a peer
+  BOOST_CHECK(table1->find(Name("metrics")) == table1->end());
+}
+
 BOOST_AUTO_TEST_CASE(TestNeedsUpdate)
 {
   shared_ptr<StatsTable> table1 = make_shared<StatsTable>(Name("linux15.01"));
@@ -270,6 +371,47 @@ BOOST_AUTO_TEST_CASE(TestNeedsUpdate)
   BOOST_CHECK(!handler1.needsUpdate());
 }
 
+BOOST_AUTO_TEST_CASE(TestAliveBackoff)
+{
+  shared_ptr<StatsTable> table1 = make_shared<StatsTable>(Name("linux15.01"));
+  table1->insert(Name("isp1"));
+
+  shared_ptr<KeyChain> keyChain = make_shared<KeyChain>();
+
+  TestUpdateHandler handler1(Name("linux15.01"), keyChain, table1, face1);
+  advanceClocks(time::milliseconds(1), 10);
+  shared_ptr<Data> d = DummyParser::createDataPacket(Name("/localhop/nfd/rib/routable-prefixes"),
+                                                      { Name("ucla") });
+  keyChain->sign(*d);
+  face1->receive(*d);
+
+  // each ALIVE Interest doubles the time before the next one is needed
+  BOOST_CHECK(handler1.needsUpdate());
+  handler1.sendAliveInterest(table1->begin());
+  BOOST_CHECK(!handler1.needsUpdate());
+  advanceClocks(time::milliseconds(100), 10);
+  BOOST_CHECK(handler1.needsUpdate());
+  handler1.sendAliveInterest(table1->begin());
+  advanceClocks(time::milliseconds(100), 10);
+  BOOST_CHECK(!handler1.needsUpdate());
+  advanceClocks(time::milliseconds(100), 10);
+  BOOST_CHECK(handler1.needsUpdate());
+  handler1.sendAliveInterest(table1->begin());
+  advanceClocks(time::milliseconds(1), 10);
+
+  // until a reply brings new prefixes
+  d = DummyParser::createDataPacket(face1->sentInterests.back().getName(), { Name("isp2") });
+  keyChain->sign(*d);
+  face1->receive(*d);
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK(table1->find(Name("isp2")) != table1->end());
+  advanceClocks(time::milliseconds(100), 40);
+  BOOST_CHECK(handler1.needsUpdate());
+  handler1.sendAliveInterest(table1->begin());
+  advanceClocks(time::milliseconds(100), 10);
+  BOOST_CHECK(handler1.needsUpdate());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "../boost-test.hpp"
+#include "util/async-writer.hpp"
+
+#include <boost/asio/io_service.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestAsyncWriter)
+
+BOOST_AUTO_TEST_CASE(TestCoalescedWrites)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  auto filePath = dirPath + "written";
+  boost::asio::io_service io;
+  AsyncWriter writer(io, 4);
+  // write 64 blocks of 16 bytes in reverse order
+  std::vector<std::vector<uint8_t>> blocks;
+  for (uint8_t i = 0; i < 64; ++i) {
+    blocks.emplace_back(16, i);
+  }
+  std::vector<size_t> completed;
+  bool allocated = false;
+  writer.allocate(filePath, 0, 64 * 16, [&allocated, &completed] (bool result) {
+                                          BOOST_CHECK(completed.empty());
+                                          allocated = result;
+                                        });
+  for (size_t i = blocks.size(); i-- > 0;) {
+    writer.write(filePath, i * 16, blocks[i].data(), blocks[i].size(),
+                 [&completed, i] (bool written) {
+                   BOOST_CHECK(written);
+                   completed.push_back(i);
+                 });
+  }
+  bool synced = false;
+  writer.flush(filePath, [&synced, &completed] (bool result) {
+                           // completions are delivered in the order the jobs were queued
+                           BOOST_CHECK_EQUAL(completed.size(), 64);
+                           synced = result;
+                         });
+  writer.drain();
+  BOOST_CHECK(allocated);
+  BOOST_CHECK(synced);
+  BOOST_CHECK_EQUAL(writer.pending(), 0);
+  BOOST_REQUIRE_EQUAL(completed.size(), 64);
+  for (size_t i = 0; i < completed.size(); ++i) {
+    BOOST_CHECK_EQUAL(completed[i], 63 - i);
+  }
+
+  std::vector<uint8_t> bytes;
+  fs::ifstream is(filePath, fs::ifstream::binary);
+  is >> std::noskipws;
+  bytes.assign(std::istream_iterator<uint8_t>(is), std::istream_iterator<uint8_t>());
+  BOOST_REQUIRE_EQUAL(bytes.size(), 64 * 16);
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    BOOST_CHECK_EQUAL(bytes[i], i / 16);
+  }
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_CASE(TestCompletionsOnIoService)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  boost::asio::io_service io;
+  AsyncWriter writer(io);
+  uint8_t byte = 42;
+  int numWritten = 0;
+  int numFailed = 0;
+  auto done = [&numWritten, &numFailed] (bool written) {
+    written ? ++numWritten : ++numFailed;
+  };
+  writer.write(dirPath + "first", 0, &byte, 1, done);
+  writer.write(dirPath + "second", 0, &byte, 1, done);
+  // the parent directory is missing
+  writer.write(dirPath + "missing/third", 0, &byte, 1, done);
+  // so no space can be reserved in it either
+  writer.allocate(dirPath + "missing/fourth", 0, 16, done);
+  // the callbacks are executed by the io_service
+  boost::asio::io_service::work work(io);
+  while (numWritten + numFailed < 4) {
+    io.run_one();
+  }
+  BOOST_CHECK_EQUAL(numWritten, 2);
+  BOOST_CHECK_EQUAL(numFailed, 2);
+  BOOST_CHECK_EQUAL(fs::file_size(dirPath + "first"), 1);
+  BOOST_CHECK_EQUAL(fs::file_size(dirPath + "second"), 1);
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "../boost-test.hpp"
+#include "util/batch-sha256.hpp"
+
+#include <ndn-cxx/util/sha256.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+// Restore the implementation selected by default once a test is done
+class ImplementationFixture {
+ public:
+  ImplementationFixture()
+  : m_implementation(BatchSha256::implementation())
+  {
+  }
+
+  ~ImplementationFixture()
+  {
+    BatchSha256::setImplementation(m_implementation);
+  }
+
+ private:
+  BatchSha256::Implementation m_implementation;
+};
+
+static std::string
+toHex(const BatchSha256::Digest& digest)
+{
+  static const char DIGITS[] = "0123456789abcdef";
+  std::string hex;
+  for (auto byte : digest) {
+    hex += DIGITS[byte >> 4];
+    hex += DIGITS[byte & 0xf];
+  }
+  return hex;
+}
+
+static const BatchSha256::Implementation IMPLEMENTATIONS[] = {
+  BatchSha256::SCALAR,
+  BatchSha256::AVX2,
+  BatchSha256::SHA_NI
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestBatchSha256, ImplementationFixture)
+
+BOOST_AUTO_TEST_CASE(TestKnownDigests)
+{
+  const struct {
+    std::string d_message;
+    std::string d_digest;
+  } DATA [] = {
+    {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+    {"abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+    {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+     "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+  };
+  enum { NUM_DATA = sizeof DATA / sizeof *DATA };
+  BOOST_CHECK(BatchSha256::isSupported(BatchSha256::SCALAR));
+  for (auto implementation : IMPLEMENTATIONS) {
+    if (!BatchSha256::setImplementation(implementation)) {
+      BOOST_TEST_MESSAGE(BatchSha256::name(implementation) << " is not supported");
+      continue;
+    }
+    BOOST_CHECK_EQUAL(BatchSha256::implementation(), implementation);
+    std::vector<BatchSha256::Message> messages;
+    for (const auto& data : DATA) {
+      messages.push_back(BatchSha256::Message{
+        reinterpret_cast<const uint8_t*>(data.d_message.data()), data.d_message.size()});
+    }
+    std::vector<BatchSha256::Digest> digests(NUM_DATA);
+    BatchSha256::computeDigests(messages.data(), messages.size(), digests.data());
+    for (int i = 0; i < NUM_DATA; ++i) {
+      BOOST_CHECK_EQUAL(toHex(digests[i]), DATA[i].d_digest);
+      BOOST_CHECK_EQUAL(toHex(BatchSha256::computeDigest(messages[i].data, messages[i].size)),
+                        DATA[i].d_digest);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestMatchesSha256)
+{
+  // the sizes around the block and padding boundaries, then random sizes, all in the same batch
+  std::mt19937 random(1);
+  std::vector<std::vector<uint8_t>> contents;
+  for (size_t size : {0, 1, 55, 56, 57, 63, 64, 65, 119, 120, 128, 1000, 8192, 8800}) {
+    contents.emplace_back(size);
+  }
+  for (size_t i = 0; i < 21; ++i) {
+    contents.emplace_back(random() % 9000);
+  }
+  std::vector<BatchSha256::Message> messages;
+  for (auto& content : contents) {
+    for (auto& byte : content) {
+      byte = static_cast<uint8_t>(random());
+    }
+    messages.push_back(BatchSha256::Message{content.data(), content.size()});
+  }
+  for (auto implementation : IMPLEMENTATIONS) {
+    if (!BatchSha256::setImplementation(implementation)) {
+      continue;
+    }
+    // every number of messages, so that every lane is left idle once
+    for (size_t count = 0; count <= messages.size(); ++count) {
+      std::vector<BatchSha256::Digest> digests(count);
+      BatchSha256::computeDigests(messages.data(), count, digests.data());
+      for (size_t i = 0; i < count; ++i) {
+        auto expected = util::Sha256::computeDigest(messages[i].data, messages[i].size);
+        BOOST_REQUIRE_EQUAL(expected->size(), BatchSha256::DIGEST_SIZE);
+        BOOST_CHECK_MESSAGE(std::equal(digests[i].begin(), digests[i].end(), expected->begin()),
+                            BatchSha256::name(implementation) << ": message " << i << " of "
+                            << count << " (" << messages[i].size << " bytes)");
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ntorrent
+} // namespace ndn
@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "../boost-test.hpp"
+#include "util/bloom-filter.hpp"
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestBloomFilter)
+
+BOOST_AUTO_TEST_CASE(TestInsertContains)
+{
+  enum { NUM_ENTRIES = 200 };
+  BloomFilter filter(BloomFilter::fitSize(NUM_ENTRIES, 1024));
+  BOOST_CHECK_EQUAL(filter.bytes().size(), NUM_ENTRIES * BloomFilter::BITS_PER_ENTRY / 8);
+  for (int i = 0; i < NUM_ENTRIES; ++i) {
+    filter.insert(Name("/isp").appendNumber(i));
+  }
+  // no false negatives, and about 1% of false positives
+  size_t falsePositives = 0;
+  for (int i = 0; i < NUM_ENTRIES; ++i) {
+    BOOST_CHECK(filter.contains(Name("/isp").appendNumber(i)));
+    falsePositives += filter.contains(Name("/other").appendNumber(i));
+  }
+  BOOST_CHECK_LT(falsePositives, NUM_ENTRIES / 20);
+
+  // the bytes are all a peer needs to test the same names
+  BloomFilter copy(filter.bytes().data(), filter.bytes().size());
+  BOOST_CHECK(copy.bytes() == filter.bytes());
+  for (int i = 0; i < NUM_ENTRIES; ++i) {
+    BOOST_CHECK_EQUAL(copy.contains(Name("/isp").appendNumber(i)), true);
+    BOOST_CHECK_EQUAL(copy.contains(Name("/other").appendNumber(i)),
+                      filter.contains(Name("/other").appendNumber(i)));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestSizes)
+{
+  BOOST_CHECK_EQUAL(BloomFilter::fitSize(0, 1024), 1);
+  BOOST_CHECK_EQUAL(BloomFilter::fitSize(1, 1024), 2);
+  BOOST_CHECK_EQUAL(BloomFilter::fitSize(100000, 1024), 1024);
+
+  // an empty filter contains nothing
+  BloomFilter empty;
+  empty.insert(Name("/isp1"));
+  BOOST_CHECK(empty.bytes().empty());
+  BOOST_CHECK(!empty.contains(Name("/isp1")));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ntorrent
+} // namespace ndn
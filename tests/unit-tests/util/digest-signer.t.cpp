@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "../boost-test.hpp"
+#include "file-manifest.hpp"
+#include "util/digest-signer.hpp"
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestDigestSigner)
+
+BOOST_AUTO_TEST_CASE(TestMatchesKeyChain)
+{
+  KeyChain keyChain;
+  std::vector<uint8_t> content = {0, 1, 2, 3, 4, 5, 6, 7};
+
+  Name name("/ndn/multicast/NTORRENT/foo/bar.txt");
+  name.appendSequenceNumber(0);
+  name.appendSequenceNumber(0);
+  Data d1(name);
+  d1.setContent(content.data(), content.size());
+  Data d2(d1);
+
+  keyChain.sign(d1, signingWithSha256());
+  DigestSigner::sign(d2);
+
+  BOOST_CHECK(d1.wireEncode() == d2.wireEncode());
+  BOOST_CHECK_EQUAL(d1.getFullName(), d2.getFullName());
+
+  // re-signing a packet leaves it unchanged
+  DigestSigner::sign(d2);
+  BOOST_CHECK_EQUAL(d1.getFullName(), d2.getFullName());
+
+  Name manifestName("/ndn/multicast/NTORRENT/foo/bar.txt");
+  manifestName.appendSequenceNumber(0);
+  FileManifest m1(manifestName, 1024, Name("/ndn/multicast/NTORRENT/foo"),
+                  { d1.getFullName() }, nullptr);
+  m1.finalize();
+  FileManifest m2(m1);
+  keyChain.sign(m1, signingWithSha256());
+  DigestSigner::sign(m2);
+  BOOST_CHECK(m1.wireEncode() == m2.wireEncode());
+}
+
+BOOST_AUTO_TEST_CASE(TestSignBatch)
+{
+  // packets of equal sizes, but the last one
+  std::vector<Data> packets;
+  std::vector<Data> expected;
+  for (uint8_t i = 0; i < 11; ++i) {
+    Name name("/ndn/multicast/NTORRENT/foo/bar.txt");
+    name.appendSequenceNumber(0);
+    name.appendSequenceNumber(i);
+    std::vector<uint8_t> content(i < 10 ? 1024 : 100, i);
+    packets.emplace_back(name);
+    packets.back().setContent(content.data(), content.size());
+    expected.push_back(packets.back());
+    DigestSigner::sign(expected.back());
+  }
+  std::vector<Name> fullNames(packets.size());
+  DigestSigner::sign(packets.data(), packets.size(), fullNames.data());
+  for (size_t i = 0; i < packets.size(); ++i) {
+    BOOST_CHECK(packets[i].wireEncode() == expected[i].wireEncode());
+    BOOST_CHECK_EQUAL(fullNames[i], expected[i].getFullName());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(TestMakeData)
+{
+  // small and empty contents, and contents whose lengths take more than one octet
+  for (size_t size : {0, 1, 252, 253, 1024, 70000}) {
+    std::vector<uint8_t> content(size);
+    for (size_t i = 0; i < size; ++i) {
+      content[i] = static_cast<uint8_t>(i);
+    }
+    Name name("/ndn/multicast/NTORRENT/foo/bar.txt");
+    name.appendSequenceNumber(0);
+    name.appendSequenceNumber(size);
+    Data expected(name);
+    expected.setContent(content.data(), content.size());
+    DigestSigner::sign(expected);
+
+    auto d = DigestSigner::makeData(name, content.data(), content.size());
+    BOOST_REQUIRE(nullptr != d);
+    BOOST_CHECK(d->wireEncode() == expected.wireEncode());
+    BOOST_CHECK_EQUAL(d->getFullName(), expected.getFullName());
+    BOOST_CHECK_EQUAL(d->getContent().value_size(), size);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn
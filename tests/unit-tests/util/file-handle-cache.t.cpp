@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "../boost-test.hpp"
+#include "util/file-handle-cache.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestFileHandleCache)
+
+BOOST_AUTO_TEST_CASE(TestWriteRead)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  auto filePath = dirPath + "handles";
+  {
+    FileHandleCache cache;
+    std::vector<uint8_t> first  = {1, 2, 3, 4};
+    std::vector<uint8_t> second = {5, 6, 7, 8};
+    // write out of order
+    BOOST_CHECK(cache.write(filePath, 4, second.data(), second.size()));
+    BOOST_CHECK(cache.write(filePath, 0, first.data(), first.size()));
+    BOOST_CHECK_EQUAL(cache.size(), 1);
+    BOOST_CHECK(cache.flush(filePath));
+    BOOST_CHECK_EQUAL(fs::file_size(filePath), 8);
+
+    std::vector<uint8_t> bytes(8);
+    BOOST_CHECK_EQUAL(cache.read(filePath, 0, bytes.data(), bytes.size()), 8);
+    std::vector<uint8_t> expected = {1, 2, 3, 4, 5, 6, 7, 8};
+    BOOST_CHECK(bytes == expected);
+
+    // short read at the end of the file
+    BOOST_CHECK_EQUAL(cache.read(filePath, 6, bytes.data(), bytes.size()), 2);
+    BOOST_CHECK_EQUAL(bytes[0], 7);
+    BOOST_CHECK_EQUAL(bytes[1], 8);
+  }
+  // reading a missing file fails
+  FileHandleCache cache;
+  uint8_t byte;
+  BOOST_CHECK_EQUAL(cache.read(dirPath + "missing", 0, &byte, 1), -1);
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_CASE(TestAllocate)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  auto filePath = dirPath + "allocated";
+  FileHandleCache cache;
+  // the space is reserved without changing the size of the file
+  BOOST_CHECK(cache.allocate(filePath, 0, 1 << 16));
+  BOOST_CHECK(fs::exists(filePath));
+  BOOST_CHECK_EQUAL(fs::file_size(filePath), 0);
+  BOOST_CHECK(cache.allocate(filePath, 1 << 16, 0));
+
+  std::vector<uint8_t> bytes(1024, 7);
+  BOOST_CHECK(cache.write(filePath, 4096, bytes.data(), bytes.size()));
+  BOOST_CHECK(cache.write(filePath, 0, bytes.data(), bytes.size()));
+  BOOST_CHECK(cache.flush(filePath));
+  BOOST_CHECK_EQUAL(fs::file_size(filePath), 4096 + 1024);
+
+  std::vector<uint8_t> read(1024);
+  BOOST_CHECK_EQUAL(cache.read(filePath, 4096, read.data(), read.size()), 1024);
+  BOOST_CHECK(bytes == read);
+  // the gap between the writes reads back as zeros
+  BOOST_CHECK_EQUAL(cache.read(filePath, 2048, read.data(), read.size()), 1024);
+  BOOST_CHECK(std::vector<uint8_t>(1024, 0) == read);
+  cache.clear();
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_CASE(TestEviction)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  FileHandleCache cache(2);
+  BOOST_CHECK_EQUAL(cache.capacity(), 2);
+  uint8_t byte = 42;
+  for (int i = 0; i < 5; ++i) {
+    BOOST_CHECK(cache.write(dirPath + std::to_string(i), 0, &byte, 1));
+    BOOST_CHECK(cache.size() <= 2);
+  }
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  // evicted files were written completely
+  for (int i = 0; i < 5; ++i) {
+    uint8_t read = 0;
+    BOOST_CHECK_EQUAL(cache.read(dirPath + std::to_string(i), 0, &read, 1), 1);
+    BOOST_CHECK_EQUAL(read, 42);
+  }
+  cache.close(dirPath + "4");
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+  cache.clear();
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn
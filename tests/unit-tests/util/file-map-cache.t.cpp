@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "../boost-test.hpp"
+#include "util/file-map-cache.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <string>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+static void
+appendBytes(const std::string& filePath, const std::vector<uint8_t>& bytes)
+{
+  fs::ofstream os(filePath, std::ios::binary | std::ios::app);
+  os.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+BOOST_AUTO_TEST_SUITE(TestFileMapCache)
+
+BOOST_AUTO_TEST_CASE(TestMap)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  auto filePath = dirPath + "mapped";
+  std::vector<uint8_t> first = {1, 2, 3, 4};
+  appendBytes(filePath, first);
+
+  FileMapCache cache;
+  auto mapping = cache.map(filePath);
+  BOOST_REQUIRE(nullptr != mapping);
+  BOOST_CHECK_EQUAL(mapping->size(), 4);
+  BOOST_CHECK(std::vector<uint8_t>(mapping->data(), mapping->data() + 4) == first);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+  // the same mapping is returned while the file is unchanged
+  BOOST_CHECK(cache.map(filePath) == mapping);
+
+  // the file is mapped again once it grew
+  std::vector<uint8_t> second = {5, 6, 7, 8};
+  appendBytes(filePath, second);
+  auto grown = cache.map(filePath);
+  BOOST_REQUIRE(nullptr != grown);
+  BOOST_CHECK(grown != mapping);
+  BOOST_CHECK_EQUAL(grown->size(), 8);
+  BOOST_CHECK_EQUAL(grown->data()[7], 8);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+  // the released mapping remains valid while it is referenced
+  BOOST_CHECK_EQUAL(mapping->data()[3], 4);
+
+  // bytes past the end of the file are not an error, and do not map it again
+  BOOST_CHECK(cache.willNeed(filePath, 0, 8));
+  BOOST_CHECK(cache.willNeed(filePath, 6, 100));
+  BOOST_CHECK(cache.willNeed(filePath, 100, 100));
+  BOOST_CHECK(cache.map(filePath) == grown);
+
+  // a missing file cannot be mapped
+  BOOST_CHECK(nullptr == cache.map(dirPath + "missing"));
+  BOOST_CHECK(!cache.willNeed(dirPath + "missing", 0, 1));
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+  cache.close(filePath);
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_CASE(TestTruncatedFile)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  auto filePath = dirPath + "mapped";
+  appendBytes(filePath, {1, 2, 3, 4, 5, 6, 7, 8});
+
+  FileMapCache cache;
+  auto mapping = cache.map(filePath);
+  BOOST_REQUIRE(nullptr != mapping);
+  BOOST_CHECK_EQUAL(mapping->size(), 8);
+
+  // a truncated file is mapped again, so that no page past its end is read
+  fs::resize_file(filePath, 2);
+  auto truncated = cache.map(filePath);
+  BOOST_REQUIRE(nullptr != truncated);
+  BOOST_CHECK(truncated != mapping);
+  BOOST_CHECK_EQUAL(truncated->size(), 2);
+
+  // as is a file replaced by another of the same size
+  fs::remove(filePath);
+  appendBytes(filePath, {9, 10});
+  auto replaced = cache.map(filePath);
+  BOOST_REQUIRE(nullptr != replaced);
+  BOOST_CHECK(replaced != truncated);
+  BOOST_CHECK_EQUAL(replaced->data()[0], 9);
+
+  // and a removed file is no longer mapped
+  fs::remove(filePath);
+  BOOST_CHECK(nullptr == cache.map(filePath));
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_CASE(TestEmptyFile)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  auto filePath = dirPath + "empty";
+  appendBytes(filePath, {});
+
+  FileMapCache cache;
+  auto mapping = cache.map(filePath);
+  BOOST_REQUIRE(nullptr != mapping);
+  BOOST_CHECK_EQUAL(mapping->size(), 0);
+  BOOST_CHECK(cache.willNeed(filePath, 0, 4096));
+  cache.clear();
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_CASE(TestEviction)
+{
+  std::string dirPath = "tests/testdata/temp/";
+  fs::create_directories(dirPath);
+  FileMapCache cache(2);
+  BOOST_CHECK_EQUAL(cache.capacity(), 2);
+  for (int i = 0; i < 5; ++i) {
+    appendBytes(dirPath + std::to_string(i), {static_cast<uint8_t>(i)});
+    auto mapping = cache.map(dirPath + std::to_string(i));
+    BOOST_REQUIRE(nullptr != mapping);
+    BOOST_CHECK_EQUAL(mapping->data()[0], i);
+    BOOST_CHECK(cache.size() <= 2);
+  }
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  // evicted files are mapped again on demand
+  auto mapping = cache.map(dirPath + "0");
+  BOOST_REQUIRE(nullptr != mapping);
+  BOOST_CHECK_EQUAL(mapping->data()[0], 0);
+  BOOST_CHECK_EQUAL(cache.size(), 2);
+  cache.clear();
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+  fs::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ntorrent
+} // namespace ndn
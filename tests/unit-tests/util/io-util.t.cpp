@@ -21,6 +21,18 @@
 
 #include "../boost-test.hpp"
 #include "util/io-util.hpp"
+#include "util/file-handle-cache.hpp"
+#include "util/file-map-cache.hpp"
+#include "file-manifest.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <ndn-cxx/util/io.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
 
 namespace ndn {
 namespace ntorrent {
@@ -52,6 +64,148 @@ BOOST_AUTO_TEST_CASE(TestFindType)
   BOOST_CHECK_EQUAL(IoUtil::findType(n3), 2);
 }
 
+BOOST_AUTO_TEST_CASE(TestPacketizeFileStreaming)
+{
+  // a file read through several buffers, whose last packet is not full
+  std::string dirPath = "tests/testdata/temp/";
+  boost::filesystem::create_directories(dirPath);
+  std::string filePath = dirPath + "streamed";
+  size_t dataPacketSize = 7000;
+  size_t fileSize = 2 * IoUtil::READ_BUFFER_SIZE + 12345;
+  BOOST_REQUIRE_NE(fileSize % dataPacketSize, 0);
+  {
+    std::vector<char> bytes(fileSize);
+    uint32_t state = 1;
+    for (auto& byte : bytes) {
+      state = state * 1103515245 + 12345;
+      byte = static_cast<char>(state >> 24);
+    }
+    std::ofstream os(filePath, std::ios::binary);
+    os.write(bytes.data(), bytes.size());
+  }
+  Name prefix("/ndn/multicast/NTORRENT/temp/streamed");
+  prefix.appendSequenceNumber(0);
+
+  // the whole file in a single sub-manifest, then split in two sub-manifests each spanning
+  // buffers
+  size_t numPacketsInFile = fileSize / dataPacketSize + 1;
+  for (size_t subManifestSize : {numPacketsInFile, size_t(200)}) {
+    std::ifstream is(filePath, std::ios::binary);
+    size_t contentLength = 0;
+    for (size_t subManifestNum = 0; subManifestNum * subManifestSize < numPacketsInFile;
+         ++subManifestNum) {
+      size_t i = 0;
+      auto offset = subManifestNum * subManifestSize * dataPacketSize;
+      auto numPackets = IoUtil::packetize_file(filePath, prefix, dataPacketSize, subManifestSize,
+                                               subManifestNum,
+                                               [&](const Data& d, const Name& fullName) {
+        BOOST_CHECK_EQUAL(fullName, d.getFullName());
+        BOOST_CHECK_EQUAL(d.getName().get(-1).toSequenceNumber(), i);
+        // the content is the bytes of the file at the offset of the packet
+        const auto& content = d.getContent();
+        auto expectedLength = std::min(dataPacketSize, fileSize - offset);
+        BOOST_REQUIRE_EQUAL(content.value_size(), expectedLength);
+        std::vector<char> expected(expectedLength);
+        is.seekg(offset);
+        is.read(expected.data(), expected.size());
+        BOOST_REQUIRE(is);
+        BOOST_CHECK(std::equal(expected.begin(), expected.end(),
+                               reinterpret_cast<const char*>(content.value())));
+        contentLength += content.value_size();
+        offset += content.value_size();
+        ++i;
+      });
+      BOOST_CHECK_EQUAL(numPackets, i);
+      BOOST_CHECK_EQUAL(numPackets, std::min(subManifestSize,
+                                             numPacketsInFile - subManifestNum * subManifestSize));
+    }
+    BOOST_CHECK_EQUAL(contentLength, fileSize);
+  }
+
+  // a sub-manifest past the end of the file has no packets
+  BOOST_CHECK(IoUtil::packetize_file(filePath, prefix, dataPacketSize, numPacketsInFile, 1).empty());
+  boost::filesystem::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_CASE(TestReadDataPacketMapped)
+{
+  std::string filePath = "tests/testdata/foo/bar1.txt";
+  auto fileSize = boost::filesystem::file_size(filePath);
+  Name prefix("/ndn/multicast/NTORRENT/foo/bar1.txt");
+  prefix.appendSequenceNumber(0);
+
+  size_t dataPacketSize = 100;
+  size_t subManifestSize = fileSize / dataPacketSize + 1;
+  auto packets = IoUtil::packetize_file(filePath, prefix, dataPacketSize, subManifestSize, 0);
+  BOOST_REQUIRE(!packets.empty());
+
+  // the packets built from the mapped file are those read from its descriptor
+  FileHandleCache handles;
+  FileMapCache mappings;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    auto fullName = packets[i].getFullName();
+    auto read = IoUtil::readDataPacket(fullName, i * dataPacketSize, dataPacketSize, filePath,
+                                       handles);
+    auto mapped = IoUtil::readDataPacket(fullName, i * dataPacketSize, dataPacketSize, filePath,
+                                         mappings);
+    BOOST_REQUIRE(nullptr != read);
+    BOOST_REQUIRE(nullptr != mapped);
+    BOOST_CHECK(read->wireEncode() == mapped->wireEncode());
+    BOOST_CHECK(packets[i].wireEncode() == mapped->wireEncode());
+  }
+
+  // a packet whose content does not match its name is not served
+  auto fullName = packets[0].getFullName();
+  BOOST_CHECK(nullptr == IoUtil::readDataPacket(fullName, 1, dataPacketSize, filePath, mappings));
+  BOOST_CHECK(nullptr == IoUtil::readDataPacket(fullName, 0, dataPacketSize,
+                                                "tests/testdata/foo/missing", mappings));
+
+  // the packets of a file truncated since it was mapped are no longer served
+  std::string dirPath = "tests/testdata/temp/";
+  boost::filesystem::create_directories(dirPath);
+  auto copyPath = dirPath + "bar1.txt";
+  boost::filesystem::copy_file(filePath, copyPath);
+  auto lastName = packets.back().getFullName();
+  auto lastOffset = (packets.size() - 1) * dataPacketSize;
+  BOOST_CHECK(nullptr != IoUtil::readDataPacket(lastName, lastOffset, dataPacketSize, copyPath,
+                                                mappings));
+  boost::filesystem::resize_file(copyPath, lastOffset);
+  BOOST_CHECK(nullptr == IoUtil::readDataPacket(lastName, lastOffset, dataPacketSize, copyPath,
+                                                mappings));
+  boost::filesystem::remove_all(dirPath);
+}
+
+BOOST_AUTO_TEST_CASE(TestLoadDirectory)
+{
+  std::string dirPath = "tests/testdata/temp/manifests/";
+  boost::filesystem::create_directories(dirPath + "bar");
+  auto manifests = FileManifest::generate("tests/testdata/foo/bar1.txt",
+                                          "/NTORRENT/foo/",
+                                          1,
+                                          1024);
+  BOOST_REQUIRE(1 < manifests.size());
+  // both encodings are read, in the order of the file paths
+  for (size_t i = 0; i < manifests.size(); ++i) {
+    auto filePath = dirPath + "bar/" + std::to_string(i);
+    if (0 == i % 2) {
+      IoUtil::save(manifests[i], filePath);
+    }
+    else {
+      io::save(manifests[i], filePath);
+    }
+    auto manifest_ptr = IoUtil::load<FileManifest>(filePath);
+    BOOST_REQUIRE(nullptr != manifest_ptr);
+    BOOST_CHECK_EQUAL(*manifest_ptr, manifests[i]);
+  }
+  BOOST_CHECK(nullptr == IoUtil::load<FileManifest>(dirPath + "missing"));
+
+  auto serial = IoUtil::load_directory<FileManifest>(dirPath);
+  auto parallel = IoUtil::load_directory<FileManifest>(dirPath, io::BASE64, 4);
+  BOOST_CHECK_EQUAL(serial.size(), manifests.size());
+  BOOST_CHECK(serial == parallel);
+  boost::filesystem::remove_all("tests/testdata/temp");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
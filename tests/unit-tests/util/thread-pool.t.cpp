@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "../boost-test.hpp"
+#include "util/thread-pool.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestThreadPool)
+
+BOOST_AUTO_TEST_CASE(TestRunAllTasks)
+{
+  ThreadPool pool(4);
+  BOOST_CHECK_EQUAL(pool.size(), 4);
+  std::vector<int> results(1000, 0);
+  std::atomic<int> count(0);
+  for (size_t i = 0; i < results.size(); ++i) {
+    pool.post([&results, &count, i] {
+      results[i] = i * 2;
+      ++count;
+    });
+  }
+  pool.wait();
+  BOOST_CHECK_EQUAL(count, 1000);
+  for (size_t i = 0; i < results.size(); ++i) {
+    BOOST_CHECK_EQUAL(results[i], i * 2);
+  }
+  // the pool can be reused after waiting
+  pool.post([&count] { ++count; });
+  pool.wait();
+  BOOST_CHECK_EQUAL(count, 1001);
+}
+
+BOOST_AUTO_TEST_CASE(TestException)
+{
+  ThreadPool pool(2);
+  std::atomic<int> count(0);
+  pool.post([] { throw std::runtime_error("task failed"); });
+  pool.post([&count] { ++count; });
+  BOOST_CHECK_THROW(pool.wait(), std::runtime_error);
+  BOOST_CHECK_EQUAL(count, 1);
+  // the error is only reported once
+  pool.wait();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn
@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+* Copyright (c) 2016 Regents of the University of California.
+*
+* This file is part of the nTorrent codebase.
+*
+* nTorrent is free software: you can redistribute it and/or modify it under the
+* terms of the GNU Lesser General Public License as published by the Free Software
+* Foundation, either version 3 of the License, or (at your option) any later version.
+*
+* nTorrent is distributed in the hope that it will be useful, but WITHOUT ANY
+* WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+* PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details.
+*
+* You should have received copies of the GNU General Public License and GNU Lesser
+* General Public License along with nTorrent, e.g., in COPYING.md file. If not, see
+* <http://www.gnu.org/licenses/>.
+*
+* See AUTHORS for complete list of nTorrent authors and contributors.
+*/
+
+#include "boost-test.hpp"
+#include "window-budget.hpp"
+
+#include <vector>
+
+namespace ndn {
+namespace ntorrent {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestWindowBudget)
+
+BOOST_AUTO_TEST_CASE(TestFairShare)
+{
+  WindowBudget budget(4);
+  auto first = budget.join(nullptr);
+  auto second = budget.join(nullptr);
+  BOOST_CHECK_EQUAL(budget.size(), 2);
+  BOOST_CHECK_EQUAL(budget.fairShare(), 4);
+
+  // alone, a torrent may use the whole budget
+  for (int i = 0; i < 4; ++i) {
+    BOOST_CHECK(budget.acquire(first));
+  }
+  BOOST_CHECK(!budget.acquire(first));
+  BOOST_CHECK_EQUAL(budget.outstanding(), 4);
+
+  // once both have Interests to send, each gets half of it
+  BOOST_CHECK(!budget.acquire(second));
+  BOOST_CHECK_EQUAL(budget.fairShare(), 2);
+  budget.update(first, 1, true);
+  BOOST_CHECK_EQUAL(budget.outstanding(), 1);
+  BOOST_CHECK(budget.acquire(first));
+  BOOST_CHECK(!budget.acquire(first));
+  BOOST_CHECK(budget.acquire(second));
+  BOOST_CHECK(budget.acquire(second));
+  BOOST_CHECK(!budget.acquire(second));
+
+  // leaving releases the outstanding Interests
+  budget.leave(first);
+  BOOST_CHECK_EQUAL(budget.outstanding(), 2);
+  BOOST_CHECK_EQUAL(budget.fairShare(), 4);
+  BOOST_CHECK(budget.acquire(second));
+  BOOST_CHECK(!budget.acquire(first));
+}
+
+BOOST_AUTO_TEST_CASE(TestWakeUp)
+{
+  WindowBudget budget(2);
+  std::vector<int> woken;
+  WindowBudget::Id ids[3];
+  for (int i = 0; i < 3; ++i) {
+    ids[i] = budget.join([&woken, i] { woken.push_back(i); });
+  }
+  BOOST_CHECK(budget.acquire(ids[0]));
+  BOOST_CHECK(budget.acquire(ids[0]));
+  // exhausted
+  BOOST_CHECK(!budget.acquire(ids[1]));
+  BOOST_CHECK(!budget.acquire(ids[2]));
+  BOOST_CHECK(woken.empty());
+
+  // the blocked torrents are woken up in the order they were denied, the updating one is not
+  budget.update(ids[0], 0, true);
+  BOOST_REQUIRE_EQUAL(woken.size(), 2);
+  BOOST_CHECK_EQUAL(woken[0], 1);
+  BOOST_CHECK_EQUAL(woken[1], 2);
+
+  // a torrent is woken up once per denial
+  budget.update(ids[0], 0, false);
+  BOOST_CHECK_EQUAL(woken.size(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace nTorrent
+} // namespace ndn